@@ -0,0 +1,109 @@
+/* Routines to count the open pixels in cubes about a sequence of */
+/* pixels from a summed-area table (integral volume) of the lattice, */
+/* so that each count takes eight lookups whatever the cube size */
+/* As in countbox, a pixel is open if its ID is below C3S or above */
+/* ABSGYP (so surface-marked pixels are counted) */
+/* The table is taken over the lattice padded periodically by */
+/* CUBEMAX/2 pixels on every side, so cubes need no wrapping; only */
+/* the CUBEMAX+1 planes of constant x needed for the current pixel are */
+/* kept, so pixels must be visited in nondecreasing x */
+/* The table is not updated by setphase, so it must be rebuilt (with */
+/* boxinit) after any change to the microstructure */
+
+#include "cemhyd.h"
+
+/* routine to allocate the table if need be and start it afresh for */
+/* the current microstructure */
+/* Called by makeinert */
+/* Calls logmsg */
+void boxinit()
+{
+        int i;
+        long int nplane;
+
+        if(sim->boxslab==NULL){
+                sim->boxside=SYSIZE+2*BOXHALF+1;
+                nplane=(long int)sim->boxside*sim->boxside;
+                sim->boxslab=(int *)malloc(nplane*sizeof(int));
+                if(sim->boxslab==NULL){
+                        logmsg(LOGDISSOLVE,LOGERROR,"Unable to allocate memory for box counts \n");
+                        exit(1);
+                }
+                for(i=0;i<BOXPLANES;i++){
+                        sim->boxplane[i]=(int *)malloc(nplane*sizeof(int));
+                        if(sim->boxplane[i]==NULL){
+                                logmsg(LOGDISSOLVE,LOGERROR,"Unable to allocate memory for box counts \n");
+                                exit(1);
+                        }
+                }
+        }
+        /* Plane 0 lies below all pixels, so is zero throughout */
+        memset(sim->boxplane[0],0,(size_t)sim->boxside*sim->boxside*sizeof(int));
+        sim->boxtop=0;
+}
+
+/* routine to compute plane boxtop+1 of the table from plane boxtop */
+/* by adding the 2-D table of the padded plane of pixels boxtop */
+/* Called by boxcount */
+/* Calls no other routines */
+void boxnext()
+{
+        int hx,hy,py,pz,*prev,*cur;
+        int zwrap[MAXSYSIZE+2*BOXHALF];
+        char *row;
+
+        hx=(sim->boxtop-BOXHALF+SYSIZE)%SYSIZE;
+        for(pz=0;pz<(sim->boxside-1);pz++){
+                zwrap[pz]=(pz-BOXHALF+SYSIZE)%SYSIZE;
+        }
+        for(pz=0;pz<sim->boxside;pz++){
+                sim->boxslab[pz]=0;
+        }
+        for(py=0;py<(sim->boxside-1);py++){
+                hy=(py-BOXHALF+SYSIZE)%SYSIZE;
+                row=&sim->mic[VOXEL(hx,hy,0)];
+                prev=&sim->boxslab[py*sim->boxside];
+                cur=&sim->boxslab[(py+1)*sim->boxside];
+                cur[0]=0;
+                for(pz=0;pz<(sim->boxside-1);pz++){
+                        cur[pz+1]=cur[pz]+prev[pz+1]-prev[pz];
+                        if((row[zwrap[pz]]<C3S)||(row[zwrap[pz]]>ABSGYP)){
+                                cur[pz+1]+=1;
+                        }
+                }
+        }
+        prev=sim->boxplane[sim->boxtop%BOXPLANES];
+        cur=sim->boxplane[(sim->boxtop+1)%BOXPLANES];
+        for(pz=0;pz<(sim->boxside*sim->boxside);pz++){
+                cur[pz]=prev[pz]+sim->boxslab[pz];
+        }
+        sim->boxtop+=1;
+}
+
+/* routine to count the number of open pixels in a cube of size */
+/* boxsize (at most CUBEMAX) centered at (qx,qy,qz), using periodic */
+/* boundaries; qx may not be less than on the last call since boxinit */
+/* Called by makeinert */
+/* Calls boxnext */
+int boxcount(boxsize,qx,qy,qz)
+        int boxsize,qx,qy,qz;
+{
+        int boxhalf,xlo,xhi,ylo,yhi,zlo,zhi;
+        int *plo,*phi;
+
+        boxhalf=boxsize/2;
+        /* Bounds of the cube in the padded lattice, upper exclusive */
+        xlo=qx-boxhalf+BOXHALF;
+        xhi=qx+boxhalf+BOXHALF+1;
+        ylo=(qy-boxhalf+BOXHALF)*sim->boxside;
+        yhi=(qy+boxhalf+BOXHALF+1)*sim->boxside;
+        zlo=qz-boxhalf+BOXHALF;
+        zhi=qz+boxhalf+BOXHALF+1;
+        while(sim->boxtop<xhi){
+                boxnext();
+        }
+        plo=sim->boxplane[xlo%BOXPLANES];
+        phi=sim->boxplane[xhi%BOXPLANES];
+        return((phi[yhi+zhi]-phi[yhi+zlo]-phi[ylo+zhi]+phi[ylo+zlo])
+                -(plo[yhi+zhi]-plo[yhi+zlo]-plo[ylo+zhi]+plo[ylo+zlo]));
+}
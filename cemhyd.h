@@ -0,0 +1,955 @@
+/* Declarations shared by the files of disrealnew: system headers, */
+/* the constants of the model, the definitions used by more than one */
+/* file, the simulation context (struct sim), and the routines of */
+/* each file */
+/* Each file includes this header and is compiled separately */
+#ifndef CEMHYD_H
+#define CEMHYD_H
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+/* Binary images are mapped into memory unless compiled with -DNOMMAP */
+/* (see imgio.c) */
+#ifndef NOMMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+/* Compile with -DPARALLEL to move the diffusing species on several */
+/* threads (see pardiff.c); the members of an ensemble are run on */
+/* threads in every build (see ensemble.c), so link with -lpthread */
+#include <pthread.h>
+/* The current simulation is kept per thread in every build, so that */
+/* threads of a calling program may each run their own (see sim.c); */
+/* this needs no thread library */
+#define THREADLOCAL __thread	/* one copy of the variable per thread */
+
+#define MAXCYC 30000    /* Maximum number of cycles of hydration */
+			/* For hydration under sealed conditions: */
+#define CUBEMAX 7      /* Maximum cube size for checking pore size */
+#define CUBEMIN 3      /* Minimum cube size for checking pore size */
+/* System size in pixels per dimension is determined at run time */
+/* from the input microstructure (see lattice.c) */
+/* Compile with -DFIXEDSIZE=100 (for example) to hardwire the size */
+#ifdef FIXEDSIZE
+#define SYSIZE FIXEDSIZE    /* System size in pixels per dimension */
+#define SYSIZEM1 (FIXEDSIZE-1)    /* System size -1 */
+#else
+#define SYSIZE sim->syssize    /* System size in pixels per dimension */
+#define SYSIZEM1 sim->syssizem1    /* System size -1 */
+#endif
+/* Linear offset of pixel (x,y,z) in the lattice arrays */
+#define VOXEL(x,y,z) ((((long)(x))*SYSIZE+(long)(y))*SYSIZE+(long)(z))
+#define DISBIAS 30.0  /* Dissolution bias- to change all dissolution rates */
+#define DISMIN 0.001  /* Minimum dissolution for C3S dissolution */
+#define DISMIN2 0.00025  /* Minimum dissolution for C2S dissolution */
+#define DISMINSLAG 0.0001  /* Minimum dissolution for SLAG dissolution */
+#define DISMINASG 0.0005  /* Minimum dissolution for ASG dissolution */
+#define DISMINCAS2 0.0005  /* Minimum dissolution for CAS2 dissolution */
+#define DISMIN_C3A_0 0.002  /* Minimum dissolution for C3A dissolution */
+#define DISMIN_C4AF_0 0.0005  /* Minimum dissolution for C4AF dissolution */
+/* Limits on numbers of diffusing species are given for a 100^3 system */
+/* and are scaled by sysvolfact for other system sizes */
+#define DETTRMAX (1200*sim->sysvolfact) /* Maximum allowed # of ettringite diffusing species */
+#define DGYPMAX (2000*sim->sysvolfact)   /*  Maximum allowed # of gypsum diffusing species */
+#define DCACO3MAX (1000*sim->sysvolfact)   /*  Maximum allowed # of CaCO3 diffusing species */
+#define DCACL2MAX (2000*sim->sysvolfact) /* Maximum allowed # of CaCl2 diffusing species */
+#define DCAS2MAX (2000*sim->sysvolfact) /* Maximum allowed # of CAS2 diffusing species */
+#define CHCRIT (50.0*sim->sysvolfact)   /* Scale parameter to adjust CH dissolution probability */
+#define C3AH6CRIT (10.0*sim->sysvolfact)   /* Scale par. to adjust C3AH6 dissolution prob. */
+#define C3AH6GROW 0.01  /* Probability for C3AH6 growth */
+#define CHGROW 1.0      /* Probability for CH growth */
+#define CHGROWAGG 1.0      /* Probability for CH growth on aggregate surface */
+#define ETTRGROW 0.002   /* Probability for ettringite growth */
+#define C3AETTR 0.001    /* Probability for reaction of diffusing C3A
+                             with ettringite  */
+#define C3AGYP 0.001      /*  Probability for diffusing C3A to react with diffusing gypsum */
+									/* diffusing anhydrite, and diffusing hemihydrate */
+#define SOLIDC3AGYP 0.5    /* Probability of solid C3A to react with diffusing sulfate */
+#define SOLIDC4AFGYP 0.1  /* Probability of solid C4AF to react with diffusing sulfate */
+#define PPOZZ 0.05      /* base probability for pozzolanic reaction */
+#define PCSH2CSH 0.002  /* probability for CSH dissolution */
+			/* for conversion of C-S-H to pozz. C-S-H */
+#define A0_CHSOL 1.325  /* Parameters for variation of CH solubility with */
+#define A1_CHSOL 0.008162   /* temperature (data from Taylor- Cement Chemistry) */
+/* changed CSHSCALE to 70000 6/15/01  to better model induction CS */
+#define CSHSCALE (70000.*sim->sysvolfact)  /*scale factor for CSH controlling induction */
+#define WCSCALE 0.4      /* scale factor for influence of w/c on induction */
+#define WCSULFSCALE 0.5    /* scale factor for influence of w/c on sulfate acceleration of silicates and aluminates */
+#define C3AH6_SCALE 2000.  /*scale factor for C3AH6 controlling induction of aluminates */
+#define NEIGHBORS 26	/* number of neighbors to consider (6, 18, or 26) */
+/* define IDs for each phase used in model */
+/* To add a solid phase, insert new phase before ABSGYP */
+/*  and increment all subsequent IDs */
+/* To add a diffusing species, insert just before DIFFCACL2 */
+/*  and increment all subsequent IDs */
+#define POROSITY 0
+#define C3S 1
+#define C2S 2
+#define C3A 3
+#define C4AF 4
+#define GYPSUM 5
+#define HEMIHYD 6
+#define ANHYDRITE 7
+#define POZZ 8
+#define INERT 9
+#define SLAG 10
+#define ASG 11		  /* aluminosilicate glass */
+#define CAS2 12
+#define CH 13
+#define CSH 14
+#define C3AH6 15
+#define ETTR 16
+#define ETTRC4AF 17     /* Iron-rich stable ettringite phase */
+#define AFM 18
+#define FH3 19
+#define POZZCSH 20
+#define SLAGCSH 21      /* Slag gel-hydration product */
+#define CACL2 22
+#define FREIDEL 23	  /* Freidel's salt */
+#define STRAT 24	  /* stratlingite (C2ASH8) */
+#define GYPSUMS 25	/* Gypsum formed from hemihydrate and anhydrite */
+#define CACO3 26
+#define AFMC 27
+#define INERTAGG 28
+#define ABSGYP 29
+#define DIFFCSH 30
+#define DIFFCH 31
+#define DIFFGYP 32
+#define DIFFC3A 33
+#define DIFFC4A 34
+#define DIFFFH3 35
+#define DIFFETTR 36
+#define DIFFCACO3 37
+#define DIFFAS 38
+#define DIFFANH 39
+#define DIFFHEM 40
+#define DIFFCAS2 41
+#define DIFFCACL2 42
+#define EMPTYP 45         /* Empty porosity due to self desiccation */
+#define OFFSET 50         /* Offset for highlighted potentially soluble pixel */
+/* define heat capacities for all components in J/g/C */
+/* including free and bound water */
+#define Cp_cement 0.75
+#define Cp_pozz 0.75
+#define Cp_agg 0.84
+#define Cp_CH 0.75
+#define Cp_h2o 4.18     /* Cp for free water */
+#define Cp_bh2o 2.2     /* Cp for bound water */
+#define WN 0.23        /* water bound per gram of cement during hydration */
+#define WCHSH 0.06     /* water imbibed per gram of cement during chemical
+			 shrinkage (estimate) */
+
+/* Random numbers (see ran1.c and ranc.c) */
+#define RANTAB 32	/* shuffle table of ran1 */
+#define RNGLEGACY 0	/* single ran1 sequence, as in earlier versions */
+#define RNGCOUNTER 1	/* counter-based streams */
+
+#define RNGCYCLE 1	/* sequential draws in the main program */
+#define RNGDISSOLVE 2	/* dissolution or reaction of one pixel */
+#define RNGSTEP 3	/* one diffusion step of one species */
+#define RNGPLACE 4	/* product placed after the domains of a colour move */
+
+#define RANBATCH 256	/* most random numbers drawn ahead at one time */
+#define RANLANES 8	/* counter blocks computed side by side */
+/* Third word of the counter of the stream of kind tag and sub */
+#define RNGTAGWORD(tag,sub) ((((unsigned int)(tag))<<24)|(((unsigned int)(sub))&0xFFFFFFu))
+
+/* Lattice (see lattice.c) */
+#define MAXSYSIZE 1024	/* limited by 10-bit coordinates packed in struct ants */
+
+/* Microstructure images (see imgio.c) */
+#define IMGMAGIC "CEMHYDBI"
+#define IMGVERSION 1
+
+#define IMGTEXT 0	/* one value per line, as in earlier versions */
+#define IMGBINARY 1	/* header and raw pixel values */
+#define IMGCOMPRESSED 2	/* header and compressed pixel values */
+
+#define IMGPLAIN 0	/* pixel values stored as they are */
+#define IMGZIP 2	/* pixel values coded by zipimage */
+
+/* header of a binary image, 292 bytes */
+struct imghead{
+        char magic[8];	/* IMGMAGIC, not null terminated */
+        int version;	/* IMGVERSION */
+        int xsize,ysize,zsize;
+        int bytes;	/* bytes per pixel value: 1 or 4 */
+        unsigned int checksum;	/* FNV-1a hash of the pixel values */
+        int coding;	/* IMGPLAIN or IMGZIP */
+        unsigned char phasemap[256];	/* value read for each stored byte */
+};
+
+/* image being read, in either form */
+struct imgfile{
+        FILE *text;	/* text image, or NULL if binary */
+        struct imghead head;
+        unsigned char *base;	/* start of the mapped or loaded file */
+        unsigned char *pix;	/* pixel values of a binary image, */
+                                /* expanded if compressed */
+        long int len;	/* length of the binary file */
+        long int next;	/* next pixel value to read */
+};
+
+/* Hydration movies (see movie.c) */
+#define MOVMAGIC "CEMHYDMV"
+#define MOVVERSION 2
+#define MOVMAXPLANE 16	/* most planes followed in one movie */
+#define MOVKEYEVERY 25	/* default frames between keyframes */
+
+#define MOVFULL 3	/* axis value for the whole lattice */
+
+#define MOVKEY 0	/* every pixel, one byte each */
+#define MOVDELTA 1	/* changed pixels since the previous frame */
+#define MOVKEYZIP 2	/* every pixel, compressed by zipimage */
+
+/* header of a movie file */
+struct movhead{
+        char magic[8];	/* MOVMAGIC, not null terminated */
+        int version;	/* MOVVERSION */
+        int nside;	/* system size */
+        int nplane;	/* planes followed, or 1 for the whole lattice */
+        int keyevery;	/* frames between keyframes */
+        int axis[MOVMAXPLANE];	/* 0, 1 or 2 for x, y or z, or MOVFULL */
+        int pos[MOVMAXPLANE];	/* coordinate of plane along axis */
+};
+
+/* header of each frame */
+struct movframe{
+        int cycle;	/* cycle at which frame was taken */
+        int kind;	/* MOVKEY, MOVDELTA or MOVKEYZIP */
+        int nbytes;	/* bytes following this header */
+};
+
+/* movie being written or read */
+struct movie{
+        FILE *file;
+        struct movhead head;
+        long int npix;	/* pixels followed in each frame */
+        unsigned char *last;	/* pixels at frame at (or last written) */
+        unsigned char *now;	/* pixels being gathered for a frame */
+        unsigned char *buf;	/* bytes of a frame */
+        long int nbuf;	/* size of buf */
+        int nframe;	/* frames written or in file */
+        int at;	/* frame held in last when reading, or -1 */
+        long int *offset;	/* file offset of each frame, and of the */
+                                /* end of the last (reading) */
+        int *cycle;	/* cycle of each frame (reading) */
+        int *kind;	/* kind of each frame (reading) */
+};
+
+/* Output files (see output.c) */
+#define OUTMAXFILE 32	/* most output files */
+#define OUTNAME 80	/* bytes for the name of a file of a run */
+#define OUTSUFFIX 20	/* longest suffix added to the root, as .heat.29999.1000.222 */
+
+/* Run parameters (see config.c) */
+#define CFGMAXENTRY 256	/* most parameters in a file and command line */
+#define CFGVALUE 80	/* longest value, including the terminating null */
+
+/* a value from the configuration file or the command line */
+struct cfgentry{
+        struct cfgkey *key;
+        char value[CFGVALUE];
+        int cmdline;	/* 1 if from the command line */
+        int used;
+};
+
+/* Pool of diffusing species (see species.c) */
+/* Location is packed as 10-bit x,y,z fields to allow systems up to */
+/* 1024 pixels per side */
+#define ANTLOC(x,y,z) ((((unsigned int)(x))<<20)|(((unsigned int)(y))<<10)|((unsigned int)(z)))
+#define ANTX(loc) ((int)((loc)>>20))
+#define ANTY(loc) ((int)(((loc)>>10)&1023))
+#define ANTZ(loc) ((int)((loc)&1023))
+
+/* Frontier of pore space (see surface.c) */
+#define OPENPH(ph) (((ph)<C3S)||((ph)>ABSGYP))
+#define SURFWORD(iv) ((iv)>>5)
+#define SURFBIT(iv) (1u<<((iv)&31))
+/* Position of the lowest set bit of a nonzero 32-bit word */
+#define SURFLOW(bits) (surfdebruijn[(((bits)&(-(bits)))*0x077CB531u)>>27])
+
+/* Summed-area table (see boxsum.c) */
+#define BOXHALF (CUBEMAX/2)	/* padding on each side of the lattice */
+#define BOXPLANES (CUBEMAX+1)	/* planes of the table kept at once */
+
+/* Sub-domains for parallel diffusion (see pardiff.c) */
+struct domain {
+        int x0,nx,y0,ny;	/* extent of domain in x and y */
+        long int first,nin;	/* species of domain in domant */
+        long int nout,ngone;	/* surviving and reacted species */
+        long int back;	/* position of its survivors in the pool */
+        /* Pixels to be added to (2*iv+1) or removed from (2*iv) the */
+        /* list of pore pixels for changes in this domain, once the */
+        /* domains of its colour have moved (see pores.c) */
+        long int *porelog,nporelog,porelogcap;
+        /* Phases of products to be placed at random anywhere in the */
+        /* lattice for reactions in this domain, once the domains of */
+        /* its colour have moved (see extrand) */
+        int *extq;
+        long int nextq,extqcap;
+};
+
+#define JOBDOMAINS 1	/* move the species of the domains of one colour */
+#define JOBCOUNT 2	/* count the species of each domain in part of the pool */
+#define JOBSORT 3	/* sort part of the pool by domain */
+#define JOBGATHER 4	/* gather the survivors of each domain into the pool */
+#define JOBMERGE 5	/* add thread counts to those of the main thread */
+#define JOBLABEL 6	/* label the changed blocks of a cluster lattice */
+#define JOBQUIT 7	/* stop the threads */
+
+/* Profile of run time (see prof.c) */
+#define PROFPASSONE 0	/* passone */
+#define PROFPASSTWO 1	/* pass two of dissolve */
+#define PROFINERT 2	/* makeinert */
+#define PROFHYDRATE 3	/* hydrate */
+#define PROFPH 4	/* pHpred */
+#define PROFBURN3D 5	/* burn3d */
+#define PROFBURNSET 6	/* burnset */
+#define PROFPARTHYD 7	/* parthyd */
+#define PROFOUTPUT 8	/* movie, snapshots and output files */
+#define PROFCKPT 9	/* checkpoint */
+#define NPROF 10
+#define NPROFSPEC (DIFFCACL2-DIFFCSH+1)	/* kinds of diffusing species */
+#define PROFSAMPLE 32	/* species steps for each one timed */
+
+/* Count n pixels scanned by the kernel being timed */
+#define PROFSCAN(n) (sim->profnvox+=(long int)(n))
+
+/* Levels of messages (see log.c) */
+#define LOGERROR 0	/* the run cannot go on */
+#define LOGWARN 1	/* something is amiss, but the run goes on */
+#define LOGINFO 2	/* set up and progress, a few lines a cycle */
+#define LOGDEBUG 3	/* everything, as printed by earlier versions */
+/* and the subsystems they come from */
+#define LOGSETUP 0	/* parameters, lattice and files */
+#define LOGCYCLE 1	/* progress of each cycle */
+#define LOGDISSOLVE 2	/* dissolve and the counts of phases */
+#define LOGHYDRATE 3	/* hydrate and the diffusing species */
+#define LOGPH 4	/* pHpred */
+#define LOGPERC 5	/* burn3d, burnset and parthyd */
+#define LOGOUTPUT 6	/* output files and checkpoints */
+#define LOGENSEMBLE 7	/* members of an ensemble */
+#define LOGPROF 8	/* summary of profile */
+#define NLOGSUB 9
+
+/* Placement of species and phases (see pores.c) */
+#define PLACEDRAW 0	/* reject random pixels, as in earlier versions (default) */
+#define PLACEINDEX 1	/* pick from the list of pore pixels */
+/* Phases listed with the pore pixels: diffusing species only trade */
+/* places with porosity, so that their moves leave the list alone */
+#define PORELISTED(ph) (((ph)==POROSITY)||(((ph)>=DIFFCSH)&&((ph)<=DIFFCACL2)))
+
+/* Percolation clusters (see perc.c) */
+#define PERCOUT 0	/* not part of any cluster */
+#define PERCPART 1	/* joined within initial particles */
+#define PERCLINK 2	/* joined to all cluster neighbors */
+
+#define PERCPORE 0	/* lattice for the porosity check */
+#define PERCSET 1	/* lattice for the set check */
+#define NPERCLAT 2
+
+#define PERCBLK 8	/* pixels along a side of a block */
+
+/* Results for one burn direction */
+struct percres{
+        long int ntop;	/* pixels in clusters touching the first face */
+        long int nthrough;	/* pixels in clusters touching both faces */
+        long int nclus;	/* number of clusters */
+        long int maxclus;	/* pixels in the largest cluster */
+};
+
+/* Clusters of one kind, kept from one check to the next */
+struct perclat{
+        char type[256];	/* class of each phase ID */
+        int *lab;	/* cluster of each pixel within its block, or -1 */
+        char *dirty;	/* blocks changed since they were labelled */
+        int *nloc;	/* number of clusters in each block */
+        int **locsize;	/* pixels in each cluster of each block */
+        int *npair;	/* pairs of clusters joined across each face */
+        int **pair;	/* and the clusters of each pair */
+};
+
+/* Checkpoints (see checkpoint.c) */
+#define CKMAXITEM 256	/* most items of state */
+#define CKMAXFILE 16	/* most output files cut back on restart */
+
+/* an item of state saved as it is in memory */
+struct ckitem{
+        char name[32];
+        void *addr;
+        long int size;
+};
+
+#define CKADD(var) ckadd(#var,(void *)&(var),(long int)sizeof(var))
+
+/* Simulation context */
+/* Every variable a simulation changes is held in a struct sim, so */
+/* that several independent simulations can be kept in one process; */
+/* the routines reach the current simulation through the pointer sim */
+/* (made with simnew and selected with simuse, see sim.c) */
+/* Variables changed by the hydration routines while species move are */
+/* held instead in a struct simthread, reached through simt, of which */
+/* the main thread and each worker thread of a parallel build have */
+/* their own copy */
+/* In a parallel build sim and simt are themselves THREADLOCAL, so */
+/* that independent simulations may be run at once on different */
+/* threads */
+
+/* State private to each thread of a simulation */
+struct simthread{
+        struct sim *owner;	/* simulation of the thread */
+        int ithr;	/* worker thread index, or -1 for the main thread */
+        /* counts for dissolved and solid species */
+        long int count[EMPTYP+1];
+        long int ncshplategrow,ncshplateinit;
+        /* Counts for pozzolan and aluminosilicate reacted */
+        long int npr,nasr;
+        long int gypready;
+        int *seed;       /* Random number seed */
+        long int ncshage[MAXCYC];	/* number of solid C-S-H pixels of each age */
+        /* Shuffle table of ran1 */
+        int ran1iv[RANTAB],ran1iy;
+        unsigned int rngctr[4];	/* counter of current stream */
+        int rngblocks;	/* blocks to compute at next refill */
+        double ranbuf[RANBATCH];	/* random numbers drawn ahead */
+        int ranpos,ranlen;	/* next unused and number in ranbuf */
+        /* First blocks of streams computed ahead (see ranahead) */
+        double aheadbuf[4*RANLANES];
+        long int aheadid[RANLANES];	/* updates they belong to */
+        int nahead,aheadnext;	/* number held and next expected */
+        unsigned int aheadtag,aheadcyc;	/* kind and cycle of the updates */
+        struct domain *curdom;	/* domain being processed */
+        int domidum;	/* ran1 seed of the current domain */
+        /* Blocks marked changed by setphase; in a parallel build, the */
+        /* main thread marks those of perclats, and each worker its own, */
+        /* which are added to those of the main thread by parmerge */
+        char *percdirty[NPERCLAT];
+        /* Seconds, steps and reactions of each kind of diffusing */
+        /* species since gathered by profgather (see prof.c) */
+        double profspec[NPROFSPEC];
+        long int profmove[NPROFSPEC],profreact[NPROFSPEC];
+        long int profnstep;	/* steps taken, for sampling their time */
+};
+
+/* State of one simulation */
+struct sim{
+        /* Microstructure stored in array mic of type char to minimize storage */
+        /* Initial particle IDs stored in array micpart (for assessing set point) */
+        /* All lattice arrays are allocated by alloclattice once the system */
+        /* size is known and are indexed using VOXEL(x,y,z) */
+        char *mic;
+        char *micorig;
+        int *micpart;
+        short int *cshage;
+        short int *faces;
+        int syssize,syssizem1;     /* Run-time system size */
+        float sysvolfact;   /* System volume relative to a 100^3 system */
+        int maxpartid;	/* Largest particle ID in particle image */
+        /* counts for dissolved and solid species */
+        long int discount[EMPTYP+1],countinit[EMPTYP+1];
+        /* Counts for initial pozzolan, gypsum, ettringite, and */
+        /* initial porosity */
+        long int nfill,ncsbar,netbar,porinit,nslagr,slagemptyp;
+        /* Initial clinker phase counts */
+        long int c3sinit,c2sinit,c3ainit,c4afinit,anhinit,heminit,chold,chnew;
+        long int nmade,ngoing,poregone,poretodo,countpore;
+        long int countkeep,water_left,water_off,pore_off;
+        int ncyc,cyccnt,cubesize,sealed,outfreq;
+        int icyc,burnfreq,setfreq,setflag,sf1,sf2,sf3,porefl1,porefl2,porefl3;
+        /* Parameters for kinetic modelling ---- maturity approach */
+        float ind_time,temp_0,temp_cur,time_step,time_cur,E_act,beta,heat_cf;
+        float w_to_c,s_to_c,krate,totfract,tfractw04,fractwithfill;
+        float kpozz,kslag;
+        float tfractw05,surffract,pfract,pfractw05,sulf_conc;
+        long int scntcement,scnttotal;
+        float U_coeff,T_ambient;
+        float alpha_cur,heat_old,heat_new,cemmass,mass_agg,mass_water,mass_fill,Cp_now;
+        float alpha,CH_mass,mass_CH,mass_fill_pozz,E_act_pozz,chs_new,cemmasswgyp;
+        float flyashmass,alpha_fa_cur;
+        float E_act_slag;
+        /* Arrays for variable CSH molar volume and water consumption */
+        float molarvcsh[MAXCYC],watercsh[MAXCYC],heatsum,molesh2o,saturation;
+        /* Arrays for dissolution probabilities for each phase */
+        float disprob[EMPTYP+1],disbase[EMPTYP+1],gypabsprob,ppozz;
+        /* Arrays for specific gravities, molar volumes, heats of formation, and */
+        /* molar water consumption for each phase */
+        float specgrav[EMPTYP+1],molarv[EMPTYP+1],heatf[EMPTYP+1],waterc[EMPTYP+1];
+        /* Solubility flags and diffusing species created for each phase */
+        /* Also flag for C1.7SH4.0 to C1.1SH3.9 conversion */
+        int soluble[EMPTYP+1],creates[EMPTYP+1],csh2flag,adiaflag,chflag,nummovsl;
+        float cs_acc;     /* increases disprob[C3S] and disprob[C2S] if gypsum is present */
+        float ca_acc;    /* increases disprob[C3A] and disprob[C4AF] if gypsum is present */
+        float dismin_c3a;
+        float dismin_c4af;
+        float gsratio2,onepixelbias;
+        /* Slag probabilities */
+        float p1slag;   /*  probability SLAG is converted to SLAGCSH */
+        float p2slag;   /*  probability SLAG is converted to POROSITY or EMPTYP */
+        float p3slag;   /*  probability adjoining pixel is converted to SLAGCSH */
+        float p4slag;   /*  probability CH is consumed during SLAG reaction */
+        float p5slag;   /*  probability a C3A diffusing species is created */
+        float slagcasi,slaghydcasi;   /* Ca/Si ratios for SLAG and SLAGCSH */
+        float slagh2osi;     /* H/S ratio of SLAGCSH */
+        float slagc3a;       /* C3A/slag molar ratio */
+        float siperslag;     /* S ratio of SLAG (per mole) */
+        float slagreact;     /* Base dissolution reactivity factor for SLAG */
+        long int DIFFCHdeficit,slaginit;   /* Deficit in CH due to SLAG reaction */
+        long int slagcum,chgone;
+        long int nch_slag;    /* number of CH consumed by SLAG reaction */
+        long int sulf_cur;
+        long int sulf_solid;
+        char heatname[OUTNAME],adianame[OUTNAME],phname[OUTNAME],ppsname[OUTNAME],ptsname[OUTNAME],phrname[OUTNAME];
+        char chshrname[OUTNAME],moviename[OUTNAME],parname[OUTNAME],micname[OUTNAME];
+        char pHname[OUTNAME],fileroot[OUTNAME];
+        FILE *movfile;
+        /* Variables for alkali predictions */
+        float pH_cur,totsodium,totpotassium,rssodium,rspotassium;
+        /* Array for whether pH influences phase solubility  -- added 2/12/02 */
+        float pHeffect[EMPTYP+1],pHfactor;
+        int pHactive,resatcyc,cshgeom;
+        /* Keep conccaplus and moles_syn_precip from one call of pHpred */
+        /* to the next to speed up execution and accumulate properly */
+        double conccaplus,moles_syn_precip,concsulfate;
+        int cshboxsize;		/* Box size for addition of extra diffusing C-S-H */
+
+        /* Run of the main program, carried from one cycle to the next */
+        /* (see simstart, simcycle and simend in disrealnew.c) */
+        int iseed;       /* Random number seed */
+        int ntimes,phydfreq,nmovstep,cycflag;
+        float pnucch,pscalech,pnuchg,pscalehg,pnucfh3,pscalefh3;
+        float pnucgyp,pscalegyp;
+        FILE *thfile;	/* programmed temperature history */
+        float thtimelo,thtimehi,thtemplo,thtemphi;
+        long int thpos;
+        float mass_cem_now;
+        struct movie movie;
+        char imgname[OUTNAME];	/* final microstructure image */
+        int finished;	/* 1 once simend has been called */
+        void (*cyclefn)();	/* called at the end of each cycle, or NULL */
+        void *cyclearg;	/* and its argument (see cemhydcallback) */
+
+        /* Random numbers (see ranc.c) */
+        int rngmode;	/* RNGLEGACY or RNGCOUNTER */
+        unsigned int rngkey[2];	/* key made from input seed */
+
+        /* Forms of images and movie written (see imgio.c and movie.c) */
+        int imgout;	/* form of the final image */
+        int imgsnap;	/* form of the periodic snapshots */
+        int movmode;	/* 1 if the movie of main is written by movwrite */
+        char *movspec;	/* planes to follow, from CEMHYD_MOVIE */
+        int movkey;	/* frames between keyframes, from CEMHYD_MOVIEKEY */
+
+        /* Output files (see output.c) */
+        int outoff;	/* 1 if no files, snapshots or movie are written */
+        char outname[OUTMAXFILE][256];	/* names of files */
+        FILE *outfp[OUTMAXFILE];	/* open files, or NULL */
+        int noutfile;
+        int outasync;	/* 1 if written by the output thread */
+        int outheld;	/* 1 while output is discarded (see outhold) */
+        char *outbuf[2];	/* snapshot buffers */
+#ifdef PARALLEL
+        unsigned char *outring;	/* ring of records */
+        long int outsize;	/* bytes in ring, a multiple of 8 */
+        long int outhead;	/* bytes put in ring (main thread) */
+        long int outtail;	/* bytes taken from ring (output thread) */
+        int outidle;	/* 1 while output thread waits for records */
+        int outbusy[2];	/* 1 while snapshot buffer is being written */
+        int outnext;	/* snapshot buffer to fill next */
+        pthread_t outthread;
+        pthread_mutex_t outmutex;
+        pthread_cond_t outwake;
+#endif
+
+        /* Run parameters (see config.c) */
+        struct cfgentry cfgentries[CFGMAXENTRY];
+        int ncfgentry;
+        int cfgkeyed;		/* 1 if read from a configuration file */
+        struct cfgentry cfgused[CFGMAXENTRY];	/* values used, in turn */
+        int ncfgused;
+
+        /* Pool of diffusing species (see species.c) */
+        unsigned int *antloc;	/* packed location, see ANTLOC */
+        short int *antbirth;	/* cycle of creation, for C-S-H aging */
+        unsigned char *antid;	/* phase ID of each diffusing species */
+        long int nants,antcap;	/* number in use and allocated */
+
+        /* Frontier of pore space (see surface.c) */
+        unsigned char *nopen;	/* number of open pixels in the 3x3x3 box */
+        unsigned char *nnear;	/* number of open pixels in the 5x5x5 box */
+        unsigned int *surfbits;	/* solid pixels with nopen>0 */
+        unsigned int *nearbits;	/* solid pixels with nnear>0 */
+        unsigned int *visitbits;	/* pixels still to be visited in pass two */
+        long int nsurfwords;
+        long int visitcur;	/* pixel currently being visited in pass two */
+        int visitcsh,visitslag;	/* C-S-H and slag pixels may react in pass two */
+
+        /* Phase changes (see phases.c) */
+        /* Classes of each phase in the cluster lattices in use (see perc.c) */
+        unsigned char percclass[256];
+        int poreok;	/* list of pore pixels is in use (see pores.c) */
+
+        /* Summed-area table (see boxsum.c) */
+        int *boxplane[BOXPLANES];	/* table planes, by padded x modulo BOXPLANES */
+        int *boxslab;	/* 2-D table of the current plane of pixels */
+        int boxside;	/* padded system size plus one */
+        int boxtop;	/* highest plane of the table computed */
+
+        /* Sub-domains and worker threads (see pardiff.c) */
+        int nthreads;		/* number of worker threads */
+#ifdef PARALLEL
+        struct simthread *workers;	/* state of each worker thread */
+        int ndomx,ndomy,ndoms;	/* number of domains in x, y and in all */
+        int *domofx,*domofy;	/* domain index of each x and y coordinate */
+        struct domain *doms;
+        int *domcolor[4],ncolor[4];	/* domains of each colour */
+        long int *domant;	/* pool indices of species sorted by domain */
+        /* Species of each domain in the part of the pool of each */
+        /* thread, and then where the first of them goes in domant */
+        long int *thrhist;
+        unsigned int *outloc;	/* survivors of each domain, as in the pool */
+        short int *outbirth;
+        unsigned char *outid;
+        long int outcap;
+        /* Work posted to the threads by runjob */
+        pthread_mutex_t poolmutex;
+        pthread_cond_t poolstart;
+        pthread_cond_t pooldone;
+        int pooljob,poolgen,poolbusy,poolcolor,poolnext;
+        int jobstep,jobterm,jobseed;
+        long int jobplaced;	/* products placed after colours in this step */
+        float jobch,jobc3ah6,jobfh3,jobgyp;
+        /* Counts at the start of a colour, and changes made to them by */
+        /* each thread */
+        long int phasecount[EMPTYP+1],phasenpr;
+        long int (*thrcount)[EMPTYP+1],*thrnpr;
+        long int *mainncshage,*maingypready,*mainnasr,*mainplategrow,*mainplateinit;
+#endif
+
+        /* Placement of species and phases (see pores.c) */
+        int placemode;
+        int *poresite;	/* lattice index of each listed pixel */
+        int *poreat;	/* position of each listed pixel in poresite */
+        long int nporesite;	/* number of pixels in poresite */
+
+        /* Percolation clusters (see perc.c) */
+        struct perclat perclats[NPERCLAT];
+        int percnb;		/* blocks along a side of the lattice */
+        long int percnblk;	/* blocks in the lattice */
+        long int *percjob,npercjob;	/* blocks to label at this check */
+        struct perclat *poollat;	/* lattice whose blocks are being labelled */
+        int percpairs[2*PERCBLK*PERCBLK];	/* pairs found across one face */
+
+        /* Checkpoints (see checkpoint.c) */
+        struct ckitem ckitems[CKMAXITEM];
+        int nckitem;
+        char *ckfiles[CKMAXFILE];	/* output files to cut back on restart */
+        int nckfile;
+        int ckevery;	/* cycles between checkpoints, or 0 for none */
+        char ckname[256];	/* checkpoint file to write */
+        char *ckrestart;	/* checkpoint file to restart from, or NULL */
+
+        /* Profile of run time (see prof.c) */
+        int profon;	/* 1 if the kernels are timed */
+        char profname[OUTNAME];	/* profile file */
+        double profbegin;	/* time the first cycle started */
+        double proflast;	/* time the last line was written */
+        int profkern;	/* kernel being timed, or -1 for none */
+        double profat;	/* time it started */
+        long int profnvox;	/* pixels it has scanned */
+        double profsec[NPROF];	/* seconds in each kernel this cycle */
+        long int profpix[NPROF];	/* and pixels scanned */
+        double proftotsec[NPROF];	/* and over the run */
+        long int proftotpix[NPROF];
+        double proftotspec[NPROFSPEC];	/* seconds, steps and reactions */
+        long int proftotmove[NPROFSPEC];	/* of each kind of species */
+        long int proftotreact[NPROFSPEC];	/* over the run */
+        long int proftotmade;	/* species dissolved over the run */
+        int profncyc;	/* lines written */
+
+        /* Messages (see log.c) */
+        int loglevel[NLOGSUB];	/* highest level printed by each subsystem */
+        char *logring;	/* ring of the last messages held back */
+        long int logsize;	/* its size in bytes */
+        long int loghead;	/* bytes written to it since last emptied */
+        int logdirty;	/* 1 if printed to since last flushed */
+        FILE *logfile;	/* file printed to, or NULL for standard output */
+#ifdef PARALLEL
+        pthread_mutex_t logmutex;
+#endif
+
+        struct simthread mainthr;	/* state of the main thread */
+};
+
+extern THREADLOCAL struct sim *sim;	/* current simulation */
+extern THREADLOCAL struct simthread *simt;	/* and state of this thread */
+
+/* Tables shared by all simulations */
+extern int xoff[27],yoff[27],zoff[27];
+extern int primevalues[6];
+extern int surfdebruijn[32];
+
+/* Ensemble settings, from the command line (see config.c and ensemble.c) */
+extern char *ensname;
+extern int ensseeds;
+extern int ensjobs;
+
+/* Routines of each file */
+/* sim.c */
+struct sim *simnew();
+void simuse();
+void simfree();
+/* disrealnew.c */
+void init();
+int chckedge();
+void marksurf();
+void passone();
+int loccsh();
+int countbox();
+int countboxc();
+void makeinert();
+void extslagcsh();
+void dissolve();
+void addrand();
+void measuresurf();
+void resaturate();
+void setrates();
+void namefile();
+void simstart();
+void simcycle();
+void simend();
+/* ran1.c */
+double ran1();
+/* ranc.c */
+void philox1();
+void philox();
+void raninit();
+void philoxlanes();
+void ranahead();
+int ranfind();
+void ranstream();
+double ranrefill();
+/* lattice.c */
+void alloclattice();
+/* imgzip.c */
+void zipmodels();
+int zipcands();
+unsigned short *zipflag();
+void zipshift();
+void zipbit();
+void zipbits();
+int unzipbit();
+int unzipbits();
+unsigned char *zipimage();
+int unzipimage();
+/* imgio.c */
+int imgsize();
+int imgform();
+void imginit();
+unsigned int imgsum();
+int imgopen();
+int imgnext();
+void imgmemory();
+void imgclose();
+void imgwrite();
+void imgsave();
+/* movie.c */
+int movinit();
+void movalloc();
+void movcreate();
+void movgather();
+void movwrite();
+int movopen();
+void movapply();
+int movseek();
+void movresume();
+void movclose();
+/* output.c */
+FILE *outopen();
+void outwrite();
+void *outworker();
+void outinit();
+int outfind();
+void outrecord();
+void outcreate();
+void outprintf(char *name,char *format,...);
+void outflush();
+void outsync();
+long int outlength();
+void outhold();
+void outresume();
+char *outbuffer();
+void outsnapshot();
+void outclose();
+/* config.c */
+struct cfgkey *cfgfind();
+void cfgadd();
+void cfgread();
+void cfginit();
+void cfgmember();
+int cfgshared();
+int cfgcheck();
+void cfgvalid();
+char *cfggiven();
+int cfgready();
+char *cfgvalue();
+int cfgint();
+long int cfglong();
+float cfgfloat();
+void cfgstring();
+void cfgsave();
+/* ensemble.c */
+void ensread();
+int ensseed();
+int *ensimage();
+void ensmember();
+void *ensworker();
+double enst95();
+void ensgather();
+void ensrun();
+/* species.c */
+void antgrow();
+void addant();
+/* surface.c */
+int surfphase();
+void flipsurf();
+void initsurf();
+void addvisit();
+long int nextvisit();
+int peekvisit();
+/* phases.c */
+void initphases();
+void setphase();
+void setcshage();
+void checkcounts();
+/* boxsum.c */
+void boxinit();
+void boxnext();
+int boxcount();
+/* pardiff.c */
+int domcount();
+int domseed();
+void movedomain();
+void antcount();
+void antsort();
+void antgather();
+int nextdomain();
+void *poolworker();
+void runjob();
+void initdomains();
+void enddomains();
+long int pardiffuse();
+void parmerge();
+void extqueue();
+void extflush();
+/* pores.c */
+void placeinit();
+void porealloc();
+void porebuild();
+void poremark();
+void poreflush();
+void porecheck();
+int randpore();
+int boxwrap();
+int boxscan();
+int boxpore();
+/* perc.c */
+int percfind();
+void percjoin();
+long int percvox();
+void percmark();
+void percwork();
+void percmerge();
+void percsetclass();
+void percfree();
+void percextent();
+void percblock();
+int perccmp();
+void percface();
+long int percbelow();
+void percupdate();
+long int perccount();
+long int perccheck();
+/* burn3d.c */
+void burn3d();
+/* burnset.c */
+void burnset();
+/* parthyd.c */
+void parthyd();
+/* hydrealnew.c */
+int moveone();
+int edgecnt();
+void extrand();
+void extcsh();
+int movecsh();
+void extfh3();
+int extettr();
+void extch();
+void extgyps();
+int moveanh();
+int movehem();
+int extfreidel();
+int extstrat();
+int movegyp();
+int movecacl2();
+int movecas2();
+int moveas();
+int movecaco3();
+void extafm();
+int moveettr();
+void extpozz();
+int movefh3();
+int movech();
+void extc3ah6();
+int movec3a();
+int movec4a();
+int stepant();
+unsigned int antstep();
+void hydrate();
+/* pHpred.c */
+void pHpred();
+/* checkpoint.c */
+void ckadd();
+void ckfile();
+void ckinit();
+void ckwrite();
+int ckload();
+/* prof.c */
+double profclock();
+void profinit();
+void profstart();
+void profstop();
+void profgather();
+void profcycle();
+void profreport();
+/* log.c */
+int loglevel();
+int loginit();
+void logkeep();
+void logdump();
+void logmsg(int sub,int level,char *format,...);
+void logdrop();
+void logflush();
+
+/* Random numbers are taken in order from a buffer refilled by */
+/* ranrefill (see ranc.c) */
+#define ran1(idum) ((simt->ranpos<simt->ranlen)?simt->ranbuf[simt->ranpos++]:ranrefill(idum))
+/* Nothing need be computed ahead before starting the stream of */
+/* update id of kind tag and sub if the numbers are not counter-based */
+/* or ranahead holds its first block, usually in the lane expected */
+/* next (see ranc.c) */
+#define ranready(tag,sub,id) ((sim->rngmode!=RNGCOUNTER)|| \
+        ((simt->aheadnext<simt->nahead)&&(simt->aheadid[simt->aheadnext]==(id))&& \
+        (simt->aheadtag==RNGTAGWORD(tag,sub))&&(simt->aheadcyc==(unsigned int)sim->cyccnt))|| \
+        (ranfind(tag,sub,id)>=0))
+
+#endif
@@ -0,0 +1,193 @@
+/************************************************************************/
+/*                                                                      */
+/*      Program cemhydex.c, a small example of running hydrations       */
+/*              through the library form of disrealnew (see             */
+/*              cemhydlib.c), which also checks that the library        */
+/*              builds and runs                                         */
+/*      Usage: cemhydex [ncyc]                                          */
+/*              Packs a small paste of C3S, C2S and gypsum spheres      */
+/*              in water, hydrates two copies of it with the same       */
+/*              seed, one cycle at a time, and prints the degree of     */
+/*              hydration, heat and pH as they go; exits with 1 if      */
+/*              the library fails or the copies differ                  */
+/*              Run, as is disrealnew, from a directory holding the     */
+/*              files alkalichar.dat and slagchar.dat                   */
+/*      Compile every file of disrealnew with -DCEMHYDLIB, as           */
+/*              cc -O2 -c -DCEMHYDLIB disrealnew.c sim.c ... log.c \    */
+/*                      cemhydlib.c                                     */
+/*              ar rcs libcemhyd.a *.o                                  */
+/*              cc -O2 -o cemhydex cemhydex.c libcemhyd.a -lm -lpthread */
+/*                                                                      */
+/************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "cemhydlib.h"
+
+#define NSIDE 40	/* system size in pixels */
+#define RADIUS 3	/* radius of the spheres */
+#define SOLIDS 0.4	/* volume fraction of solids to pack */
+
+/* Phase IDs of the paste, as in an image file */
+#define POROSITY 0
+#define C3S 1
+#define C2S 2
+#define GYPSUM 5
+
+#define VOX(x,y,z) (((long)(x)*NSIDE+(y))*NSIDE+(z))
+
+static unsigned long exseed=12345;	/* state of exrand */
+
+/* routine to return a random number in [0,n), from a linear */
+/* congruential generator, so that the paste is the same on any */
+/* machine */
+/* Called by expack */
+/* Calls no other routines */
+int exrand(n)
+        int n;
+{
+        exseed=(exseed*1103515245UL+12345UL)&0x7fffffffUL;
+        return((int)((exseed>>8)%(unsigned long)n));
+}
+
+/* routine to pack spheres of C3S, C2S and gypsum, at random and not */
+/* overlapping, into mic, giving each its own particle ID in part */
+/* Called by main program */
+/* Calls exrand */
+void expack(mic,part)
+        unsigned char *mic;
+        int *part;
+{
+        long int nvox,nsolid,iv;
+        int npart,ntry,xc,yc,zc,ix,iy,iz,phase,clear;
+
+        nvox=(long int)NSIDE*NSIDE*NSIDE;
+        for(iv=0;iv<nvox;iv++){
+                mic[iv]=POROSITY;
+                part[iv]=0;
+        }
+        nsolid=npart=0;
+        for(ntry=0;(ntry<100000)&&((double)nsolid<SOLIDS*(double)nvox);ntry++){
+                xc=exrand(NSIDE);
+                yc=exrand(NSIDE);
+                zc=exrand(NSIDE);
+                clear=1;
+                for(ix=-RADIUS;(ix<=RADIUS)&&clear;ix++){
+                for(iy=-RADIUS;(iy<=RADIUS)&&clear;iy++){
+                for(iz=-RADIUS;(iz<=RADIUS)&&clear;iz++){
+                        if((ix*ix+iy*iy+iz*iz)>RADIUS*RADIUS){continue;}
+                        if(mic[VOX((xc+ix+NSIDE)%NSIDE,(yc+iy+NSIDE)%NSIDE,(zc+iz+NSIDE)%NSIDE)]!=POROSITY){
+                                clear=0;
+                        }
+                }
+                }
+                }
+                if(!clear){continue;}
+                /* About 70% C3S, 20% C2S and 10% gypsum */
+                phase=exrand(10);
+                phase=(phase<7)?C3S:((phase<9)?C2S:GYPSUM);
+                npart+=1;
+                for(ix=-RADIUS;ix<=RADIUS;ix++){
+                for(iy=-RADIUS;iy<=RADIUS;iy++){
+                for(iz=-RADIUS;iz<=RADIUS;iz++){
+                        if((ix*ix+iy*iy+iz*iz)>RADIUS*RADIUS){continue;}
+                        iv=VOX((xc+ix+NSIDE)%NSIDE,(yc+iy+NSIDE)%NSIDE,(zc+iz+NSIDE)%NSIDE);
+                        mic[iv]=phase;
+                        part[iv]=npart;
+                        nsolid+=1;
+                }
+                }
+                }
+        }
+        printf("Packed %d particles, %ld of %ld pixels solid \n",npart,nsolid,nvox);
+}
+
+/* routine to count the cycles run, called by the library after each */
+/* Called by cemhydstep */
+/* Calls no other routines */
+void excycle(s,cycle,arg)
+        struct sim *s;
+        int cycle;
+        void *arg;
+{
+        *(int *)arg+=1;
+}
+
+/* routine to give simulation s its parameters, returning 0, or -1 */
+/* if the library refuses one */
+/* Called by main program */
+/* Calls cemhydparam */
+int exparam(s,ncyc)
+        struct sim *s;
+        char *ncyc;
+{
+        int err;
+
+        err=0;
+        err|=cemhydparam(s,"iseed","-2794");
+        err|=cemhydparam(s,"ncyc",ncyc);
+        err|=cemhydparam(s,"burnfreq","10");
+        err|=cemhydparam(s,"setfreq","10");
+        err|=cemhydparam(s,"nummovsl","0");
+        return(err);
+}
+
+int main(argc,argv)
+        int argc;
+        char *argv[];
+{
+        struct sim *s[2];
+        unsigned char *mic;
+        int *part,ncycle[2],k,nrun,ok,pore[3],solid[3];
+        char *ncyc;
+
+        ncyc=(argc>1)?argv[1]:"20";
+        mic=(unsigned char *)malloc((long int)NSIDE*NSIDE*NSIDE);
+        part=(int *)malloc((long int)NSIDE*NSIDE*NSIDE*sizeof(int));
+        if((mic==NULL)||(part==NULL)){
+                printf("Unable to allocate memory for paste \n");
+                exit(1);
+        }
+        expack(mic,part);
+
+        /* Two copies, set up alike and stepped in turn */
+        for(k=0;k<2;k++){
+                s[k]=cemhydnew();
+                ncycle[k]=0;
+                if(exparam(s[k],ncyc)!=0){
+                        printf("Parameters refused by the library \n");
+                        exit(1);
+                }
+                cemhydcallback(s[k],excycle,(void *)&ncycle[k]);
+                if(cemhydload(s[k],NULL,mic,part,NSIDE)!=0){
+                        printf("Unable to load paste into the library \n");
+                        exit(1);
+                }
+        }
+        printf("Cycle time(h) alpha_mass heat(kJ/kg_solid) pH \n");
+        ok=1;
+        do{
+                nrun=cemhydstep(s[0],1);
+                if(cemhydstep(s[1],1)!=nrun){ok=0;}
+                if(nrun==1){
+                        printf("%d %f %f %f %f \n",cemhydcycle(s[0]),cemhydtime(s[0]),
+                         cemhydalpha(s[0]),cemhydheat(s[0]),cemhydph(s[0]));
+                }
+                if(cemhydalpha(s[0])!=cemhydalpha(s[1])){ok=0;}
+        }while((nrun==1)&&ok);
+        for(k=0;k<2;k++){
+                cemhydfinish(s[k]);
+        }
+        cemhydperc(s[0],pore,solid);
+        printf("Pore space percolates %d %d %d, solids %d %d %d \n",pore[0],pore[1],pore[2],solid[0],solid[1],solid[2]);
+        if((ncycle[0]!=ncycle[1])||(ncycle[0]==0)||(cemhydalpha(s[0])<=0.0)||
+         (cemhydalpha(s[0])!=cemhydalpha(s[1]))||(cemhydcount(s[0],C3S)!=cemhydcount(s[1],C3S))){
+                ok=0;
+        }
+        for(k=0;k<2;k++){
+                cemhydfree(s[k]);
+        }
+        free(mic);
+        free(part);
+        printf("%s after %d cycles \n",ok?"Copies agree":"Copies differ",ncycle[0]);
+        return(ok?0:1);
+}
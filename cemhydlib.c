@@ -0,0 +1,350 @@
+/* Routines to run hydrations from another program (in C or C++, see */
+/* cemhydlib.h) rather than from the standard input, so that the model */
+/* can be called in process many times, with no files read or written */
+/* The library is built from all the files of the program, compiled */
+/* with -DCEMHYDLIB to leave out main, for example */
+/*	cc -O2 -c -DCEMHYDLIB disrealnew.c sim.c ran1.c ... cemhydlib.c */
+/*	ar rcs libcemhyd.a *.o */
+/* and linked with -lm -lpthread */
+/* A run goes */
+/*	s=cemhydnew(); */
+/*	cemhydparam(s,"ncyc","2000");	and other parameters */
+/*	cemhydload(s,"paste",mic,part,100); */
+/*	while(cemhydstep(s,1)==1){ */
+/*		query the state and change the conditions */
+/*	} */
+/*	cemhydfinish(s); */
+/*	cemhydfree(s); */
+/* (the program cemhydex.c is a small example, built against the */
+/* library as any caller would be) */
+/* Parameters have the names and defaults of those of a configuration */
+/* file (see config.c), other than micfile and partfile; a parameter */
+/* given again replaces its earlier value, except for the pairs of */
+/* nadd and phtodo, which are taken in turn */
+/* The microstructure and particle IDs are given in memory, in the */
+/* order of an image file (z varying fastest), and the phase IDs of */
+/* the microstructure are assigned by fidc3s, ... as for a file */
+/* No output files are written unless asked for by cemhydfiles, in */
+/* which case they are written as by the program, named from root */
+/* Every routine works on the simulation passed to it, which it makes */
+/* that of the calling thread (see simuse), so simulations may run at */
+/* once on different threads of the caller, in any build */
+/* An error in setting up, in the parameters, the images or the files */
+/* they name, is returned as -1 by cemhydparam or cemhydload, leaving */
+/* the process running, so that a caller may try many parameters; */
+/* running out of memory, or an error in a cycle, still ends it */
+/* Only warnings and errors are printed, unless asked for by */
+/* CEMHYD_LOG or cemhydlog (see log.c) */
+
+#include "cemhyd.h"
+#include "cemhydlib.h"
+
+/* routine to return a new simulation, to be given its parameters */
+/* Called by caller of library */
+/* Calls simnew, simuse and loginit */
+struct sim *cemhydnew()
+{
+        struct sim *s;
+
+        s=simnew();
+        simuse(s);
+        if(loginit(getenv("CEMHYD_LOG"),LOGWARN)!=0){
+                loginit((char *)NULL,LOGWARN);
+        }
+        /* Parameters are only given by name, never read */
+        sim->cfgkeyed=1;
+        sim->outoff=1;
+        strcpy(sim->fileroot,"cemhyd");
+        return(s);
+}
+
+/* routine to give parameter name of simulation s the value value, */
+/* returning 0, or -1 if there is no such parameter (or it is an */
+/* image, given to cemhydload), the value is too long, not a number */
+/* of the right type or outside the range of the parameter, or the */
+/* microstructure has already been loaded */
+/* Called by caller of library */
+/* Calls simuse, cfgfind, cfgcheck and cfgadd */
+int cemhydparam(s,name,value)
+        struct sim *s;
+        const char *name,*value;
+{
+        struct cfgkey *key;
+        int ie;
+
+        simuse(s);
+        key=cfgfind((char *)name);
+        if((key==NULL)||(strcmp(name,"micfile")==0)||(strcmp(name,"partfile")==0)){
+                return(-1);
+        }
+        if((strlen(value)==0)||(strlen(value)>=CFGVALUE)||(sim->icyc!=0)){
+                return(-1);
+        }
+        if(cfgcheck(key,(char *)value)!=0){
+                return(-1);
+        }
+        if((strcmp(name,"nadd")!=0)&&(strcmp(name,"phtodo")!=0)){
+                for(ie=0;ie<sim->ncfgentry;ie++){
+                        if(sim->cfgentries[ie].key==key){
+                                strcpy(sim->cfgentries[ie].value,value);
+                                return(0);
+                        }
+                }
+        }
+        if(sim->ncfgentry>=CFGMAXENTRY){
+                return(-1);
+        }
+        cfgadd((char *)name,(char *)value,1,"parameters of library");
+        return(0);
+}
+
+/* routine to write (on nonzero) or not the output files of */
+/* simulation s, before its microstructure is loaded */
+/* Called by caller of library */
+/* Calls simuse */
+void cemhydfiles(s,on)
+        struct sim *s;
+        int on;
+{
+        simuse(s);
+        sim->outoff=(on==0);
+}
+
+/* routine to set the messages printed by simulation s from spec, in */
+/* the form of CEMHYD_LOG (see log.c), such as "warn,cycle=info", */
+/* returning 0, or -1 if spec is not understood, leaving them as */
+/* they were */
+/* Called by caller of library */
+/* Calls simuse and loginit */
+int cemhydlog(s,spec)
+        struct sim *s;
+        const char *spec;
+{
+        int old[NLOGSUB],isub;
+
+        simuse(s);
+        for(isub=0;isub<NLOGSUB;isub++){
+                old[isub]=sim->loglevel[isub];
+        }
+        if(loginit((char *)spec,LOGWARN)!=0){
+                for(isub=0;isub<NLOGSUB;isub++){
+                        sim->loglevel[isub]=old[isub];
+                }
+                return(-1);
+        }
+        return(0);
+}
+
+/* routine to have fn(s,cycle,arg) called at the end of each cycle of */
+/* simulation s, or no routine if fn is NULL */
+/* Called by caller of library */
+/* Calls simuse */
+void cemhydcallback(s,fn,arg)
+        struct sim *s;
+        cemhydfn fn;
+        void *arg;
+{
+        simuse(s);
+        sim->cyclefn=(void (*)())fn;
+        sim->cyclearg=arg;
+}
+
+/* routine to load the nside^3 phase IDs mic and particle IDs part */
+/* (0 for none) of simulation s, and set it up for its first cycle, */
+/* naming any output files from root (if not NULL), returning 0, or -1 */
+/* if the arguments are wrong, it has already been loaded, or the */
+/* parameters are incomplete or name files that cannot be read (see */
+/* cfgready) */
+/* Called by caller of library */
+/* Calls simuse, cfgready, imgmemory, simstart and logmsg */
+int cemhydload(s,root,mic,part,nside)
+        struct sim *s;
+        const char *root;
+        const unsigned char *mic;
+        const int *part;
+        int nside;
+{
+        struct imgfile micimg,partimg;
+        char why[CFGVALUE+80];
+
+        simuse(s);
+        if((sim->icyc!=0)||(mic==NULL)||(part==NULL)||(nside<3)||(nside>MAXSYSIZE)){
+                return(-1);
+        }
+#ifdef FIXEDSIZE
+        if(nside!=FIXEDSIZE){
+                return(-1);
+        }
+#endif
+        if(cfgready(0,why)!=0){
+                logmsg(LOGSETUP,LOGINFO,"%s \n",why);
+                return(-1);
+        }
+        if(root!=NULL){
+                /* Leave room for the suffixes of the output files */
+                if((strlen(root)==0)||(strlen(root)>=40)){
+                        return(-1);
+                }
+                strcpy(sim->fileroot,root);
+        }
+        imgmemory((unsigned char *)mic,1,nside,&micimg);
+        imgmemory((unsigned char *)part,4,nside,&partimg);
+        simstart(&micimg,&partimg);
+        return(0);
+}
+
+/* routine to run up to ncycle cycles of simulation s, returning the */
+/* number run, which is less once the last cycle (ncyc) is reached, */
+/* or -1 if it has not been loaded */
+/* Called by caller of library */
+/* Calls simuse and simcycle */
+int cemhydstep(s,ncycle)
+        struct sim *s;
+        int ncycle;
+{
+        int n;
+
+        simuse(s);
+        if(sim->icyc==0){
+                return(-1);
+        }
+        for(n=0;(n<ncycle)&&(sim->icyc<=sim->ncyc)&&(!sim->finished);n++){
+                simcycle();
+        }
+        return(n);
+}
+
+/* routine to end the hydration of simulation s, whether or not its */
+/* last cycle has been run, and write its final results, after which */
+/* no more cycles are run */
+/* Called by caller of library */
+/* Calls simuse, simend and outflush */
+void cemhydfinish(s)
+        struct sim *s;
+{
+        simuse(s);
+        if((sim->icyc==0)||(sim->finished)){
+                return;
+        }
+        simend();
+        outflush();
+        sim->finished=1;
+}
+
+/* routine to close the output files of simulation s and free it */
+/* Called by caller of library */
+/* Calls simuse, outclose and simfree */
+void cemhydfree(s)
+        struct sim *s;
+{
+        simuse(s);
+        outclose();
+        simfree(s);
+}
+
+/* routines to return, for simulation s after its last cycle run, the */
+/* number of cycles run, the number of pixels of phase phase (or -1 */
+/* if there is no such phase), the degree of hydration (mass basis), */
+/* the heat released (kJ/kg of solid, as in the .heat file), the time */
+/* in hours, the temperature in C and the pH of the pore solution */
+/* Called by caller of library */
+/* Call simuse */
+int cemhydcycle(s)
+        struct sim *s;
+{
+        simuse(s);
+        return((sim->icyc>0)?(sim->icyc-1):0);
+}
+
+long int cemhydcount(s,phase)
+        struct sim *s;
+        int phase;
+{
+        simuse(s);
+        if((phase<0)||(phase>EMPTYP)){
+                return(-1);
+        }
+        return(simt->count[phase]);
+}
+
+double cemhydalpha(s)
+        struct sim *s;
+{
+        simuse(s);
+        return((double)sim->alpha_cur);
+}
+
+double cemhydheat(s)
+        struct sim *s;
+{
+        simuse(s);
+        return((double)(sim->heat_new*sim->heat_cf));
+}
+
+double cemhydtime(s)
+        struct sim *s;
+{
+        simuse(s);
+        return((double)sim->time_cur);
+}
+
+double cemhydtemp(s)
+        struct sim *s;
+{
+        simuse(s);
+        return((double)sim->temp_cur);
+}
+
+double cemhydph(s)
+        struct sim *s;
+{
+        simuse(s);
+        return((double)sim->pH_cur);
+}
+
+/* routine to return whether the pore space (pore) and the solids */
+/* (solid) of simulation s percolate in x, y and z, each 1 if so, as */
+/* found by the last check (every burnfreq and setfreq cycles) */
+/* Called by caller of library */
+/* Calls simuse */
+void cemhydperc(s,pore,solid)
+        struct sim *s;
+        int pore[3],solid[3];
+{
+        simuse(s);
+        pore[0]=sim->porefl1;
+        pore[1]=sim->porefl2;
+        pore[2]=sim->porefl3;
+        solid[0]=sim->sf1;
+        solid[1]=sim->sf2;
+        solid[2]=sim->sf3;
+}
+
+/* routine to set the temperature of simulation s to temp (C) for the */
+/* cycles that follow, under isothermal or adiabatic conditions */
+/* (adiaflag 0 or 1); a programmed temperature history (adiaflag 2) */
+/* sets the temperature again at the next cycle */
+/* Called by caller of library */
+/* Calls simuse and setrates */
+void cemhydsettemp(s,temp)
+        struct sim *s;
+        double temp;
+{
+        simuse(s);
+        sim->temp_cur=temp;
+        setrates();
+}
+
+/* routine to set the ambient temperature (C) and the heat transfer */
+/* coefficient (J/g/C/s) of simulation s under adiabatic conditions */
+/* for the cycles that follow */
+/* Called by caller of library */
+/* Calls simuse */
+void cemhydsetambient(s,ambient,ucoeff)
+        struct sim *s;
+        double ambient,ucoeff;
+{
+        simuse(s);
+        sim->T_ambient=ambient;
+        sim->U_coeff=ucoeff;
+}
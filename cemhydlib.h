@@ -0,0 +1,44 @@
+/* Routines of the library form of disrealnew, for running hydrations */
+/* from another program, in C or C++ (see cemhydlib.c) */
+#ifndef CEMHYDLIB_H
+#define CEMHYDLIB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sim;	/* one simulation; its contents are private */
+
+/* routine called at the end of each cycle */
+typedef void (*cemhydfn)(struct sim *s,int cycle,void *arg);
+
+/* Setting up, running and freeing a simulation */
+struct sim *cemhydnew(void);
+int cemhydparam(struct sim *s,const char *name,const char *value);
+void cemhydfiles(struct sim *s,int on);
+int cemhydlog(struct sim *s,const char *spec);
+void cemhydcallback(struct sim *s,cemhydfn fn,void *arg);
+int cemhydload(struct sim *s,const char *root,const unsigned char *mic,const int *part,int nside);
+int cemhydstep(struct sim *s,int ncycle);
+void cemhydfinish(struct sim *s);
+void cemhydfree(struct sim *s);
+
+/* State after the last cycle run */
+int cemhydcycle(struct sim *s);
+long cemhydcount(struct sim *s,int phase);
+double cemhydalpha(struct sim *s);
+double cemhydheat(struct sim *s);
+double cemhydtime(struct sim *s);
+double cemhydtemp(struct sim *s);
+double cemhydph(struct sim *s);
+void cemhydperc(struct sim *s,int pore[3],int solid[3]);
+
+/* Conditions for the cycles that follow */
+void cemhydsettemp(struct sim *s,double temp);
+void cemhydsetambient(struct sim *s,double ambient,double ucoeff);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
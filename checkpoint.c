@@ -0,0 +1,411 @@
+/* Routines to save the full state of a simulation to a checkpoint */
+/* file, and to restart from it so that the run continues exactly as */
+/* if it had not been stopped */
+/* Set the environment variable CEMHYD_CHECKPOINT to a number of */
+/* cycles to write a checkpoint after every that many cycles, to */
+/* CEMHYD_CHECKFILE (default fileroot.ckp) or, if it is not set, the */
+/* root name of the output files followed by .ckp; each checkpoint is */
+/* written to a temporary file and then renamed, so that a run stopped */
+/* while writing leaves the previous checkpoint in place */
+/* To restart, run again with the same input and CEMHYD_RESTART set */
+/* to the checkpoint file: the set up of the run is repeated (with */
+/* output to the files held back), the state is read back, the output */
+/* files are cut back to their lengths at the checkpoint, and the */
+/* cycles carry on from the one after the checkpoint */
+/* The state saved is the lattices (mic, micorig, micpart, cshage and */
+/* faces), the pool of diffusing species, the random number state, */
+/* and every global variable changed during the cycles; the frontier */
+/* of pore space is built again from the microstructure, and the */
+/* percolation clusters at their next use; the list of pore pixels */
+/* is saved in its order, which sets the pixels picked from it */
+/* A checkpoint can only be read by the same build of the program on */
+/* the same kind of machine; one of version 2 that does not list the */
+/* profile file (see prof.c) among the output files, as written */
+/* before there was one, is read as if that file did not exist at */
+/* the checkpoint */
+
+#include "cemhyd.h"
+
+#define CKMAGIC "CEMHYDCK"
+#define CKVERSION 3
+#define CKNOPROF 2	/* last version without the profile file */
+
+/* header of a checkpoint file */
+struct ckhead{
+        char magic[8];	/* CKMAGIC, not null terminated */
+        int version;	/* CKVERSION */
+        int nside;	/* system size */
+        int icyc;	/* last cycle completed */
+        int nitem;	/* items of state following the lattices */
+        int nfile;	/* output files */
+        long int nants;	/* diffusing species */
+        long int nporesite;	/* listed pore pixels, or -1 if not listed */
+};
+
+/* routine to add the item of state at addr, of size bytes, to those */
+/* saved, under name less any sim-> or simt-> (see CKADD) */
+/* Called by ckinit and main program */
+/* Calls logmsg */
+void ckadd(name,addr,size)
+        char *name;
+        void *addr;
+        long int size;
+{
+        if(sim->nckitem>=CKMAXITEM){
+                logmsg(LOGOUTPUT,LOGERROR,"Too many items of state for checkpoint \n");
+                exit(1);
+        }
+        if(strncmp(name,"sim->",5)==0){name+=5;}
+        else if(strncmp(name,"simt->",6)==0){name+=6;}
+        strncpy(sim->ckitems[sim->nckitem].name,name,31);
+        sim->ckitems[sim->nckitem].name[31]='\0';
+        sim->ckitems[sim->nckitem].addr=addr;
+        sim->ckitems[sim->nckitem].size=size;
+        sim->nckitem+=1;
+}
+
+/* routine to add output file name to those cut back on restart */
+/* Called by main program */
+/* Calls logmsg */
+void ckfile(name)
+        char *name;
+{
+        if(sim->nckfile>=CKMAXFILE){
+                logmsg(LOGOUTPUT,LOGERROR,"Too many output files for checkpoint \n");
+                exit(1);
+        }
+        sim->ckfiles[sim->nckfile]=name;
+        sim->nckfile+=1;
+}
+
+/* routine to read the checkpoint settings and list the global state */
+/* Called by main program */
+/* Calls ckadd, outhold and logmsg */
+void ckinit()
+{
+        char *envck;
+
+        envck=getenv("CEMHYD_CHECKPOINT");
+        if(envck!=NULL){
+                sim->ckevery=atoi(envck);
+                if(sim->ckevery<0){sim->ckevery=0;}
+        }
+        sim->ckname[0]='\0';
+        envck=getenv("CEMHYD_CHECKFILE");
+        if(envck!=NULL){
+                strncpy(sim->ckname,envck,250);
+                sim->ckname[250]='\0';
+        }
+        sim->ckrestart=getenv("CEMHYD_RESTART");
+        if(sim->ckrestart!=NULL){
+                logmsg(LOGOUTPUT,LOGINFO,"Restarting from checkpoint %s \n",sim->ckrestart);
+                outhold();
+        }
+
+        /* Random number state */
+        CKADD(simt->ran1iv);
+        CKADD(simt->ran1iy);
+        CKADD(sim->rngkey);
+        CKADD(simt->rngctr);
+        CKADD(simt->rngblocks);
+        CKADD(simt->ranbuf);
+        CKADD(simt->ranpos);
+        CKADD(simt->ranlen);
+        /* Phase counts */
+        CKADD(sim->discount);
+        CKADD(sim->countinit);
+        CKADD(simt->count);
+        CKADD(simt->ncshage);
+        CKADD(simt->ncshplategrow);
+        CKADD(simt->ncshplateinit);
+        CKADD(simt->npr);
+        CKADD(simt->nasr);
+        CKADD(sim->nfill);
+        CKADD(sim->ncsbar);
+        CKADD(sim->netbar);
+        CKADD(sim->porinit);
+        CKADD(sim->nslagr);
+        CKADD(sim->slagemptyp);
+        CKADD(sim->c3sinit);
+        CKADD(sim->c2sinit);
+        CKADD(sim->c3ainit);
+        CKADD(sim->c4afinit);
+        CKADD(sim->anhinit);
+        CKADD(sim->heminit);
+        CKADD(sim->chold);
+        CKADD(sim->chnew);
+        CKADD(simt->gypready);
+        CKADD(sim->nmade);
+        CKADD(sim->ngoing);
+        CKADD(sim->poregone);
+        CKADD(sim->poretodo);
+        CKADD(sim->countpore);
+        CKADD(sim->countkeep);
+        CKADD(sim->water_left);
+        CKADD(sim->water_off);
+        CKADD(sim->pore_off);
+        /* Cycle and percolation state */
+        CKADD(sim->cyccnt);
+        CKADD(sim->cubesize);
+        CKADD(sim->sealed);
+        CKADD(sim->setflag);
+        CKADD(sim->sf1);
+        CKADD(sim->sf2);
+        CKADD(sim->sf3);
+        CKADD(sim->porefl1);
+        CKADD(sim->porefl2);
+        CKADD(sim->porefl3);
+        /* Kinetics, temperature and time */
+        CKADD(sim->ind_time);
+        CKADD(sim->E_act);
+        CKADD(sim->E_act_pozz);
+        CKADD(sim->E_act_slag);
+        CKADD(sim->beta);
+        CKADD(sim->heat_cf);
+        CKADD(sim->w_to_c);
+        CKADD(sim->s_to_c);
+        CKADD(sim->totfract);
+        CKADD(sim->tfractw04);
+        CKADD(sim->tfractw05);
+        CKADD(sim->fractwithfill);
+        CKADD(sim->pfractw05);
+        CKADD(sim->U_coeff);
+        CKADD(sim->T_ambient);
+        CKADD(sim->temp_0);
+        CKADD(sim->temp_cur);
+        CKADD(sim->time_step);
+        CKADD(sim->time_cur);
+        CKADD(sim->krate);
+        CKADD(sim->kpozz);
+        CKADD(sim->kslag);
+        CKADD(sim->surffract);
+        CKADD(sim->pfract);
+        CKADD(sim->sulf_conc);
+        CKADD(sim->scntcement);
+        CKADD(sim->scnttotal);
+        CKADD(sim->alpha_cur);
+        CKADD(sim->heat_old);
+        CKADD(sim->heat_new);
+        CKADD(sim->cemmass);
+        CKADD(sim->mass_agg);
+        CKADD(sim->mass_water);
+        CKADD(sim->mass_fill);
+        CKADD(sim->Cp_now);
+        CKADD(sim->alpha);
+        CKADD(sim->CH_mass);
+        CKADD(sim->mass_CH);
+        CKADD(sim->mass_fill_pozz);
+        CKADD(sim->chs_new);
+        CKADD(sim->cemmasswgyp);
+        CKADD(sim->flyashmass);
+        CKADD(sim->alpha_fa_cur);
+        CKADD(sim->molarvcsh);
+        CKADD(sim->watercsh);
+        CKADD(sim->heatsum);
+        CKADD(sim->molesh2o);
+        CKADD(sim->saturation);
+        /* Dissolution probabilities and solubilities */
+        CKADD(sim->disprob);
+        CKADD(sim->disbase);
+        CKADD(sim->gypabsprob);
+        CKADD(sim->ppozz);
+        CKADD(sim->specgrav);
+        CKADD(sim->molarv);
+        CKADD(sim->heatf);
+        CKADD(sim->waterc);
+        CKADD(sim->soluble);
+        CKADD(sim->creates);
+        CKADD(sim->cs_acc);
+        CKADD(sim->ca_acc);
+        CKADD(sim->dismin_c3a);
+        CKADD(sim->dismin_c4af);
+        CKADD(sim->gsratio2);
+        CKADD(sim->onepixelbias);
+        CKADD(sim->cshboxsize);
+        /* Slag reaction */
+        CKADD(sim->p1slag);
+        CKADD(sim->p2slag);
+        CKADD(sim->p3slag);
+        CKADD(sim->p4slag);
+        CKADD(sim->p5slag);
+        CKADD(sim->slagcasi);
+        CKADD(sim->slaghydcasi);
+        CKADD(sim->slagh2osi);
+        CKADD(sim->slagc3a);
+        CKADD(sim->siperslag);
+        CKADD(sim->slagreact);
+        CKADD(sim->DIFFCHdeficit);
+        CKADD(sim->slaginit);
+        CKADD(sim->slagcum);
+        CKADD(sim->chgone);
+        CKADD(sim->nch_slag);
+        CKADD(sim->sulf_cur);
+        CKADD(sim->sulf_solid);
+        /* Pore solution */
+        CKADD(sim->pH_cur);
+        CKADD(sim->totsodium);
+        CKADD(sim->totpotassium);
+        CKADD(sim->rssodium);
+        CKADD(sim->rspotassium);
+        CKADD(sim->pHeffect);
+        CKADD(sim->pHfactor);
+        CKADD(sim->conccaplus);
+        CKADD(sim->moles_syn_precip);
+        CKADD(sim->concsulfate);
+}
+
+/* routine to write the state at the end of the given cycle to the */
+/* checkpoint file */
+/* Called by main program */
+/* Calls outsync, outlength and logmsg */
+void ckwrite(cycle)
+        int cycle;
+{
+        FILE *ckfp;
+        struct ckhead head;
+        long int nvox,len;
+        char tmpname[270];
+        int i,ok;
+
+        if(sim->ckname[0]=='\0'){
+                sprintf(sim->ckname,"%s.ckp",sim->fileroot);
+        }
+        /* Output files must be complete up to this cycle */
+        outsync();
+
+        memset(&head,0,sizeof(struct ckhead));
+        memcpy(head.magic,CKMAGIC,8);
+        head.version=CKVERSION;
+        head.nside=SYSIZE;
+        head.icyc=cycle;
+        head.nitem=sim->nckitem;
+        head.nfile=sim->nckfile;
+        head.nants=sim->nants;
+        head.nporesite=(-1);
+        if(sim->poreok){head.nporesite=sim->nporesite;}
+        nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+        sprintf(tmpname,"%s.tmp",sim->ckname);
+        ckfp=fopen(tmpname,"wb");
+        if(ckfp==NULL){
+                logmsg(LOGOUTPUT,LOGERROR,"Unable to write checkpoint file %s \n",tmpname);
+                exit(1);
+        }
+        ok=(fwrite(&head,sizeof(struct ckhead),1,ckfp)==1);
+        ok=ok&&(fwrite(sim->mic,sizeof(char),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fwrite(sim->micorig,sizeof(char),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fwrite(sim->micpart,sizeof(int),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fwrite(sim->cshage,sizeof(short int),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fwrite(sim->faces,sizeof(short int),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fwrite(sim->antloc,sizeof(unsigned int),sim->nants,ckfp)==(size_t)sim->nants);
+        ok=ok&&(fwrite(sim->antbirth,sizeof(short int),sim->nants,ckfp)==(size_t)sim->nants);
+        ok=ok&&(fwrite(sim->antid,sizeof(unsigned char),sim->nants,ckfp)==(size_t)sim->nants);
+        if(head.nporesite>0){
+                ok=ok&&(fwrite(sim->poresite,sizeof(int),head.nporesite,ckfp)==(size_t)head.nporesite);
+        }
+        for(i=0;i<sim->nckitem;i++){
+                ok=ok&&(fwrite(sim->ckitems[i].name,1,32,ckfp)==32);
+                ok=ok&&(fwrite(&sim->ckitems[i].size,sizeof(long int),1,ckfp)==1);
+                ok=ok&&(fwrite(sim->ckitems[i].addr,1,sim->ckitems[i].size,ckfp)==(size_t)sim->ckitems[i].size);
+        }
+        for(i=0;i<sim->nckfile;i++){
+                len=outlength(sim->ckfiles[i]);
+                ok=ok&&(fwrite(&len,sizeof(long int),1,ckfp)==1);
+        }
+        if((fclose(ckfp)!=0)||(!ok)||(rename(tmpname,sim->ckname)!=0)){
+                logmsg(LOGOUTPUT,LOGERROR,"Unable to write checkpoint file %s \n",sim->ckname);
+                exit(1);
+        }
+        logmsg(LOGOUTPUT,LOGINFO,"Wrote checkpoint at cycle %d to %s \n",cycle,sim->ckname);
+}
+
+/* routine to read back the state from the checkpoint file given by */
+/* CEMHYD_RESTART, returning the last cycle completed */
+/* Called by main program */
+/* Calls antgrow, porealloc, initphases, checkcounts, outresume and */
+/* logmsg */
+int ckload()
+{
+        FILE *ckfp;
+        struct ckhead head;
+        long int nvox,size,i,k,len;
+        char name[32];
+        int ok,noprof;
+
+        ckfp=fopen(sim->ckrestart,"rb");
+        if(ckfp==NULL){
+                logmsg(LOGOUTPUT,LOGERROR,"Unable to open checkpoint file %s \n",sim->ckrestart);
+                exit(1);
+        }
+        if((fread(&head,sizeof(struct ckhead),1,ckfp)!=1)||(memcmp(head.magic,CKMAGIC,8)!=0)||((head.version!=CKVERSION)&&(head.version!=CKNOPROF))){
+                logmsg(LOGOUTPUT,LOGERROR,"File %s is not a checkpoint of this version \n",sim->ckrestart);
+                exit(1);
+        }
+        /* Some checkpoints of version 2 already list the profile file */
+        noprof=((head.version==CKNOPROF)&&(head.nfile==(sim->nckfile-1)));
+        if((head.nside!=SYSIZE)||(head.nitem!=sim->nckitem)||(head.nfile!=(sim->nckfile-noprof))){
+                logmsg(LOGOUTPUT,LOGERROR,"Checkpoint %s does not match this run \n",sim->ckrestart);
+                exit(1);
+        }
+        nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+        ok=(fread(sim->mic,sizeof(char),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fread(sim->micorig,sizeof(char),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fread(sim->micpart,sizeof(int),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fread(sim->cshage,sizeof(short int),nvox,ckfp)==(size_t)nvox);
+        ok=ok&&(fread(sim->faces,sizeof(short int),nvox,ckfp)==(size_t)nvox);
+        antgrow(head.nants);
+        sim->nants=head.nants;
+        ok=ok&&(fread(sim->antloc,sizeof(unsigned int),sim->nants,ckfp)==(size_t)sim->nants);
+        ok=ok&&(fread(sim->antbirth,sizeof(short int),sim->nants,ckfp)==(size_t)sim->nants);
+        ok=ok&&(fread(sim->antid,sizeof(unsigned char),sim->nants,ckfp)==(size_t)sim->nants);
+        sim->poreok=0;
+        if(head.nporesite>=0){
+                porealloc();
+                sim->nporesite=head.nporesite;
+                ok=ok&&(fread(sim->poresite,sizeof(int),sim->nporesite,ckfp)==(size_t)sim->nporesite);
+                for(k=0;k<sim->nporesite;k++){
+                        sim->poreat[sim->poresite[k]]=k;
+                }
+                sim->poreok=1;
+        }
+        if(!ok){
+                logmsg(LOGOUTPUT,LOGERROR,"Checkpoint %s is truncated \n",sim->ckrestart);
+                exit(1);
+        }
+
+        /* Frontier of pore space, from the microstructure */
+        initphases();
+
+        for(i=0;i<sim->nckitem;i++){
+                if((fread(name,1,32,ckfp)!=32)||(fread(&size,sizeof(long int),1,ckfp)!=1)){
+                        logmsg(LOGOUTPUT,LOGERROR,"Checkpoint %s is truncated \n",sim->ckrestart);
+                        exit(1);
+                }
+                if((strncmp(name,sim->ckitems[i].name,32)!=0)||(size!=sim->ckitems[i].size)){
+                        logmsg(LOGOUTPUT,LOGERROR,"Checkpoint %s does not match this run at %s \n",sim->ckrestart,sim->ckitems[i].name);
+                        exit(1);
+                }
+                if(fread(sim->ckitems[i].addr,1,size,ckfp)!=(size_t)size){
+                        logmsg(LOGOUTPUT,LOGERROR,"Checkpoint %s is truncated \n",sim->ckrestart);
+                        exit(1);
+                }
+        }
+#ifdef CHECKCOUNTS
+        checkcounts();
+#endif
+
+        /* Cut the output files back to the checkpoint */
+        for(i=0;i<sim->nckfile;i++){
+                if((noprof)&&(sim->ckfiles[i]==sim->profname)){
+                        outresume(sim->ckfiles[i],-1L);
+                        continue;
+                }
+                if(fread(&len,sizeof(long int),1,ckfp)!=1){
+                        logmsg(LOGOUTPUT,LOGERROR,"Checkpoint %s is truncated \n",sim->ckrestart);
+                        exit(1);
+                }
+                outresume(sim->ckfiles[i],len);
+        }
+        fclose(ckfp);
+        logmsg(LOGOUTPUT,LOGINFO,"Restarted from checkpoint at cycle %d \n",head.icyc);
+        return(head.icyc);
+}
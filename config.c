@@ -0,0 +1,551 @@
+/* Routines to read the parameters of a run, either in turn from the */
+/* standard input in the form of earlier versions (see disrealnew.dat) */
+/* or by name from a configuration file */
+/* Usage: disrealnew [-c configfile] [name=value ...] */
+/*        disrealnew -c configfile [-e ensemblefile] [-n nseed] [-j njob] */
+/*              [name=value ...] to run an ensemble (see ensemble.c) */
+/* A configuration file holds one parameter a line as name = value, */
+/* with blank lines and anything following # ignored; the names are */
+/* those of cfgkeys below, and parameters left out take the default */
+/* given there (the seed and the two image files must always be given) */
+/* One pixel particles are added by pairs of lines nadd = and phtodo = */
+/* Each name=value on the command line replaces the value of that */
+/* parameter from the configuration file or the standard input */
+/* Every value is checked against its range as soon as it is given, */
+/* and with a configuration file the parameters are checked to be */
+/* complete before any image is read; the parameters as used are */
+/* written to the .par file of the run as a configuration file, so */
+/* that the run can be repeated with -c */
+
+#include "cemhyd.h"
+
+#define CFGINT 0
+#define CFGLONG 1
+#define CFGFLOAT 2
+#define CFGSTRING 3
+
+/* Results of cfgcheck */
+#define CFGOK 0
+#define CFGNOTNUM 1	/* not a number of the type of the parameter */
+#define CFGRANGE 2	/* outside the range of the parameter */
+
+/* a parameter of a run */
+struct cfgkey{
+        char *name;
+        int type;	/* CFGINT, CFGLONG, CFGFLOAT or CFGSTRING */
+        char *def;	/* default value, or NULL if it must be given */
+        double lo,hi;	/* range of a number */
+        int legacy;	/* 1 if read from the standard input */
+        char *help;
+};
+
+/* Parameters in the order of the standard input */
+struct cfgkey cfgkeys[]={
+        {"iseed",CFGINT,NULL,-2147483647.,2147483647.,1,"random number seed"},
+        {"micfile",CFGSTRING,NULL,0.,0.,1,"initial microstructure image"},
+        {"fidc3s",CFGINT,"1",0.,255.,1,"ID of C3S in microstructure"},
+        {"fidc2s",CFGINT,"2",0.,255.,1,"ID of C2S in microstructure"},
+        {"fidc3a",CFGINT,"3",0.,255.,1,"ID of C3A in microstructure"},
+        {"fidc4af",CFGINT,"4",0.,255.,1,"ID of C4AF in microstructure"},
+        {"fidgyp",CFGINT,"5",0.,255.,1,"ID of gypsum in microstructure"},
+        {"fidhem",CFGINT,"6",0.,255.,1,"ID of hemihydrate in microstructure"},
+        {"fidanh",CFGINT,"7",0.,255.,1,"ID of anhydrite in microstructure"},
+        {"fidagg",CFGINT,"28",0.,255.,1,"ID of aggregate in microstructure"},
+        {"fidcaco3",CFGINT,"26",0.,255.,1,"ID of CaCO3 in microstructure"},
+        {"ffac3a",CFGINT,"35",0.,255.,1,"ID of C3A in fly ash"},
+        {"partfile",CFGSTRING,NULL,0.,0.,1,"particle ID image"},
+        {"nadd",CFGLONG,"0",0.,2147483647.,1,"one pixel particles to add (0 to quit)"},
+        {"phtodo",CFGINT,NULL,0.,(double)CACO3,1,"phase of one pixel particles"},
+        {"ncyc",CFGINT,"1000",0.,(double)(MAXCYC-1),1,"cycles to execute"},
+        {"sealed",CFGINT,"0",0.,1.,1,"0) saturated or 1) sealed"},
+        {"ntimes",CFGINT,"500",0.,1.e9,1,"most diffusion steps per cycle"},
+        {"pnucch",CFGFLOAT,"0.0001",0.,1.,1,"nucleation probability of CH"},
+        {"pscalech",CFGFLOAT,"9000.",1.e-30,1.e30,1,"nucleation scale factor of CH"},
+        {"pnucgyp",CFGFLOAT,"0.01",0.,1.,1,"nucleation probability of gypsum"},
+        {"pscalegyp",CFGFLOAT,"9000.",1.e-30,1.e30,1,"nucleation scale factor of gypsum"},
+        {"pnuchg",CFGFLOAT,"0.00002",0.,1.,1,"nucleation probability of C3AH6"},
+        {"pscalehg",CFGFLOAT,"10000.",1.e-30,1.e30,1,"nucleation scale factor of C3AH6"},
+        {"pnucfh3",CFGFLOAT,"0.002",0.,1.,1,"nucleation probability of FH3"},
+        {"pscalefh3",CFGFLOAT,"2500.",1.e-30,1.e30,1,"nucleation scale factor of FH3"},
+        {"burnfreq",CFGINT,"50",1.,2147483647.,1,"cycles between pore percolation checks"},
+        {"setfreq",CFGINT,"5",1.,2147483647.,1,"cycles between solid percolation checks"},
+        {"phydfreq",CFGINT,"5000",1.,2147483647.,1,"cycles between particle hydration checks"},
+        {"outfreq",CFGINT,"5000",1.,2147483647.,1,"cycles between microstructure outputs"},
+        {"ind_time",CFGFLOAT,"0.00",0.,1.e6,1,"induction time in hours"},
+        {"temp_0",CFGFLOAT,"20.0",-273.,1000.,1,"initial temperature in C"},
+        {"T_ambient",CFGFLOAT,"20.0",-273.,1000.,1,"ambient temperature in C"},
+        {"U_coeff",CFGFLOAT,"0.0",0.,1.e30,1,"heat transfer coefficient in J/g/C/s"},
+        {"E_act",CFGFLOAT,"40.0",0.,1.e6,1,"activation energy of hydration in kJ/mole"},
+        {"E_act_pozz",CFGFLOAT,"83.14",0.,1.e6,1,"activation energy of pozzolanic reactions in kJ/mole"},
+        {"E_act_slag",CFGFLOAT,"80.0",0.,1.e6,1,"activation energy of slag reactions in kJ/mole"},
+        {"beta",CFGFLOAT,"0.00035",1.e-30,1.e30,1,"factor from cycles to hours at 25 C"},
+        {"mass_agg",CFGFLOAT,"0.72",0.,1.,1,"mass fraction of aggregate"},
+        {"adiaflag",CFGINT,"0",0.,2.,1,"0) isothermal, 1) adiabatic or 2) programmed temperature"},
+        {"csh2flag",CFGINT,"0",0.,1.,1,"CSH to pozzolanic CSH 0) prohibited or 1) allowed"},
+        {"chflag",CFGINT,"1",0.,1.,1,"CH on aggregate 0) prohibited or 1) allowed"},
+        {"nummovsl",CFGINT,"0",0.,2147483647.,1,"slices in hydration movie"},
+        {"onepixelbias",CFGFLOAT,"1.0",0.,1.e30,1,"dissolution bias of one pixel particles"},
+        {"resatcyc",CFGINT,"0",0.,2147483647.,1,"cycles before resaturation (0 for none)"},
+        {"cshgeom",CFGINT,"0",0.,1.,1,"C-S-H geometry 0) random or 1) plates"},
+        {"pHactive",CFGINT,"1",0.,1.,1,"pH influences kinetics 0) no or 1) yes"},
+        /* Given only by name */
+        {"alkalifile",CFGSTRING,"alkalichar.dat",0.,0.,0,"alkali characteristics"},
+        {"slagfile",CFGSTRING,"slagchar.dat",0.,0.,0,"slag characteristics"},
+        {"thfile",CFGSTRING,"temphist.dat",0.,0.,0,"programmed temperature history"},
+        {NULL,0,NULL,0.,0.,0,NULL}
+};
+
+char *ensname=NULL;	/* ensemble file, or NULL */
+int ensseeds=0;		/* seeds for each set of parameters of ensemble */
+int ensjobs=0;		/* members of ensemble run at once */
+
+/* routine to find the parameter called name, returning NULL if there */
+/* is none */
+/* Called by cfgadd, cfgvalue, cfggiven, ensread and cemhydparam */
+/* Calls no other routines */
+struct cfgkey *cfgfind(name)
+        char *name;
+{
+        int ik;
+
+        for(ik=0;cfgkeys[ik].name!=NULL;ik++){
+                if(strcmp(cfgkeys[ik].name,name)==0){
+                        return(&cfgkeys[ik]);
+                }
+        }
+        return(NULL);
+}
+
+/* routine to add the value of parameter name, from source */
+/* Called by cfgread, cfginit and cfgmember */
+/* Calls cfgfind, cfgvalid and logmsg */
+void cfgadd(name,value,cmdline,source)
+        char *name,*value,*source;
+        int cmdline;
+{
+        struct cfgkey *key;
+
+        key=cfgfind(name);
+        if(key==NULL){
+                logmsg(LOGSETUP,LOGERROR,"Unknown parameter %s in %s \n",name,source);
+                exit(1);
+        }
+        if((strlen(value)==0)||(strlen(value)>=CFGVALUE)){
+                logmsg(LOGSETUP,LOGERROR,"Value of parameter %s in %s is missing or too long \n",name,source);
+                exit(1);
+        }
+        cfgvalid(key,value,source);
+        if(sim->ncfgentry>=CFGMAXENTRY){
+                logmsg(LOGSETUP,LOGERROR,"Too many parameters in %s \n",source);
+                exit(1);
+        }
+        sim->cfgentries[sim->ncfgentry].key=key;
+        strcpy(sim->cfgentries[sim->ncfgentry].value,value);
+        sim->cfgentries[sim->ncfgentry].cmdline=cmdline;
+        sim->cfgentries[sim->ncfgentry].used=0;
+        sim->ncfgentry+=1;
+}
+
+/* routine to read the parameters in configuration file name */
+/* Called by cfginit */
+/* Calls cfgadd and logmsg */
+void cfgread(name)
+        char *name;
+{
+        FILE *cfgfile;
+        char line[256],*hash,*eq,*pname,*pvalue,*pend;
+        char source[300];
+        int nline;
+
+        cfgfile=fopen(name,"r");
+        if(cfgfile==NULL){
+                logmsg(LOGSETUP,LOGERROR,"Unable to open configuration file %s \n",name);
+                exit(1);
+        }
+        nline=0;
+        while(fgets(line,256,cfgfile)!=NULL){
+                nline+=1;
+                hash=strchr(line,'#');
+                if(hash!=NULL){*hash='\0';}
+                for(pname=line;(*pname==' ')||(*pname=='\t');pname++);
+                if((*pname=='\0')||(*pname=='\n')||(*pname=='\r')){continue;}
+                sprintf(source,"line %d of %s",nline,name);
+                eq=strchr(pname,'=');
+                if(eq==NULL){
+                        logmsg(LOGSETUP,LOGERROR,"Expected name = value on %s \n",source);
+                        exit(1);
+                }
+                /* Trim the blanks around the name and the value */
+                for(pend=eq;(pend>pname)&&((pend[-1]==' ')||(pend[-1]=='\t'));pend--);
+                *pend='\0';
+                for(pvalue=eq+1;(*pvalue==' ')||(*pvalue=='\t');pvalue++);
+                pend=pvalue+strlen(pvalue);
+                while((pend>pvalue)&&((pend[-1]==' ')||(pend[-1]=='\t')||(pend[-1]=='\n')||(pend[-1]=='\r'))){
+                        pend--;
+                }
+                *pend='\0';
+                cfgadd(pname,pvalue,0,source);
+        }
+        fclose(cfgfile);
+}
+
+/* routine to read the command line, and the configuration file and */
+/* ensemble file if they are given, and check that the parameters of */
+/* a configuration file are complete */
+/* Called by main program */
+/* Calls cfgread, cfgadd, cfgready, ensread and logmsg */
+void cfginit(argc,argv)
+        int argc;
+        char *argv[];
+{
+        int iarg,ie,je;
+        char *eq,why[CFGVALUE+80];
+
+        for(iarg=1;iarg<argc;iarg++){
+                eq=strchr(argv[iarg],'=');
+                if((strcmp(argv[iarg],"-c")==0)&&((iarg+1)<argc)&&(!sim->cfgkeyed)){
+                        iarg+=1;
+                        cfgread(argv[iarg]);
+                        sim->cfgkeyed=1;
+                }
+                else if((strcmp(argv[iarg],"-e")==0)&&((iarg+1)<argc)){
+                        iarg+=1;
+                        ensname=argv[iarg];
+                }
+                else if((strcmp(argv[iarg],"-n")==0)&&((iarg+1)<argc)&&(atoi(argv[iarg+1])>0)){
+                        iarg+=1;
+                        ensseeds=atoi(argv[iarg]);
+                }
+                else if((strcmp(argv[iarg],"-j")==0)&&((iarg+1)<argc)&&(atoi(argv[iarg+1])>0)){
+                        iarg+=1;
+                        ensjobs=atoi(argv[iarg]);
+                }
+                else if((eq!=NULL)&&(eq!=argv[iarg])&&(argv[iarg][0]!='-')){
+                        *eq='\0';
+                        cfgadd(argv[iarg],eq+1,1,"command line");
+                        *eq='=';
+                }
+                else{
+                        logmsg(LOGSETUP,LOGERROR,"Usage: disrealnew [-c configfile] [name=value ...] \n");
+                        logmsg(LOGSETUP,LOGERROR,"       disrealnew -c configfile [-e ensemblefile] [-n nseed] [-j njob] [name=value ...] \n");
+                        logmsg(LOGSETUP,LOGERROR,"Without a configuration file, parameters are read from the standard input \n");
+                        exit(1);
+                }
+        }
+        if(((ensname!=NULL)||(ensseeds>0))&&(!sim->cfgkeyed)){
+                logmsg(LOGSETUP,LOGERROR,"An ensemble needs a configuration file (-c) \n");
+                exit(1);
+        }
+        /* Values on the command line replace those in the file */
+        for(ie=0;ie<sim->ncfgentry;ie++){
+                if(!sim->cfgentries[ie].cmdline){continue;}
+                for(je=0;je<sim->ncfgentry;je++){
+                        if((!sim->cfgentries[je].cmdline)&&(sim->cfgentries[je].key==sim->cfgentries[ie].key)){
+                                sim->cfgentries[je].used=1;
+                        }
+                }
+        }
+        if(sim->cfgkeyed){
+                if(cfgready(1,why)!=0){
+                        logmsg(LOGSETUP,LOGERROR,"%s \n",why);
+                        exit(1);
+                }
+        }
+        if(ensname!=NULL){ensread(ensname);}
+}
+
+/* routine to give parameter name the value for a member of an */
+/* ensemble, in place of any other */
+/* Called by ensmember */
+/* Calls cfgadd */
+void cfgmember(name,value,source)
+        char *name,*value,*source;
+{
+        int ie;
+
+        cfgadd(name,value,1,source);
+        for(ie=0;ie<(sim->ncfgentry-1);ie++){
+                if(sim->cfgentries[ie].key==sim->cfgentries[sim->ncfgentry-1].key){
+                        sim->cfgentries[ie].used=1;
+                }
+        }
+}
+
+/* routine to return 1 if parameter key is read before the phases */
+/* are assigned, and so is the same for all members of an ensemble */
+/* (these come before nadd in cfgkeys) */
+/* Called by ensread */
+/* Calls no other routines */
+int cfgshared(key)
+        struct cfgkey *key;
+{
+        int ik;
+
+        for(ik=0;strcmp(cfgkeys[ik].name,"nadd")!=0;ik++){
+                if(&cfgkeys[ik]==key){return(1);}
+        }
+        return(0);
+}
+
+/* routine to check value against the type and range of parameter */
+/* key, returning CFGOK, CFGNOTNUM if it is not a number of the type, */
+/* or CFGRANGE if it is outside the range */
+/* Called by cfgvalid and cemhydparam */
+/* Calls no other routines */
+int cfgcheck(key,value)
+        struct cfgkey *key;
+        char *value;
+{
+        char *end;
+        double num;
+
+        if(key->type==CFGSTRING){
+                return(CFGOK);
+        }
+        if(key->type==CFGFLOAT){
+                num=strtod(value,&end);
+        }
+        else{
+                num=(double)strtol(value,&end,10);
+        }
+        if((end==value)||(*end!='\0')){
+                return(CFGNOTNUM);
+        }
+        /* Written so that nan is outside every range */
+        if(!((num>=key->lo)&&(num<=key->hi))){
+                return(CFGRANGE);
+        }
+        return(CFGOK);
+}
+
+/* routine to stop the run if value, from source, is not a number of */
+/* the type of parameter key or is outside its range */
+/* The messages held back are not printed, as they could not explain */
+/* the error */
+/* Called by cfgadd, cfgvalue and ensread */
+/* Calls cfgcheck, logdrop and logmsg */
+void cfgvalid(key,value,source)
+        struct cfgkey *key;
+        char *value,*source;
+{
+        int check;
+
+        check=cfgcheck(key,value);
+        if(check==CFGOK){return;}
+        logdrop();
+        if(check==CFGNOTNUM){
+                logmsg(LOGSETUP,LOGERROR,"Value %s of parameter %s in %s is not a number of the right type \n",value,key->name,source);
+        }
+        else{
+                logmsg(LOGSETUP,LOGERROR,"Value %s of parameter %s in %s is outside the range %g to %g \n",value,key->name,source,key->lo,key->hi);
+        }
+        exit(1);
+}
+
+/* routine to return the value parameter name will take in a run set */
+/* up only by name (that is, the first given on the command line, */
+/* then in the file, or the default) */
+/* Called by cfgready, simstart and ensrun */
+/* Calls cfgfind */
+char *cfggiven(name)
+        char *name;
+{
+        struct cfgkey *key;
+        int ie,pass;
+
+        key=cfgfind(name);
+        for(pass=1;pass>=0;pass--){
+                for(ie=0;ie<sim->ncfgentry;ie++){
+                        if((sim->cfgentries[ie].key==key)&&(!sim->cfgentries[ie].used)&&(sim->cfgentries[ie].cmdline==pass)){
+                                return(sim->cfgentries[ie].value);
+                        }
+                }
+        }
+        return(key->def);
+}
+
+/* routine to check, before a run set up only by name (from a */
+/* configuration file, or see cemhydlib.c) is started, that the */
+/* parameters given are complete and the files they name can be */
+/* read, returning 0, or -1 if the run would stop in setting up, with */
+/* the reason in why */
+/* The images must be named if images is 1, and are otherwise given */
+/* in memory; every value has already been checked by cfgcheck */
+/* Called by cfginit and cemhydload */
+/* Calls cfggiven */
+int cfgready(images,why)
+        int images;
+        char *why;
+{
+        FILE *f;
+        char *names[3];
+        long int nadd;
+        int ie,naddpos,nphtodo,ended,i,nfile;
+
+        /* Parameters with no default, other than phtodo, checked */
+        /* below */
+        for(i=0;cfgkeys[i].name!=NULL;i++){
+                if((cfgkeys[i].def==NULL)&&(strcmp(cfgkeys[i].name,"phtodo")!=0)&&
+                 (images||((strcmp(cfgkeys[i].name,"micfile")!=0)&&(strcmp(cfgkeys[i].name,"partfile")!=0)))&&
+                 (cfggiven(cfgkeys[i].name)==NULL)){
+                        sprintf(why,"Parameter %s (%s) must be given",cfgkeys[i].name,cfgkeys[i].help);
+                        return(-1);
+                }
+        }
+        /* Each nadd above 0 takes a phtodo, and none follow an nadd of 0 */
+        naddpos=nphtodo=ended=0;
+        for(ie=0;ie<sim->ncfgentry;ie++){
+                if(sim->cfgentries[ie].used){continue;}
+                if(strcmp(sim->cfgentries[ie].key->name,"nadd")==0){
+                        if(ended){
+                                sprintf(why,"Parameter nadd follows an nadd of 0");
+                                return(-1);
+                        }
+                        nadd=strtol(sim->cfgentries[ie].value,NULL,10);
+                        if(nadd>0){naddpos+=1;}
+                        else{ended=1;}
+                }
+                if(strcmp(sim->cfgentries[ie].key->name,"phtodo")==0){
+                        nphtodo+=1;
+                }
+        }
+        if(nphtodo!=naddpos){
+                sprintf(why,"Each nadd above 0 must be followed by a phtodo");
+                return(-1);
+        }
+        /* Files read while setting up */
+        nfile=0;
+        if(images){
+                names[nfile++]=cfggiven("micfile");
+                names[nfile++]=cfggiven("partfile");
+                /* The output files are named from the microstructure */
+                if((strcspn(names[0],".")+OUTSUFFIX)>=OUTNAME){
+                        sprintf(why,"Name of microstructure file %s too long for the names of output files",names[0]);
+                        return(-1);
+                }
+        }
+        names[nfile++]=cfggiven("alkalifile");
+        names[nfile++]=cfggiven("slagfile");
+        if(atoi(cfggiven("adiaflag"))==2){
+                names[nfile++]=cfggiven("thfile");
+        }
+        for(i=0;i<nfile;i++){
+                f=fopen(names[i],"r");
+                if(f==NULL){
+                        sprintf(why,"Unable to open file %s",names[i]);
+                        return(-1);
+                }
+                fclose(f);
+        }
+        return(0);
+}
+
+/* routine to find the value to use for parameter name, check it */
+/* against the type and range of the parameter, and add it to those */
+/* used */
+/* Called by cfgint, cfglong, cfgfloat and cfgstring */
+/* Calls cfgfind, cfgvalid, logdrop and logmsg */
+char *cfgvalue(name)
+        char *name;
+{
+        struct cfgkey *key;
+        struct cfgentry *use;
+        char token[CFGVALUE],*value;
+        int ie,pass;
+
+        key=cfgfind(name);
+        if(key==NULL){
+                logmsg(LOGSETUP,LOGERROR,"Unknown parameter %s \n",name);
+                exit(1);
+        }
+        /* The standard input is read even if the value is replaced, */
+        /* to keep the parameters that follow in place */
+        value=NULL;
+        if((!sim->cfgkeyed)&&(key->legacy)){
+                if(scanf("%79s",token)!=1){
+                        logdrop();
+                        logmsg(LOGSETUP,LOGERROR,"Input ended before parameter %s (%s) \n",name,key->help);
+                        exit(1);
+                }
+                value=token;
+        }
+        /* Values from the command line come first, then the file */
+        for(pass=1;pass>=0;pass--){
+                for(ie=0;ie<sim->ncfgentry;ie++){
+                        if((sim->cfgentries[ie].key==key)&&(!sim->cfgentries[ie].used)&&(sim->cfgentries[ie].cmdline==pass)){
+                                sim->cfgentries[ie].used=1;
+                                value=sim->cfgentries[ie].value;
+                                break;
+                        }
+                }
+                if(ie<sim->ncfgentry){break;}
+        }
+        if(value==NULL){value=key->def;}
+        if(value==NULL){
+                logdrop();
+                logmsg(LOGSETUP,LOGERROR,"Parameter %s (%s) must be given \n",name,key->help);
+                exit(1);
+        }
+        /* Values given by name were checked as they were added */
+        if(value==token){cfgvalid(key,value,"standard input");}
+
+        if(sim->ncfgused>=CFGMAXENTRY){
+                logmsg(LOGSETUP,LOGERROR,"Too many parameters \n");
+                exit(1);
+        }
+        use=&sim->cfgused[sim->ncfgused];
+        use->key=key;
+        strcpy(use->value,value);
+        sim->ncfgused+=1;
+        return(use->value);
+}
+
+/* routines to get the value of an integer, long integer, floating */
+/* point or string parameter */
+/* Called by main program and init */
+/* Call cfgvalue */
+int cfgint(name)
+        char *name;
+{
+        return((int)strtol(cfgvalue(name),NULL,10));
+}
+
+long int cfglong(name)
+        char *name;
+{
+        return(strtol(cfgvalue(name),NULL,10));
+}
+
+float cfgfloat(name)
+        char *name;
+{
+        return(strtof(cfgvalue(name),NULL));
+}
+
+void cfgstring(name,value)
+        char *name,*value;
+{
+        strcpy(value,cfgvalue(name));
+}
+
+/* routine to check that every parameter given has been used, and to */
+/* write the parameters used to the configuration file name */
+/* Called by main program */
+/* Calls outcreate, outprintf and logmsg */
+void cfgsave(name)
+        char *name;
+{
+        int ie;
+
+        for(ie=0;ie<sim->ncfgentry;ie++){
+                if(!sim->cfgentries[ie].used){
+                        logmsg(LOGSETUP,LOGERROR,"Parameter %s = %s was not used \n",sim->cfgentries[ie].key->name,sim->cfgentries[ie].value);
+                        exit(1);
+                }
+        }
+        outcreate(name);
+        outprintf(name,"# Parameters of run, for use with disrealnew -c %s \n",name);
+        for(ie=0;ie<sim->ncfgused;ie++){
+                outprintf(name,"%s = %s\t# %s\n",sim->cfgused[ie].key->name,sim->cfgused[ie].value,sim->cfgused[ie].key->help);
+        }
+}
@@ -61,484 +61,316 @@
 /* Induction and gypsum acceleration - influence of w/c modified 11/04 */
 /* Possibility of resaturation added 12/04 */
 /* C-S-H precipitating as plates added 01/26/05 */
-#include <stdio.h>
-#include <string.h>
-#include <math.h>
-#include <stdlib.h>
-
-#define MAXCYC 30000    /* Maximum number of cycles of hydration */
-			/* For hydration under sealed conditions: */
-#define CUBEMAX 7      /* Maximum cube size for checking pore size */
-#define CUBEMIN 3      /* Minimum cube size for checking pore size */
-#define SYSIZE 100    /* System size in pixels per dimension */
-#define SYSIZEM1 99    /* System size -1 */
-#define DISBIAS 30.0  /* Dissolution bias- to change all dissolution rates */
-#define DISMIN 0.001  /* Minimum dissolution for C3S dissolution */
-#define DISMIN2 0.00025  /* Minimum dissolution for C2S dissolution */
-#define DISMINSLAG 0.0001  /* Minimum dissolution for SLAG dissolution */
-#define DISMINASG 0.0005  /* Minimum dissolution for ASG dissolution */
-#define DISMINCAS2 0.0005  /* Minimum dissolution for CAS2 dissolution */
-#define DISMIN_C3A_0 0.002  /* Minimum dissolution for C3A dissolution */
-#define DISMIN_C4AF_0 0.0005  /* Minimum dissolution for C4AF dissolution */
-#define DETTRMAX 1200 /* Maximum allowed # of ettringite diffusing species */
-#define DGYPMAX 2000   /*  Maximum allowed # of gypsum diffusing species */
-#define DCACO3MAX 1000   /*  Maximum allowed # of CaCO3 diffusing species */
-#define DCACL2MAX 2000 /* Maximum allowed # of CaCl2 diffusing species */
-#define DCAS2MAX 2000 /* Maximum allowed # of CAS2 diffusing species */
-#define CHCRIT 50.0   /* Scale parameter to adjust CH dissolution probability */
-#define C3AH6CRIT 10.0   /* Scale par. to adjust C3AH6 dissolution prob. */
-#define C3AH6GROW 0.01  /* Probability for C3AH6 growth */
-#define CHGROW 1.0      /* Probability for CH growth */
-#define CHGROWAGG 1.0      /* Probability for CH growth on aggregate surface */
-#define ETTRGROW 0.002   /* Probability for ettringite growth */
-#define C3AETTR 0.001    /* Probability for reaction of diffusing C3A
-                             with ettringite  */
-#define C3AGYP 0.001      /*  Probability for diffusing C3A to react with diffusing gypsum */
-									/* diffusing anhydrite, and diffusing hemihydrate */
-#define SOLIDC3AGYP 0.5    /* Probability of solid C3A to react with diffusing sulfate */
-#define SOLIDC4AFGYP 0.1  /* Probability of solid C4AF to react with diffusing sulfate */
-#define PPOZZ 0.05      /* base probability for pozzolanic reaction */
-#define PCSH2CSH 0.002  /* probability for CSH dissolution */
-			/* for conversion of C-S-H to pozz. C-S-H */
-#define A0_CHSOL 1.325  /* Parameters for variation of CH solubility with */
-#define A1_CHSOL 0.008162   /* temperature (data from Taylor- Cement Chemistry) */
-/* changed CSHSCALE to 70000 6/15/01  to better model induction CS */
-#define CSHSCALE 70000.  /*scale factor for CSH controlling induction */
-#define WCSCALE 0.4      /* scale factor for influence of w/c on induction */
-#define WCSULFSCALE 0.5    /* scale factor for influence of w/c on sulfate acceleration of silicates and aluminates */
-#define C3AH6_SCALE 2000.  /*scale factor for C3AH6 controlling induction of aluminates */
-#define NEIGHBORS 26	/* number of neighbors to consider (6, 18, or 26) */
-/* define IDs for each phase used in model */
-/* To add a solid phase, insert new phase before ABSGYP */
-/*  and increment all subsequent IDs */
-/* To add a diffusing species, insert just before DIFFCACL2 */
-/*  and increment all subsequent IDs */
-#define POROSITY 0
-#define C3S 1
-#define C2S 2
-#define C3A 3
-#define C4AF 4
-#define GYPSUM 5
-#define HEMIHYD 6
-#define ANHYDRITE 7
-#define POZZ 8
-#define INERT 9
-#define SLAG 10
-#define ASG 11		  /* aluminosilicate glass */
-#define CAS2 12
-#define CH 13
-#define CSH 14
-#define C3AH6 15
-#define ETTR 16
-#define ETTRC4AF 17     /* Iron-rich stable ettringite phase */
-#define AFM 18
-#define FH3 19
-#define POZZCSH 20
-#define SLAGCSH 21      /* Slag gel-hydration product */
-#define CACL2 22
-#define FREIDEL 23	  /* Freidel's salt */
-#define STRAT 24	  /* stratlingite (C2ASH8) */
-#define GYPSUMS 25	/* Gypsum formed from hemihydrate and anhydrite */
-#define CACO3 26
-#define AFMC 27
-#define INERTAGG 28
-#define ABSGYP 29
-#define DIFFCSH 30
-#define DIFFCH 31
-#define DIFFGYP 32
-#define DIFFC3A 33
-#define DIFFC4A 34
-#define DIFFFH3 35
-#define DIFFETTR 36
-#define DIFFCACO3 37
-#define DIFFAS 38
-#define DIFFANH 39
-#define DIFFHEM 40
-#define DIFFCAS2 41
-#define DIFFCACL2 42
-#define EMPTYP 45         /* Empty porosity due to self desiccation */
-#define OFFSET 50         /* Offset for highlighted potentially soluble pixel */
-/* define heat capacities for all components in J/g/C */
-/* including free and bound water */
-#define Cp_cement 0.75
-#define Cp_pozz 0.75
-#define Cp_agg 0.84
-#define Cp_CH 0.75
-#define Cp_h2o 4.18     /* Cp for free water */
-#define Cp_bh2o 2.2     /* Cp for bound water */
-#define WN 0.23        /* water bound per gram of cement during hydration */
-#define WCHSH 0.06     /* water imbibed per gram of cement during chemical
-			 shrinkage (estimate) */
-
-/* data structure for diffusing species - to be dynamically allocated */
-/* Use of a doubly linked list to allow for easy maintenance */
-/* (i.e. insertion and deletion) */
-/* Added 11/94 */
-/* Note that if SYSIZE exceeds 256, need to change x, y, and z to */
-/* int variables */
-struct ants{
-        unsigned char x,y,z,id;
-	int cycbirth;
-        struct ants *nextant;
-        struct ants *prevant;
-};
-
-/* data structure for elements to remove to simulate self-desiccation */
-/* once again a doubly linked list */
-struct togo{
-        int x,y,z,npore;
-        struct togo *nexttogo;
-        struct togo *prevtogo;
-};
-
-/* Global variables */
-/* Microstructure stored in array mic of type char to minimize storage */
-/* Initial particle IDs stored in array micpart (for assessing set point) */
-static char mic [SYSIZE] [SYSIZE] [SYSIZE];
-static char micorig [SYSIZE] [SYSIZE] [SYSIZE];
-static short int micpart [SYSIZE] [SYSIZE] [SYSIZE];
-static short int cshage [SYSIZE] [SYSIZE] [SYSIZE];
-static short int faces [SYSIZE] [SYSIZE] [SYSIZE];
-/* counts for dissolved and solid species */
-long int discount[EMPTYP+1],count[EMPTYP+1],countinit[EMPTYP+1];
-long int ncshplategrow=0,ncshplateinit=0;
-/* Counts for pozzolan reacted, initial pozzolan, gypsum, ettringite,
-initial porosity, and aluminosilicate reacted */
-long int npr,nfill,ncsbar,netbar,porinit,nasr,nslagr,slagemptyp=0;
-/* Initial clinker phase counts */
-long int c3sinit,c2sinit,c3ainit,c4afinit,anhinit,heminit,chold,chnew;
-long int nmade,ngoing,gypready,poregone,poretodo,countpore=0;
-long int countkeep,water_left,water_off,pore_off;
-int ncyc,cyccnt,cubesize,sealed,outfreq;
-int icyc,burnfreq,setfreq,setflag,sf1,sf2,sf3,porefl1,porefl2,porefl3;
+/* Separate compilation of each file added 10/26 */
+/* Compile and link all the files of the program, for example */
+/*	cc -O2 -o disrealnew disrealnew.c sim.c ran1.c ranc.c lattice.c \ */
+/*		imgzip.c imgio.c movie.c output.c config.c ensemble.c \ */
+/*		species.c surface.c phases.c boxsum.c pardiff.c pores.c \ */
+/*		perc.c burn3d.c burnset.c parthyd.c hydrealnew.c pHpred.c \ */
+/*		checkpoint.c prof.c log.c -lm -lpthread */
+/* with -DPARALLEL for a parallel build (see pardiff.c), */
+/* and the same -D options for every file */
+/* Library for running hydrations from another program added 10/26 */
+/* (compile every file, and cemhydlib.c, with -DCEMHYDLIB to leave out */
+/* main; see cemhydlib.c) */
+/* Profile of the run time of each kernel added 10/26 */
+/* Messages by level and subsystem, quiet by default, added 10/26 */
+#include "cemhyd.h"
+
+/* Supplementary programs, compiled separately */
+/*	sim.c		simulation context */
+/*	ran1.c		random number generation */
+/*	ranc.c		counter-based and batched random numbers */
+/*	lattice.c	run-time sizing of microstructure arrays */
+/*	imgzip.c	compression of phase images */
+/*	imgio.c		text and binary microstructure images */
+/*	movie.c		hydration movies as logs of changes */
+/*	output.c	buffered and background output files */
+/*	config.c	parameters from input or configuration file */
+/*	ensemble.c	ensembles of runs over seeds and parameters */
+/*	species.c	pool of diffusing species */
+/*	surface.c	frontier of pixels in contact with pore space */
+/*	phases.c	changes of pixel phase and phase counts */
+/*	boxsum.c	summed-area table for counts in cubes */
+/*	pardiff.c	sub-domains for parallel diffusion */
+/*	pores.c		random picks of pore pixels for placement */
+/*	perc.c		cluster labelling for percolation */
+/*	burn3d.c	percolation of porosity assessment */
+/*	burnset.c	set point assessment */
+/*	parthyd.c	particle hydration assessment */
+/*	hydrealnew.c	hydration execution */
+/*	pHpred.c	pore solution pH prediction */
+/*	checkpoint.c	saving and restoring the full state */
+/*	prof.c		profile of run time */
+/*	log.c		messages by level and subsystem */
+/*	cemhydlib.c	library interface for other programs */
+
+/* All the variables of a simulation are held in struct sim (see */
+/* cemhyd.h); only the constant tables are global */
 int xoff[27]={1,0,0,-1,0,0,1,1,-1,-1,0,0,0,0,1,1,-1,-1,1,1,1,1,-1,-1,-1,-1,0};
 int yoff[27]={0,1,0,0,-1,0,1,-1,1,-1,1,-1,1,-1,0,0,0,0,1,-1,1,-1,1,1,-1,-1,0};
 int zoff[27]={0,0,1,0,0,-1,0,0,0,0,1,1,-1,-1,1,-1,1,-1,1,1,-1,-1,1,-1,1,-1,0};
-/* Parameters for kinetic modelling ---- maturity approach */
-float ind_time,temp_0,temp_cur,time_step=0.0,time_cur,E_act,beta,heat_cf;
-float w_to_c=0.0,s_to_c,krate,totfract=1.0,tfractw04=0.438596,fractwithfill=1.0;
-float kpozz,kslag;
-float tfractw05=0.384615,surffract=0.0,pfract,pfractw05=0.615385,sulf_conc;
-long int scntcement=0,scnttotal=0;
-float U_coeff=0.0,T_ambient=25.;
-float alpha_cur,heat_old,heat_new,cemmass,mass_agg,mass_water,mass_fill,Cp_now;
-float alpha,CH_mass,mass_CH,mass_fill_pozz,E_act_pozz,chs_new,cemmasswgyp;
-float flyashmass,alpha_fa_cur;
-float E_act_slag;
-/* Arrays for variable CSH molar volume and water consumption */
-float molarvcsh[MAXCYC],watercsh[MAXCYC],heatsum,molesh2o,saturation=1.0;
-/* Arrays for dissolution probabilities for each phase */
-float disprob[EMPTYP+1],disbase[EMPTYP+1],gypabsprob,ppozz;
-/* Arrays for specific gravities, molar volumes, heats of formation, and */
-/* molar water consumption for each phase */
-float specgrav[EMPTYP+1],molarv[EMPTYP+1],heatf[EMPTYP+1],waterc[EMPTYP+1];
-/* Solubility flags and diffusing species created for each phase */
-/* Also flag for C1.7SH4.0 to C1.1SH3.9 conversion */
-int soluble[EMPTYP+1],creates[EMPTYP+1],csh2flag,adiaflag,chflag,nummovsl;
-float cs_acc=1.0;     /* increases disprob[C3S] and disprob[C2S] if gypsum is present */
-float ca_acc=1.0;    /* increases disprob[C3A] and disprob[C4AF] if gypsum is present */
-float dismin_c3a=DISMIN_C3A_0;
-float dismin_c4af=DISMIN_C4AF_0;
-float gsratio2=0.0,onepixelbias=1.0;
-/* Slag probabilities */
-float p1slag;   /*  probability SLAG is converted to SLAGCSH */
-float p2slag;   /*  probability SLAG is converted to POROSITY or EMPTYP */
-float p3slag;   /*  probability adjoining pixel is converted to SLAGCSH */
-float p4slag;   /*  probability CH is consumed during SLAG reaction */
-float p5slag;   /*  probability a C3A diffusing species is created */
-float slagcasi,slaghydcasi;   /* Ca/Si ratios for SLAG and SLAGCSH */
-float slagh2osi;     /* H/S ratio of SLAGCSH */
-float slagc3a;       /* C3A/slag molar ratio */
-float siperslag;     /* S ratio of SLAG (per mole) */
-float slagreact;     /* Base dissolution reactivity factor for SLAG */
-long int DIFFCHdeficit=0,slaginit=0;   /* Deficit in CH due to SLAG reaction */
-long int slagcum=0,chgone=0;
-long int nch_slag=0;    /* number of CH consumed by SLAG reaction */
-long int sulf_cur=0;
-long int sulf_solid;
-int *seed;       /* Random number seed */
-char heatname[80],adianame[80],phname[80],ppsname[80],ptsname[80],phrname[80];
-char chshrname[80],moviename[80],parname[80],micname[80];
-char cmdnew[120],pHname[80],fileroot[80];
-struct ants *headant,*tailant;
-FILE *heatfile,*chsfile,*ptmpfile,*movfile,*pHfile,*micfile;
-/* Variables for alkali predictions */
-float pH_cur,totsodium,totpotassium,rssodium,rspotassium;
-/* Array for whether pH influences phase solubility  -- added 2/12/02 */
-float pHeffect[EMPTYP+1],pHfactor=0.0;
-int pHactive,resatcyc,cshgeom;
-/* Make conccaplus global to speed up execution and moles_syn_precip */
-/* global to accumulate properly */
-double conccaplus=0.0,moles_syn_precip=0.0,concsulfate=0.0; 
 int primevalues[6]={2,3,5,7,11,13};
-int cshboxsize;		/* Box size for addition of extra diffusing C-S-H */
-
-/* Supplementary programs */
-#include "ran1.c"		/* random number generation */
-#include "burn3d.c"		/* percolation of porosity assessment */
-#include "burnset.c"		/* set point assessment */
-#include "parthyd.c"		/* particle hydration assessment */
-#include "hydrealnew.c"		/* hydration execution */
-#include "pHpred.c"             /* pore solution pH prediction */
 
 /* routine to initialize values for solubilities, molar volumes, etc. */
 /* Called by main program */
-/* Calls no other routines */
+/* Calls cfgstring and logmsg */
 void init()
 {
         int i;
         float slagin,CHperslag;
         FILE *slagfile,*alkalifile;
+        char filein[80];
 
         for(i=0;i<=EMPTYP;i++){
-                creates[i]=0;
-                soluble[i]=0;
-                disprob[i]=0.0;
-                disbase[i]=0.0;
-                pHeffect[i]=0.0;
-		countinit[i]=0;
+                sim->creates[i]=0;
+                sim->soluble[i]=0;
+                sim->disprob[i]=0.0;
+                sim->disbase[i]=0.0;
+                sim->pHeffect[i]=0.0;
+		sim->countinit[i]=0;
         }
 
         /* soluble [x] - flag indicating if phase x is soluble */
         /* disprob [x] - probability of dissolution (relative diss. rate) */
-        gypabsprob=0.01;	/* One sulfate absorbed per 100 CSH units */
+        sim->gypabsprob=0.01;	/* One sulfate absorbed per 100 CSH units */
 	/* Source is from Taylor's Cement Chemistry  for K and Na absorption */
         /* Note that for the first cycle, of the clinker phases only the */
         /* aluminates and gypsum are soluble */
-        soluble[C4AF]=1;
-        disprob[C4AF]=disbase[C4AF]=0.067/DISBIAS;
-        creates[C4AF]=POROSITY;
-        pHeffect[C4AF]=1.0;
-        soluble[C3S]=0;
-        disprob[C3S]=disbase[C3S]=0.7/DISBIAS;
-        creates[C3S]=DIFFCSH;
-        pHeffect[C3S]=1.0;
-        soluble[C2S]=0;
-        disprob[C2S]=disbase[C2S]=0.1/DISBIAS;
-        creates[C2S]=DIFFCSH;
-        pHeffect[C2S]=1.0;
-        soluble[C3A]=1;
+        sim->soluble[C4AF]=1;
+        sim->disprob[C4AF]=sim->disbase[C4AF]=0.067/DISBIAS;
+        sim->creates[C4AF]=POROSITY;
+        sim->pHeffect[C4AF]=1.0;
+        sim->soluble[C3S]=0;
+        sim->disprob[C3S]=sim->disbase[C3S]=0.7/DISBIAS;
+        sim->creates[C3S]=DIFFCSH;
+        sim->pHeffect[C3S]=1.0;
+        sim->soluble[C2S]=0;
+        sim->disprob[C2S]=sim->disbase[C2S]=0.1/DISBIAS;
+        sim->creates[C2S]=DIFFCSH;
+        sim->pHeffect[C2S]=1.0;
+        sim->soluble[C3A]=1;
 	/* increased back to 0.4 from 0.25 7/8/99 */
-        disprob[C3A]=disbase[C3A]=0.4/DISBIAS;
-        creates[C3A]=POROSITY;
-        pHeffect[C3A]=1.0;
-        soluble[GYPSUM]=1;
+        sim->disprob[C3A]=sim->disbase[C3A]=0.4/DISBIAS;
+        sim->creates[C3A]=POROSITY;
+        sim->pHeffect[C3A]=1.0;
+        sim->soluble[GYPSUM]=1;
 	/* Changed from 0.05 to 0.015  9/29/98 */
 	/* Changed to 0.040 10/15/98 */
 	/* back to 0.05 from 0.10 7/8/99 */
 	/* from 0.05 to 0.02 4/4/00 */
 	/* from 0.02 to 0.025 8/13/01 */
-        disprob[GYPSUM]=disbase[GYPSUM]=0.025;   /*geaendert am 04.04.00, urspr. 0.05*/
+        sim->disprob[GYPSUM]=sim->disbase[GYPSUM]=0.025;   /*geaendert am 04.04.00, urspr. 0.05*/
 	/* dissolved gypsum distributed at random throughout microstructure */
-        creates[GYPSUM]=POROSITY;
-        soluble[GYPSUMS]=1;
-        pHeffect[GYPSUM]=0.0;
+        sim->creates[GYPSUM]=POROSITY;
+        sim->soluble[GYPSUMS]=1;
+        sim->pHeffect[GYPSUM]=0.0;
 	/* Changed from 0.05 to 0.015  9/29/98 */
 	/* Changed to 0.020 10/15/98 */
 	/* and also changed all sulfate based dissolution rates */
-        disprob[GYPSUMS]=disbase[GYPSUMS]=disprob[GYPSUM];
-        creates[GYPSUMS]=POROSITY;
-        pHeffect[GYPSUMS]=0.0;
-        soluble[ANHYDRITE]=1;
+        sim->disprob[GYPSUMS]=sim->disbase[GYPSUMS]=sim->disprob[GYPSUM];
+        sim->creates[GYPSUMS]=POROSITY;
+        sim->pHeffect[GYPSUMS]=0.0;
+        sim->soluble[ANHYDRITE]=1;
 	/* set anhydrite dissolution at 4/5ths of that of gypsum */
 	/* Source: Uchikawa et al., CCR, 1984 */
-      disprob[ANHYDRITE]=disbase[ANHYDRITE]=0.8*disprob[GYPSUM];
+      sim->disprob[ANHYDRITE]=sim->disbase[ANHYDRITE]=0.8*sim->disprob[GYPSUM];
 	/* dissolved anhydrite distributed at random throughout microstructure */
-        creates[ANHYDRITE]=POROSITY;
-        pHeffect[ANHYDRITE]=0.0;
-        soluble[HEMIHYD]=1;
+        sim->creates[ANHYDRITE]=POROSITY;
+        sim->pHeffect[ANHYDRITE]=0.0;
+        sim->soluble[HEMIHYD]=1;
 	/* set hemihydrate dissolution at 3 times that of gypsum */
 	/* Source: Uchikawa et al., CCR, 1984 */
         /* Changed to 1.5 times that of gypsum 6/1/00 */
-        disprob[HEMIHYD]=disbase[HEMIHYD]=1.5*disprob[GYPSUM];   /* ge�ndert am 01.06.00, urspr. 3.0 */
+        sim->disprob[HEMIHYD]=sim->disbase[HEMIHYD]=1.5*sim->disprob[GYPSUM];   /* ge�ndert am 01.06.00, urspr. 3.0 */
 	/* dissolved hemihydrate distributed at random throughout microstructure */
-        creates[HEMIHYD]=POROSITY;
-        pHeffect[HEMIHYD]=0.0;
+        sim->creates[HEMIHYD]=POROSITY;
+        sim->pHeffect[HEMIHYD]=0.0;
 	/* CH soluble to allow for Ostwald ripening of crystals */
-        soluble[CH]=1;
-        disprob[CH]=disbase[CH]=0.5/DISBIAS;
-        creates[CH]=DIFFCH;
-        pHeffect[CH]=0.0;
+        sim->soluble[CH]=1;
+        sim->disprob[CH]=sim->disbase[CH]=0.5/DISBIAS;
+        sim->creates[CH]=DIFFCH;
+        sim->pHeffect[CH]=0.0;
         /* CaCO3 is only mildly soluble */
-        soluble[CACO3]=1;
-        disprob[CACO3]=disbase[CACO3]=0.10/DISBIAS;
-        creates[CACO3]=DIFFCACO3;
-        pHeffect[CACO3]=0.0;
+        sim->soluble[CACO3]=1;
+        sim->disprob[CACO3]=sim->disbase[CACO3]=0.10/DISBIAS;
+        sim->creates[CACO3]=DIFFCACO3;
+        sim->pHeffect[CACO3]=0.0;
         /* Slag is not truly soluble, but use its dissolution probability for reaction probability */
-        soluble[SLAG]=0;
-        disprob[SLAG]=disbase[SLAG]=0.005/DISBIAS;
-        creates[SLAG]=0;
-        pHeffect[SLAG]=1.0;
-        soluble[C3AH6]=1;
-        disprob[C3AH6]=disbase[C3AH6]=0.01/DISBIAS; /* changed from 0.5 to 0.01 06.09.00 */
-        creates[C3AH6]=POROSITY;
-        pHeffect[C3AH6]=0.0;
+        sim->soluble[SLAG]=0;
+        sim->disprob[SLAG]=sim->disbase[SLAG]=0.005/DISBIAS;
+        sim->creates[SLAG]=0;
+        sim->pHeffect[SLAG]=1.0;
+        sim->soluble[C3AH6]=1;
+        sim->disprob[C3AH6]=sim->disbase[C3AH6]=0.01/DISBIAS; /* changed from 0.5 to 0.01 06.09.00 */
+        sim->creates[C3AH6]=POROSITY;
+        sim->pHeffect[C3AH6]=0.0;
         /* Ettringite is initially insoluble */
-        soluble[ETTR]=0;
+        sim->soluble[ETTR]=0;
 	/* Changed to 0.008 from 0.020  3/11/99 */
-        disprob[ETTR]=disbase[ETTR]=0.008/DISBIAS;
-        creates[ETTR]=DIFFETTR;
-        pHeffect[ETTR]=0.0;
+        sim->disprob[ETTR]=sim->disbase[ETTR]=0.008/DISBIAS;
+        sim->creates[ETTR]=DIFFETTR;
+        sim->pHeffect[ETTR]=0.0;
         /* Iron-rich ettringite is always insoluble */
-        soluble[ETTRC4AF]=0;
-        disprob[ETTRC4AF]=disbase[ETTRC4AF]=0.0;
-        creates[ETTRC4AF]=ETTRC4AF;
-        pHeffect[ETTRC4AF]=0.0;
+        sim->soluble[ETTRC4AF]=0;
+        sim->disprob[ETTRC4AF]=sim->disbase[ETTRC4AF]=0.0;
+        sim->creates[ETTRC4AF]=ETTRC4AF;
+        sim->pHeffect[ETTRC4AF]=0.0;
 	/* calcium chloride is soluble */
-        soluble[CACL2]=1;
-	disprob[CACL2]=disbase[CACL2]=0.1/DISBIAS;
- 	creates[CACL2]=DIFFCACL2;
-        pHeffect[CACL2]=0.0;
+        sim->soluble[CACL2]=1;
+	sim->disprob[CACL2]=sim->disbase[CACL2]=0.1/DISBIAS;
+ 	sim->creates[CACL2]=DIFFCACL2;
+        sim->pHeffect[CACL2]=0.0;
 	/* aluminosilicate glass is soluble */
-	soluble[ASG]=1;
-	disprob[ASG]=disbase[ASG]=0.2/DISBIAS;
-	creates[ASG]=DIFFAS;
-        pHeffect[ASG]=1.0;
+	sim->soluble[ASG]=1;
+	sim->disprob[ASG]=sim->disbase[ASG]=0.2/DISBIAS;
+	sim->creates[ASG]=DIFFAS;
+        sim->pHeffect[ASG]=1.0;
 	/* calcium aluminodisilicate is soluble */
-	soluble[CAS2]=1;
-	disprob[CAS2]=disbase[CAS2]=0.2/DISBIAS;
-	creates[CAS2]=DIFFCAS2;
-        pHeffect[CAS2]=1.0;
+	sim->soluble[CAS2]=1;
+	sim->disprob[CAS2]=sim->disbase[CAS2]=0.2/DISBIAS;
+	sim->creates[CAS2]=DIFFCAS2;
+        sim->pHeffect[CAS2]=1.0;
 
         /* establish molar volumes and heats of formation */
         /* molar volumes are in cm^3/mole */
         /* heats of formation are in kJ/mole */
         /* See paper by Fukuhara et al., Cem. & Conc. Res., 11, 407-14, 1981. */
         /* values for Porosity are those of water */
-        molarv[POROSITY]=18.068;
-        heatf[POROSITY]=(-285.83);
-        waterc[POROSITY]=1.0;
-        specgrav[POROSITY]=0.99707;
-
-        molarv[C3S]=71.129;
-        heatf[C3S]=(-2927.82);
-        waterc[C3S]=0.0;
-        specgrav[C3S]=3.21;
+        sim->molarv[POROSITY]=18.068;
+        sim->heatf[POROSITY]=(-285.83);
+        sim->waterc[POROSITY]=1.0;
+        sim->specgrav[POROSITY]=0.99707;
+
+        sim->molarv[C3S]=71.129;
+        sim->heatf[C3S]=(-2927.82);
+        sim->waterc[C3S]=0.0;
+        sim->specgrav[C3S]=3.21;
         /* For improvement in chemical shrinkage correspondence */
         /* Changed molar volume of C(1.7)-S-H(4.0) to 108 5/24/95 */
-        molarv[CSH]=108.;
-        heatf[CSH]=(-3283.0);
-        waterc[CSH]=4.0;
-        specgrav[CSH]=2.11;
+        sim->molarv[CSH]=108.;
+        sim->heatf[CSH]=(-3283.0);
+        sim->waterc[CSH]=4.0;
+        sim->specgrav[CSH]=2.11;
 
-        molarv[CH]=33.1;
-        heatf[CH]=(-986.1);
-        waterc[CH]=1.0;
-        specgrav[CH]=2.24;
+        sim->molarv[CH]=33.1;
+        sim->heatf[CH]=(-986.1);
+        sim->waterc[CH]=1.0;
+        sim->specgrav[CH]=2.24;
 
         /* Assume that calcium carbonate is in the calcite form */
-        molarv[CACO3]=36.93;
-        waterc[CACO3]=0.0;
-        specgrav[CACO3]=2.71;
-        heatf[CACO3]=(-1206.92);
-
-        molarv[AFMC]=261.91;
-        waterc[AFMC]=11.0;
-        specgrav[AFMC]=2.17;
+        sim->molarv[CACO3]=36.93;
+        sim->waterc[CACO3]=0.0;
+        sim->specgrav[CACO3]=2.71;
+        sim->heatf[CACO3]=(-1206.92);
+
+        sim->molarv[AFMC]=261.91;
+        sim->waterc[AFMC]=11.0;
+        sim->specgrav[AFMC]=2.17;
         /* Need to fill in heat of formation at a later date */
-        heatf[AFMC]=(0.0);
-
-        molarv[C2S]=52.513;
-        heatf[C2S]=(-2311.6);
-        waterc[C2S]=0.0;
-        specgrav[C2S]=3.28;
-
-        molarv[C3A]=88.94;
-        heatf[C3A]=(-3587.8);
-        waterc[C3A]=0.0;
-        specgrav[C3A]=3.038;
-
-        molarv[GYPSUM]=74.21;
-        heatf[GYPSUM]=(-2022.6);
-        waterc[GYPSUM]=0.0;
-        specgrav[GYPSUM]=2.32;
-        molarv[GYPSUMS]=74.21;
-        heatf[GYPSUMS]=(-2022.6);
-        waterc[GYPSUMS]=0.0;
-        specgrav[GYPSUMS]=2.32;
-
-        molarv[ANHYDRITE]=52.16;
-        heatf[ANHYDRITE]=(-1424.6);
-        waterc[ANHYDRITE]=0.0;
-        specgrav[ANHYDRITE]=2.61;
-
-        molarv[HEMIHYD]=52.973;
-        heatf[HEMIHYD]=(-1574.65);
-        waterc[HEMIHYD]=0.0;
-        specgrav[HEMIHYD]=2.74;
-
-        molarv[C4AF]=130.29;
-        heatf[C4AF]=(-5090.3);
-        waterc[C4AF]=0.0;
-        specgrav[C4AF]=3.73;
-
-        molarv[C3AH6]=150.12;
-        heatf[C3AH6]=(-5548.);
-        waterc[C3AH6]=6.0;
-        specgrav[C3AH6]=2.52;
+        sim->heatf[AFMC]=(0.0);
+
+        sim->molarv[C2S]=52.513;
+        sim->heatf[C2S]=(-2311.6);
+        sim->waterc[C2S]=0.0;
+        sim->specgrav[C2S]=3.28;
+
+        sim->molarv[C3A]=88.94;
+        sim->heatf[C3A]=(-3587.8);
+        sim->waterc[C3A]=0.0;
+        sim->specgrav[C3A]=3.038;
+
+        sim->molarv[GYPSUM]=74.21;
+        sim->heatf[GYPSUM]=(-2022.6);
+        sim->waterc[GYPSUM]=0.0;
+        sim->specgrav[GYPSUM]=2.32;
+        sim->molarv[GYPSUMS]=74.21;
+        sim->heatf[GYPSUMS]=(-2022.6);
+        sim->waterc[GYPSUMS]=0.0;
+        sim->specgrav[GYPSUMS]=2.32;
+
+        sim->molarv[ANHYDRITE]=52.16;
+        sim->heatf[ANHYDRITE]=(-1424.6);
+        sim->waterc[ANHYDRITE]=0.0;
+        sim->specgrav[ANHYDRITE]=2.61;
+
+        sim->molarv[HEMIHYD]=52.973;
+        sim->heatf[HEMIHYD]=(-1574.65);
+        sim->waterc[HEMIHYD]=0.0;
+        sim->specgrav[HEMIHYD]=2.74;
+
+        sim->molarv[C4AF]=130.29;
+        sim->heatf[C4AF]=(-5090.3);
+        sim->waterc[C4AF]=0.0;
+        sim->specgrav[C4AF]=3.73;
+
+        sim->molarv[C3AH6]=150.12;
+        sim->heatf[C3AH6]=(-5548.);
+        sim->waterc[C3AH6]=6.0;
+        sim->specgrav[C3AH6]=2.52;
 
 /* Changed molar volume of FH3 to 69.8 (specific gravity of 3.06) 5/23/95 */
-        molarv[FH3]=69.803;
-        heatf[FH3]=(-823.9);
-        waterc[FH3]=3.0;
-        specgrav[FH3]=3.062;
-
-        molarv[ETTRC4AF]=735.01;
-        heatf[ETTRC4AF]=(-17539.0);
-        waterc[ETTRC4AF]=26.0;
-        specgrav[ETTRC4AF]=1.7076;
+        sim->molarv[FH3]=69.803;
+        sim->heatf[FH3]=(-823.9);
+        sim->waterc[FH3]=3.0;
+        sim->specgrav[FH3]=3.062;
+
+        sim->molarv[ETTRC4AF]=735.01;
+        sim->heatf[ETTRC4AF]=(-17539.0);
+        sim->waterc[ETTRC4AF]=26.0;
+        sim->specgrav[ETTRC4AF]=1.7076;
 /* Changed molar volue of ettringite to 735 (spec. gr.=1.7076)  5/24/95 */
-        molarv[ETTR]=735.01;
-        heatf[ETTR]=(-17539.0);
-        waterc[ETTR]=26.0;
-        specgrav[ETTR]=1.7076;
+        sim->molarv[ETTR]=735.01;
+        sim->heatf[ETTR]=(-17539.0);
+        sim->waterc[ETTR]=26.0;
+        sim->specgrav[ETTR]=1.7076;
 
-        molarv[AFM]=312.82;
-        heatf[AFM]=(-8778.0);
+        sim->molarv[AFM]=312.82;
+        sim->heatf[AFM]=(-8778.0);
         /* Each mole of AFM which forms requires 12 moles of water, */
         /* two of which are supplied by gypsum in forming ETTR  */
         /* leaving 10 moles to be incorporated from free water */
-        waterc[AFM]=10.0;
-        specgrav[AFM]=1.99;
+        sim->waterc[AFM]=10.0;
+        sim->specgrav[AFM]=1.99;
 
-	molarv[CACL2]=51.62;
-	heatf[CACL2]=(-795.8);
-	waterc[CACL2]=0;
-	specgrav[CACL2]=2.15;
+	sim->molarv[CACL2]=51.62;
+	sim->heatf[CACL2]=(-795.8);
+	sim->waterc[CACL2]=0;
+	sim->specgrav[CACL2]=2.15;
 
-	molarv[FREIDEL]=296.662;
+	sim->molarv[FREIDEL]=296.662;
 	/* No data available for heat of formation */
-	heatf[FREIDEL]=(0.0);
+	sim->heatf[FREIDEL]=(0.0);
 	/* 10 moles of H2O per mole of Freidel's salt */
-	waterc[FREIDEL]=10.0;
-	specgrav[FREIDEL]=1.892;
+	sim->waterc[FREIDEL]=10.0;
+	sim->specgrav[FREIDEL]=1.892;
 
 	/* Basic reaction is 2CH + ASG + 6H --> C2ASH8 (Stratlingite) */
-	molarv[ASG]=49.9;
+	sim->molarv[ASG]=49.9;
 	/* No data available for heat of formation */
-	heatf[ASG]=0.0;
-	waterc[ASG]=0.0;
-	specgrav[ASG]=3.247;
+	sim->heatf[ASG]=0.0;
+	sim->waterc[ASG]=0.0;
+	sim->specgrav[ASG]=3.247;
 
-	molarv[CAS2]=100.62;
+	sim->molarv[CAS2]=100.62;
 	/* No data available for heat of formation */
-	heatf[CAS2]=0.0;
-	waterc[CAS2]=0.0;
-	specgrav[CAS2]=2.77;
+	sim->heatf[CAS2]=0.0;
+	sim->waterc[CAS2]=0.0;
+	sim->specgrav[CAS2]=2.77;
 
-	molarv[STRAT]=215.63;
+	sim->molarv[STRAT]=215.63;
 	/* No data available for heat of formation */
-	heatf[STRAT]=0.0;
+	sim->heatf[STRAT]=0.0;
 	/* 8 moles of water per mole of stratlingite */
-	waterc[STRAT]=8.0;
-	specgrav[STRAT]=1.94;
+	sim->waterc[STRAT]=8.0;
+	sim->specgrav[STRAT]=1.94;
 
-        molarv[POZZ]=27.0;
+        sim->molarv[POZZ]=27.0;
         /* Use heat of formation of SiO2 (quartz) for unreacted pozzolan */
         /* Source- Handbook of Chemistry and Physics */
-        heatf[POZZ]=-907.5;
-        waterc[POZZ]=0.0;
-        specgrav[POZZ]=2.22;
+        sim->heatf[POZZ]=-907.5;
+        sim->waterc[POZZ]=0.0;
+        sim->specgrav[POZZ]=2.22;
 
 	/* Data for Pozzolanic CSH based on work of Atlassi, DeLarrard, */
 	/* and Jensen */
@@ -549,79 +381,89 @@ void init()
 	/* results 1/22/97 */
 	/* MW is 191.8 g/mole */
         /* Changed molar volume to 101.81  3/10/97 */
-	molarv[POZZCSH]=101.81;
-	waterc[POZZCSH]=3.9;
-        specgrav[POZZCSH]=1.884;
-        heatf[POZZCSH]=(-2299.1);
+	sim->molarv[POZZCSH]=101.81;
+	sim->waterc[POZZCSH]=3.9;
+        sim->specgrav[POZZCSH]=1.884;
+        sim->heatf[POZZCSH]=(-2299.1);
 
 /* Assume inert filler has same specific gravity and molar volume as SiO2 */
-        molarv[INERT]=27.0;
-       	heatf[INERT]=0.0;
-        waterc[INERT]=0.0;
-        specgrav[INERT]=2.2;
+        sim->molarv[INERT]=27.0;
+       	sim->heatf[INERT]=0.0;
+        sim->waterc[INERT]=0.0;
+        sim->specgrav[INERT]=2.2;
 
-        molarv[ABSGYP]=74.21;
-        heatf[ABSGYP]=(-2022.6);
-        waterc[ABSGYP]=0.0;
-        specgrav[ABSGYP]=2.32;
+        sim->molarv[ABSGYP]=74.21;
+        sim->heatf[ABSGYP]=(-2022.6);
+        sim->waterc[ABSGYP]=0.0;
+        sim->specgrav[ABSGYP]=2.32;
 
-        molarv[EMPTYP]=18.068;
-        heatf[EMPTYP]=(-285.83);
-        waterc[EMPTYP]=0.0;
-        specgrav[EMPTYP]=0.99707;
+        sim->molarv[EMPTYP]=18.068;
+        sim->heatf[EMPTYP]=(-285.83);
+        sim->waterc[EMPTYP]=0.0;
+        sim->specgrav[EMPTYP]=0.99707;
 
         /* Read in values for alkali characteristics and */
         /* convert them to fractions from percentages */
-        alkalifile=fopen("alkalichar.dat","r");
-        fscanf(alkalifile,"%f",&totsodium);
-        fscanf(alkalifile,"%f",&totpotassium);
-        fscanf(alkalifile,"%f",&rssodium);
-        fscanf(alkalifile,"%f",&rspotassium);
+        cfgstring("alkalifile",filein);
+        alkalifile=fopen(filein,"r");
+        if(alkalifile==NULL){
+                logmsg(LOGSETUP,LOGERROR,"Unable to open alkali file %s \n",filein);
+                exit(1);
+        }
+        fscanf(alkalifile,"%f",&sim->totsodium);
+        fscanf(alkalifile,"%f",&sim->totpotassium);
+        fscanf(alkalifile,"%f",&sim->rssodium);
+        fscanf(alkalifile,"%f",&sim->rspotassium);
         fclose(alkalifile);
-        totsodium/=100.;
-        totpotassium/=100.;
-        rssodium/=100.;
-        rspotassium/=100.;
+        sim->totsodium/=100.;
+        sim->totpotassium/=100.;
+        sim->rssodium/=100.;
+        sim->rspotassium/=100.;
         /* Read in values for slag characteristics */
-        slagfile=fopen("slagchar.dat","r");
+        cfgstring("slagfile",filein);
+        slagfile=fopen(filein,"r");
+        if(slagfile==NULL){
+                logmsg(LOGSETUP,LOGERROR,"Unable to open slag file %s \n",filein);
+                exit(1);
+        }
         fscanf(slagfile,"%f",&slagin);
         fscanf(slagfile,"%f",&slagin);
         fscanf(slagfile,"%f",&slagin);
-        specgrav[SLAG]=slagin;
+        sim->specgrav[SLAG]=slagin;
         fscanf(slagfile,"%f",&slagin);
-        specgrav[SLAGCSH]=slagin;
+        sim->specgrav[SLAGCSH]=slagin;
         fscanf(slagfile,"%f",&slagin);
-        molarv[SLAG]=slagin;
+        sim->molarv[SLAG]=slagin;
         fscanf(slagfile,"%f",&slagin);
-        molarv[SLAGCSH]=slagin;
-        fscanf(slagfile,"%f",&slagcasi);
-        fscanf(slagfile,"%f",&slaghydcasi);
-        fscanf(slagfile,"%f",&siperslag);
+        sim->molarv[SLAGCSH]=slagin;
+        fscanf(slagfile,"%f",&sim->slagcasi);
+        fscanf(slagfile,"%f",&sim->slaghydcasi);
+        fscanf(slagfile,"%f",&sim->siperslag);
         fscanf(slagfile,"%f",&slagin);
-        waterc[SLAGCSH]=slagin*siperslag;
-        fscanf(slagfile,"%f",&slagc3a);
-        fscanf(slagfile,"%f",&slagreact);
-        waterc[SLAG]=0.0;
-        heatf[SLAG]=0.0;
-        heatf[SLAGCSH]=0.0;
+        sim->waterc[SLAGCSH]=slagin*sim->siperslag;
+        fscanf(slagfile,"%f",&sim->slagc3a);
+        fscanf(slagfile,"%f",&sim->slagreact);
+        sim->waterc[SLAG]=0.0;
+        sim->heatf[SLAG]=0.0;
+        sim->heatf[SLAGCSH]=0.0;
         fclose(slagfile);
         /* Compute slag probabilities as defined above */
-        CHperslag=siperslag*(slaghydcasi-slagcasi)+3.*slagc3a;
+        CHperslag=sim->siperslag*(sim->slaghydcasi-sim->slagcasi)+3.*sim->slagc3a;
         if(CHperslag<0.0){CHperslag=0.0;}
-        p2slag=(molarv[SLAG]+molarv[CH]*CHperslag+molarv[POROSITY]*(waterc[SLAGCSH]-CHperslag+waterc[C3AH6]*slagc3a)-molarv[SLAGCSH]-molarv[C3AH6]*slagc3a)/molarv[SLAG];
-        p1slag=1.0-p2slag;
-        p3slag=(molarv[SLAGCSH]/molarv[SLAG])-p1slag;
-        p4slag=CHperslag*molarv[CH]/molarv[SLAG];
-        p5slag=slagc3a*molarv[C3A]/molarv[SLAG];
-        if(p5slag>1.0){
-           p5slag=1.0;
-           printf("Error in range of C3A/slag value...  reset to 1.0 \n");
+        sim->p2slag=(sim->molarv[SLAG]+sim->molarv[CH]*CHperslag+sim->molarv[POROSITY]*(sim->waterc[SLAGCSH]-CHperslag+sim->waterc[C3AH6]*sim->slagc3a)-sim->molarv[SLAGCSH]-sim->molarv[C3AH6]*sim->slagc3a)/sim->molarv[SLAG];
+        sim->p1slag=1.0-sim->p2slag;
+        sim->p3slag=(sim->molarv[SLAGCSH]/sim->molarv[SLAG])-sim->p1slag;
+        sim->p4slag=CHperslag*sim->molarv[CH]/sim->molarv[SLAG];
+        sim->p5slag=sim->slagc3a*sim->molarv[C3A]/sim->molarv[SLAG];
+        if(sim->p5slag>1.0){
+           sim->p5slag=1.0;
+           logmsg(LOGSETUP,LOGWARN,"Error in range of C3A/slag value...  reset to 1.0 \n");
         }
 }
 
 /* routine to check if a pixel located at (xck,yck,zck) is on an edge */
 /* (in contact with pore space) in 3-D system */
-/* Called by passone */
+/* Called by marksurf */
 /* Calls no other routines */
 int chckedge(xck,yck,zck)
         int xck,yck,zck;
@@ -644,110 +486,116 @@ int chckedge(xck,yck,zck)
                 if(y2<0){y2=SYSIZEM1;}
                 if(z2>=SYSIZE){z2=0;}
                 if(z2<0){z2=SYSIZEM1;}
-                if(mic [x2] [y2] [z2]==POROSITY){
+                if(sim->mic[VOXEL(x2,y2,z2)]==POROSITY){
                         edgeback=1;
                 }
         }
         return(edgeback);
 }
 
+/* routine to highlight soluble pixels in contact with porosity by */
+/* adding OFFSET to their phase IDs and queueing them for pass two */
+/* low and high indicate phase ID range to check for surface sites */
+/* Called by passone and dissolve */
+/* Calls chckedge */
+void marksurf(low,high)
+        int low,high;
+{
+        int xid,yid,zid,phid;
+        long int iv,iw,nscan;
+        unsigned int bits;
+
+        /* Only solid pixels with an open neighbor can be in contact */
+        /* with porosity */
+        nscan=0;
+        for(iw=0;iw<sim->nsurfwords;iw++){
+        for(bits=sim->surfbits[iw];bits!=0;bits&=(bits-1)){
+        iv=(iw<<5)+SURFLOW(bits);
+        nscan+=1;
+        phid=sim->mic[iv];
+        /* If phase is soluble, see if it is in contact with porosity */
+        if((phid>=low)&&(phid<=high)&&(sim->soluble[phid]==1)){
+                xid=(int)(iv/((long int)SYSIZE*SYSIZE));
+                yid=(int)((iv/SYSIZE)%SYSIZE);
+                zid=(int)(iv%SYSIZE);
+                if(chckedge(xid,yid,zid)==1){
+/* Surface eligible species has an ID OFFSET greater than its original value */
+                        sim->mic[iv]+=OFFSET;
+                        /* and is visited in pass two of dissolve */
+                        sim->visitbits[iw]|=SURFBIT(iv);
+                }
+        }
+        }  /* end of bits */
+        }  /* end of iw */
+        PROFSCAN(nscan);
+}
+
 /* routine for first pass through microstructure during dissolution */
 /* low and high indicate phase ID range to check for surface sites */
+/* Phase counts are kept up to date by setphase, and only pixels */
+/* on the frontier (see surface.c) are checked for surface sites */
 /* Called by dissolve */
-/* Calls chckedge */
+/* Calls marksurf */
 void passone(low,high,cycid,cshexflag)
         int low,high,cycid,cshexflag;
 {
-        int i,xid,yid,zid,phid,iph,edgef,phread,cshcyc;
+        int i,cshcyc;
 
-        /* gypready used to determine if any soluble gypsum remains */
-        if((low<=GYPSUM)&&(GYPSUM<=high)){
-                gypready=0;
-        }
-	/* Zero out count for the relevant phases */
-	for(i=low;i<=high;i++){
-		count[i]=0;
-	}
-        /* Scan the entire 3-D microstructure */
-        for(xid=0;xid<SYSIZE;xid++){
-        for(yid=0;yid<SYSIZE;yid++){
-        for(zid=0;zid<SYSIZE;zid++){
-
-	phread=mic[xid][yid][zid];
 	/* Update heat data and water consumed for solid CSH */
-	if((cshexflag==1)&&(phread==CSH)){
-		cshcyc=cshage[xid][yid][zid];
-		if(cshcyc>0){
-			heatsum+=heatf[CSH]/molarvcsh[cshcyc];
-			molesh2o+=watercsh[cshcyc]/molarvcsh[cshcyc];
-		}
-	}
-        /* Identify phase and update count */
-        phid=60;
-        for(i=low;((i<=high)&&(phid==60));i++){
-
-                if(mic [xid][yid][zid]==i){
-                        phid=i;
-                        /* Update count for this phase */
-                        count[i]+=1;
-                        if((i==GYPSUM)||(i==GYPSUMS)){
-                                gypready+=1;
-                        }
-                        /* If first cycle, then accumulate initial counts */
-                        if((cycid==1)||((cycid==0)&&(ncyc==0))){
-				countinit[i]+=1;
-                                if(i==POROSITY){porinit+=1;}
-				/* Ordered in terms of likely volume fractions */
-				/* (largest to smallest) to speed execution */
-                                else if(i==C3S){c3sinit+=1;}
-                                else if(i==C2S){c2sinit+=1;}
-                                else if(i==C3A){c3ainit+=1;}
-                                else if(i==C4AF){c4afinit+=1;}
-                                else if(i==GYPSUM){ncsbar+=1;}
-                                else if(i==GYPSUMS){ncsbar+=1;}
-                                else if(i==ANHYDRITE){anhinit+=1;}
-                                else if(i==HEMIHYD){heminit+=1;}
-                                else if(i==POZZ){nfill+=1;}
-                                else if(i==SLAG){slaginit+=1;}
-                                else if(i==ETTR){netbar+=1;}
-                                else if(i==ETTRC4AF){netbar+=1;}
+        if(cshexflag==1){
+                for(cshcyc=1;cshcyc<MAXCYC;cshcyc++){
+                        if(simt->ncshage[cshcyc]>0){
+                                sim->heatsum+=(float)simt->ncshage[cshcyc]*sim->heatf[CSH]/sim->molarvcsh[cshcyc];
+                                sim->molesh2o+=(float)simt->ncshage[cshcyc]*sim->watercsh[cshcyc]/sim->molarvcsh[cshcyc];
                         }
                 }
         }
 
-        if(phid!=60){
-                /* If phase is soluble, see if it is in contact with porosity */
-                if((cycid!=0)&&(soluble[phid]==1)){
-                        edgef=chckedge(xid,yid,zid);
-                        if(edgef==1){
-/* Surface eligible species has an ID OFFSET greater than its original value */
-                                mic [xid][yid][zid]+=OFFSET;
-                        }
-                }
+        /* If first cycle, then accumulate initial counts */
+        if((cycid==1)||((cycid==0)&&(sim->ncyc==0))){
+        for(i=low;i<=high;i++){
+		sim->countinit[i]+=simt->count[i];
+                if(i==POROSITY){sim->porinit+=simt->count[i];}
+                else if(i==C3S){sim->c3sinit+=simt->count[i];}
+                else if(i==C2S){sim->c2sinit+=simt->count[i];}
+                else if(i==C3A){sim->c3ainit+=simt->count[i];}
+                else if(i==C4AF){sim->c4afinit+=simt->count[i];}
+                else if(i==GYPSUM){sim->ncsbar+=simt->count[i];}
+                else if(i==GYPSUMS){sim->ncsbar+=simt->count[i];}
+                else if(i==ANHYDRITE){sim->anhinit+=simt->count[i];}
+                else if(i==HEMIHYD){sim->heminit+=simt->count[i];}
+                else if(i==POZZ){sim->nfill+=simt->count[i];}
+                else if(i==SLAG){sim->slaginit+=simt->count[i];}
+                else if(i==ETTR){sim->netbar+=simt->count[i];}
+                else if(i==ETTRC4AF){sim->netbar+=simt->count[i];}
+        }
+        }
+        if(cycid!=0){
+                marksurf(low,high);
         }
-        }  /* end of zid */
-        }  /* end of yid */
-        }  /* end of xid */
 }
 
 /* routine to locate a diffusing CSH species near dissolution source */
 /* at (xcur,ycur,zcur) */
 /* Called by dissolve */
-/* Calls no other routines */
+/* Calls boxpore, setphase and addant */
 int loccsh(xcur,ycur,zcur,extent)
         int xcur,ycur,zcur,extent;
 {
        	int xpmax,ypmax,effort,tries,xmod,ymod,zmod;
-       	struct ants *antnew;
 
        	effort=0;    /* effort indicates if appropriate location found */
        	tries=0;
-       	/* 500 tries in immediate vicinity */
-       	while((effort==0)&&(tries<500)){
+        /* pick among the pore pixels of the box, or else make */
+        /* 500 tries in immediate vicinity */
+        if(sim->placemode==PLACEINDEX){
+                effort=boxpore(xcur,ycur,zcur,extent,&xmod,&ymod,&zmod);
+        }
+       	while((sim->placemode!=PLACEINDEX)&&(effort==0)&&(tries<500)){
                 tries+=1;
-                xmod=(-extent)+(int)((2.*(float)extent+1.)*ran1(seed));
-                ymod=(-extent)+(int)((2.*(float)extent+1.)*ran1(seed));
-                zmod=(-extent)+(int)((2.*(float)extent+1.)*ran1(seed));
+                xmod=(-extent)+(int)((2.*(float)extent+1.)*ran1(simt->seed));
+                ymod=(-extent)+(int)((2.*(float)extent+1.)*ran1(simt->seed));
+                zmod=(-extent)+(int)((2.*(float)extent+1.)*ran1(simt->seed));
                 if(xmod>extent){xmod=extent;}
                 if(ymod>extent){ymod=extent;}
                 if(zmod>extent){zmod=extent;}
@@ -762,25 +610,17 @@ int loccsh(xcur,ycur,zcur,extent)
                 if(ymod<0){ymod+=SYSIZE;}
                 else if(ymod>=SYSIZE){ymod-=SYSIZE;}
 
-                if(mic[xmod][ymod][zmod]==POROSITY){
+                if(sim->mic[VOXEL(xmod,ymod,zmod)]==POROSITY){
                         effort=1;
-                        mic[xmod][ymod][zmod]=DIFFCSH;
-                        nmade+=1;
-                        ngoing+=1;
-                        /* Add this diffusing species to the linked list */
-                        antnew=(struct ants *)malloc(sizeof(struct ants));
-                        antnew->x=xmod;
-                        antnew->y=ymod;
-                        antnew->z=zmod;
-                        antnew->id=DIFFCSH;
-			antnew->cycbirth=cyccnt;
-                     /* Now connect this ant structure to end of linked list */
-                        antnew->prevant=tailant;
-                        tailant->nextant=antnew;
-                        antnew->nextant=NULL;
-                        tailant=antnew;
                 }
         }
+        if(effort){
+                setphase(xmod,ymod,zmod,DIFFCSH);
+                sim->nmade+=1;
+                sim->ngoing+=1;
+                /* Add this diffusing species to the pool */
+                addant(xmod,ymod,zmod,DIFFCSH);
+        }
        	return(effort);
 }
 
@@ -793,6 +633,7 @@ int countbox(boxsize,qx,qy,qz)
 {
         int nfound,ix,iy,iz,qxlo,qxhi,qylo,qyhi,qzlo,qzhi;
         int hx,hy,hz,boxhalf;
+        char *row;
 
         boxhalf=boxsize/2;
         nfound=0;
@@ -812,12 +653,13 @@ int countbox(boxsize,qx,qy,qz)
                 hy=iy;
                 if(hy<0){hy+=SYSIZE;}
                 else if(hy>=SYSIZE){hy-=SYSIZE;}
+                row=&sim->mic[VOXEL(hx,hy,0)];
         for(iz=qzlo;iz<=qzhi;iz++){
                 hz=iz;
                 if(hz<0){hz+=SYSIZE;}
                 else if(hz>=SYSIZE){hz-=SYSIZE;}
                 /* Count if porosity, diffusing species, or empty porosity */
-                if((mic [hx] [hy] [hz]<C3S)||(mic[hx] [hy] [hz]>ABSGYP)){
+                if((row[hz]<C3S)||(row[hz]>ABSGYP)){
                         nfound+=1;
                	}
         }
@@ -837,6 +679,7 @@ int countboxc(boxsize,qx,qy,qz)
 {
         int nfound,ix,iy,iz,qxlo,qxhi,qylo,qyhi,qzlo,qzhi;
         int hx,hy,hz,boxhalf;
+        char *row;
 
         boxhalf=boxsize/2;
         nfound=0;
@@ -856,12 +699,13 @@ int countboxc(boxsize,qx,qy,qz)
                 hy=iy;
                 if(hy<0){hy+=SYSIZE;}
                 else if(hy>=SYSIZE){hy-=SYSIZE;}
+                row=&sim->mic[VOXEL(hx,hy,0)];
         for(iz=qzlo;iz<=qzhi;iz++){
                 hz=iz;
                 if(hz<0){hz+=SYSIZE;}
                 else if(hz>=SYSIZE){hz-=SYSIZE;}
                 /* Count if not cement clinker */
-                if((mic [hx] [hy] [hz]<C3S)||(mic[hx] [hy] [hz]>POZZ)){
+                if((row[hz]<C3S)||(row[hz]>POZZ)){
                         nfound+=1;
                	}
         }
@@ -872,112 +716,104 @@ int countboxc(boxsize,qx,qy,qz)
 
 /* routine to create ndesire pixels of empty pore space to simulate */
 /* self-desiccation */
+/* The pore pixels with the most porosity in the surrounding cube are */
+/* emptied; a histogram of the counts gives the smallest count to be */
+/* emptied, and the pixels with that count are chosen in lattice order */
+/* as in earlier versions, or at random if the environment variable */
+/* CEMHYD_INERTTIES is set to random */
 /* Called by dissolve */
-/* Calls countbox */
+/* Calls boxinit, boxcount, countbox, setphase, logmsg and logflush */
 void makeinert(ndesire)
         long int ndesire;
 {
-        struct togo *headtogo,*tailtogo,*newtogo,*lasttogo,*onetogo;
-        long int idesire;
-        int px,py,pz,placed,cntpore,cntmax;
-
-        /* First allocate the first element of the linked list */
-        headtogo=(struct togo *)malloc(sizeof(struct togo));
-        headtogo->x=headtogo->y=headtogo->z=(-1);
-        headtogo->npore=0;
-        headtogo->nexttogo=NULL;
-        headtogo->prevtogo=NULL;
-        tailtogo=headtogo;
-        cntmax=0;
-
-        printf("In makeinert with %ld needed elements \n",ndesire);
-        fflush(stdout);
-        /* Add needed number of elements to the end of the list */
-        for(idesire=2;idesire<=ndesire;idesire++){
-                newtogo=(struct togo *)malloc(sizeof(struct togo));
-                newtogo->npore=0;
-                newtogo->x=newtogo->y=newtogo->z=(-1);
-                tailtogo->nexttogo=newtogo;
-                newtogo->prevtogo=tailtogo;
-                tailtogo=newtogo;
+        long int nsite[CUBEMAX*CUBEMAX*CUBEMAX+1],npore,ipore,nabove,ntie,nseen;
+        int px,py,pz,cntpore,cntmax,cntcut,randties;
+        unsigned short *cntsite;
+        char *envties;
+
+        logmsg(LOGDISSOLVE,LOGDEBUG,"In makeinert with %ld needed elements \n",ndesire);
+        logflush();
+        envties=getenv("CEMHYD_INERTTIES");
+        randties=((envties!=NULL)&&(strcmp(envties,"random")==0));
+        npore=simt->count[POROSITY];
+        cntsite=(unsigned short *)malloc((npore+1)*sizeof(unsigned short));
+        if(cntsite==NULL){
+                logmsg(LOGDISSOLVE,LOGERROR,"Unable to allocate memory for pore site counts \n");
+                exit(1);
         }
+        for(cntpore=0;cntpore<=(CUBEMAX*CUBEMAX*CUBEMAX);cntpore++){
+                nsite[cntpore]=0;
+        }
+        cntmax=0;
 
-        /* Now scan the microstructure and rank the sites */
+        /* Now scan the microstructure and tally the site values */
+        boxinit();
+        ipore=0;
         for(px=0;px<SYSIZE;px++){
         for(py=0;py<SYSIZE;py++){
         for(pz=0;pz<SYSIZE;pz++){
-                if(mic[px][py][pz]==POROSITY){
-                        cntpore=countbox(cubesize,px,py,pz);
+                if(sim->mic[VOXEL(px,py,pz)]==POROSITY){
+                        cntpore=boxcount(sim->cubesize,px,py,pz);
+#ifdef CHECKCOUNTS
+                        if(cntpore!=countbox(sim->cubesize,px,py,pz)){
+                                logmsg(LOGDISSOLVE,LOGERROR,"Box count at (%d,%d,%d) is %d but should be %d \n",px,py,pz,cntpore,countbox(sim->cubesize,px,py,pz));
+                                exit(1);
+                        }
+#endif
                         if(cntpore>cntmax){cntmax=cntpore;}
-                        /* Store this site value at appropriate place in */
-                        /* sorted linked list */
-                        if(cntpore>(tailtogo->npore)){
-                                placed=0;
-                                lasttogo=tailtogo;
-                                while(placed==0){
-                                        newtogo=lasttogo->prevtogo;
-                                        if(newtogo==NULL){
-                                                placed=2;
-                                        }
-                                        else{
-                                                if(cntpore<=(newtogo->npore)){
-                                                        placed=1;
-                                                }
-                                        }
-                                        if(placed==0){
-                                                lasttogo=newtogo;
-                                        }
-                                }
-                             onetogo=(struct togo *)malloc(sizeof(struct togo));
-                                onetogo->x=px;
-                                onetogo->y=py;
-                                onetogo->z=pz;
-                                onetogo->npore=cntpore;
-                                /* Insertion at the head of the list */
-                                if(placed==2){
-                                        onetogo->prevtogo=NULL;
-                                        onetogo->nexttogo=headtogo;
-                                        headtogo->prevtogo=onetogo;
-                                        headtogo=onetogo;
-                                }
-                               	if(placed==1){
-                                        onetogo->nexttogo=lasttogo;
-                                        onetogo->prevtogo=newtogo;
-                                        lasttogo->prevtogo=onetogo;
-                                        newtogo->nexttogo=onetogo;
-                                }
-                                /* Eliminate the last element */
-                                lasttogo=tailtogo;
-                                tailtogo=tailtogo->prevtogo;
-                                tailtogo->nexttogo=NULL;
-                                free(lasttogo);
+                        if(ipore>=npore){
+                                logmsg(LOGDISSOLVE,LOGERROR,"More pore pixels found than counted (%ld) \n",npore);
+                                exit(1);
                         }
+                        cntsite[ipore]=cntpore;
+                        ipore+=1;
+                        nsite[cntpore]+=1;
                 }
         }
         }
         }
 
-        /* Now remove the sites */
-        /* starting at the head of the list */
-        /* and deallocate all of the used memory */
-        for(idesire=1;idesire<=ndesire;idesire++){
-                px=headtogo->x;
-                py=headtogo->y;
-                pz=headtogo->z;
-                if(px!=(-1)){
-                        mic [px] [py] [pz]=EMPTYP;
-                        count[POROSITY]-=1;
-                       	count[EMPTYP]+=1;
+        /* Find the smallest site value to be emptied, the number of */
+        /* sites with larger values, and the number to empty with it */
+        nabove=0;
+        for(cntcut=cntmax;cntcut>0;cntcut--){
+                if((nabove+nsite[cntcut])>=ndesire){break;}
+                nabove+=nsite[cntcut];
+        }
+        ntie=ndesire-nabove;
+
+        /* Now remove the sites, in a second pass over the pore pixels */
+        ipore=0;
+        nseen=0;
+        for(px=0;px<SYSIZE;px++){
+        for(py=0;py<SYSIZE;py++){
+        for(pz=0;pz<SYSIZE;pz++){
+                if(sim->mic[VOXEL(px,py,pz)]==POROSITY){
+                        cntpore=cntsite[ipore];
+                        ipore+=1;
+                        if(cntpore>cntcut){
+                                setphase(px,py,pz,EMPTYP);
+                        }
+                        else if((cntpore==cntcut)&&(ntie>0)){
+                                /* Select ntie of the remaining sites */
+                                /* with this value with equal chances */
+                                if((randties==0)||(((double)(nsite[cntcut]-nseen)*ran1(simt->seed))<(double)ntie)){
+                                        setphase(px,py,pz,EMPTYP);
+                                        ntie-=1;
+                                }
+                                nseen+=1;
+                        }
                 }
-                lasttogo=headtogo;
-                headtogo=headtogo->nexttogo;
-                free(lasttogo);
-         }
+        }
+        }
+        }
+        free(cntsite);
+        PROFSCAN(2L*SYSIZE*SYSIZE*SYSIZE);
         /* If only small cubes of porosity were found, then adjust */
         /* cubesize to have a more efficient search in the future */
-        if(cubesize>CUBEMIN){
-                if((2*cntmax)<(cubesize*cubesize*cubesize)){
-                       cubesize-=2;
+        if(sim->cubesize>CUBEMIN){
+                if((2*cntmax)<(sim->cubesize*sim->cubesize*sim->cubesize)){
+                       sim->cubesize-=2;
                 }
        	}
 }
@@ -986,7 +822,7 @@ void makeinert(ndesire)
 /* routine to add extra SLAG CSH when SLAG reacts */
 /* SLAG located at (xpres,ypres,zpres) */
 /* Called by dissolve */
-/* Calls moveone and edgecnt */
+/* Calls moveone, edgecnt, randpore and logmsg */
 void extslagcsh(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
@@ -1009,8 +845,8 @@ void extslagcsh(xpres,ypres,zpres)
                 zchr=zpres;
                 action=0;
                 sump*=moveone(&xchr,&ychr,&zchr,&action,sump);
-                if(action==0){printf("Error in value of action in extpozz \n");}
-                check=mic[xchr][ychr][zchr];
+                if(action==0){logmsg(LOGDISSOLVE,LOGWARN,"Error in value of action in extpozz \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];
 		/* Determine the direction of the neighbor selected and */
 		/* the plates possible for growth */
 		if(xchr!=xpres){
@@ -1028,11 +864,9 @@ void extslagcsh(xpres,ypres,zpres)
 
                 /* if neighbor is porosity, locate the SLAG CSH there */
                 if(check==POROSITY){
-			if((faces[xpres][ypres][zpres]==0)||(mstest==faces[xpres][ypres][zpres])||(mstest2==faces[xpres][ypres][zpres])){
-	                        mic[xchr][ychr][zchr]=SLAGCSH;
-       		                faces[xchr][ychr][zchr]=faces[xpres][ypres][zpres];
-				count[SLAGCSH]+=1;
-				count[POROSITY]-=1;
+			if((sim->faces[VOXEL(xpres,ypres,zpres)]==0)||(mstest==sim->faces[VOXEL(xpres,ypres,zpres)])||(mstest2==sim->faces[VOXEL(xpres,ypres,zpres)])){
+	                        setphase(xchr,ychr,zchr,SLAGCSH);
+       		                sim->faces[VOXEL(xchr,ychr,zchr)]=sim->faces[VOXEL(xpres,ypres,zpres)];
                         	fchr=1;
 			}
                 }
@@ -1044,22 +878,13 @@ void extslagcsh(xpres,ypres,zpres)
         while(fchr==0){
                 tries+=1;
                 /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-           /* if location is porosity, locate the extra SLAG CSH there */
-                if(check==POROSITY){
+                /* if location is porosity, locate the extra SLAG CSH there */
+                if(randpore(&xchr,&ychr,&zchr)){
                         numnear=edgecnt(xchr,ychr,zchr,SLAG,CSH,SLAGCSH);
                         /* Be sure that one neighboring species is CSH or */
                         /* SLAG material */
                         if((tries>5000)||(numnear<26)){
-                                mic[xchr][ychr][zchr]=SLAGCSH;
-				count[SLAGCSH]+=1;
-				count[POROSITY]-=1;
+                                setphase(xchr,ychr,zchr,SLAGCSH);
                                 fchr=1;
                         }
                 }
@@ -1068,7 +893,8 @@ void extslagcsh(xpres,ypres,zpres)
 
 /* routine to implement a cycle of dissolution */
 /* Called by main program */
-/* Calls passone, loccsh, and makeinert */
+/* Calls passone, loccsh, makeinert, randpore, peekvisit, ranready, */
+/* ranahead, profstart, profstop, logmsg and logflush */
 void dissolve(cycle)
         int cycle;
 {
@@ -1077,7 +903,8 @@ void dissolve(cycle)
         int xpmax,ypmax,phid,phnew,plnew,cread;
         int i,xloop,yloop,zloop,ngood,ix1,iy1,xc,yc,valid,xc1,yc1;
         int iz1,zc,zc1,cycnew;
-        long int ctest;
+        long int ctest,ivisit;
+        long int aheadid[RANLANES];
         int placed,cshrand,ntrycsh,maxsulfate,msface;
         long int ncshgo,nsurf,suminit;
         long int xext,nhgd,npchext,nslagc3a=0;
@@ -1085,256 +912,264 @@ void dissolve(cycle)
         float dfact,dfact1,molesdh2o,h2oinit,heat4,fhemext,fc4aext;
         float pconvert,pc3scsh,pc2scsh,calcx,calcy,calcz,tdisfact;
         float frafm,frettr,frhyg,frtot,mc3ar,mc4ar,p3init;
-        FILE *phfile,*difffile;
-        struct ants *antadd;
+        FILE *difffile;
 
         /* Initialize variables */
-        nmade=0;
+        sim->nmade=0;
         npchext=ncshgo=cshrand=0;  /* counter for number of csh diffusing species to */
                         /* be located at random locations in microstructure */
-        heat_old=heat_new; /* new and old values for heat released */
+        sim->heat_old=sim->heat_new; /* new and old values for heat released */
 
-        /* Initialize dissolution and phase counters */
+        ranstream(RNGCYCLE,1,0);
+
+        /* Initialize dissolution counters */
         nsurf=0;
         for(i=0;i<=EMPTYP;i++){
-                discount[i]=0;
-                count[i]=0;
+                sim->discount[i]=0;
         }
+#ifdef CHECKCOUNTS
+        checkcounts();
+#endif
 
         /* Pass one- highlight all edge points which are soluble */
-        soluble[C3AH6]=0;
-	heatsum=molesh2o=0.0;
+        sim->soluble[C3AH6]=0;
+	sim->heatsum=sim->molesh2o=0.0;
+        profstart(PROFPASSONE);
         passone(0,EMPTYP,cycle,1);
-        printf("Returned from passone \n");
-        fflush(stdout);
+        profstop(PROFPASSONE);
+        logmsg(LOGDISSOLVE,LOGDEBUG,"Returned from passone \n");
+        logflush();
         
-        sulf_solid=count[GYPSUM]+count[GYPSUMS]+count[HEMIHYD]+count[ANHYDRITE];
+        sim->sulf_solid=simt->count[GYPSUM]+simt->count[GYPSUMS]+simt->count[HEMIHYD]+simt->count[ANHYDRITE];
         /* If first cycle, then determine all mixture proportions based */
         /* on user input and original microstructure */
         if(cycle==1){
                 /* Mass of cement in system */
-                cemmass=(specgrav[C3S]*(float)count[C3S]+specgrav[C2S]*
-                (float)count[C2S]+specgrav[C3A]*(float)count[C3A]+
-                specgrav[C4AF]*(float)count[C4AF]);
+                sim->cemmass=(sim->specgrav[C3S]*(float)simt->count[C3S]+sim->specgrav[C2S]*
+                (float)simt->count[C2S]+sim->specgrav[C3A]*(float)simt->count[C3A]+
+                sim->specgrav[C4AF]*(float)simt->count[C4AF]);
 	/*	+specgrav[GYPSUM]*
                 (float)count[GYPSUM]+specgrav[ANHYDRITE]*(float)
 		count[ANHYDRITE]+specgrav[HEMIHYD]*(float)count[HEMIHYD]); */
-                cemmasswgyp=(specgrav[C3S]*(float)count[C3S]+specgrav[C2S]*
-                (float)count[C2S]+specgrav[C3A]*(float)count[C3A]+
-                specgrav[C4AF]*(float)count[C4AF]+specgrav[GYPSUM]*
-                (float)count[GYPSUM]+specgrav[ANHYDRITE]*(float)
-		count[ANHYDRITE]+specgrav[HEMIHYD]*(float)count[HEMIHYD]); 
-                flyashmass=(specgrav[ASG]*(float)count[ASG]+specgrav[CAS2]*
-                (float)count[CAS2]+specgrav[POZZ]*(float)count[POZZ]);
-		CH_mass=specgrav[CH]*(float)count[CH];
+                sim->cemmasswgyp=(sim->specgrav[C3S]*(float)simt->count[C3S]+sim->specgrav[C2S]*
+                (float)simt->count[C2S]+sim->specgrav[C3A]*(float)simt->count[C3A]+
+                sim->specgrav[C4AF]*(float)simt->count[C4AF]+sim->specgrav[GYPSUM]*
+                (float)simt->count[GYPSUM]+sim->specgrav[ANHYDRITE]*(float)
+		simt->count[ANHYDRITE]+sim->specgrav[HEMIHYD]*(float)simt->count[HEMIHYD]); 
+                sim->flyashmass=(sim->specgrav[ASG]*(float)simt->count[ASG]+sim->specgrav[CAS2]*
+                (float)simt->count[CAS2]+sim->specgrav[POZZ]*(float)simt->count[POZZ]);
+		sim->CH_mass=sim->specgrav[CH]*(float)simt->count[CH];
                 /* Total mass in system neglecting single aggregate */
-                tot_mass=cemmass+(float)count[POROSITY]+specgrav[INERT]*
-                (float)count[INERT]+specgrav[CACL2]*(float)count[CACL2]+
-		specgrav[ASG]*(float)count[ASG]+
-		specgrav[SLAG]*(float)count[SLAG]+
-		specgrav[HEMIHYD]*(float)count[HEMIHYD]+
-		specgrav[ANHYDRITE]*(float)count[ANHYDRITE]+
-		specgrav[CAS2]*(float)count[CAS2]+
-		specgrav[CACO3]*(float)count[CACO3]+
-		specgrav[CSH]*(float)count[CSH]+
-		specgrav[GYPSUM]*(float)count[GYPSUM]+
-		specgrav[GYPSUMS]*(float)count[GYPSUMS]+
-		specgrav[POZZ]*(float)count[POZZ]+CH_mass;
+                tot_mass=sim->cemmass+(float)simt->count[POROSITY]+sim->specgrav[INERT]*
+                (float)simt->count[INERT]+sim->specgrav[CACL2]*(float)simt->count[CACL2]+
+		sim->specgrav[ASG]*(float)simt->count[ASG]+
+		sim->specgrav[SLAG]*(float)simt->count[SLAG]+
+		sim->specgrav[HEMIHYD]*(float)simt->count[HEMIHYD]+
+		sim->specgrav[ANHYDRITE]*(float)simt->count[ANHYDRITE]+
+		sim->specgrav[CAS2]*(float)simt->count[CAS2]+
+		sim->specgrav[CACO3]*(float)simt->count[CACO3]+
+		sim->specgrav[CSH]*(float)simt->count[CSH]+
+		sim->specgrav[GYPSUM]*(float)simt->count[GYPSUM]+
+		sim->specgrav[GYPSUMS]*(float)simt->count[GYPSUMS]+
+		sim->specgrav[POZZ]*(float)simt->count[POZZ]+sim->CH_mass;
                 /* water-to-cement ratio */
-		if(cemmass!=0.0){
-	                w_to_c=(float)count[POROSITY]/(cemmass+
-			specgrav[GYPSUM]*(float)count[GYPSUM]+
-			specgrav[ANHYDRITE]*(float)count[ANHYDRITE]+
-			specgrav[HEMIHYD]*(float)count[HEMIHYD]);
+		if(sim->cemmass!=0.0){
+	                sim->w_to_c=(float)simt->count[POROSITY]/(sim->cemmass+
+			sim->specgrav[GYPSUM]*(float)simt->count[GYPSUM]+
+			sim->specgrav[ANHYDRITE]*(float)simt->count[ANHYDRITE]+
+			sim->specgrav[HEMIHYD]*(float)simt->count[HEMIHYD]);
 		}
 		else{
-			w_to_c=0.0;
+			sim->w_to_c=0.0;
 		}
      /* totfract is the total cement volume count including calcium sulfates */
      /* fractwithfill is the total count of cement and solid fillers and */
      /*    mineral admixtures   DPB- 10/04 */
-		totfract=count[C3S]+count[C2S];
-		totfract+=(count[C3A]+count[C4AF]);
-		totfract+=(count[GYPSUM]+count[ANHYDRITE]+count[HEMIHYD]);
-		fractwithfill=totfract+count[CACO3]+count[SLAG]+count[INERT];
-		fractwithfill+=count[POZZ]+count[CAS2]+count[ASG]+count[CACL2];
-		totfract/=(float)SYSIZE;
-		totfract/=(float)SYSIZE;
-		totfract/=(float)SYSIZE;
-		fractwithfill/=(float)SYSIZE;
-		fractwithfill/=(float)SYSIZE;
-		fractwithfill/=(float)SYSIZE;
+		sim->totfract=simt->count[C3S]+simt->count[C2S];
+		sim->totfract+=(simt->count[C3A]+simt->count[C4AF]);
+		sim->totfract+=(simt->count[GYPSUM]+simt->count[ANHYDRITE]+simt->count[HEMIHYD]);
+		sim->fractwithfill=sim->totfract+simt->count[CACO3]+simt->count[SLAG]+simt->count[INERT];
+		sim->fractwithfill+=simt->count[POZZ]+simt->count[CAS2]+simt->count[ASG]+simt->count[CACL2];
+		sim->totfract/=(float)SYSIZE;
+		sim->totfract/=(float)SYSIZE;
+		sim->totfract/=(float)SYSIZE;
+		sim->fractwithfill/=(float)SYSIZE;
+		sim->fractwithfill/=(float)SYSIZE;
+		sim->fractwithfill/=(float)SYSIZE;
 		/* Adjust masses for presence of aggregates in concrete */
-                mass_water=(1.-mass_agg)*(float)count[POROSITY]/tot_mass;
-		mass_CH=(1.-mass_agg)*CH_mass/tot_mass;
+                sim->mass_water=(1.-sim->mass_agg)*(float)simt->count[POROSITY]/tot_mass;
+		sim->mass_CH=(1.-sim->mass_agg)*sim->CH_mass/tot_mass;
                 /* pozzolan-to-cement ratio */
-		if(cemmass!=0.0){
-	                s_to_c=(float)(count[INERT]*specgrav[INERT]+
-			count[CACL2]*specgrav[CACL2]+count[ASG]*specgrav[ASG]+
-                        count[CAS2]*specgrav[CAS2]+
-                        count[CACO3]*specgrav[CACO3]+
-                        count[SLAG]*specgrav[SLAG]+
-       		        count[POZZ]*specgrav[POZZ])/cemmass;
+		if(sim->cemmass!=0.0){
+	                sim->s_to_c=(float)(simt->count[INERT]*sim->specgrav[INERT]+
+			simt->count[CACL2]*sim->specgrav[CACL2]+simt->count[ASG]*sim->specgrav[ASG]+
+                        simt->count[CAS2]*sim->specgrav[CAS2]+
+                        simt->count[CACO3]*sim->specgrav[CACO3]+
+                        simt->count[SLAG]*sim->specgrav[SLAG]+
+       		        simt->count[POZZ]*sim->specgrav[POZZ])/sim->cemmass;
 		}
 		else{
-			s_to_c=0.0;
+			sim->s_to_c=0.0;
 		}
                 /* Conversion factor to kJ/kg for heat produced */
-		if(cemmass!=0.0){
-			heatfill=(float)(count[INERT]+count[SLAG]+count[POZZ]+count[CACL2]+count[ASG]+count[CAS2]+count[CACO3])/cemmasswgyp;
+		if(sim->cemmass!=0.0){
+			heatfill=(float)(simt->count[INERT]+simt->count[SLAG]+simt->count[POZZ]+simt->count[CACL2]+simt->count[ASG]+simt->count[CAS2]+simt->count[CACO3])/sim->cemmasswgyp;
 		}
 		else{
 			heatfill=0.0;
 		}
-		if(w_to_c>0.01){
-	                heat_cf=0.001*(0.3125+w_to_c+heatfill);
+		if(sim->w_to_c>0.01){
+	                sim->heat_cf=0.001*(0.3125+sim->w_to_c+heatfill);
 		}
 		else{
 			/* Need volume per 1 gram of silica fume */
-			heat_cf=0.001*((1./specgrav[POZZ])+(float)(count[POROSITY]+count[CH]+count[INERT])/(specgrav[POZZ]*(float)count[POZZ]));
+			sim->heat_cf=0.001*((1./sim->specgrav[POZZ])+(float)(simt->count[POROSITY]+simt->count[CH]+simt->count[INERT])/(sim->specgrav[POZZ]*(float)simt->count[POZZ]));
 		}
-                mass_fill_pozz=(1.-mass_agg)*(float)(count[POZZ]*specgrav[POZZ])/tot_mass;
-                mass_fill=(1.-mass_agg)*(float)(count[INERT]*specgrav[INERT]+
-		count[ASG]*specgrav[ASG]+count[SLAG]*specgrav[SLAG]+
-                count[CAS2]*specgrav[CAS2]+count[POZZ]*specgrav[POZZ]+
-                count[CACL2]*specgrav[CACL2]+count[CACO3]*specgrav[CACO3])/tot_mass;
-                printf("Calculated w/c is %.4f\n",w_to_c);
-                printf("Calculated s/c is %.4f \n",s_to_c);
-                printf("Calculated heat conversion factor is %f \n",heat_cf);
-  printf("Calculated mass fractions of water and filler are %.4f  and %.4f \n",
-                mass_water,mass_fill);
+		/* Heat is summed over the whole system, so refer it */
+		/* to a 100^3 system */
+		sim->heat_cf/=sim->sysvolfact;
+                sim->mass_fill_pozz=(1.-sim->mass_agg)*(float)(simt->count[POZZ]*sim->specgrav[POZZ])/tot_mass;
+                sim->mass_fill=(1.-sim->mass_agg)*(float)(simt->count[INERT]*sim->specgrav[INERT]+
+		simt->count[ASG]*sim->specgrav[ASG]+simt->count[SLAG]*sim->specgrav[SLAG]+
+                simt->count[CAS2]*sim->specgrav[CAS2]+simt->count[POZZ]*sim->specgrav[POZZ]+
+                simt->count[CACL2]*sim->specgrav[CACL2]+simt->count[CACO3]*sim->specgrav[CACO3])/tot_mass;
+                logmsg(LOGDISSOLVE,LOGINFO,"Calculated w/c is %.4f\n",sim->w_to_c);
+                logmsg(LOGDISSOLVE,LOGINFO,"Calculated s/c is %.4f \n",sim->s_to_c);
+                logmsg(LOGDISSOLVE,LOGINFO,"Calculated heat conversion factor is %f \n",sim->heat_cf);
+  logmsg(LOGDISSOLVE,LOGINFO,"Calculated mass fractions of water and filler are %.4f  and %.4f \n",
+                sim->mass_water,sim->mass_fill);
         }
 
         molesdh2o=0.0;
-       	alpha=0.0;      /* degree of hydration */
+       	sim->alpha=0.0;      /* degree of hydration */
         /* heat4 contains measured heat release for C4AF hydration from  */
         /* Fukuhara et al., Cem. and Conc. Res. article */
         heat4=0.0;
         mass_now=0.0;    /* total cement mass corrected for hydration */
-        suminit=c3sinit+c2sinit+c3ainit+c4afinit;
+        suminit=sim->c3sinit+sim->c2sinit+sim->c3ainit+sim->c4afinit;
 /*        suminit=c3sinit+c2sinit+c3ainit+c4afinit+ncsbar+anhinit+heminit; */
         /* ctest is number of gypsum likely to form ettringite */
         /* 1 unit of C3A can react with 2.5 units of Gypsum */
-        ctest=count[DIFFGYP];
-        printf("ctest is %ld\n",ctest);
-        	fflush(stdout);
-        if((float)ctest>(2.5*(float)(count[DIFFC3A]+count[DIFFC4A]))){
-                 ctest=2.5*(float)(count[DIFFC3A]+count[DIFFC4A]);
+        ctest=simt->count[DIFFGYP];
+        logmsg(LOGDISSOLVE,LOGDEBUG,"ctest is %ld\n",ctest);
+        	logflush();
+        if((float)ctest>(2.5*(float)(simt->count[DIFFC3A]+simt->count[DIFFC4A]))){
+                 ctest=2.5*(float)(simt->count[DIFFC3A]+simt->count[DIFFC4A]);
         }
        	for(i=0;i<=EMPTYP;i++){
                 if((i!=0)&&(i<=ABSGYP)&&(i!=INERTAGG)&&(i!=CSH)){
-                        heatsum+=(float)(count[i]-countinit[i])*heatf[i]/molarv[i];
+                        sim->heatsum+=(float)(simt->count[i]-sim->countinit[i])*sim->heatf[i]/sim->molarv[i];
                 /* Tabulate moles of H2O consumed by reactions so far */
-                        molesh2o+=(float)(count[i]-countinit[i])*waterc[i]/molarv[i];
+                        sim->molesh2o+=(float)(simt->count[i]-sim->countinit[i])*sim->waterc[i]/sim->molarv[i];
                 }
                 /* assume that all C3A which can, does form ettringite */
                 if(i==DIFFC3A){
-           heatsum+=((float)count[DIFFC3A]-(float)ctest/2.5)*heatf[C3A]/molarv[C3A];
+           sim->heatsum+=((float)simt->count[DIFFC3A]-(float)ctest/2.5)*sim->heatf[C3A]/sim->molarv[C3A];
                 }
                 /* assume that all C4A which can, does form ettringite */
                 if(i==DIFFC4A){
-           heatsum+=((float)count[DIFFC4A]-(float)ctest/2.5)*heatf[C4AF]/molarv[C4AF];
+           sim->heatsum+=((float)simt->count[DIFFC4A]-(float)ctest/2.5)*sim->heatf[C4AF]/sim->molarv[C4AF];
                 }
                 /* assume all gypsum which can, does form ettringite */
                 /* rest will remain as gypsum */
                 if(i==DIFFGYP){
-                 heatsum+=(float)(count[DIFFGYP]-ctest)*heatf[GYPSUM]/molarv[GYPSUM];
+                 sim->heatsum+=(float)(simt->count[DIFFGYP]-ctest)*sim->heatf[GYPSUM]/sim->molarv[GYPSUM];
 			/* 3.3 is the molar expansion from GYPSUM to ETTR */
-                        heatsum+=(float)ctest*3.30*heatf[ETTR]/molarv[ETTR];
-                        molesdh2o+=(float)ctest*3.30*waterc[ETTR]/molarv[ETTR];
+                        sim->heatsum+=(float)ctest*3.30*sim->heatf[ETTR]/sim->molarv[ETTR];
+                        molesdh2o+=(float)ctest*3.30*sim->waterc[ETTR]/sim->molarv[ETTR];
                 }
                	else if(i==DIFFCH){
-                        heatsum+=(float)count[DIFFCH]*heatf[CH]/molarv[CH];
-                        molesdh2o+=(float)count[DIFFCH]*waterc[CH]/molarv[CH];
+                        sim->heatsum+=(float)simt->count[DIFFCH]*sim->heatf[CH]/sim->molarv[CH];
+                        molesdh2o+=(float)simt->count[DIFFCH]*sim->waterc[CH]/sim->molarv[CH];
                 }
                	else if(i==DIFFFH3){
-                        heatsum+=(float)count[DIFFFH3]*heatf[FH3]/molarv[FH3];
-                        molesdh2o+=(float)count[DIFFFH3]*waterc[FH3]/molarv[FH3];
+                        sim->heatsum+=(float)simt->count[DIFFFH3]*sim->heatf[FH3]/sim->molarv[FH3];
+                        molesdh2o+=(float)simt->count[DIFFFH3]*sim->waterc[FH3]/sim->molarv[FH3];
                 }
                 else if(i==DIFFCSH){
 			/* use current CSH properties */
-                        heatsum+=(float)count[DIFFCSH]*heatf[CSH]/molarvcsh[cycle];
-                        molesdh2o+=(float)count[DIFFCSH]*watercsh[cycle]/molarvcsh[cycle];
+                        sim->heatsum+=(float)simt->count[DIFFCSH]*sim->heatf[CSH]/sim->molarvcsh[cycle];
+                        molesdh2o+=(float)simt->count[DIFFCSH]*sim->watercsh[cycle]/sim->molarvcsh[cycle];
                 }
                	else if(i==DIFFETTR){
-                        heatsum+=(float)count[DIFFETTR]*heatf[ETTR]/molarv[ETTR];
-                        molesdh2o+=(float)count[DIFFETTR]*waterc[ETTR]/molarv[ETTR];
+                        sim->heatsum+=(float)simt->count[DIFFETTR]*sim->heatf[ETTR]/sim->molarv[ETTR];
+                        molesdh2o+=(float)simt->count[DIFFETTR]*sim->waterc[ETTR]/sim->molarv[ETTR];
                 }
                	else if(i==DIFFCACL2){
-                        heatsum+=(float)count[DIFFCACL2]*heatf[CACL2]/molarv[CACL2];
-                        molesdh2o+=(float)count[DIFFCACL2]*waterc[CACL2]/molarv[CACL2];
+                        sim->heatsum+=(float)simt->count[DIFFCACL2]*sim->heatf[CACL2]/sim->molarv[CACL2];
+                        molesdh2o+=(float)simt->count[DIFFCACL2]*sim->waterc[CACL2]/sim->molarv[CACL2];
                 }
                	else if(i==DIFFAS){
-                        heatsum+=(float)count[DIFFAS]*heatf[ASG]/molarv[ASG];
-                        molesdh2o+=(float)count[DIFFAS]*waterc[ASG]/molarv[ASG];
+                        sim->heatsum+=(float)simt->count[DIFFAS]*sim->heatf[ASG]/sim->molarv[ASG];
+                        molesdh2o+=(float)simt->count[DIFFAS]*sim->waterc[ASG]/sim->molarv[ASG];
                 }
                	else if(i==DIFFCAS2){
-                        heatsum+=(float)count[DIFFCAS2]*heatf[CAS2]/molarv[CAS2];
-                        molesdh2o+=(float)count[DIFFCAS2]*waterc[CAS2]/molarv[CAS2];
+                        sim->heatsum+=(float)simt->count[DIFFCAS2]*sim->heatf[CAS2]/sim->molarv[CAS2];
+                        molesdh2o+=(float)simt->count[DIFFCAS2]*sim->waterc[CAS2]/sim->molarv[CAS2];
                 }
 		/* assume that all diffusing anhydrite leads to gypsum formation */
                	else if(i==DIFFANH){
-                        heatsum+=(float)count[DIFFANH]*heatf[GYPSUMS]/molarv[GYPSUMS];
+                        sim->heatsum+=(float)simt->count[DIFFANH]*sim->heatf[GYPSUMS]/sim->molarv[GYPSUMS];
 			/* 2 moles of water per mole of gypsum formed */
-                        molesdh2o+=(float)count[DIFFANH]*2.0/molarv[GYPSUMS];
+                        molesdh2o+=(float)simt->count[DIFFANH]*2.0/sim->molarv[GYPSUMS];
                 }
 		/* assume that all diffusing hemihydrate leads to gypsum formation */
                	else if(i==DIFFHEM){
-                        heatsum+=(float)count[DIFFHEM]*heatf[GYPSUMS]/molarv[GYPSUMS];
+                        sim->heatsum+=(float)simt->count[DIFFHEM]*sim->heatf[GYPSUMS]/sim->molarv[GYPSUMS];
 			/* 1.5 moles of water per mole of gypsum formed */
-                        molesdh2o+=(float)count[DIFFHEM]*1.5/molarv[GYPSUMS];
+                        molesdh2o+=(float)simt->count[DIFFHEM]*1.5/sim->molarv[GYPSUMS];
                 }
                 else if(i==C3S){
-                        alpha+=(float)(c3sinit-count[C3S]);
-                        mass_now+=specgrav[C3S]*(float)count[C3S];
-                        heat4+=.517*(float)(c3sinit-count[C3S])*specgrav[C3S];
+                        sim->alpha+=(float)(sim->c3sinit-simt->count[C3S]);
+                        mass_now+=sim->specgrav[C3S]*(float)simt->count[C3S];
+                        heat4+=.517*(float)(sim->c3sinit-simt->count[C3S])*sim->specgrav[C3S];
                 }
                 else if(i==C2S){
-                        alpha+=(float)(c2sinit-count[C2S]);
-                        mass_now+=specgrav[C2S]*(float)count[C2S];
-                        heat4+=.262*(float)(c2sinit-count[C2S])*specgrav[C2S];
+                        sim->alpha+=(float)(sim->c2sinit-simt->count[C2S]);
+                        mass_now+=sim->specgrav[C2S]*(float)simt->count[C2S];
+                        heat4+=.262*(float)(sim->c2sinit-simt->count[C2S])*sim->specgrav[C2S];
                 }
                 else if(i==C3A){
-                        alpha+=(float)(c3ainit-count[C3A]);
-                        mass_now+=specgrav[C3A]*(float)count[C3A];
-                        mc3ar=(c3ainit-(float)count[C3A])/molarv[C3A];
-                        mc4ar=(c4afinit-(float)count[C4AF])/molarv[C4AF];
+                        sim->alpha+=(float)(sim->c3ainit-simt->count[C3A]);
+                        mass_now+=sim->specgrav[C3A]*(float)simt->count[C3A];
+                        mc3ar=(sim->c3ainit-(float)simt->count[C3A])/sim->molarv[C3A];
+                        mc4ar=(sim->c4afinit-(float)simt->count[C4AF])/sim->molarv[C4AF];
                         if((mc3ar+mc4ar)>0.0){
-                        	frhyg=(mc3ar/(mc3ar+mc4ar))*(float)count[C3AH6]/molarv[C3AH6];
+                        	frhyg=(mc3ar/(mc3ar+mc4ar))*(float)simt->count[C3AH6]/sim->molarv[C3AH6];
                         }
                         else{
                         	frhyg=0.0;
                         }
-                        frettr=(float)count[ETTR]/molarv[ETTR];
-			frafm=(float)count[AFM]/molarv[AFM];
+                        frettr=(float)simt->count[ETTR]/sim->molarv[ETTR];
+			frafm=(float)simt->count[AFM]/sim->molarv[AFM];
                         frtot=frafm+frettr+frhyg;
                         if(frtot>0.0){
                         frettr/=frtot;
                         frafm/=frtot;
                         frhyg/=frtot;
-                        heat4+=frafm*1.144*(float)(c3ainit-count[C3A])*specgrav[C3A];
-                        heat4+=frhyg*0.908*(float)(c3ainit-count[C3A])*specgrav[C3A];
-                        heat4+=frettr*1.672*(float)(c3ainit-count[C3A])*specgrav[C3A];
+                        heat4+=frafm*1.144*(float)(sim->c3ainit-simt->count[C3A])*sim->specgrav[C3A];
+                        heat4+=frhyg*0.908*(float)(sim->c3ainit-simt->count[C3A])*sim->specgrav[C3A];
+                        heat4+=frettr*1.672*(float)(sim->c3ainit-simt->count[C3A])*sim->specgrav[C3A];
                         }
                 }
                	else if(i==C4AF){
-                        alpha+=(float)(c4afinit-count[C4AF]);
-                        mass_now+=specgrav[C4AF]*(float)count[C4AF];
-                        mc3ar=(c3ainit-(float)count[C3A])/molarv[C3A];
-                        mc4ar=(c4afinit-(float)count[C4AF])/molarv[C4AF];
+                        sim->alpha+=(float)(sim->c4afinit-simt->count[C4AF]);
+                        mass_now+=sim->specgrav[C4AF]*(float)simt->count[C4AF];
+                        mc3ar=(sim->c3ainit-(float)simt->count[C3A])/sim->molarv[C3A];
+                        mc4ar=(sim->c4afinit-(float)simt->count[C4AF])/sim->molarv[C4AF];
                         if((mc3ar+mc4ar)>0.0){
-                        	frhyg=(mc4ar/(mc3ar+mc4ar))*(float)count[C3AH6]/molarv[C3AH6];
+                        	frhyg=(mc4ar/(mc3ar+mc4ar))*(float)simt->count[C3AH6]/sim->molarv[C3AH6];
                         }
                         else{
                         	frhyg=0.0;
                         }
-                        frettr=(float)count[ETTRC4AF]/molarv[ETTRC4AF];
+                        frettr=(float)simt->count[ETTRC4AF]/sim->molarv[ETTRC4AF];
                         frtot=frettr+frhyg;
                         if(frtot>0.0){
                         frettr/=frtot;
                         frhyg/=frtot;
-                        heat4+=frhyg*.418*(float)(c4afinit-count[C4AF])*specgrav[C4AF];
-                        heat4+=frettr*.725*(float)(c4afinit-count[C4AF])*specgrav[C4AF];
+                        heat4+=frhyg*.418*(float)(sim->c4afinit-simt->count[C4AF])*sim->specgrav[C4AF];
+                        heat4+=frettr*.725*(float)(sim->c4afinit-simt->count[C4AF])*sim->specgrav[C4AF];
                         }
                 }
 /*               	else if(i==GYPSUM){
@@ -1345,236 +1180,232 @@ void dissolve(cycle)
                	else if(i==ANHYDRITE){
                      /*  alpha+=(float)(anhinit-count[ANHYDRITE]);
                        mass_now+=specgrav[ANHYDRITE]*(float)count[ANHYDRITE]; */
-                       heat4+=.187*(float)(anhinit-count[ANHYDRITE])*specgrav[ANHYDRITE];
+                       heat4+=.187*(float)(sim->anhinit-simt->count[ANHYDRITE])*sim->specgrav[ANHYDRITE];
 			/* 2 moles of water consumed per mole of anhydrite reacted */
-                       molesh2o+=(float)(anhinit-count[ANHYDRITE])*2.0/molarv[ANHYDRITE];
+                       sim->molesh2o+=(float)(sim->anhinit-simt->count[ANHYDRITE])*2.0/sim->molarv[ANHYDRITE];
                 }
 		/* 0.132 kJ/g hemihydrate for hemihydrate-->gypsum conversion */
                	else if(i==HEMIHYD){
 /*                     alpha+=(float)(heminit-count[HEMIHYD]);
                        mass_now+=specgrav[HEMIHYD]*(float)count[HEMIHYD]; */
-                       heat4+=.132*(float)(heminit-count[HEMIHYD])*specgrav[HEMIHYD];
+                       heat4+=.132*(float)(sim->heminit-simt->count[HEMIHYD])*sim->specgrav[HEMIHYD];
 			/* 1.5 moles of water consumed per mole of anhydrite reacted */
-                       molesh2o+=(float)(heminit-count[HEMIHYD])*1.5/molarv[HEMIHYD];
+                       sim->molesh2o+=(float)(sim->heminit-simt->count[HEMIHYD])*1.5/sim->molarv[HEMIHYD];
                 }
         }
-	mass_fa_now = specgrav[ASG]*(float)count[ASG];
-	mass_fa_now += specgrav[CAS2]*(float)count[CAS2];
-	mass_fa_now += specgrav[POZZ]*(float)count[POZZ];
+	mass_fa_now = sim->specgrav[ASG]*(float)simt->count[ASG];
+	mass_fa_now += sim->specgrav[CAS2]*(float)simt->count[CAS2];
+	mass_fa_now += sim->specgrav[POZZ]*(float)simt->count[POZZ];
 	if(suminit!=0){
-	        alpha=alpha/(float)suminit;
+	        sim->alpha=sim->alpha/(float)suminit;
 	}
 	else{
-		alpha=0.0;
+		sim->alpha=0.0;
 	}
         /* Current degree of hydration on a mass basis */
-	if(cemmass!=0.0){
-	        alpha_cur=1.0-(mass_now/cemmass);
+	if(sim->cemmass!=0.0){
+	        sim->alpha_cur=1.0-(mass_now/sim->cemmass);
 	}
 	else{
-		alpha_cur=0.0;
+		sim->alpha_cur=0.0;
 	}
-	if(flyashmass!=0.0){
-	        alpha_fa_cur=1.0-(mass_fa_now/flyashmass);
+	if(sim->flyashmass!=0.0){
+	        sim->alpha_fa_cur=1.0-(mass_fa_now/sim->flyashmass);
 	}
 	else{
-		alpha_fa_cur=0.0;
+		sim->alpha_fa_cur=0.0;
 	}
-        h2oinit=(float)porinit/molarv[POROSITY];
+        h2oinit=(float)sim->porinit/sim->molarv[POROSITY];
 
 	/* Assume 780 J/g S for pozzolanic reaction */
 	/* Each unit of silica fume consumes 1.35 units of CH, */
 	/* so divide npr by 1.35 to get silca fume which has reacted */
-	heat4+=0.78*((float)npr/1.35)*specgrav[POZZ];
+	heat4+=0.78*((float)simt->npr/1.35)*sim->specgrav[POZZ];
 
 	/* Assume 800 J/g S for slag reaction */
 	/* Seems reasonable with measurements of Biernacki and Richardson */
-	heat4+=0.8*((float)nslagr)*specgrav[SLAG];
+	heat4+=0.8*((float)sim->nslagr)*sim->specgrav[SLAG];
 
 	/* Assume 800 J/g AS for stratlingite formation (DeLarrard) */
 	/* Each unit of AS consumes 1.3267 units of CH, */
 	/* so divide nasr by 1.3267 to get ASG which has reacted */
-	heat4+=0.80*((float)nasr/1.3267)*specgrav[ASG];
+	heat4+=0.80*((float)simt->nasr/1.3267)*sim->specgrav[ASG];
 
         /* Should be additional code here for heat release due to CAS2 to */
         /* stratlingite conversion, but data unavailable at this time */
 
         /* Adjust heat sum for water left in system */
-        water_left=(long int)((h2oinit-molesh2o)*molarv[POROSITY]+0.5);
-	countkeep=count[POROSITY];
-        heatsum+=(h2oinit-molesh2o-molesdh2o)*heatf[POROSITY];
-        if(cyccnt==0){
-           heatfile=fopen(heatname,"w");
-  fprintf(heatfile,"Cycle time(h) alpha_vol alpha_mass heat4(kJ/kg_solid) Gsratio2 G-s_ratio\n");
-           fclose(heatfile);
-        }
-        heat_new=heat4;     /* use heat4 for all adiabatic calculations */
+        sim->water_left=(long int)((h2oinit-sim->molesh2o)*sim->molarv[POROSITY]+0.5);
+	sim->countkeep=simt->count[POROSITY];
+        sim->heatsum+=(h2oinit-sim->molesh2o-molesdh2o)*sim->heatf[POROSITY];
+        if(sim->cyccnt==0){
+           outcreate(sim->heatname);
+  outprintf(sim->heatname,"Cycle time(h) alpha_vol alpha_mass heat4(kJ/kg_solid) Gsratio2 G-s_ratio\n");
+        }
+        sim->heat_new=heat4;     /* use heat4 for all adiabatic calculations */
                             /* due to best agreement with calorimetry data */
-        if(cyccnt==0){
-        chsfile=fopen(chshrname,"w");
-  fprintf(chsfile,"Cycle  time(h) alpha_mass  Chemical shrinkage (ml/g cement)\n");
-        fclose(chsfile);
+        if(sim->cyccnt==0){
+        outcreate(sim->chshrname);
+  outprintf(sim->chshrname,"Cycle  time(h) alpha_mass  Chemical shrinkage (ml/g cement)\n");
         }
-         chs_new=((float)(count[EMPTYP]+count[POROSITY]-water_left)*heat_cf/1000.);
+         sim->chs_new=((float)(simt->count[EMPTYP]+simt->count[POROSITY]-sim->water_left)*sim->heat_cf/1000.);
 /* 	if((molesh2o>h2oinit)&&(sealed==1)){  */
-        if(((water_left+water_off)<0)&&(sealed==1)){
-                printf("All water consumed at cycle %d \n",cyccnt);
-                fflush(stdout);
+        if(((sim->water_left+sim->water_off)<0)&&(sim->sealed==1)){
+                logmsg(LOGDISSOLVE,LOGERROR,"All water consumed at cycle %d \n",sim->cyccnt);
+                logflush();
                 exit(1);
         }
         /* Attempt to create empty porosity to account for self-desiccation */
-        if((sealed==1)&&((count[POROSITY]-water_left)>0)){
-                poretodo=(count[POROSITY]-pore_off)-(water_left-water_off);
-                poretodo-=slagemptyp;
-		if(poretodo>0){
-	                makeinert(poretodo);
-                	poregone+=poretodo;
+        if((sim->sealed==1)&&((simt->count[POROSITY]-sim->water_left)>0)){
+                sim->poretodo=(simt->count[POROSITY]-sim->pore_off)-(sim->water_left-sim->water_off);
+                sim->poretodo-=sim->slagemptyp;
+		if(sim->poretodo>0){
+                        profstart(PROFINERT);
+	                makeinert(sim->poretodo);
+                        profstop(PROFINERT);
+                	sim->poregone+=sim->poretodo;
 		}
         }
         /* Output phase counts */
 	/* phfile for reactant and product phases */
-        if(cyccnt==0){
-        	phfile=fopen(phname,"w");
-         fprintf(phfile,"Cycle Porosity C3S C2S C3A C4AF GYPSUM HEMIHYD ANHYDRITE POZZ INERT SLAG ASG CAS2 CH CSH C3AH6 ETTR ETTRC4AF AFM FH3 POZZCSH SLAGCSH CACL2 FREIDEL STRAT GYPSUMS CACO3 AFMC AGG ABSGYP EMPTYP water_left \n");
-        }
-        else{
-        	phfile=fopen(phname,"a");
+        if(sim->cyccnt==0){
+        	outcreate(sim->phname);
+         outprintf(sim->phname,"Cycle Porosity C3S C2S C3A C4AF GYPSUM HEMIHYD ANHYDRITE POZZ INERT SLAG ASG CAS2 CH CSH C3AH6 ETTR ETTRC4AF AFM FH3 POZZCSH SLAGCSH CACL2 FREIDEL STRAT GYPSUMS CACO3 AFMC AGG ABSGYP EMPTYP water_left \n");
         }
-        fprintf(phfile,"%d ",cyccnt);
+        outprintf(sim->phname,"%d ",sim->cyccnt);
        	for(i=0;i<=EMPTYP;i++){
 		if((i<DIFFCSH)||(i>=EMPTYP)){
-	                fprintf(phfile,"%ld ",count[i]);
+	                outprintf(sim->phname,"%ld ",simt->count[i]);
 		}
-       		printf("%ld ",count[i]);
+       		logmsg(LOGDISSOLVE,LOGDEBUG,"%ld ",simt->count[i]);
         }
-        printf("\n");
-        fprintf(phfile,"%ld\n",water_left);
-        fclose(phfile);
+        logmsg(LOGDISSOLVE,LOGDEBUG,"\n");
+        outprintf(sim->phname,"%ld\n",sim->water_left);
 
         if(cycle==0){
                 return;
         }
-        cyccnt+=1;
-        printf("Cycle %d \n",cyccnt);
-        fflush(stdout);
+        sim->cyccnt+=1;
+        logmsg(LOGCYCLE,LOGINFO,"Cycle %d \n",sim->cyccnt);
+        logflush();
 	/* Update current volume count for CH */
-	chold=chnew;
-	chnew=count[CH];
+	sim->chold=sim->chnew;
+	sim->chnew=simt->count[CH];
 
         /* See if ettringite is soluble yet */
 	/* Gypsum 80% consumed, changed 06.09.00 from 90% to 80% */
 	/* Gypsum 75% consumed, changed 09.09.01 from 80% to 75% */
 	/* or system temperature exceeds 70 C */
-        if(((ncsbar+anhinit+heminit)!=0.0)||(temp_cur>=70.0)){
+        if(((sim->ncsbar+sim->anhinit+sim->heminit)!=0.0)||(sim->temp_cur>=70.0)){
 	/* Account for all sulfate sources and forms */
-        if((soluble[ETTR]==0)&&((temp_cur>=70.0)||(count[AFM]!=0)||
-	((((float)count[GYPSUM]+1.42*(float)count[ANHYDRITE]+1.4*
-	(float)count[HEMIHYD]+(float)count[GYPSUMS])/((float)ncsbar+
-	1.42*(float)anhinit+1.4*(float)heminit+((float)netbar/3.30)))<0.25))){
-                soluble[ETTR]=1;
-                printf("Ettringite is soluble beginning at cycle %d \n",cycle);
+        if((sim->soluble[ETTR]==0)&&((sim->temp_cur>=70.0)||(simt->count[AFM]!=0)||
+	((((float)simt->count[GYPSUM]+1.42*(float)simt->count[ANHYDRITE]+1.4*
+	(float)simt->count[HEMIHYD]+(float)simt->count[GYPSUMS])/((float)sim->ncsbar+
+	1.42*(float)sim->anhinit+1.4*(float)sim->heminit+((float)sim->netbar/3.30)))<0.25))){
+                sim->soluble[ETTR]=1;
+                logmsg(LOGDISSOLVE,LOGINFO,"Ettringite is soluble beginning at cycle %d \n",cycle);
                 /* identify all new soluble ettringite */
-                passone(ETTR,ETTR,2,0);
+                marksurf(ETTR,ETTR);
         }
         } /* end of soluble ettringite test */
 
         /* Adjust ettringite solubility */
 	/* if too many ettringites already in solution */
-        if(count[DIFFETTR]>DETTRMAX){
-                disprob[ETTR]=0.0;
+        if(simt->count[DIFFETTR]>DETTRMAX){
+                sim->disprob[ETTR]=0.0;
         }
         else{
-                disprob[ETTR]=disbase[ETTR];
+                sim->disprob[ETTR]=sim->disbase[ETTR];
         }
         /* Adjust CaCl2 solubility */
 	/* if too many CaCl2 already in solution */
-        if(count[DIFFCACL2]>DCACL2MAX){
-                disprob[CACL2]=0.0;
+        if(simt->count[DIFFCACL2]>DCACL2MAX){
+                sim->disprob[CACL2]=0.0;
         }
         else{
-                disprob[CACL2]=disbase[CACL2];
+                sim->disprob[CACL2]=sim->disbase[CACL2];
         }
         /* Adjust CaCO3 solubility */
 	/* if too many CaCO3 already in solution */
-        if((count[DIFFCACO3]>DCACO3MAX)&&(soluble[ETTR]==0)){
-                disprob[CACO3]=0.0;
+        if((simt->count[DIFFCACO3]>DCACO3MAX)&&(sim->soluble[ETTR]==0)){
+                sim->disprob[CACO3]=0.0;
         }
-        else if(count[DIFFCACO3]>(4*DCACO3MAX)){
-                disprob[CACO3]=0.0;
+        else if(simt->count[DIFFCACO3]>(4*DCACO3MAX)){
+                sim->disprob[CACO3]=0.0;
         }
         else{
-                disprob[CACO3]=disbase[CACO3];
+                sim->disprob[CACO3]=sim->disbase[CACO3];
         }
         /* Adjust solubility of CH */
         /* based on amount of CH currently diffusing */
         /* Note that CH is always soluble to allow some */
         /* Ostwald ripening of the CH crystals */
-        if((float)count[DIFFCH]>=CHCRIT){
-                disprob[CH]=disbase[CH]*CHCRIT/(float)count[DIFFCH];
+        if((float)simt->count[DIFFCH]>=CHCRIT){
+                sim->disprob[CH]=sim->disbase[CH]*CHCRIT/(float)simt->count[DIFFCH];
         }
         else{
-                disprob[CH]=disbase[CH];
+                sim->disprob[CH]=sim->disbase[CH];
         }
 	/* Adjust solubility of CH for temperature */
 	/* Fit to data provided in Taylor, Cement Chemistry */
 	/* Scale to a reference temperature of 25 C */
 	/* and adjust based on availability of pozzolan */
-	printf("CH dissolution probability goes from %f ",disprob[CH]);
-	disprob[CH]*=((A0_CHSOL-A1_CHSOL*temp_cur)/(A0_CHSOL-A1_CHSOL*25.0));
-	if((ppozz>0.0)&&(nfill>0)){
-		disprob[CH]*=ppozz/PPOZZ;
+	logmsg(LOGDISSOLVE,LOGDEBUG,"CH dissolution probability goes from %f ",sim->disprob[CH]);
+	sim->disprob[CH]*=((A0_CHSOL-A1_CHSOL*sim->temp_cur)/(A0_CHSOL-A1_CHSOL*25.0));
+	if((sim->ppozz>0.0)&&(sim->nfill>0)){
+		sim->disprob[CH]*=sim->ppozz/PPOZZ;
 	}
-	printf("to %f \n",disprob[CH]);
+	logmsg(LOGDISSOLVE,LOGDEBUG,"to %f \n",sim->disprob[CH]);
 
 	/* Adjust solubility of ASG and CAS2 phases */
 	/* based on pH rise during hydration */
 	/* To be added at a later date */
-        disprob[ASG]=disbase[ASG]*kpozz/krate;
-        disprob[CAS2]=disbase[CAS2]*kpozz/krate;
+        sim->disprob[ASG]=sim->disbase[ASG]*sim->kpozz/sim->krate;
+        sim->disprob[CAS2]=sim->disbase[CAS2]*sim->kpozz/sim->krate;
         /* Address solubility of C3AH6 */
 	/* If lots of gypsum or reactive ettringite, allow C3AH6 to dissolve */
 	/* to generate diffusing C3A species */
-        if(((count[GYPSUM]+count[GYPSUMS])>(int)(((float)ncsbar+
-	1.42*(float)anhinit+1.4*(float)heminit)*0.05))
-	||(count[ETTR]>500)){
-                soluble[C3AH6]=1;
-                passone(C3AH6,C3AH6,2,0);
+        if(((simt->count[GYPSUM]+simt->count[GYPSUMS])>(int)(((float)sim->ncsbar+
+	1.42*(float)sim->anhinit+1.4*(float)sim->heminit)*0.05))
+	||(simt->count[ETTR]>(500*sim->sysvolfact))){
+                sim->soluble[C3AH6]=1;
+                marksurf(C3AH6,C3AH6);
                 /* Base C3AH6 solubility on maximum sulfate in solution */
                 /* from gypsum or ettringite available for dissolution */
                 /* The more the sulfate, the higher this solubility should be */
-                maxsulfate=count[DIFFGYP];
-                if((maxsulfate<count[DIFFETTR])&&(soluble[ETTR]==1)){
-                        maxsulfate=count[DIFFETTR];
+                maxsulfate=simt->count[DIFFGYP];
+                if((maxsulfate<simt->count[DIFFETTR])&&(sim->soluble[ETTR]==1)){
+                        maxsulfate=simt->count[DIFFETTR];
                 }
 /* Adjust C3AH6 solubility based on potential gypsum which will dissolve */
-                if(maxsulfate<(int)((float)gypready*disprob[GYPSUM]*
-                (float)count[POROSITY]/1000000.)){
-                        maxsulfate=(int)((float)gypready*disprob[GYPSUM]*
-                        (float)count[POROSITY]/1000000.);
+                if(maxsulfate<(int)((float)simt->gypready*sim->disprob[GYPSUM]*
+                (float)simt->count[POROSITY]/(1000000.*sim->sysvolfact))){
+                        maxsulfate=(int)((float)simt->gypready*sim->disprob[GYPSUM]*
+                        (float)simt->count[POROSITY]/(1000000.*sim->sysvolfact));
                 }
                 if(maxsulfate>0){
-                      disprob[C3AH6]=disbase[C3AH6]*(float)maxsulfate/C3AH6CRIT;
-                      if(disprob[C3AH6]>0.5){disprob[C3AH6]=0.5;}
+                      sim->disprob[C3AH6]=sim->disbase[C3AH6]*(float)maxsulfate/C3AH6CRIT;
+                      if(sim->disprob[C3AH6]>0.5){sim->disprob[C3AH6]=0.5;}
                 }
                 else{
-                      disprob[C3AH6]=disbase[C3AH6];
+                      sim->disprob[C3AH6]=sim->disbase[C3AH6];
                 }
         }
         else{
-                soluble[C3AH6]=0;
+                sim->soluble[C3AH6]=0;
         }
 
         /* See if silicates are soluble yet */
-        if((soluble[C3S]==0)&&((cycle>1)||(count[ETTR]>0)||(count[AFM]>0)||(count[ETTRC4AF]>0))){
-                soluble[C2S]=1;
-                soluble[C3S]=1;
+        if((sim->soluble[C3S]==0)&&((cycle>1)||(simt->count[ETTR]>0)||(simt->count[AFM]>0)||(simt->count[ETTRC4AF]>0))){
+                sim->soluble[C2S]=1;
+                sim->soluble[C3S]=1;
                 /* identify all new soluble silicates */
-                passone(C3S,C2S,2,0);
+                marksurf(C3S,C2S);
         } /* end of soluble silicate test */
 	/* Adjust solubility of C3S and C2S with CSH concentration */
 	/* for simulation of induction period */
 
-   tdisfact=A0_CHSOL-temp_cur*A1_CHSOL;
+   tdisfact=A0_CHSOL-sim->temp_cur*A1_CHSOL;
 /*   printf("tdisfact is %f\n",tdisfact);
      fflush(stdout); */
 
@@ -1584,34 +1415,34 @@ void dissolve(cycle)
    /*    per unit porosity basis */
    /*  Try using current porosity count to see if this helps in initial */
    /*   hydration rates of sealed vs. saturated  */
-   pfract=(float)count[POROSITY]/(float)(SYSIZE*SYSIZE*SYSIZE);
-   if((ncsbar+anhinit+heminit)==0.0){
-   			cs_acc=1.0;
-         	        ca_acc=1.0;
-                        dismin_c3a=5.0*DISMIN_C3A_0;
-                    	dismin_c4af=5.0*DISMIN_C4AF_0; 
+   sim->pfract=(float)simt->count[POROSITY]/(float)(SYSIZE*SYSIZE*SYSIZE);
+   if((sim->ncsbar+sim->anhinit+sim->heminit)==0.0){
+   			sim->cs_acc=1.0;
+         	        sim->ca_acc=1.0;
+                        sim->dismin_c3a=5.0*DISMIN_C3A_0;
+                    	sim->dismin_c4af=5.0*DISMIN_C4AF_0; 
         }
    else{
-        sulf_conc=sulf_cur*tfractw05*pfractw05/totfract/pfract;
-   	if(sulf_conc<10.0){
-   			cs_acc=1.0;
-         	        ca_acc=1.0;
-            	        dismin_c3a=DISMIN_C3A_0;
-               	        dismin_c4af=DISMIN_C4AF_0;
-        }
-        else if(sulf_conc<20.0){
-      			cs_acc=1.0+((sulf_conc)-10.0)/10.0;
-                        ca_acc=1.0;
-           	        dismin_c3a=DISMIN_C3A_0;
-               	        dismin_c4af=DISMIN_C4AF_0;
+        sim->sulf_conc=(sim->sulf_cur/sim->sysvolfact)*sim->tfractw05*sim->pfractw05/sim->totfract/sim->pfract;
+   	if(sim->sulf_conc<10.0){
+   			sim->cs_acc=1.0;
+         	        sim->ca_acc=1.0;
+            	        sim->dismin_c3a=DISMIN_C3A_0;
+               	        sim->dismin_c4af=DISMIN_C4AF_0;
+        }
+        else if(sim->sulf_conc<20.0){
+      			sim->cs_acc=1.0+((sim->sulf_conc)-10.0)/10.0;
+                        sim->ca_acc=1.0;
+           	        sim->dismin_c3a=DISMIN_C3A_0;
+               	        sim->dismin_c4af=DISMIN_C4AF_0;
         }
    	else{
-   		cs_acc=1.0+(double)log10(sulf_conc-10.0);
-             	ca_acc=1.0;
-      	        dismin_c3a=(6.0-(double)log10(sulf_conc))*DISMIN_C3A_0;
-      	        dismin_c4af=(6.0-(double)log10(sulf_conc))*DISMIN_C4AF_0;
-      	        if(dismin_c3a<DISMIN_C3A_0){dismin_c3a=DISMIN_C3A_0;}
-      	        if(dismin_c4af<DISMIN_C4AF_0){dismin_c4af=DISMIN_C4AF_0;}
+   		sim->cs_acc=1.0+(double)log10(sim->sulf_conc-10.0);
+             	sim->ca_acc=1.0;
+      	        sim->dismin_c3a=(6.0-(double)log10(sim->sulf_conc))*DISMIN_C3A_0;
+      	        sim->dismin_c4af=(6.0-(double)log10(sim->sulf_conc))*DISMIN_C4AF_0;
+      	        if(sim->dismin_c3a<DISMIN_C3A_0){sim->dismin_c3a=DISMIN_C3A_0;}
+      	        if(sim->dismin_c4af<DISMIN_C4AF_0){sim->dismin_c4af=DISMIN_C4AF_0;}
       	}
    }
 
@@ -1621,76 +1452,76 @@ void dissolve(cycle)
 /*    dfact=tdisfact*((float)count[CSH]/((float)CSHSCALE*(0.3125+WCSCALE)/(w_to_c+0.3125)))*((float)count[CSH]/((float)CSHSCALE*(0.3125+WCSCALE)/(w_to_c+0.3125)))*cs_acc;*/
 	/* October 2004 --- changed to truly scale with volume of cement in */
 	/* system for both plain portland cements and filled systems */
-    dfact=tdisfact*((float)count[CSH]/((float)CSHSCALE*surffract*totfract/tfractw04))*((float)count[CSH]/((float)CSHSCALE*surffract*totfract/tfractw04))*cs_acc;
-	 disprob[C3S]=DISMIN+dfact*disbase[C3S];
-	 disprob[C2S]=DISMIN2+dfact*disbase[C2S];
-	 if(disprob[C3S]>(1.*disbase[C3S])){disprob[C3S]=(1.*disbase[C3S]);}
-	 if(disprob[C2S]>(1.*disbase[C2S])){disprob[C2S]=(1.*disbase[C2S]);}
+    dfact=tdisfact*((float)simt->count[CSH]/((float)CSHSCALE*sim->surffract*sim->totfract/sim->tfractw04))*((float)simt->count[CSH]/((float)CSHSCALE*sim->surffract*sim->totfract/sim->tfractw04))*sim->cs_acc;
+	 sim->disprob[C3S]=DISMIN+dfact*sim->disbase[C3S];
+	 sim->disprob[C2S]=DISMIN2+dfact*sim->disbase[C2S];
+	 if(sim->disprob[C3S]>(1.*sim->disbase[C3S])){sim->disprob[C3S]=(1.*sim->disbase[C3S]);}
+	 if(sim->disprob[C2S]>(1.*sim->disbase[C2S])){sim->disprob[C2S]=(1.*sim->disbase[C2S]);}
 
          /* Also adjust slag and fly ash dissolution rates here */
          /* Really slow down initial slag and fly ash dissolutions */
          /* Ultimately should be linked to pH of pore solution, most likely */
-         disprob[SLAG]=slagreact*(kslag/krate)*(DISMINSLAG+dfact*disbase[SLAG])/10.0;
-	 if(disprob[SLAG]>(slagreact*(kslag/krate)*disbase[SLAG])){disprob[SLAG]=(slagreact*disbase[SLAG]*kslag/krate);}
-         if(disprob[C3S]==disbase[C3S]){disprob[SLAG]=slagreact*disbase[SLAG]*kslag/krate;}
-         disprob[ASG]=(DISMINASG+dfact*disbase[ASG]/5.0)*kpozz/krate;
-	 if(disprob[ASG]>(1.*disbase[ASG])){disprob[ASG]=(1.*disbase[ASG]*kpozz/krate);}
-         if(disprob[C3S]==disbase[C3S]){disprob[ASG]=disbase[ASG]*kpozz/krate;}
-         disprob[CAS2]=(DISMINCAS2+dfact*disbase[CAS2]/5.0)*kpozz/krate;
-	 if(disprob[CAS2]>(kpozz*disbase[CAS2]/krate)){disprob[CAS2]=(1.*disbase[CAS2])*kpozz/krate;}
-         if(disprob[C3S]==disbase[C3S]){disprob[CAS2]=disbase[CAS2]*kpozz/krate;}
+         sim->disprob[SLAG]=sim->slagreact*(sim->kslag/sim->krate)*(DISMINSLAG+dfact*sim->disbase[SLAG])/10.0;
+	 if(sim->disprob[SLAG]>(sim->slagreact*(sim->kslag/sim->krate)*sim->disbase[SLAG])){sim->disprob[SLAG]=(sim->slagreact*sim->disbase[SLAG]*sim->kslag/sim->krate);}
+         if(sim->disprob[C3S]==sim->disbase[C3S]){sim->disprob[SLAG]=sim->slagreact*sim->disbase[SLAG]*sim->kslag/sim->krate;}
+         sim->disprob[ASG]=(DISMINASG+dfact*sim->disbase[ASG]/5.0)*sim->kpozz/sim->krate;
+	 if(sim->disprob[ASG]>(1.*sim->disbase[ASG])){sim->disprob[ASG]=(1.*sim->disbase[ASG]*sim->kpozz/sim->krate);}
+         if(sim->disprob[C3S]==sim->disbase[C3S]){sim->disprob[ASG]=sim->disbase[ASG]*sim->kpozz/sim->krate;}
+         sim->disprob[CAS2]=(DISMINCAS2+dfact*sim->disbase[CAS2]/5.0)*sim->kpozz/sim->krate;
+	 if(sim->disprob[CAS2]>(sim->kpozz*sim->disbase[CAS2]/sim->krate)){sim->disprob[CAS2]=(1.*sim->disbase[CAS2])*sim->kpozz/sim->krate;}
+         if(sim->disprob[C3S]==sim->disbase[C3S]){sim->disprob[CAS2]=sim->disbase[CAS2]*sim->kpozz/sim->krate;}
         /* Adjust CAS2 solubility */
 	/* if too many CAS2 already in solution */
-        if(count[DIFFCAS2]>DCAS2MAX){
-                disprob[CAS2]=0.0;
+        if(simt->count[DIFFCAS2]>DCAS2MAX){
+                sim->disprob[CAS2]=0.0;
         }
-    printf("Silicate probabilities: %f %f\n",disprob[C3S],disprob[C2S]);
-    fflush(stdout);
+    logmsg(LOGDISSOLVE,LOGDEBUG,"Silicate probabilities: %f %f\n",sim->disprob[C3S],sim->disprob[C2S]);
+    logflush();
 	/* Assume that aluminate dissolution controlled by formation */
 	/* of impermeable layer proportional to CSH concentration */
         /* if sulfates are present in the system */
 
 /*      dfact1=tdisfact*((float)count[CSH]/CSHSCALE)*((float)count[CSH]/CSHSCALE)*ca_acc;  */
-    if((ncsbar+heminit+anhinit)>1000){
+    if((sim->ncsbar+sim->heminit+sim->anhinit)>(1000*sim->sysvolfact)){
 /*    dfact1=tdisfact*((float)count[CSH]/((float)CSHSCALE*(0.3125+WCSCALE)/(0.3125+w_to_c)))*((float)count[CSH]/((float)CSHSCALE*(0.3125+WCSCALE)/(0.3125+w_to_c)))*ca_acc; */
 	/* October 2004 --- changed to truly scale with volume of cement in */
 	/* system for both plain portland cements and filled systems */
-    dfact1=tdisfact*((float)count[CSH]/((float)CSHSCALE*surffract*totfract/tfractw04))*((float)count[CSH]/((float)CSHSCALE*surffract*totfract/tfractw04))*ca_acc;
-    disprob[C3A]=dismin_c3a+dfact1*disbase[C3A];
-    disprob[C4AF]=dismin_c4af+dfact1*disbase[C4AF];
-    if(disprob[C3A]>(1.*disbase[C3A])){disprob[C3A]=(1.*disbase[C3A]);}
-    if(disprob[C4AF]>(1.*disbase[C4AF])){disprob[C4AF]=(1.*disbase[C4AF]);}
+    dfact1=tdisfact*((float)simt->count[CSH]/((float)CSHSCALE*sim->surffract*sim->totfract/sim->tfractw04))*((float)simt->count[CSH]/((float)CSHSCALE*sim->surffract*sim->totfract/sim->tfractw04))*sim->ca_acc;
+    sim->disprob[C3A]=sim->dismin_c3a+dfact1*sim->disbase[C3A];
+    sim->disprob[C4AF]=sim->dismin_c4af+dfact1*sim->disbase[C4AF];
+    if(sim->disprob[C3A]>(1.*sim->disbase[C3A])){sim->disprob[C3A]=(1.*sim->disbase[C3A]);}
+    if(sim->disprob[C4AF]>(1.*sim->disbase[C4AF])){sim->disprob[C4AF]=(1.*sim->disbase[C4AF]);}
 
      /* Location to add in dissolution reduction in calcium sulfate phases */
      /* if needed */
-    disprob[GYPSUM]=(disbase[GYPSUM]/15.)+dfact1*disbase[GYPSUM];
-    if(disprob[GYPSUM]>(disbase[GYPSUM])){disprob[GYPSUM]=(disbase[GYPSUM]);}
-    disprob[GYPSUMS]=(disbase[GYPSUMS]/15.)+dfact1*disbase[GYPSUMS];
-    if(disprob[GYPSUMS]>(disbase[GYPSUMS])){disprob[GYPSUMS]=(disbase[GYPSUMS]);}
+    sim->disprob[GYPSUM]=(sim->disbase[GYPSUM]/15.)+dfact1*sim->disbase[GYPSUM];
+    if(sim->disprob[GYPSUM]>(sim->disbase[GYPSUM])){sim->disprob[GYPSUM]=(sim->disbase[GYPSUM]);}
+    sim->disprob[GYPSUMS]=(sim->disbase[GYPSUMS]/15.)+dfact1*sim->disbase[GYPSUMS];
+    if(sim->disprob[GYPSUMS]>(sim->disbase[GYPSUMS])){sim->disprob[GYPSUMS]=(sim->disbase[GYPSUMS]);}
     /* Adjust gypsum solubility */
     /* if too many diffusing gypsums already in solution */
-    if(count[DIFFGYP]>DGYPMAX){
-           disprob[GYPSUM]=disprob[GYPSUMS]=0.0;
+    if(simt->count[DIFFGYP]>DGYPMAX){
+           sim->disprob[GYPSUM]=sim->disprob[GYPSUMS]=0.0;
     }
-    disprob[HEMIHYD]=(disbase[HEMIHYD]/15.)+dfact1*disbase[HEMIHYD];
-    if(disprob[HEMIHYD]>(disbase[HEMIHYD])){disprob[HEMIHYD]=(disbase[HEMIHYD]);}
-    disprob[ANHYDRITE]=(disbase[ANHYDRITE]/15.)+dfact1*disbase[ANHYDRITE];
-    if(disprob[ANHYDRITE]>(disbase[ANHYDRITE])){disprob[ANHYDRITE]=(disbase[ANHYDRITE]);}
+    sim->disprob[HEMIHYD]=(sim->disbase[HEMIHYD]/15.)+dfact1*sim->disbase[HEMIHYD];
+    if(sim->disprob[HEMIHYD]>(sim->disbase[HEMIHYD])){sim->disprob[HEMIHYD]=(sim->disbase[HEMIHYD]);}
+    sim->disprob[ANHYDRITE]=(sim->disbase[ANHYDRITE]/15.)+dfact1*sim->disbase[ANHYDRITE];
+    if(sim->disprob[ANHYDRITE]>(sim->disbase[ANHYDRITE])){sim->disprob[ANHYDRITE]=(sim->disbase[ANHYDRITE]);}
 
     }
     else{
         /* Cause flash set by increasing dissolution rates of C3A and C4AF */
         /* each by a factor of four */
-	disprob[C3A]=4.*disbase[C3A];
-	disprob[C4AF]=4.*disbase[C4AF];
-	disprob[GYPSUM]=disbase[GYPSUM];
-	disprob[HEMIHYD]=disbase[HEMIHYD];
-	disprob[ANHYDRITE]=disbase[ANHYDRITE];
+	sim->disprob[C3A]=4.*sim->disbase[C3A];
+	sim->disprob[C4AF]=4.*sim->disbase[C4AF];
+	sim->disprob[GYPSUM]=sim->disbase[GYPSUM];
+	sim->disprob[HEMIHYD]=sim->disbase[HEMIHYD];
+	sim->disprob[ANHYDRITE]=sim->disbase[ANHYDRITE];
     }
     /* Reduce dissolution probabilities based on saturation of system */
-    if((count[EMPTYP]>0)&&((count[POROSITY]+count[EMPTYP])<220000)){
-        if(countpore==0){countpore=count[EMPTYP];}
-	saturation=(float)(count[POROSITY])/(float)(count[POROSITY]+(count[EMPTYP]-countpore));
+    if((simt->count[EMPTYP]>0)&&((simt->count[POROSITY]+simt->count[EMPTYP])<(220000*sim->sysvolfact))){
+        if(sim->countpore==0){sim->countpore=simt->count[EMPTYP];}
+	sim->saturation=(float)(simt->count[POROSITY])/(float)(simt->count[POROSITY]+(simt->count[EMPTYP]-sim->countpore));
         /* Roughly according to results of Jensen, powers for RH 
            sensitivity are:
             C3S-19
@@ -1698,120 +1529,133 @@ void dissolve(cycle)
             C3A, C4AF-6    */
         /* Adjust fly ash silicates (ASG and CAS2) and pozzolanic reactivity */
         /* by same factor as C3S (also CH) */
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation*saturation);
-        disprob[C3S]*=(saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation*saturation);
-        disprob[SLAG]*=(saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation*saturation);
-        disprob[CH]*=(saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation*saturation);
-        disprob[ASG]*=(saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation*saturation);
-        disprob[CAS2]*=(saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation*saturation);
-        ppozz*=(saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation*saturation);
-        disprob[C2S]*=(saturation);
-        disprob[C3A]*=(saturation*saturation);
-        disprob[C3A]*=(saturation*saturation);
-        disprob[C3A]*=(saturation*saturation);
-        disprob[C4AF]*=(saturation*saturation);
-        disprob[C4AF]*=(saturation*saturation);
-        disprob[C4AF]*=(saturation*saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3S]*=(sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation*sim->saturation);
+        sim->disprob[SLAG]*=(sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation*sim->saturation);
+        sim->disprob[CH]*=(sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation*sim->saturation);
+        sim->disprob[ASG]*=(sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation*sim->saturation);
+        sim->disprob[CAS2]*=(sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation*sim->saturation);
+        sim->ppozz*=(sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation*sim->saturation);
+        sim->disprob[C2S]*=(sim->saturation);
+        sim->disprob[C3A]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3A]*=(sim->saturation*sim->saturation);
+        sim->disprob[C3A]*=(sim->saturation*sim->saturation);
+        sim->disprob[C4AF]*=(sim->saturation*sim->saturation);
+        sim->disprob[C4AF]*=(sim->saturation*sim->saturation);
+        sim->disprob[C4AF]*=(sim->saturation*sim->saturation);
     }
-	printf("Silicate and aluminate probabilities: %f %f %f %f\n",disprob[C3S],disprob[C2S],disprob[C3A],disprob[C4AF]);
-        printf("cs_acc is %f  and ca_acc is %f sulf_cur is %ld\n",cs_acc,ca_acc,sulf_cur);
-    fflush(stdout);
+	logmsg(LOGDISSOLVE,LOGDEBUG,"Silicate and aluminate probabilities: %f %f %f %f\n",sim->disprob[C3S],sim->disprob[C2S],sim->disprob[C3A],sim->disprob[C4AF]);
+        logmsg(LOGDISSOLVE,LOGDEBUG,"cs_acc is %f  and ca_acc is %f sulf_cur is %ld\n",sim->cs_acc,sim->ca_acc,sim->sulf_cur);
+    logflush();
         /* Pass two- perform the dissolution of species */
+        profstart(PROFPASSTWO);
         /* Determine the pH factor to use */
-        pHfactor=0.0;
-        if((pHactive==1)&&(count[CSH]>((CSHSCALE*surffract*surffract*totfract*totfract/tfractw04/tfractw04)/8.0))){
-         pHfactor=1.5;
-         if(pH_cur>12.5){pHfactor=1.0;}
+        sim->pHfactor=0.0;
+        if((sim->pHactive==1)&&(simt->count[CSH]>((CSHSCALE*sim->surffract*sim->surffract*sim->totfract*sim->totfract/sim->tfractw04/sim->tfractw04)/8.0))){
+         sim->pHfactor=1.5;
+         if(sim->pH_cur>12.5){sim->pHfactor=1.0;}
             /* 2/02*/
 /*          pHfactor=0.30*(((14.1-pH_cur)/0.3)-1.0); */
             /* 3/02*/
         /*  pHfactor=0.60*(((14.1-pH_cur)/0.5)-1.0); */
-          if(pH_cur>12.75){pHfactor=0.667;}
-          if(pH_cur>13.00){pHfactor=0.333;}
-          if(pH_cur>13.25){pHfactor=(0.0);}
-          if(pH_cur>13.75){pHfactor=(-0.25);}
-          pHfactor+=concsulfate;   /* influence of sulfate on reactivity */
+          if(sim->pH_cur>12.75){sim->pHfactor=0.667;}
+          if(sim->pH_cur>13.00){sim->pHfactor=0.333;}
+          if(sim->pH_cur>13.25){sim->pHfactor=(0.0);}
+          if(sim->pH_cur>13.75){sim->pHfactor=(-0.25);}
+          sim->pHfactor+=sim->concsulfate;   /* influence of sulfate on reactivity */
         }
         nhgd=0;
 	/* Update molar volume ratios for CSH formation */
-	pc3scsh=molarvcsh[cyccnt]/molarv[C3S]-1.0;
-	pc2scsh=molarvcsh[cyccnt]/molarv[C2S]-1.0;
-        /* Once again, scan all pixels in microstructure */
-        slagemptyp=0;
-        for(xloop=0;xloop<SYSIZE;xloop++){
-        for(yloop=0;yloop<SYSIZE;yloop++){
-        for(zloop=0;zloop<SYSIZE;zloop++){
-                if(mic[xloop][yloop][zloop]>OFFSET){
-                        phid=mic[xloop][yloop][zloop]-OFFSET;
+	pc3scsh=sim->molarvcsh[sim->cyccnt]/sim->molarv[C3S]-1.0;
+	pc2scsh=sim->molarvcsh[sim->cyccnt]/sim->molarv[C2S]-1.0;
+        /* Once again, visit pixels in lattice order, but only those */
+        /* which may dissolve or react: the surface sites marked in */
+        /* passone and C-S-H or slag pixels in contact with pore space */
+        sim->slagemptyp=0;
+        sim->visitcsh=((simt->count[POZZ]>=(13000*sim->sysvolfact))&&(sim->chnew<(0.15*SYSIZE*SYSIZE*SYSIZE))&&(sim->csh2flag==1));
+        sim->visitslag=(simt->count[SLAG]>0);
+        addvisit();
+        while((ivisit=nextvisit())>=0){
+                xloop=(int)(ivisit/((long int)SYSIZE*SYSIZE));
+                yloop=(int)((ivisit/SYSIZE)%SYSIZE);
+                zloop=(int)(ivisit%SYSIZE);
+                /* Compute the first numbers of this and the next few */
+                /* pixels' streams side by side */
+                if(!ranready(RNGDISSOLVE,0,ivisit)){
+                        ranahead(RNGDISSOLVE,0,aheadid,peekvisit(ivisit,aheadid,RANLANES));
+                }
+                ranstream(RNGDISSOLVE,0,ivisit);
+                if(sim->mic[VOXEL(xloop,yloop,zloop)]>OFFSET){
+                        phid=sim->mic[VOXEL(xloop,yloop,zloop)]-OFFSET;
                         /* attempt a one-step random walk to dissolve */
-                        plnew=(int)((float)NEIGHBORS*ran1(seed));
+                        plnew=(int)((float)NEIGHBORS*ran1(simt->seed));
                         if((plnew<0)||(plnew>=NEIGHBORS)){ plnew=NEIGHBORS-1;}
                         xc=xloop+xoff[plnew];
                         yc=yloop+yoff[plnew];
@@ -1824,19 +1668,18 @@ void dissolve(cycle)
                         if(zc>=SYSIZE){zc=0;}
                        
                        /* Generate probability for dissolution */
-                       pdis=ran1(seed);
+                       pdis=ran1(simt->seed);
 			/* Bias dissolution for one pixel particles as */
 			/* indicated by a pixel value of zero in the */
 			/* particle microstructure image */
-                       if(((pdis<=(disprob[phid]/(1.+pHfactor*pHeffect[phid])))||((pdis<=(onepixelbias*disprob[phid]/(1.+pHfactor*pHeffect[phid])))&&(micpart[xloop][yloop][zloop]==0)))&&(mic[xc][yc][zc]==POROSITY)){
-                                discount[phid]+=1;
-                                cread=creates[phid];
-				count[phid]-=1;
-                                mic[xloop][yloop][zloop]=POROSITY;
+                       if(((pdis<=(sim->disprob[phid]/(1.+sim->pHfactor*sim->pHeffect[phid])))||((pdis<=(sim->onepixelbias*sim->disprob[phid]/(1.+sim->pHfactor*sim->pHeffect[phid])))&&(sim->micpart[VOXEL(xloop,yloop,zloop)]==0)))&&(sim->mic[VOXEL(xc,yc,zc)]==POROSITY)){
+                                sim->discount[phid]+=1;
+                                cread=sim->creates[phid];
+                                setphase(xloop,yloop,zloop,POROSITY);
                                 if(phid==C3AH6){nhgd+=1;}
                                 /* Special dissolution for C4AF */
                                 if(phid==C4AF){
-                                        plfh3=ran1(seed);
+                                        plfh3=ran1(simt->seed);
                                         if((plfh3<0.0)||(plfh3>1.0)){
                                                 plfh3=1.0;
                                         }
@@ -1846,62 +1689,40 @@ void dissolve(cycle)
                                                 cread=DIFFFH3;
                                         }
                                  }
-                                 if(cread==POROSITY){
-					count[POROSITY]+=1;
-				 }
                                  if(cread!=POROSITY){
-                                        nmade+=1;
-                                        ngoing+=1;
+                                        sim->nmade+=1;
+                                        sim->ngoing+=1;
                                         phnew=cread;
-                                        count[phnew]+=1;
-                                        mic[xc][yc][zc]=phnew;
-                            antadd=(struct ants *)malloc(sizeof(struct ants));
-                                        antadd->x=xc;
-                                        antadd->y=yc;
-                                        antadd->z=zc;
-                                        antadd->id=phnew;
-					antadd->cycbirth=cyccnt;
-                      /* Now connect this ant structure to end of linked list */
-                                        antadd->prevant=tailant;
-                                        tailant->nextant=antadd;
-                                        antadd->nextant=NULL;
-                                        tailant=antadd;
+                                        setphase(xc,yc,zc,phnew);
+                                        addant(xc,yc,zc,phnew);
                                  }
 				/* Extra CSH diffusing species based on current temperature */
                                  if((phid==C3S)||(phid==C2S)){
-                                        plfh3=ran1(seed);
+                                        plfh3=ran1(simt->seed);
                                         if(((phid==C2S)&&(plfh3<=pc2scsh))||(plfh3<=pc3scsh)){
-						cshboxsize=(int)(3.+5.*(40.-temp_cur)/20.);
-						if(cshboxsize<1){cshboxsize=1;}
-                                                placed=loccsh(xc,yc,zc,cshboxsize);
-                                                if(placed!=0){
-                                                        count[DIFFCSH]+=1;
-							count[POROSITY]-=1;
-                                                }
-                                                else{
+						sim->cshboxsize=(int)(3.+5.*(40.-sim->temp_cur)/20.);
+						if(sim->cshboxsize<1){sim->cshboxsize=1;}
+                                                placed=loccsh(xc,yc,zc,sim->cshboxsize);
+                                                if(placed==0){
                                                         cshrand+=1;
                                                 }
                                         }
                                  }
 
                                  if((phid==C2S)&&(pc2scsh>1.0)){
-                                        plfh3=ran1(seed);
+                                        plfh3=ran1(simt->seed);
                                         if(plfh3<=(pc2scsh-1.0)){
-						cshboxsize=(int)(3.+5.*(40.-temp_cur)/20.);
-						if(cshboxsize<1){cshboxsize=1;}
-                                                placed=loccsh(xc,yc,zc,cshboxsize);
-                                                if(placed!=0){
-                                                        count[DIFFCSH]+=1;
-							count[POROSITY]-=1;
-                                                }
-                                                else{
+						sim->cshboxsize=(int)(3.+5.*(40.-sim->temp_cur)/20.);
+						if(sim->cshboxsize<1){sim->cshboxsize=1;}
+                                                placed=loccsh(xc,yc,zc,sim->cshboxsize);
+                                                if(placed==0){
                                                         cshrand+=1;
                                                 }
                                         }
                                  }
                         }
                         else{
-                                 mic[xloop][yloop][zloop]-=OFFSET;
+                                 sim->mic[VOXEL(xloop,yloop,zloop)]-=OFFSET;
                         }
 
                 } /* end of if edge loop */
@@ -1909,48 +1730,37 @@ void dissolve(cycle)
 		/* Only if CH is less than 15% in volume */
 		/* Only if CSH is in contact with at least one porosity */
 		/* and user wishes to use this option */
-		if((count[POZZ]>=13000)&&(chnew<(0.15*SYSIZE*SYSIZE*SYSIZE))&&(csh2flag==1)){
-			if(mic[xloop][yloop][zloop]==CSH){
-			if((countbox(3,xloop,yloop,zloop))>=1){
-				pconvert=ran1(seed);
+		/* A pixel with an open neighbor (nopen, see surface.c) */
+		/* needs no count, since countbox would find it */
+		if((simt->count[POZZ]>=(13000*sim->sysvolfact))&&(sim->chnew<(0.15*SYSIZE*SYSIZE*SYSIZE))&&(sim->csh2flag==1)){
+			if(sim->mic[VOXEL(xloop,yloop,zloop)]==CSH){
+			if((sim->nopen[VOXEL(xloop,yloop,zloop)]>0)||((countbox(3,xloop,yloop,zloop))>=1)){
+				pconvert=ran1(simt->seed);
 				if(pconvert<PCSH2CSH){
-					count[CSH]-=1;
-                                        plfh3=ran1(seed);
+                                        plfh3=ran1(simt->seed);
 					/* molarvcsh units of C1.7SHx goes to */
 					/* 101.81 units of C1.1SH3.9 */
 					/* with 19.86 units of CH */
 					/* so p=calcy */
 					calcz=0.0;
-					cycnew=cshage[xloop][yloop][zloop];
-					calcy=molarv[POZZCSH]/molarvcsh[cycnew];
+					cycnew=sim->cshage[VOXEL(xloop,yloop,zloop)];
+					calcy=sim->molarv[POZZCSH]/sim->molarvcsh[cycnew];
 					if(calcy>1.0){
 						calcz=calcy-1.0;
 						calcy=1.0;
-						printf("Problem of not creating enough pozzolanic CSH during CSH conversion \n");
-						printf("Current temperature is %f C\n",temp_cur);
+						logmsg(LOGDISSOLVE,LOGWARN,"Problem of not creating enough pozzolanic CSH during CSH conversion \n");
+						logmsg(LOGDISSOLVE,LOGWARN,"Current temperature is %f C\n",sim->temp_cur);
 					}
 
 					if(plfh3<=calcy){
-						mic[xloop][yloop][zloop]=POZZCSH;
-						count[POZZCSH]+=1;
+						setphase(xloop,yloop,zloop,POZZCSH);
 					}
 					else{
-						mic[xloop][yloop][zloop]=DIFFCH;
-                                        	nmade+=1;
+						setphase(xloop,yloop,zloop,DIFFCH);
+                                        	sim->nmade+=1;
 						ncshgo+=1;
- 	                                        ngoing+=1;
-	                                        count[DIFFCH]+=1;
-       	                     antadd=(struct ants *)malloc(sizeof(struct ants));
-                            	        	antadd->x=xloop;
-                               	        	antadd->y=yloop;
-                                        	antadd->z=zloop;
-                                        	antadd->id=DIFFCH;
-						antadd->cycbirth=cyccnt;
-                      /* Now connect this ant structure to end of linked list */
-                                        	antadd->prevant=tailant;
-                                        	tailant->nextant=antadd;
-                                        	antadd->nextant=NULL;
-                                        	tailant=antadd;
+ 	                                        sim->ngoing+=1;
+                                        	addant(xloop,yloop,zloop,DIFFCH);
 					}
 					/* Possibly need even more pozzolanic CSH */
 					/* Would need a diffusing pozzolanic
@@ -1963,8 +1773,8 @@ CSH species??? */
 					}    */
 
 
-                                        plfh3=ran1(seed);
-					calcx=(19.86/molarvcsh[cycnew])-(1.-calcy);
+                                        plfh3=ran1(simt->seed);
+					calcx=(19.86/sim->molarvcsh[cycnew])-(1.-calcy);
 					/* Ex. 0.12658=(19.86/108.)-(1.-0.94269) */
 					if(plfh3<calcx){
 						npchext+=1;
@@ -1974,117 +1784,113 @@ CSH species??? */
 			}
 		}
                 /* See if slag can react --- in contact with at least one porosity */
-		if(mic[xloop][yloop][zloop]==SLAG){
-			if((countbox(3,xloop,yloop,zloop))>=1){
-				pconvert=ran1(seed);
-				if(pconvert<(disprob[SLAG]/(1.+pHfactor*pHeffect[SLAG]))){
-                                     nslagr+=1;
-                                     count[SLAG]-=1;
-                                     discount[SLAG]+=1;
+		if(sim->mic[VOXEL(xloop,yloop,zloop)]==SLAG){
+			if((sim->nopen[VOXEL(xloop,yloop,zloop)]>0)||((countbox(3,xloop,yloop,zloop))>=1)){
+				pconvert=ran1(simt->seed);
+				if(pconvert<(sim->disprob[SLAG]/(1.+sim->pHfactor*sim->pHeffect[SLAG]))){
+                                     sim->nslagr+=1;
+                                     sim->discount[SLAG]+=1;
                                      /* Check on extra C3A generation */
-                                     plfh3=ran1(seed);
-                                     if(plfh3<p5slag){
+                                     plfh3=ran1(simt->seed);
+                                     if(plfh3<sim->p5slag){
                                          nslagc3a+=1;
 				     }
                                      /* Convert slag to reaction products */
-                                     plfh3=ran1(seed);
-                                     if(plfh3<p1slag){
-                                       mic[xloop][yloop][zloop]=SLAGCSH;
+                                     plfh3=ran1(simt->seed);
+                                     if(plfh3<sim->p1slag){
+                                       setphase(xloop,yloop,zloop,SLAGCSH);
 					/* Assign a plate axes identifier to this slag C-S-H voxel */
-					msface=(int)(3.*ran1(seed)+1.);
+					msface=(int)(3.*ran1(simt->seed)+1.);
 					if(msface>3){msface=1;}
-					faces[xloop][yloop][zloop]=msface;
-                                       count[SLAGCSH]+=1;
+					sim->faces[VOXEL(xloop,yloop,zloop)]=msface;
                                      }
                                      else{
-					if(sealed==1){
+					if(sim->sealed==1){
                                         /* Create empty porosity at slag site */
-						slagemptyp+=1;
-						mic[xloop][yloop][zloop]=EMPTYP;
-                                                count[EMPTYP]+=1;
+						sim->slagemptyp+=1;
+						setphase(xloop,yloop,zloop,EMPTYP);
 					}
 					else{
-						mic[xloop][yloop][zloop]=POROSITY;
-                                                count[POROSITY]+=1;
+						setphase(xloop,yloop,zloop,POROSITY);
 					}
                                      }
                                      /* Add in extra SLAGCSH as needed */
-                                     p3init=p3slag;
+                                     p3init=sim->p3slag;
                                      while(p3init>1.0){
                                           extslagcsh(xloop,yloop,zloop);
                                           p3init-=1.0;
                                      }
-                                     plfh3=ran1(seed);
+                                     plfh3=ran1(simt->seed);
                                      if(plfh3<p3init){
                                           extslagcsh(xloop,yloop,zloop);
                                      }
                                 }
 			}
 		}
-        } /* end of zloop */
-       	} /* end of yloop */
-       	} /* end of xloop */
+        } /* end of ivisit loop */
+        sim->visitcsh=sim->visitslag=0;
+        ranstream(RNGCYCLE,2,0);
 
-	if(ncshgo!=0){printf("CSH dissolved is %ld \n",ncshgo);}
+	if(ncshgo!=0){logmsg(LOGDISSOLVE,LOGDEBUG,"CSH dissolved is %ld \n",ncshgo);}
 
-	if(npchext>0){printf("npchext is %ld at cycle %d \n",npchext,cycle);}
+	if(npchext>0){logmsg(LOGDISSOLVE,LOGDEBUG,"npchext is %ld at cycle %d \n",npchext,cycle);}
         /* Now add in the extra diffusing species for dissolution */
         /* Expansion factors from Young and Hansen and */
         /* Mindess and Young (Concrete) */
         ncshext=cshrand;
         if(cshrand!=0){
-                   printf("cshrand is %d \n",cshrand);
+                   logmsg(LOGDISSOLVE,LOGDEBUG,"cshrand is %d \n",cshrand);
         }
         /* CH, Gypsum, and diffusing C3A are added at totally random */
         /* locations as opposed to at the dissolution site */
-        fchext=0.61*(float)discount[C3S]+0.191*(float)discount[C2S]+
-        0.2584*(float)discount[C4AF];
+        fchext=0.61*(float)sim->discount[C3S]+0.191*(float)sim->discount[C2S]+
+        0.2584*(float)sim->discount[C4AF];
         nchext=fchext;
         if(fchext>(float)nchext){
-                pdis=ran1(seed);
+                pdis=ran1(simt->seed);
                	if((fchext-(float)nchext)>pdis){
                         nchext+=1;
                 }
         }
 	nchext+=npchext;
         /* Adjust CH addition for slag consumption and maintain deficit as needed */
-	slagcum+=discount[SLAG];
-	chgone=(int)(p4slag*(float)slagcum);
-        nchext-=chgone;
-	slagcum-=(int)((float)chgone/p4slag);
-        nchext-=DIFFCHdeficit;
-        DIFFCHdeficit=0;
+	sim->slagcum+=sim->discount[SLAG];
+	sim->chgone=(int)(sim->p4slag*(float)sim->slagcum);
+        nchext-=sim->chgone;
+	sim->slagcum-=(int)((float)sim->chgone/sim->p4slag);
+        nchext-=sim->DIFFCHdeficit;
+        sim->DIFFCHdeficit=0;
         if(nchext<0){
-               DIFFCHdeficit-=nchext;
+               sim->DIFFCHdeficit-=nchext;
                nchext=0;
         }
-       	fc3aext=discount[C3A]+0.5917*(float)discount[C3AH6];
+       	fc3aext=sim->discount[C3A]+0.5917*(float)sim->discount[C3AH6];
         nc3aext=fc3aext+nslagc3a;
         if(fc3aext>(float)nc3aext){
-                pdis=ran1(seed);
+                pdis=ran1(simt->seed);
                	if((fc3aext-(float)nc3aext)>pdis){
                         nc3aext+=1;
                 }
         }
-        fc4aext=0.696*(float)discount[C4AF];
+        fc4aext=0.696*(float)sim->discount[C4AF];
 	nc4aext=fc4aext;
 	if(fc4aext>(float)nc4aext){
-		pdis=ran1(seed);
+		pdis=ran1(simt->seed);
 		if((fc4aext-(float)nc4aext)>pdis){
 			nc4aext+=1;
 		}
 	}
 	/* both forms of GYPSUM form same DIFFGYP species */
-        ngypext=discount[GYPSUM]+discount[GYPSUMS];
+        ngypext=sim->discount[GYPSUM]+sim->discount[GYPSUMS];
 	/* Convert to diffusing anhydrite at volume necessary for final */
 	/* gypsum formation  (1 anhydrite --> 1.423 gypsum) */
 	/* Since hemihydrate can now react with C3A, etc., can't */
 	/* do expansion here any longer  7/99 */
 /*	fanhext=1.423*(float)discount[ANHYDRITE]; */
-	fanhext=(float)discount[ANHYDRITE];
+	fanhext=(float)sim->discount[ANHYDRITE];
         nanhext=fanhext;
         if(fanhext>(float)nanhext){
-                pdis=ran1(seed);
+                pdis=ran1(simt->seed);
                	if((fanhext-(float)nanhext)>pdis){
                         nanhext+=1;
                 }
@@ -2093,100 +1899,76 @@ CSH species??? */
 	/* gypsum formation  (1 hemihydrate --> 1.4 gypsum) */
 	/* Since hemihydrate can now react with C3A, etc., can't */
 	/* do expansion here any longer  7/99 */
-	fhemext=(float)discount[HEMIHYD];
+	fhemext=(float)sim->discount[HEMIHYD];
 /*	fhemext=1.3955*(float)discount[HEMIHYD];  */
 
         nhemext=fhemext;
         if(fhemext>(float)nhemext){
-                pdis=ran1(seed);
+                pdis=ran1(simt->seed);
                	if((fhemext-(float)nhemext)>pdis){
                         nhemext+=1;
                 }
         }
-        count[DIFFGYP]+=ngypext;
-        count[DIFFANH]+=nanhext;
-	count[DIFFHEM]+=nhemext;
-        count[DIFFCH]+=nchext;
-        count[DIFFCSH]+=ncshext;
-        count[DIFFC3A]+=nc3aext;
-        count[DIFFC4A]+=nc4aext;
 
 	nsum2=nchext+ncshext;
 	nsum3=nsum2+nc3aext;
 	nsum4=nsum3+nc4aext;
 	nsum5=nsum4+ngypext;
 	nsum6=nsum5+nhemext;
-	fflush(stdout);
+	logflush();
         for(xext=1;xext<=(nsum6+nanhext);xext++){
         plok=0;
         do{
-                xc=(int)((float)SYSIZE*ran1(seed));
-                yc=(int)((float)SYSIZE*ran1(seed));
-                zc=(int)((float)SYSIZE*ran1(seed));
-                if(xc>=SYSIZE){xc=0;}
-                if(yc>=SYSIZE){yc=0;}
-                if(zc>=SYSIZE){zc=0;}
-
-                if(mic[xc][yc][zc]==POROSITY){
+                if(randpore(&xc,&yc,&zc)){
                         plok=1;
                         phid=DIFFCH;
-			count[POROSITY]-=1;
                         if(xext>nsum6){phid=DIFFANH;}
                         else if(xext>nsum5){phid=DIFFHEM;}
                         else if(xext>nsum4){phid=DIFFGYP;}
 			else if(xext>nsum3){phid=DIFFC4A;}
                         else if(xext>nsum2){phid=DIFFC3A;}
                         else if(xext>nchext){phid=DIFFCSH;}
-                        mic[xc][yc][zc]=phid;
-                        nmade+=1;
-                        ngoing+=1;
-                        antadd=(struct ants *)malloc(sizeof(struct ants));
-                        antadd->x=xc;
-                        antadd->y=yc;
-                        antadd->z=zc;
-                        antadd->id=phid;
-			antadd->cycbirth=cyccnt;
-                     /* Now connect this ant structure to end of linked list */
-                        antadd->prevant=tailant;
-                        tailant->nextant=antadd;
-                        antadd->nextant=NULL;
-                        tailant=antadd;
+                        setphase(xc,yc,zc,phid);
+                        sim->nmade+=1;
+                        sim->ngoing+=1;
+                        addant(xc,yc,zc,phid);
                 }
         } while (plok==0);
 
         } /* end of xext for extra species generation */
+        profstop(PROFPASSTWO);
 
-        printf("Dissolved- %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld\n",count[DIFFCSH],
-        count[DIFFCH],count[DIFFGYP],count[DIFFC3A],count[DIFFFH3],
-        count[DIFFETTR],count[DIFFAS],count[DIFFANH],count[DIFFHEM],
-	count[DIFFCAS2],count[DIFFCACL2],count[DIFFCACO3]);
-      sulf_cur=count[DIFFGYP]+count[DIFFANH]+count[DIFFHEM];
+        logmsg(LOGDISSOLVE,LOGDEBUG,"Dissolved- %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld\n",simt->count[DIFFCSH],
+        simt->count[DIFFCH],simt->count[DIFFGYP],simt->count[DIFFC3A],simt->count[DIFFFH3],
+        simt->count[DIFFETTR],simt->count[DIFFAS],simt->count[DIFFANH],simt->count[DIFFHEM],
+	simt->count[DIFFCAS2],simt->count[DIFFCACL2],simt->count[DIFFCACO3]);
+      sim->sulf_cur=simt->count[DIFFGYP]+simt->count[DIFFANH]+simt->count[DIFFHEM];
 /*   	difffile=fopen("diffuse.out","a");
       fprintf(difffile,"%d %ld %f %f %f %f %f %f %f\n",cycle, sulf_cur, cs_acc, ca_acc, disprob[C3S], disprob[C3A], disprob[C4AF], dfact, dfact1);
 
       fclose(difffile); */
 
       	/* if too many diffusing gypsums already in solution */
-        if(sulf_cur>DGYPMAX){
-                disprob[GYPSUM]=disprob[GYPSUMS]=0.0;
+        if(sim->sulf_cur>DGYPMAX){
+                sim->disprob[GYPSUM]=sim->disprob[GYPSUMS]=0.0;
         }
         else{
-                disprob[GYPSUM]=disbase[GYPSUM];
-                disprob[ANHYDRITE]=disbase[ANHYDRITE];
-                disprob[HEMIHYD]=disbase[HEMIHYD];
-                disprob[GYPSUMS]=disbase[GYPSUMS];
+                sim->disprob[GYPSUM]=sim->disbase[GYPSUM];
+                sim->disprob[ANHYDRITE]=sim->disbase[ANHYDRITE];
+                sim->disprob[HEMIHYD]=sim->disbase[HEMIHYD];
+                sim->disprob[GYPSUMS]=sim->disbase[GYPSUMS];
         }
 
 
-        printf("C3AH6 dissolved- %ld with prob. of %f \n",nhgd,disprob[C3AH6]);
-        fflush(stdout);
+        logmsg(LOGDISSOLVE,LOGDEBUG,"C3AH6 dissolved- %ld with prob. of %f \n",nhgd,sim->disprob[C3AH6]);
+        logflush();
 }
 /* routine to add nneed one pixel elements of phase randid at random */
 /* locations in microstructure */
 /* Special features for addition of 1-pixel CACO3 and INERT particles */
 /* added 5/26/2004 */
 /* Called by main program */
-/* Calls no other routines */
+/* Calls randpore, countboxc and setphase */
 void addrand(randid,nneed)
         int randid;
         long int nneed;
@@ -2199,23 +1981,17 @@ void addrand(randid,nneed)
         for(ic=1;ic<=nneed;ic++){
                 success=0;
                 while(success==0){
-                        ix=(int)((float)SYSIZE*ran1(seed));
-                        iy=(int)((float)SYSIZE*ran1(seed));
-                        iz=(int)((float)SYSIZE*ran1(seed));
-                        if(ix==SYSIZE){ix=0;}
-                        if(iy==SYSIZE){iy=0;}
-                        if(iz==SYSIZE){iz=0;}
-                        if(mic[ix][iy][iz]==POROSITY){
+                        if(randpore(&ix,&iy,&iz)){
                             if((randid!=CACO3)&&(randid!=INERT)){
-                                mic[ix][iy][iz]=randid;
-				micorig[ix][iy][iz]=randid;
+                                setphase(ix,iy,iz,randid);
+				sim->micorig[VOXEL(ix,iy,iz)]=randid;
                                 success=1;
 			    }
                             else{
 				cpores=countboxc(3,ix,iy,iz);
                                 if(cpores>=26){
-                                	mic[ix][iy][iz]=randid;
-					micorig[ix][iy][iz]=randid;
+                                	setphase(ix,iy,iz,randid);
+					sim->micorig[VOXEL(ix,iy,iz)]=randid;
        		                        success=1;
 				}
                             }
@@ -2232,7 +2008,7 @@ void measuresurf()
 	for(sx=0;sx<SYSIZE;sx++){
 	for(sy=0;sy<SYSIZE;sy++){
 	for(sz=0;sz<SYSIZE;sz++){
-           if(mic[sx][sy][sz]==POROSITY){
+           if(sim->mic[VOXEL(sx,sy,sz)]==POROSITY){
            for(faceid=0;faceid<6;faceid++){
               if(faceid==1){
                   jx=sx-1;
@@ -2271,10 +2047,10 @@ void measuresurf()
                   jy=sy;
              }
             /* If the neighboring pixel is solid, update surface counts */
-		if((mic[jx][jy][jz]==C3S)||(mic[jx][jy][jz]==C2S)||(mic[jx][jy][jz]==C3A)||(mic[jx][jy][jz]==C4AF)||(mic[jx][jy][jz]==INERT)||(mic[jx][jy][jz]==CACO3)){
-		scnttotal+=1;
-		if((mic[jx][jy][jz]==C3S)||(mic[jx][jy][jz]==C2S)||(mic[jx][jy][jz]==C3A)||(mic[jx][jy][jz]==C4AF)){
-			scntcement+=1;
+		if((sim->mic[VOXEL(jx,jy,jz)]==C3S)||(sim->mic[VOXEL(jx,jy,jz)]==C2S)||(sim->mic[VOXEL(jx,jy,jz)]==C3A)||(sim->mic[VOXEL(jx,jy,jz)]==C4AF)||(sim->mic[VOXEL(jx,jy,jz)]==INERT)||(sim->mic[VOXEL(jx,jy,jz)]==CACO3)){
+		sim->scnttotal+=1;
+		if((sim->mic[VOXEL(jx,jy,jz)]==C3S)||(sim->mic[VOXEL(jx,jy,jz)]==C2S)||(sim->mic[VOXEL(jx,jy,jz)]==C3A)||(sim->mic[VOXEL(jx,jy,jz)]==C4AF)){
+			sim->scntcement+=1;
 		}
 	      }
              }
@@ -2283,11 +2059,11 @@ void measuresurf()
 	}
 	}
 	}
-	printf("Cement surface count is %ld \n",scntcement);
-	printf("Total surface count is %ld \n",scnttotal);
-	surffract=(float)scntcement/(float)scnttotal;
-	printf("Surface fraction is %f \n",surffract);
-	fflush(stdout);
+	logmsg(LOGSETUP,LOGINFO,"Cement surface count is %ld \n",sim->scntcement);
+	logmsg(LOGSETUP,LOGINFO,"Total surface count is %ld \n",sim->scnttotal);
+	sim->surffract=(float)sim->scntcement/(float)sim->scnttotal;
+	logmsg(LOGSETUP,LOGINFO,"Surface fraction is %f \n",sim->surffract);
+	logflush();
 }
 
 /* Routine resaturate to resaturate all empty porosity */
@@ -2300,536 +2076,657 @@ void resaturate()
 	for(sx=0;sx<SYSIZE;sx++){
 	for(sy=0;sy<SYSIZE;sy++){
 	for(sz=0;sz<SYSIZE;sz++){
-		if(mic[sx][sy][sz]==EMPTYP){
-			mic[sx][sy][sz]=POROSITY;
+		if(sim->mic[VOXEL(sx,sy,sz)]==EMPTYP){
+			setphase(sx,sy,sz,POROSITY);
 			nresat++;
 		}
 	}
 	}
 	}
 	if(nresat>0){
-		porefl1=porefl2=porefl3=1;
+		sim->porefl1=sim->porefl2=sim->porefl3=1;
 	}
-	printf("Number resaturated is %ld \n",nresat);
-	fflush(stdout);
+	logmsg(LOGCYCLE,LOGINFO,"Number resaturated is %ld \n",nresat);
+	logflush();
 }
 
-/* Calls init, dissolve and addrand */
-int main()
+/* routine to set the rate constants of hydration and of pozzolanic */
+/* and slag reactions for the current temperature, and the */
+/* probabilities of reaction that depend on them */
+/* Called by simstart, simcycle and cemhydsettemp */
+/* Calls no other routines */
+void setrates()
 {
-        int ntimes,valin,nmovstep,stopflag=0;	
-        int cycflag,ix,iy,iz,phtodo;
-        int iseed,phydfreq,oflag;
+        sim->krate=exp(-(1000.*sim->E_act/8.314)*((1./(sim->temp_cur+273.15))-(1./298.15)));
+	/* Determine pozzolanic and slag reaction rate constants */
+        sim->kpozz=exp(-(1000.*sim->E_act_pozz/8.314)*((1./(sim->temp_cur+273.15))-(1./298.15)));
+        sim->kslag=exp(-(1000.*sim->E_act_slag/8.314)*((1./(sim->temp_cur+273.15))-(1./298.15)));
+	/* Update probability of pozzolanic reaction */
+	/* based on ratio of pozzolanic reaction rate to hydration rate */
+	sim->ppozz=PPOZZ*sim->kpozz/sim->krate;
+        /* Assume same holds for dissolution of fly ash phases */
+	sim->disprob[ASG]=sim->disbase[ASG]*sim->kpozz/sim->krate;
+	sim->disprob[CAS2]=sim->disbase[CAS2]*sim->kpozz/sim->krate;
+	/* Update probability of slag dissolution */
+	sim->disprob[SLAG]=sim->slagreact*sim->disbase[SLAG]*sim->kslag/sim->krate;
+}
+
+/* routine to set name (of OUTNAME bytes) to that of the output file */
+/* of kind kind (heat, chs, ...) for cycle cycle, from the root name */
+/* Called by simstart and simcycle */
+/* Calls logdrop and logmsg */
+void namefile(name,kind,cycle)
+        char *name,*kind;
+        int cycle;
+{
+        if(snprintf(name,OUTNAME,"%s.%s.%d.%d.%1d%1d%1d",sim->fileroot,kind,cycle,(int)sim->temp_0,sim->csh2flag,sim->adiaflag,sim->sealed)>=OUTNAME){
+                logdrop();
+                logmsg(LOGOUTPUT,LOGERROR,"Root name %s too long for the .%s file \n",sim->fileroot,kind);
+                exit(1);
+        }
+}
+
+/* routine to read the parameters of a run and set up the */
+/* microstructure, up to the first cycle, from the images mic and */
+/* part if given (see cemhydload) or else from the image files named */
+/* in the parameters */
+/* Called by main program, ensmember and cemhydload */
+/* Calls init, addrand, measuresurf, setrates, profinit, logmsg and */
+/* logflush */
+void simstart(mic,part)
+        struct imgfile *mic,*part;
+{
+        int valin,icycfirst,ix,iy,iz,phtodo;
         long int nadd;
-        int xpl,xph,ypl,yph,fidc3s,fidc2s,fidc3a,fidc4af,fidgyp,fidagg,ffac3a;
-	int fidhem,fidanh,fidcaco3,nlen,pixtmp;
-        float pnucch,pscalech,pnuchg,pscalehg,pnucfh3,pscalefh3;
-	float pnucgyp,pscalegyp;
-	float thtimelo,thtimehi,thtemplo,thtemphi;
-        float mass_cement,mass_cem_now,mass_cur;
-        FILE *infile,*outfile,*adiafile,*thfile;
-        char filei[80],fileo[80],filetemp[80];
-
-        ngoing=0;
-	porefl1=porefl2=porefl3=1;
-	pore_off=water_off=0;
-        cycflag=0;
-        heat_old=heat_new=0.0;
-	chold=chnew=0;	   /* Current and previous cycle CH counts */
-        time_cur=0.0;      /* Elapsed time according to maturity principles */
-        cubesize=CUBEMAX;
-	ppozz=PPOZZ;
-        poregone=poretodo=0;
+        int fidc3s,fidc2s,fidc3a,fidc4af,fidgyp,fidagg,ffac3a;
+	int fidhem,fidanh,fidcaco3,nlen,nside;
+        struct imgfile img;
+        char filei[80],filetemp[80];
+
+        sim->ngoing=0;
+	sim->porefl1=sim->porefl2=sim->porefl3=1;
+	sim->pore_off=sim->water_off=0;
+        sim->cycflag=0;
+        sim->heat_old=sim->heat_new=0.0;
+	sim->chold=sim->chnew=0;	   /* Current and previous cycle CH counts */
+        sim->time_cur=0.0;      /* Elapsed time according to maturity principles */
+        sim->cubesize=CUBEMAX;
+	sim->ppozz=PPOZZ;
+        sim->poregone=sim->poretodo=0;
         /* Get random number seed */
-        printf("Enter random number seed \n");
-        scanf("%d",&iseed);
-        printf("%d\n",iseed);
-        seed=(&iseed);
-
-        printf("Dissolution bias is set at %f \n",DISBIAS);
-        /* Open file and read in original cement particle microstructure */
-        printf("Enter name of file to read initial microstructure from \n");
-        scanf("%s",filei);
-        printf("%s\n",filei);
-	nlen=strcspn(filei,".");
-        sprintf(fileroot,"");
-	strncat(fileroot,filei,nlen);
-        printf("nlen is %d and fileroot is now %s \n",nlen,fileroot);
-        fflush(stdout);
+        logmsg(LOGSETUP,LOGINFO,"Enter random number seed \n");
+        sim->iseed=cfgint("iseed");
+        logmsg(LOGSETUP,LOGINFO,"%d\n",sim->iseed);
+        simt->seed=(&sim->iseed);
+        raninit(sim->iseed);
+        ranstream(RNGCYCLE,0,0);
+        placeinit();
+        imginit(&sim->imgout,&sim->imgsnap);
+        if(sim->imgout==IMGBINARY){logmsg(LOGSETUP,LOGINFO,"Writing final microstructure in binary \n");}
+        if(sim->imgout==IMGCOMPRESSED){logmsg(LOGSETUP,LOGINFO,"Writing final microstructure compressed \n");}
+        if(sim->imgsnap==IMGBINARY){logmsg(LOGSETUP,LOGINFO,"Writing microstructure snapshots in binary \n");}
+        if(sim->imgsnap==IMGCOMPRESSED){logmsg(LOGSETUP,LOGINFO,"Writing microstructure snapshots compressed \n");}
+        sim->movmode=movinit(&sim->movspec,&sim->movkey);
+        if(sim->movmode){
+                logmsg(LOGSETUP,LOGINFO,"Writing movie of %s as changes, keyframe every %d frames \n",sim->movspec,sim->movkey);
+        }
+        outinit();
+        ckinit();
+        /* State of the main program carried from one cycle to the next */
+        CKADD(sim->iseed);
+        CKADD(sim->mass_cem_now);
+        CKADD(sim->thtimelo);
+        CKADD(sim->thtimehi);
+        CKADD(sim->thtemplo);
+        CKADD(sim->thtemphi);
+        CKADD(sim->thpos);
+
+        logmsg(LOGSETUP,LOGINFO,"Dissolution bias is set at %f \n",DISBIAS);
+        if(mic==NULL){
+                /* Open file and read in original cement particle microstructure */
+                logmsg(LOGSETUP,LOGINFO,"Enter name of file to read initial microstructure from \n");
+                cfgstring("micfile",filei);
+                logmsg(LOGSETUP,LOGINFO,"%s\n",filei);
+                nlen=strcspn(filei,".");
+                sim->fileroot[0]='\0';
+                strncat(sim->fileroot,filei,nlen);
+                logmsg(LOGSETUP,LOGINFO,"nlen is %d and fileroot is now %s \n",nlen,sim->fileroot);
+                logflush();
+        }
+        else if(cfggiven("micfile")!=NULL){
+                /* A member of an ensemble is given the images named, */
+                /* already read */
+                cfgstring("micfile",filei);
+        }
         /* Get phase assignments for original microstructure */
         /* to transform to needed ID values */
-     printf("Enter IDs in file for C3S, C2S, C3A, C4AF, Gypsum, Hemihydrate, Anhydrite, Aggregate CaCO3\n");
-    scanf("%d %d %d %d %d %d %d %d %d",&fidc3s,&fidc2s,&fidc3a,&fidc4af,&fidgyp,&fidhem,&fidanh,&fidagg,&fidcaco3);
-       printf("%d %d %d %d %d %d %d %d %d\n",fidc3s,fidc2s,fidc3a,fidc4af,fidgyp,fidhem,fidanh,fidagg,fidcaco3);
-       printf("Enter ID in file for C3A in fly ash  (default=35)\n");
-       scanf("%d",&ffac3a);
-       printf("%d\n",ffac3a);
-        fflush(stdout);
-
-        infile=fopen(filei,"r");
+     logmsg(LOGSETUP,LOGINFO,"Enter IDs in file for C3S, C2S, C3A, C4AF, Gypsum, Hemihydrate, Anhydrite, Aggregate CaCO3\n");
+        fidc3s=cfgint("fidc3s");
+        fidc2s=cfgint("fidc2s");
+        fidc3a=cfgint("fidc3a");
+        fidc4af=cfgint("fidc4af");
+        fidgyp=cfgint("fidgyp");
+        fidhem=cfgint("fidhem");
+        fidanh=cfgint("fidanh");
+        fidagg=cfgint("fidagg");
+        fidcaco3=cfgint("fidcaco3");
+       logmsg(LOGSETUP,LOGINFO,"%d %d %d %d %d %d %d %d %d\n",fidc3s,fidc2s,fidc3a,fidc4af,fidgyp,fidhem,fidanh,fidagg,fidcaco3);
+       logmsg(LOGSETUP,LOGINFO,"Enter ID in file for C3A in fly ash  (default=35)\n");
+       ffac3a=cfgint("ffac3a");
+       logmsg(LOGSETUP,LOGINFO,"%d\n",ffac3a);
+        logflush();
+
+        if(mic==NULL){
+                nside=imgopen(filei,&img);
+                if(nside==0){
+                        logmsg(LOGSETUP,LOGERROR,"Unable to open microstructure file %s \n",filei);
+                        exit(1);
+                }
+                mic=(&img);
+        }
+        else{
+                nside=mic->head.xsize;
+        }
+        /* Size and allocate the system based on the input image */
+        alloclattice(nside);
+        logmsg(LOGSETUP,LOGINFO,"System size is %d \n",SYSIZE);
 
         for(ix=0;ix<SYSIZE;ix++){
         for(iy=0;iy<SYSIZE;iy++){
         for(iz=0;iz<SYSIZE;iz++){
-		cshage[ix][iy][iz]=0;
-		faces[ix][iy][iz]=0;
-                fscanf(infile,"%d",&valin);
-                mic[ix][iy][iz]=valin;
+                valin=imgnext(mic);
+                sim->mic[VOXEL(ix,iy,iz)]=valin;
                 if(valin==fidc3s){
-                        mic[ix][iy][iz]=C3S;
+                        sim->mic[VOXEL(ix,iy,iz)]=C3S;
                 }
                 else if(valin==fidc2s){
-                        mic[ix][iy][iz]=C2S;
+                        sim->mic[VOXEL(ix,iy,iz)]=C2S;
                 }
                 else if((valin==fidc3a)||(valin==ffac3a)){
-                        mic[ix][iy][iz]=C3A;
+                        sim->mic[VOXEL(ix,iy,iz)]=C3A;
                 }
                 else if(valin==fidc4af){
-                        mic[ix][iy][iz]=C4AF;
+                        sim->mic[VOXEL(ix,iy,iz)]=C4AF;
                 }
                 else if(valin==fidgyp){
-                        mic[ix][iy][iz]=GYPSUM;
+                        sim->mic[VOXEL(ix,iy,iz)]=GYPSUM;
                 }
                 else if(valin==fidanh){
-                        mic[ix][iy][iz]=ANHYDRITE;
+                        sim->mic[VOXEL(ix,iy,iz)]=ANHYDRITE;
                 }
                 else if(valin==fidhem){
-                        mic[ix][iy][iz]=HEMIHYD;
+                        sim->mic[VOXEL(ix,iy,iz)]=HEMIHYD;
                 }
                 else if(valin==fidcaco3){
-                        mic[ix][iy][iz]=CACO3;
+                        sim->mic[VOXEL(ix,iy,iz)]=CACO3;
                 }
                 else if(valin==fidagg){
-                        mic[ix][iy][iz]=INERTAGG;
+                        sim->mic[VOXEL(ix,iy,iz)]=INERTAGG;
                 }
-		micorig[ix][iy][iz]=mic[ix][iy][iz];
+		sim->micorig[VOXEL(ix,iy,iz)]=sim->mic[VOXEL(ix,iy,iz)];
         }
         }
         }
-        fclose(infile);
-        fflush(stdout);
+        imgclose(mic);
+        logflush();
 
         /* Now read in particle IDs from file */
-        printf("Enter name of file to read particle IDs from \n");
-        scanf("%s",filei);
-        printf("%s\n",filei);
-        infile=fopen(filei,"r");
+        if(part==NULL){
+                logmsg(LOGSETUP,LOGINFO,"Enter name of file to read particle IDs from \n");
+                cfgstring("partfile",filei);
+                logmsg(LOGSETUP,LOGINFO,"%s\n",filei);
+                nside=imgopen(filei,&img);
+                if(nside==0){
+                        logmsg(LOGSETUP,LOGERROR,"Unable to open particle ID file %s \n",filei);
+                        exit(1);
+                }
+                part=(&img);
+        }
+        else{
+                if(cfggiven("partfile")!=NULL){cfgstring("partfile",filei);}
+                nside=part->head.xsize;
+        }
+        if(nside!=SYSIZE){
+                logmsg(LOGSETUP,LOGERROR,"Particle ID image size does not match microstructure \n");
+                exit(1);
+        }
 
         for(ix=0;ix<SYSIZE;ix++){
         for(iy=0;iy<SYSIZE;iy++){
         for(iz=0;iz<SYSIZE;iz++){
-                fscanf(infile,"%d",&valin);
-                micpart[ix][iy][iz]=valin;
+                valin=imgnext(part);
+                sim->micpart[VOXEL(ix,iy,iz)]=valin;
+                if(valin>sim->maxpartid){sim->maxpartid=valin;}
         }
         }
         }
 	
-        fclose(infile);
-        fflush(stdout);   
+        imgclose(part);
+        logflush();   
+
+        /* Count the phases and locate the solid pixels in contact */
+        /* with pore space */
+        initphases();
+#ifdef PARALLEL
+        initdomains();
+#endif
 
         /* Initialize counters, etc. */
-        npr=nasr=nslagr=0;
-        nfill=0;
-        ncsbar=0;
-        netbar=0;
-        porinit=0;
-        cyccnt=0;
-        setflag=0;
-        c3sinit=c2sinit=c3ainit=c4afinit=anhinit=heminit=slaginit=0;
-
-        /* Initialize structure for ants */
-        headant=(struct ants *)malloc(sizeof(struct ants));
-        headant->prevant=NULL;
-        headant->nextant=NULL;
-        headant->x=0;
-        headant->y=0;
-        headant->z=0;
-        headant->id=100;       /* special ID indicating first ant in list */
-	headant->cycbirth=0;
-        tailant=headant;
+        simt->npr=simt->nasr=sim->nslagr=0;
+        sim->nfill=0;
+        sim->ncsbar=0;
+        sim->netbar=0;
+        sim->porinit=0;
+        sim->cyccnt=0;
+        sim->setflag=0;
+        sim->c3sinit=sim->c2sinit=sim->c3ainit=sim->c4afinit=sim->anhinit=sim->heminit=sim->slaginit=0;
 
       /* Allow user to iteratively add one pixel particles of various phases */
       /* Typical application would be for addition of silica fume */
-        printf("Enter number of one pixel particles to add (0 to quit) \n");
-        scanf("%ld",&nadd);
-        printf("%ld\n",nadd);
+        logmsg(LOGSETUP,LOGINFO,"Enter number of one pixel particles to add (0 to quit) \n");
+        nadd=cfglong("nadd");
+        logmsg(LOGSETUP,LOGINFO,"%ld\n",nadd);
         while(nadd>0){
-                printf("Enter phase to add \n");
-                printf(" C3S 1 \n");
-                printf(" C2S 2 \n");
-                printf(" C3A 3 \n");
-                printf(" C4AF 4 \n");
-                printf(" GYPSUM 5 \n");
-                printf(" HEMIHYD 6 \n");
-                printf(" ANHYDRITE 7 \n");
-                printf(" POZZ 8 \n");
-                printf(" INERT 9 \n");
-                printf(" SLAG 10 \n");
-                printf(" ASG 11 \n");
-                printf(" CAS2 12 \n");
-                printf(" CH 13 \n");
-                printf(" CSH 14 \n");
-                printf(" C3AH6 15 \n");
-                printf(" Ettringite 16 \n");
-                printf(" Stable Ettringite from C4AF 17 \n");
-                printf(" AFM 18 \n");
-                printf(" FH3 19 \n");
-                printf(" POZZCSH 20 \n");
-                printf(" SLAGCSH 21 \n");
-                printf(" CACL2 22 \n");
-		printf(" Friedels salt 23 \n");
-		printf(" Stratlingite 24 \n");
-		printf(" Calcium carbonate 26 \n");
-                scanf("%d",&phtodo);
-                printf("%d \n",phtodo);
+                logmsg(LOGSETUP,LOGDEBUG,"Enter phase to add \n");
+                logmsg(LOGSETUP,LOGDEBUG," C3S 1 \n");
+                logmsg(LOGSETUP,LOGDEBUG," C2S 2 \n");
+                logmsg(LOGSETUP,LOGDEBUG," C3A 3 \n");
+                logmsg(LOGSETUP,LOGDEBUG," C4AF 4 \n");
+                logmsg(LOGSETUP,LOGDEBUG," GYPSUM 5 \n");
+                logmsg(LOGSETUP,LOGDEBUG," HEMIHYD 6 \n");
+                logmsg(LOGSETUP,LOGDEBUG," ANHYDRITE 7 \n");
+                logmsg(LOGSETUP,LOGDEBUG," POZZ 8 \n");
+                logmsg(LOGSETUP,LOGDEBUG," INERT 9 \n");
+                logmsg(LOGSETUP,LOGDEBUG," SLAG 10 \n");
+                logmsg(LOGSETUP,LOGDEBUG," ASG 11 \n");
+                logmsg(LOGSETUP,LOGDEBUG," CAS2 12 \n");
+                logmsg(LOGSETUP,LOGDEBUG," CH 13 \n");
+                logmsg(LOGSETUP,LOGDEBUG," CSH 14 \n");
+                logmsg(LOGSETUP,LOGDEBUG," C3AH6 15 \n");
+                logmsg(LOGSETUP,LOGDEBUG," Ettringite 16 \n");
+                logmsg(LOGSETUP,LOGDEBUG," Stable Ettringite from C4AF 17 \n");
+                logmsg(LOGSETUP,LOGDEBUG," AFM 18 \n");
+                logmsg(LOGSETUP,LOGDEBUG," FH3 19 \n");
+                logmsg(LOGSETUP,LOGDEBUG," POZZCSH 20 \n");
+                logmsg(LOGSETUP,LOGDEBUG," SLAGCSH 21 \n");
+                logmsg(LOGSETUP,LOGDEBUG," CACL2 22 \n");
+		logmsg(LOGSETUP,LOGDEBUG," Friedels salt 23 \n");
+		logmsg(LOGSETUP,LOGDEBUG," Stratlingite 24 \n");
+		logmsg(LOGSETUP,LOGDEBUG," Calcium carbonate 26 \n");
+                phtodo=cfgint("phtodo");
+                logmsg(LOGSETUP,LOGINFO,"%d \n",phtodo);
                 if((phtodo<0)||(phtodo>CACO3)){
-                      printf("Error in phase input for one pixel particles \n");
+                      logmsg(LOGSETUP,LOGERROR,"Error in phase input for one pixel particles \n");
                       exit(1);
                 }
                 addrand(phtodo,nadd);
-	printf("Enter number of one pixel particles to add (0 to quit) \n");
-                scanf("%ld",&nadd);
-                printf("%ld\n",nadd);
+	logmsg(LOGSETUP,LOGINFO,"Enter number of one pixel particles to add (0 to quit) \n");
+                nadd=cfglong("nadd");
+                logmsg(LOGSETUP,LOGINFO,"%ld\n",nadd);
         }
-        fflush(stdout);
+        logflush();
 
         init();
-        printf("After init routine \n");
-        printf("Enter number of cycles to execute \n");
-        scanf("%d",&ncyc);
-        printf("%d \n",ncyc);
-  printf("Do you wish hydration under 0) saturated or 1) sealed conditions \n");
-        scanf("%d",&sealed);
-        printf("%d \n",sealed);
-        printf("Enter max. # of diffusion steps per cycle (500) \n");
-        scanf("%d",&ntimes);
-        printf("%d \n",ntimes);
-        printf("Enter nuc. prob. and scale factor for CH nucleation \n");
-        scanf("%f %f",&pnucch,&pscalech);
-        printf("%f %f \n",pnucch,pscalech);
-        printf("Enter nuc. prob. and scale factor for gypsum nucleation \n");
-        scanf("%f %f",&pnucgyp,&pscalegyp);
-        printf("%f %f \n",pnucgyp,pscalegyp);
-        printf("Enter nuc. prob. and scale factor for C3AH6 nucleation \n");
-        scanf("%f %f",&pnuchg,&pscalehg);
-        printf("%f %f \n",pnuchg,pscalehg);
-        printf("Enter nuc. prob. and scale factor for FH3 nucleation \n");
-        scanf("%f %f",&pnucfh3,&pscalefh3);
-        printf("%f %f \n",pnucfh3,pscalefh3);
-        printf("Enter cycle frequency for checking pore space percolation \n");
-        scanf("%d",&burnfreq);
-        printf("%d\n",burnfreq);
-  printf("Enter cycle frequency for checking percolation of solids (set) \n");
-        scanf("%d",&setfreq);
-        printf("%d\n",setfreq);
-  printf("Enter cycle frequency for checking hydration of particles \n");
-        scanf("%d",&phydfreq);
-        printf("%d\n",phydfreq);
-  printf("Enter cycle frequency for outputting hydrating microstructure \n");
-        scanf("%d",&outfreq);
-        printf("%d\n",outfreq);
+        logmsg(LOGSETUP,LOGINFO,"After init routine \n");
+        logmsg(LOGSETUP,LOGINFO,"Enter number of cycles to execute \n");
+        sim->ncyc=cfgint("ncyc");
+        logmsg(LOGSETUP,LOGINFO,"%d \n",sim->ncyc);
+  logmsg(LOGSETUP,LOGINFO,"Do you wish hydration under 0) saturated or 1) sealed conditions \n");
+        sim->sealed=cfgint("sealed");
+        logmsg(LOGSETUP,LOGINFO,"%d \n",sim->sealed);
+        logmsg(LOGSETUP,LOGINFO,"Enter max. # of diffusion steps per cycle (500) \n");
+        sim->ntimes=cfgint("ntimes");
+        logmsg(LOGSETUP,LOGINFO,"%d \n",sim->ntimes);
+        logmsg(LOGSETUP,LOGINFO,"Enter nuc. prob. and scale factor for CH nucleation \n");
+        sim->pnucch=cfgfloat("pnucch");
+        sim->pscalech=cfgfloat("pscalech");
+        logmsg(LOGSETUP,LOGINFO,"%f %f \n",sim->pnucch,sim->pscalech);
+        logmsg(LOGSETUP,LOGINFO,"Enter nuc. prob. and scale factor for gypsum nucleation \n");
+        sim->pnucgyp=cfgfloat("pnucgyp");
+        sim->pscalegyp=cfgfloat("pscalegyp");
+        logmsg(LOGSETUP,LOGINFO,"%f %f \n",sim->pnucgyp,sim->pscalegyp);
+        logmsg(LOGSETUP,LOGINFO,"Enter nuc. prob. and scale factor for C3AH6 nucleation \n");
+        sim->pnuchg=cfgfloat("pnuchg");
+        sim->pscalehg=cfgfloat("pscalehg");
+        logmsg(LOGSETUP,LOGINFO,"%f %f \n",sim->pnuchg,sim->pscalehg);
+        logmsg(LOGSETUP,LOGINFO,"Enter nuc. prob. and scale factor for FH3 nucleation \n");
+        sim->pnucfh3=cfgfloat("pnucfh3");
+        sim->pscalefh3=cfgfloat("pscalefh3");
+        logmsg(LOGSETUP,LOGINFO,"%f %f \n",sim->pnucfh3,sim->pscalefh3);
+        logmsg(LOGSETUP,LOGINFO,"Enter cycle frequency for checking pore space percolation \n");
+        sim->burnfreq=cfgint("burnfreq");
+        logmsg(LOGSETUP,LOGINFO,"%d\n",sim->burnfreq);
+  logmsg(LOGSETUP,LOGINFO,"Enter cycle frequency for checking percolation of solids (set) \n");
+        sim->setfreq=cfgint("setfreq");
+        logmsg(LOGSETUP,LOGINFO,"%d\n",sim->setfreq);
+  logmsg(LOGSETUP,LOGINFO,"Enter cycle frequency for checking hydration of particles \n");
+        sim->phydfreq=cfgint("phydfreq");
+        logmsg(LOGSETUP,LOGINFO,"%d\n",sim->phydfreq);
+  logmsg(LOGSETUP,LOGINFO,"Enter cycle frequency for outputting hydrating microstructure \n");
+        sim->outfreq=cfgint("outfreq");
+        logmsg(LOGSETUP,LOGINFO,"%d\n",sim->outfreq);
         /* Parameters for adiabatic temperature rise calculation */
-        printf("Enter the induction time in hours \n");
-        scanf("%f",&ind_time);
-        printf("%f \n",ind_time);
-        time_cur+=ind_time;
-        printf("Enter the initial temperature in degrees Celsius \n");
-        scanf("%f",&temp_0);
-        printf("%f \n",temp_0);
-        temp_cur=temp_0;
-        printf("Enter the ambient temperature in degrees Celsius \n");
-        scanf("%f",&T_ambient);
-        printf("%f \n",T_ambient);
-        printf("Enter the overall heat transfer coefficient in J/g/C/s \n");
-        scanf("%f",&U_coeff);
-        printf("%f \n",U_coeff);
-        printf("Enter apparent activation energy for hydration in kJ/mole \n");
-        scanf("%f",&E_act);
-        printf("%f \n",E_act);
-        printf("Enter apparent activation energy for pozzolanic reactions in kJ/mole \n");
-        scanf("%f",&E_act_pozz);
-        printf("%f \n",E_act_pozz);
-        printf("Enter apparent activation energy for slag reactions in kJ/mole \n");
-        scanf("%f",&E_act_slag);
-        printf("%f \n",E_act_slag);
-        printf("Enter kinetic factor to convert cycles to time for 25 C \n");
-        scanf("%f",&beta);
-        printf("%f \n",beta);
-        printf("Enter mass fraction of aggregate in concrete \n");
-        scanf("%f",&mass_agg);
-        printf("%f \n",mass_agg);
-        printf("Hydration under 0) isothermal, 1) adiabatic or 2) programmed temperature history conditions \n");
-        scanf("%d",&adiaflag);
-        printf("%d \n",adiaflag);
-	if(adiaflag==2){
-		thfile=fopen("temphist.dat","r");
-		fscanf(thfile,"%f %f %f %f",&thtimelo,&thtimehi,&thtemplo,&thtemphi);
-		printf("%f %f %f %f\n",thtimelo,thtimehi,thtemplo,thtemphi);
+        logmsg(LOGSETUP,LOGINFO,"Enter the induction time in hours \n");
+        sim->ind_time=cfgfloat("ind_time");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->ind_time);
+        sim->time_cur+=sim->ind_time;
+        logmsg(LOGSETUP,LOGINFO,"Enter the initial temperature in degrees Celsius \n");
+        sim->temp_0=cfgfloat("temp_0");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->temp_0);
+        sim->temp_cur=sim->temp_0;
+        logmsg(LOGSETUP,LOGINFO,"Enter the ambient temperature in degrees Celsius \n");
+        sim->T_ambient=cfgfloat("T_ambient");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->T_ambient);
+        logmsg(LOGSETUP,LOGINFO,"Enter the overall heat transfer coefficient in J/g/C/s \n");
+        sim->U_coeff=cfgfloat("U_coeff");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->U_coeff);
+        logmsg(LOGSETUP,LOGINFO,"Enter apparent activation energy for hydration in kJ/mole \n");
+        sim->E_act=cfgfloat("E_act");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->E_act);
+        logmsg(LOGSETUP,LOGINFO,"Enter apparent activation energy for pozzolanic reactions in kJ/mole \n");
+        sim->E_act_pozz=cfgfloat("E_act_pozz");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->E_act_pozz);
+        logmsg(LOGSETUP,LOGINFO,"Enter apparent activation energy for slag reactions in kJ/mole \n");
+        sim->E_act_slag=cfgfloat("E_act_slag");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->E_act_slag);
+        logmsg(LOGSETUP,LOGINFO,"Enter kinetic factor to convert cycles to time for 25 C \n");
+        sim->beta=cfgfloat("beta");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->beta);
+        logmsg(LOGSETUP,LOGINFO,"Enter mass fraction of aggregate in concrete \n");
+        sim->mass_agg=cfgfloat("mass_agg");
+        logmsg(LOGSETUP,LOGINFO,"%f \n",sim->mass_agg);
+        logmsg(LOGSETUP,LOGINFO,"Hydration under 0) isothermal, 1) adiabatic or 2) programmed temperature history conditions \n");
+        sim->adiaflag=cfgint("adiaflag");
+        logmsg(LOGSETUP,LOGINFO,"%d \n",sim->adiaflag);
+	cfgstring("thfile",filetemp);
+	if(sim->adiaflag==2){
+		sim->thfile=fopen(filetemp,"r");
+		if(sim->thfile==NULL){
+			logmsg(LOGSETUP,LOGERROR,"Unable to open temperature history file %s \n",filetemp);
+			exit(1);
+		}
+		fscanf(sim->thfile,"%f %f %f %f",&sim->thtimelo,&sim->thtimehi,&sim->thtemplo,&sim->thtemphi);
+		logmsg(LOGSETUP,LOGINFO,"%f %f %f %f\n",sim->thtimelo,sim->thtimehi,sim->thtemplo,sim->thtemphi);
 	}
-	printf("CSH to pozzolanic CSH 0) prohibited or 1) allowed \n");
-	scanf("%d",&csh2flag);
-	printf("%d \n",csh2flag);
-	printf("CH precipitation on aggregate surfaces 0) prohibited or 1) allowed \n");
-	scanf("%d",&chflag);
-	printf("%d \n",chflag);
-        printf("Number of slices in hydration movie \n");
-        scanf("%d",&nummovsl);
-        printf("%d \n",nummovsl);
-        nmovstep=1;
-        if(nummovsl>0){
-		nmovstep=ncyc/nummovsl;
-                if(nmovstep<1){nmovstep=1;}
-        }
-        printf("Dissolution bias factor for one-pixel particles \n");
-        scanf("%f",&onepixelbias);
-        printf("%f\n",onepixelbias);
-	printf("Enter number of cycles before executing total resaturation \n");
-	scanf("%d",&resatcyc);
-	printf("%d\n",resatcyc);
-	printf("Enter choice for C-S-H geometry 0) random or 1) plates \n");
-	scanf("%d",&cshgeom);
-	printf("%d \n",cshgeom);
-        printf("Does pH influence hydration kinetics 0) no or 1) yes \n");
-        scanf("%d",&pHactive);
-        printf("%d\n",pHactive);
-        fflush(stdout);
-        sprintf(heatname,"%s.heat.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        sprintf(moviename,"%s.mov.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        sprintf(chshrname,"%s.chs.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        sprintf(adianame,"%s.adi.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        sprintf(parname,"%s.par.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
+	logmsg(LOGSETUP,LOGINFO,"CSH to pozzolanic CSH 0) prohibited or 1) allowed \n");
+	sim->csh2flag=cfgint("csh2flag");
+	logmsg(LOGSETUP,LOGINFO,"%d \n",sim->csh2flag);
+	logmsg(LOGSETUP,LOGINFO,"CH precipitation on aggregate surfaces 0) prohibited or 1) allowed \n");
+	sim->chflag=cfgint("chflag");
+	logmsg(LOGSETUP,LOGINFO,"%d \n",sim->chflag);
+        logmsg(LOGSETUP,LOGINFO,"Number of slices in hydration movie \n");
+        sim->nummovsl=cfgint("nummovsl");
+        logmsg(LOGSETUP,LOGINFO,"%d \n",sim->nummovsl);
+        if(sim->outoff){sim->nummovsl=0;}
+        sim->nmovstep=1;
+        if(sim->nummovsl>0){
+		sim->nmovstep=sim->ncyc/sim->nummovsl;
+                if(sim->nmovstep<1){sim->nmovstep=1;}
+        }
+        logmsg(LOGSETUP,LOGINFO,"Dissolution bias factor for one-pixel particles \n");
+        sim->onepixelbias=cfgfloat("onepixelbias");
+        logmsg(LOGSETUP,LOGINFO,"%f\n",sim->onepixelbias);
+	logmsg(LOGSETUP,LOGINFO,"Enter number of cycles before executing total resaturation \n");
+	sim->resatcyc=cfgint("resatcyc");
+	logmsg(LOGSETUP,LOGINFO,"%d\n",sim->resatcyc);
+	logmsg(LOGSETUP,LOGINFO,"Enter choice for C-S-H geometry 0) random or 1) plates \n");
+	sim->cshgeom=cfgint("cshgeom");
+	logmsg(LOGSETUP,LOGINFO,"%d \n",sim->cshgeom);
+        logmsg(LOGSETUP,LOGINFO,"Does pH influence hydration kinetics 0) no or 1) yes \n");
+        sim->pHactive=cfgint("pHactive");
+        logmsg(LOGSETUP,LOGINFO,"%d\n",sim->pHactive);
+        logflush();
+        namefile(sim->heatname,"heat",sim->ncyc);
+        namefile(sim->moviename,"mov",sim->ncyc);
+        namefile(sim->chshrname,"chs",sim->ncyc);
+        namefile(sim->adianame,"adi",sim->ncyc);
+        namefile(sim->parname,"par",sim->ncyc);
 	/* Store filename for pH file and initialize with column headings */
-        sprintf(pHname,"%s.phv.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
+        namefile(sim->pHname,"phv",sim->ncyc);
 /*        pHfile=fopen(pHname,"w");
         fprintf(pHfile,"Cycle time(h) alpha_mass pH sigma [Na+] [K+] [Ca++] [SO4--] activityCa activityOH activitySO4 activityK molesSyngenite\n");
         fclose(pHfile); */
-        sprintf(fileo,"%s.img.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        sprintf(phname,"%s.pha.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        sprintf(ppsname,"%s.pps.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
+        namefile(sim->imgname,"img",sim->ncyc);
+        namefile(sim->phname,"pha",sim->ncyc);
+        namefile(sim->ppsname,"pps",sim->ncyc);
         /* Store parameters input in parameter file */
-        sprintf(cmdnew,"cp disrealnew.out %s",parname);
-        system(cmdnew);
-        if(burnfreq<=ncyc){
-           ptmpfile=fopen(ppsname,"w");
-           fprintf(ptmpfile,"Cycle time(h) alpha_mass conn_por total_por frac_conn\n");
-           fclose(ptmpfile);
+        cfgsave(sim->parname);
+        if(sim->burnfreq<=sim->ncyc){
+           outcreate(sim->ppsname);
+           outprintf(sim->ppsname,"Cycle time(h) alpha_mass conn_por total_por frac_conn\n");
        }
-        sprintf(ptsname,"%s.pts.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        if(setfreq<=ncyc){
-           ptmpfile=fopen(ptsname,"w");
-           fprintf(ptmpfile,"Cycle time(h) alpha_mass conn_solid total_solid frac_conn\n");
-           fclose(ptmpfile);
+        namefile(sim->ptsname,"pts",sim->ncyc);
+        if(sim->setfreq<=sim->ncyc){
+           outcreate(sim->ptsname);
+           outprintf(sim->ptsname,"Cycle time(h) alpha_mass conn_solid total_solid frac_conn\n");
        }
-        sprintf(phrname,"%s.phr.%d.%d.%1d%1d%1d",fileroot,ncyc,(int)temp_0,csh2flag,adiaflag,sealed);
-        krate=exp(-(1000.*E_act/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-	/* Determine pozzolanic and slag reaction rate constants */
-        kpozz=exp(-(1000.*E_act_pozz/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-        kslag=exp(-(1000.*E_act_slag/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-	/* Update probability of pozzolanic reaction */
-	/* based on ratio of pozzolanic reaction rate to hydration rate */
-	ppozz=PPOZZ*kpozz/krate;
-        /* Assume same holds for dissolution of fly ash phases */
-	disprob[ASG]=disbase[ASG]*kpozz/krate;
-	disprob[CAS2]=disbase[CAS2]*kpozz/krate;
-	/* Update probability of slag dissolution */
-	disprob[SLAG]=slagreact*disbase[SLAG]*kslag/krate;
-        printf("%s\n",adianame);
-        fflush(stdout);
-        adiafile=fopen(adianame,"w");
-fprintf(adiafile,"Time(h) Temperature  Alpha  Krate   Cp_now  Mass_cem kpozz/khyd kslag/khyd\n");
+        namefile(sim->phrname,"phr",sim->ncyc);
+        ckfile(sim->heatname);
+        ckfile(sim->chshrname);
+        ckfile(sim->adianame);
+        ckfile(sim->phname);
+        ckfile(sim->ppsname);
+        ckfile(sim->ptsname);
+        ckfile(sim->phrname);
+        ckfile(sim->pHname);
+        ckfile(sim->moviename);
+        profinit();
+        setrates();
+        logmsg(LOGSETUP,LOGINFO,"%s\n",sim->adianame);
+        logflush();
+        outcreate(sim->adianame);
+outprintf(sim->adianame,"Time(h) Temperature  Alpha  Krate   Cp_now  Mass_cem kpozz/khyd kslag/khyd\n");
 	/* Set initial properties of CSH */
-	molarvcsh[0]=molarv[CSH];
-	watercsh[0]=waterc[CSH];
+	sim->molarvcsh[0]=sim->molarv[CSH];
+	sim->watercsh[0]=sim->waterc[CSH];
 	/* Determine surface counts */
 	measuresurf();
-        for(icyc=1;icyc<=ncyc;icyc++){
-		if((sealed==1)&&(icyc==(resatcyc+1))&&(resatcyc!=0)){
+        icycfirst=1;
+        if(sim->ckrestart!=NULL){
+                icycfirst=ckload()+1;
+                if(sim->adiaflag==2){
+                        fseek(sim->thfile,sim->thpos,SEEK_SET);
+                }
+                if((sim->movmode)&&(sim->nummovsl>0)&&((icycfirst-1)>=sim->nmovstep)){
+                        movresume(sim->moviename,&sim->movie);
+                }
+        }
+        sim->icyc=icycfirst;
+}
+
+/* routine to carry out cycle icyc of the hydration, and write its */
+/* results */
+/* Called by main program and cemhydstep */
+/* Calls dissolve, hydrate, setrates, pHpred, burn3d, burnset, */
+/* parthyd, profstart, profstop, profcycle, logmsg and logflush */
+void simcycle()
+{
+        int ix,iy,iz,pixtmp;
+        float mass_cement,mass_cur;
+        char *micout;
+
+		if((sim->sealed==1)&&(sim->icyc==(sim->resatcyc+1))&&(sim->resatcyc!=0)){
 			resaturate();
-			sealed=0;
+			sim->sealed=0;
 		}
-	if(temp_cur<=80.0){
-		molarvcsh[icyc]=molarv[CSH]-8.0*((temp_cur-20.)/(80.-20.));
-		watercsh[icyc]=waterc[CSH]-1.3*((temp_cur-20.)/(80.-20.));
+	if(sim->temp_cur<=80.0){
+		sim->molarvcsh[sim->icyc]=sim->molarv[CSH]-8.0*((sim->temp_cur-20.)/(80.-20.));
+		sim->watercsh[sim->icyc]=sim->waterc[CSH]-1.3*((sim->temp_cur-20.)/(80.-20.));
 	}
 	else{
-		molarvcsh[icyc]=molarv[CSH]-8.0;
-		watercsh[icyc]=waterc[CSH]-1.3;
+		sim->molarvcsh[sim->icyc]=sim->molarv[CSH]-8.0;
+		sim->watercsh[sim->icyc]=sim->waterc[CSH]-1.3;
 	}
-                if(icyc==ncyc){cycflag=1;}
-                printf("Calling dissolve \n");
-                fflush(stdout);
-                dissolve(icyc);
-printf("Number dissolved this pass- %ld total diffusing- %ld \n",nmade,ngoing);
-                fflush(stdout);
-               	if(icyc==1){
-                     printf("ncsbar is %ld   netbar is %ld \n",ncsbar,netbar);
+                if(sim->icyc==sim->ncyc){sim->cycflag=1;}
+                logmsg(LOGCYCLE,LOGDEBUG,"Calling dissolve \n");
+                logflush();
+                dissolve(sim->icyc);
+logmsg(LOGCYCLE,LOGINFO,"Number dissolved this pass- %ld total diffusing- %ld \n",sim->nmade,sim->ngoing);
+                logflush();
+               	if(sim->icyc==1){
+                     logmsg(LOGCYCLE,LOGDEBUG,"ncsbar is %ld   netbar is %ld \n",sim->ncsbar,sim->netbar);
                 }
-      hydrate(cycflag,ntimes,pnucch,pscalech,pnuchg,pscalehg,pnucfh3,pscalefh3,pnucgyp,pscalegyp);
-      printf("Returned from hydrate \n");
-      fflush(stdout);
-                temp_0=temp_cur;
+      profstart(PROFHYDRATE);
+      hydrate(sim->cycflag,sim->ntimes,sim->pnucch,sim->pscalech,sim->pnuchg,sim->pscalehg,sim->pnucfh3,sim->pscalefh3,sim->pnucgyp,sim->pscalegyp);
+      profstop(PROFHYDRATE);
+      logmsg(LOGCYCLE,LOGDEBUG,"Returned from hydrate \n");
+      logflush();
+                sim->temp_0=sim->temp_cur;
                 /* Handle adiabatic case first */
                 /* Cement + aggregate +water + filler=1;  that's all there is */
-                mass_cement=1.-mass_agg-mass_fill-mass_water-mass_CH;
-		mass_cem_now=mass_cement;
-                if(adiaflag==1){
+                mass_cement=1.-sim->mass_agg-sim->mass_fill-sim->mass_water-sim->mass_CH;
+		sim->mass_cem_now=mass_cement;
+                if(sim->adiaflag==1){
                         /* determine heat capacity of current mixture, */
                         /* accounting for imbibed water if necessary */
-                        if(sealed==1){
-                                Cp_now=mass_agg*Cp_agg;
-                                Cp_now+=Cp_pozz*mass_fill;
-                                Cp_now+=Cp_cement*mass_cement;
-				Cp_now+=Cp_CH*mass_CH;
-	Cp_now+=(Cp_h2o*mass_water-alpha_cur*WN*mass_cement*(Cp_h2o-Cp_bh2o));
-                                mass_cem_now=mass_cement;
+                        if(sim->sealed==1){
+                                sim->Cp_now=sim->mass_agg*Cp_agg;
+                                sim->Cp_now+=Cp_pozz*sim->mass_fill;
+                                sim->Cp_now+=Cp_cement*mass_cement;
+				sim->Cp_now+=Cp_CH*sim->mass_CH;
+	sim->Cp_now+=(Cp_h2o*sim->mass_water-sim->alpha_cur*WN*mass_cement*(Cp_h2o-Cp_bh2o));
+                                sim->mass_cem_now=mass_cement;
                         }
                 /* Else need to account for extra capillary water drawn in */
         /* Basis is WCHSH(0.06) g H2O per gram cement for chemical shrinkage */
                 /* Need to adjust mass basis to account for extra imbibed H2O */
                         else{
-                                mass_cur=1.+WCHSH*mass_cement*alpha_cur;
-                                Cp_now=mass_agg*Cp_agg/mass_cur;
-                                Cp_now+=Cp_pozz*mass_fill/mass_cur;
-                                Cp_now+=Cp_cement*mass_cement/mass_cur;
-				Cp_now+=Cp_CH*mass_CH/mass_cur;
-        Cp_now+=(Cp_h2o*mass_water-alpha_cur*WN*mass_cement*(Cp_h2o-Cp_bh2o));
-        Cp_now+=(WCHSH*Cp_h2o*alpha_cur*mass_cement);
-                                mass_cem_now=mass_cement/mass_cur;
+                                mass_cur=1.+WCHSH*mass_cement*sim->alpha_cur;
+                                sim->Cp_now=sim->mass_agg*Cp_agg/mass_cur;
+                                sim->Cp_now+=Cp_pozz*sim->mass_fill/mass_cur;
+                                sim->Cp_now+=Cp_cement*mass_cement/mass_cur;
+				sim->Cp_now+=Cp_CH*sim->mass_CH/mass_cur;
+        sim->Cp_now+=(Cp_h2o*sim->mass_water-sim->alpha_cur*WN*mass_cement*(Cp_h2o-Cp_bh2o));
+        sim->Cp_now+=(WCHSH*Cp_h2o*sim->alpha_cur*mass_cement);
+                                sim->mass_cem_now=mass_cement/mass_cur;
                         }
-                /* Determine rate constant based on Arrhenius expression */
+                /* Determine rate constants based on Arrhenius expression */
                 /* Recall that temp_cur is in degrees Celsius */
-         krate=exp(-(1000.*E_act/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-		/* Determine pozzolanic and slag reaction rate constant */
-         kpozz=exp(-(1000.*E_act_pozz/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-         kslag=exp(-(1000.*E_act_slag/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-		/* Update probability of pozzolanic and slag reactions */
-    /* based on ratio of pozzolanic (slag) reaction rate to hydration rate */
-		ppozz=PPOZZ*kpozz/krate;
-		disprob[ASG]=disbase[ASG]*kpozz/krate;
-		disprob[CAS2]=disbase[CAS2]*kpozz/krate;
-		disprob[SLAG]=slagreact*disbase[SLAG]*kslag/krate;
+                setrates();
 
                 /* Update temperature based on heat generated and current Cp */
-		if(mass_cem_now>0.01){
-	               	temp_cur=temp_0+mass_cem_now*heat_cf*(heat_new-heat_old)/Cp_now;
+		if(sim->mass_cem_now>0.01){
+	               	sim->temp_cur=sim->temp_0+sim->mass_cem_now*sim->heat_cf*(sim->heat_new-sim->heat_old)/sim->Cp_now;
 		}
 		else{
-	               	temp_cur=temp_0+mass_fill_pozz*heat_cf*(heat_new-heat_old)/Cp_now;
+	               	sim->temp_cur=sim->temp_0+sim->mass_fill_pozz*sim->heat_cf*(sim->heat_new-sim->heat_old)/sim->Cp_now;
 
 		}
 		/* Update system temperature due to heat loss/gain to/from */
 		/* surroundings (semi-adiabatic case)  */
-		temp_cur-=(temp_cur-T_ambient)*time_step*U_coeff/Cp_now;
+		sim->temp_cur-=(sim->temp_cur-sim->T_ambient)*sim->time_step*sim->U_coeff/sim->Cp_now;
                 }
-		else if(adiaflag==2){
+		else if(sim->adiaflag==2){
 			/* Update system temperature based on current time */
 			/* and requested temperature history */
-			while((time_cur>thtimehi)&&(!feof(thfile))){
-				fscanf(thfile,"%f %f %f %f",&thtimelo,&thtimehi,&thtemplo,&thtemphi);
-				printf("New temperature history values : \n");
-				printf("%f %f %f %f\n",thtimelo,thtimehi,thtemplo,thtemphi);
+			while((sim->time_cur>sim->thtimehi)&&(!feof(sim->thfile))){
+				fscanf(sim->thfile,"%f %f %f %f",&sim->thtimelo,&sim->thtimehi,&sim->thtemplo,&sim->thtemphi);
+				logmsg(LOGCYCLE,LOGINFO,"New temperature history values : \n");
+				logmsg(LOGCYCLE,LOGINFO,"%f %f %f %f\n",sim->thtimelo,sim->thtimehi,sim->thtemplo,sim->thtemphi);
 			}
-		if((thtimehi-thtimelo)>0.0){
-			temp_cur=thtemplo+(thtemphi-thtemplo)*(time_cur-thtimelo)/(thtimehi-thtimelo);
+		if((sim->thtimehi-sim->thtimelo)>0.0){
+			sim->temp_cur=sim->thtemplo+(sim->thtemphi-sim->thtemplo)*(sim->time_cur-sim->thtimelo)/(sim->thtimehi-sim->thtimelo);
 		}
 		else{
-			temp_cur=thtemplo;
+			sim->temp_cur=sim->thtemplo;
 		}
-         krate=exp(-(1000.*E_act/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-         kpozz=exp(-(1000.*E_act_pozz/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-         kslag=exp(-(1000.*E_act_slag/8.314)*((1./(temp_cur+273.15))-(1./298.15)));
-		ppozz=PPOZZ*kpozz/krate;
-		disprob[ASG]=disbase[ASG]*kpozz/krate;
-		disprob[CAS2]=disbase[CAS2]*kpozz/krate;
-		disprob[SLAG]=slagreact*disbase[SLAG]*kslag/krate;
+                setrates();
 		}
                 /* Update time based on simple numerical integration */
                 /* simulating maturity approach */
                 /* with parabolic kinetics (Knudsen model) */
-                if(cyccnt>1){
-			time_cur+=(2.*(float)(cyccnt-1)-1.0)*beta/krate;
-			time_step=(2.*(float)(cyccnt-1)-1.0)*beta/krate;
+                if(sim->cyccnt>1){
+			sim->time_cur+=(2.*(float)(sim->cyccnt-1)-1.0)*sim->beta/sim->krate;
+			sim->time_step=(2.*(float)(sim->cyccnt-1)-1.0)*sim->beta/sim->krate;
 		}
-                fprintf(adiafile,"%f %f %f %f %f %f %f %f\n",time_cur,temp_cur,
-                 alpha_cur,krate,Cp_now,mass_cem_now,kpozz/krate,kslag/krate);
-                fflush(adiafile);
-                gsratio2=0.0;
-                gsratio2+=(float)(count[CH]+count[CSH]+count[C3AH6]+count[ETTR]);
-                gsratio2+=(float)(count[POZZCSH]+count[SLAGCSH]+count[FH3]+count[AFM]+count[ETTRC4AF]);
-                gsratio2+=(float)(count[FREIDEL]+count[STRAT]+count[ABSGYP]+count[AFMC]);
-                gsratio2=(gsratio2)/(gsratio2+(float)(count[POROSITY]+count[EMPTYP]));
-                heatfile=fopen(heatname,"a");
-                if(w_to_c!=0.0){
-       		        fprintf(heatfile,"%d %f %f %f %f %f  %f \n",
-       		  cyccnt-1,time_cur,alpha,alpha_cur,heat_new*heat_cf,gsratio2,((0.68*alpha_cur)/(0.32*alpha_cur+w_to_c)));
+                outprintf(sim->adianame,"%f %f %f %f %f %f %f %f\n",sim->time_cur,sim->temp_cur,
+                 sim->alpha_cur,sim->krate,sim->Cp_now,sim->mass_cem_now,sim->kpozz/sim->krate,sim->kslag/sim->krate);
+                sim->gsratio2=0.0;
+                sim->gsratio2+=(float)(simt->count[CH]+simt->count[CSH]+simt->count[C3AH6]+simt->count[ETTR]);
+                sim->gsratio2+=(float)(simt->count[POZZCSH]+simt->count[SLAGCSH]+simt->count[FH3]+simt->count[AFM]+simt->count[ETTRC4AF]);
+                sim->gsratio2+=(float)(simt->count[FREIDEL]+simt->count[STRAT]+simt->count[ABSGYP]+simt->count[AFMC]);
+                sim->gsratio2=(sim->gsratio2)/(sim->gsratio2+(float)(simt->count[POROSITY]+simt->count[EMPTYP]));
+                if(sim->w_to_c!=0.0){
+       		        outprintf(sim->heatname,"%d %f %f %f %f %f  %f \n",
+       		  sim->cyccnt-1,sim->time_cur,sim->alpha,sim->alpha_cur,sim->heat_new*sim->heat_cf,sim->gsratio2,((0.68*sim->alpha_cur)/(0.32*sim->alpha_cur+sim->w_to_c)));
                 }
                 else{
-       	        	fprintf(heatfile,"%d %f %f %f %f %f  %f \n",
-	         cyccnt-1,time_cur,alpha,alpha_cur,heat_new*heat_cf,gsratio2,0.0);
+       	        	outprintf(sim->heatname,"%d %f %f %f %f %f  %f \n",
+	         sim->cyccnt-1,sim->time_cur,sim->alpha,sim->alpha_cur,sim->heat_new*sim->heat_cf,sim->gsratio2,0.0);
                 }
-                fclose(heatfile);
-                chsfile=fopen(chshrname,"a");
-                fprintf(chsfile,"%d %f %f %f\n",
-         cyccnt-1,time_cur,alpha_cur,chs_new);
-                fclose(chsfile);
+                outprintf(sim->chshrname,"%d %f %f %f\n",
+         sim->cyccnt-1,sim->time_cur,sim->alpha_cur,sim->chs_new);
+                profstart(PROFPH);
                 pHpred();
-                printf("Returned from call to pH \n");
-                fflush(stdout);
+                profstop(PROFPH);
+                logmsg(LOGCYCLE,LOGDEBUG,"Returned from call to pH \n");
+                logflush();
         /* Check percolation of pore space */
 	/* Note that first variable passed corresponds to phase to check */
 	/* Could easily add calls to check for percolation of CH, CSH, etc. */
-        if(((icyc%burnfreq)==0)&&((porefl1+porefl2+porefl3)!=0)){
-               porefl1=burn3d(0,1,0,0);
-               porefl2=burn3d(0,0,1,0);
-               porefl3=burn3d(0,0,0,1);
+        if(((sim->icyc%sim->burnfreq)==0)&&((sim->porefl1+sim->porefl2+sim->porefl3)!=0)){
+               profstart(PROFBURN3D);
+               burn3d(0,&sim->porefl1,&sim->porefl2,&sim->porefl3);
+               profstop(PROFBURN3D);
+               if((sim->porefl1+sim->porefl2+sim->porefl3)==0){percfree(PERCPORE);}
 		/* Switch to self-desiccating conditions when porosity */
 		/* disconnects */
-		if(((porefl1+porefl2+porefl3)==0)&&(sealed==0)){
-			water_off=water_left;
-			pore_off=countkeep;
-			sealed=1;
-			printf("Switching to self-desiccating at cycle %d \n",cyccnt);
-			fflush(stdout);
+		if(((sim->porefl1+sim->porefl2+sim->porefl3)==0)&&(sim->sealed==0)){
+			sim->water_off=sim->water_left;
+			sim->pore_off=sim->countkeep;
+			sim->sealed=1;
+			logmsg(LOGCYCLE,LOGINFO,"Switching to self-desiccating at cycle %d \n",sim->cyccnt);
+			logflush();
 		}
         }
         /* Check percolation of solids (set point) */
-        if(((icyc%setfreq)==0)&&(setflag==0)){
-                sf1=burnset(1,0,0);
-                sf2=burnset(0,1,0);
-                sf3=burnset(0,0,1);
-		setflag=sf1*sf2*sf3;
+        if(((sim->icyc%sim->setfreq)==0)&&(sim->setflag==0)){
+                profstart(PROFBURNSET);
+                burnset(&sim->sf1,&sim->sf2,&sim->sf3);
+                profstop(PROFBURNSET);
+		sim->setflag=sim->sf1*sim->sf2*sim->sf3;
+                if(sim->setflag!=0){percfree(PERCSET);}
         }
 
 
 	/* Check hydration of particles */
-	if((icyc%phydfreq)==0){
+	if((sim->icyc%sim->phydfreq)==0){
+                profstart(PROFPARTHYD);
 		parthyd();
+                profstop(PROFPARTHYD);
 	}
         /* Output movie microstructure if desired */
-               if((nummovsl>0)&&((icyc%nmovstep)==0)){
-                        if(icyc==nmovstep){
-				movfile=fopen(moviename,"w");
+        profstart(PROFOUTPUT);
+               if((sim->nummovsl>0)&&((sim->icyc%sim->nmovstep)==0)&&(sim->movmode)){
+                        if(sim->icyc==sim->nmovstep){
+                                movcreate(sim->moviename,SYSIZE,sim->movspec,sim->movkey,&sim->movie);
+                        }
+                        movwrite(&sim->movie,sim->mic,sim->icyc);
+               }
+               else if((sim->nummovsl>0)&&((sim->icyc%sim->nmovstep)==0)){
+                        if(sim->icyc==sim->nmovstep){
+				sim->movfile=fopen(sim->moviename,"w");
                         }
                         else{
-				movfile=fopen(moviename,"a");
+				sim->movfile=fopen(sim->moviename,"a");
                         }
 
 			for(ix=0;ix<SYSIZE;ix++){
 			for(iy=0;iy<SYSIZE;iy++){
-    				fprintf(movfile,"%d\n",(int)mic[50][ix][iy]);
+    				fprintf(sim->movfile,"%d\n",(int)sim->mic[VOXEL(SYSIZE/2,ix,iy)]);
 			}
 			}
-			fclose(movfile);
+			fclose(sim->movfile);
 		}
         /* Output complete microstructure every outfreq cycles */
-               if((icyc>0)&&((icyc%outfreq)==0)){
-       		 sprintf(micname,"%s.ima.%d.%d.%1d%1d%1d",fileroot,icyc,(int)temp_0,csh2flag,adiaflag,sealed);
-			micfile=fopen(micname,"w");
+               if((sim->icyc>0)&&((sim->icyc%sim->outfreq)==0)&&(!sim->outoff)){
+       		 namefile(sim->micname,"ima",sim->icyc);
+			micout=outbuffer(SYSIZE);
 
 			for(ix=0;ix<SYSIZE;ix++){
 			for(iy=0;iy<SYSIZE;iy++){
 			for(iz=0;iz<SYSIZE;iz++){
-                                pixtmp=(int)mic[ix][iy][iz];
+                                pixtmp=(int)sim->mic[VOXEL(ix,iy,iz)];
                                 if(pixtmp==DIFFCSH){
                                    pixtmp=CSH;
                                 }
@@ -2869,66 +2766,116 @@ printf("Number dissolved this pass- %ld total diffusing- %ld \n",nmade,ngoing);
                                 else if (pixtmp==DIFFCH){
                                    pixtmp=CH;
                                 }
-    				fprintf(micfile,"%d\n",pixtmp);
+    				micout[VOXEL(ix,iy,iz)]=pixtmp;
 			}
 			}
                         }
-			fclose(micfile);
+			outsnapshot(sim->micname,micout,SYSIZE,sim->imgsnap);
 		}
+        outflush();
+        profstop(PROFOUTPUT);
+        /* Write the profile of the cycle before it is checkpointed */
+        profcycle();
+        /* Save the state every ckevery cycles */
+        if((sim->ckevery>0)&&((sim->icyc%sim->ckevery)==0)){
+                if(sim->adiaflag==2){
+                        sim->thpos=ftell(sim->thfile);
+                }
+                profstart(PROFCKPT);
+                ckwrite(sim->icyc);
+                profstop(PROFCKPT);
+        }
 
+        /* Report the cycle to a caller of the library (see cemhydlib.c) */
+        if(sim->cyclefn!=NULL){
+                (*sim->cyclefn)(sim,sim->icyc,sim->cyclearg);
         }
+        sim->icyc+=1;
+}
+
+/* routine to end the hydration after the last cycle, and write the */
+/* final results */
+/* Called by main program and cemhydfinish */
+/* Calls dissolve, pHpred, burn3d, burnset, profstart, profstop, */
+/* profreport and logmsg */
+void simend()
+{
 	/* Last call to dissolve to terminate hydration */
         dissolve(0);
         /* Check percolation of pore space */
 	/* Note that first variable passed corresponds to phase to check */
 	/* Could easily add calls to check for percolation of CH, CSH, etc. */
-        if((burnfreq!=0)&&(burnfreq<=ncyc)&&((porefl1+porefl2+porefl3)!=0)){
-               porefl1=burn3d(0,1,0,0);
-               porefl2=burn3d(0,0,1,0);
-               porefl3=burn3d(0,0,0,1);
+        if((sim->burnfreq!=0)&&(sim->burnfreq<=sim->ncyc)&&((sim->porefl1+sim->porefl2+sim->porefl3)!=0)){
+               profstart(PROFBURN3D);
+               burn3d(0,&sim->porefl1,&sim->porefl2,&sim->porefl3);
+               profstop(PROFBURN3D);
         }
         /* Check percolation of solids (set point) */
-        if((setfreq!=0)&&(setfreq<=ncyc)){
-                setflag=burnset(1,0,0);
-                setflag+=burnset(0,1,0);
-                setflag+=burnset(0,0,1);
+        if((sim->setfreq!=0)&&(sim->setfreq<=sim->ncyc)){
+                profstart(PROFBURNSET);
+                burnset(&sim->sf1,&sim->sf2,&sim->sf3);
+                profstop(PROFBURNSET);
+                sim->setflag=sim->sf1+sim->sf2+sim->sf3;
         }
 
         /* Output last lines of heat and chemical shrinkage files */
-        if(cyccnt>1){
-		time_cur+=(2.*(float)cyccnt-1.0)*beta/krate;
-		time_step=(2.*(float)cyccnt-1.0)*beta/krate;
+        if(sim->cyccnt>1){
+		sim->time_cur+=(2.*(float)sim->cyccnt-1.0)*sim->beta/sim->krate;
+		sim->time_step=(2.*(float)sim->cyccnt-1.0)*sim->beta/sim->krate;
 	}
-        fprintf(adiafile,"%f %f %f %f %f %f %f %f\n",time_cur,temp_cur,
-          alpha_cur,krate,Cp_now,mass_cem_now,kpozz/krate,kslag/krate);
-        fflush(adiafile);
-        fclose(adiafile);
-        gsratio2=0.0;
-        gsratio2+=(float)(count[CH]+count[CSH]+count[C3AH6]+count[ETTR]);
-        gsratio2+=(float)(count[POZZCSH]+count[SLAGCSH]+count[FH3]+count[AFM]+count[ETTRC4AF]);
-        gsratio2+=(float)(count[FREIDEL]+count[STRAT]+count[ABSGYP]+count[AFMC]);
-        gsratio2=(gsratio2)/(gsratio2+(float)(count[POROSITY]+count[EMPTYP]));
-        heatfile=fopen(heatname,"a");
-        fprintf(heatfile,"%d %f %f %f %f %f %f\n",
-         cyccnt,time_cur,alpha,alpha_cur,heat_new*heat_cf,gsratio2,((0.68*alpha_cur)/(0.32*alpha_cur+w_to_c)));
-        fclose(heatfile);
-        chsfile=fopen(chshrname,"a");
-        fprintf(chsfile,"%d %f %f %f\n",
-        cyccnt,time_cur,alpha_cur,((float)(count[EMPTYP]+count[POROSITY]-water_left)*heat_cf/1000.));
-        fclose(chsfile);
-        cyccnt+=1;
+        outprintf(sim->adianame,"%f %f %f %f %f %f %f %f\n",sim->time_cur,sim->temp_cur,
+          sim->alpha_cur,sim->krate,sim->Cp_now,sim->mass_cem_now,sim->kpozz/sim->krate,sim->kslag/sim->krate);
+        sim->gsratio2=0.0;
+        sim->gsratio2+=(float)(simt->count[CH]+simt->count[CSH]+simt->count[C3AH6]+simt->count[ETTR]);
+        sim->gsratio2+=(float)(simt->count[POZZCSH]+simt->count[SLAGCSH]+simt->count[FH3]+simt->count[AFM]+simt->count[ETTRC4AF]);
+        sim->gsratio2+=(float)(simt->count[FREIDEL]+simt->count[STRAT]+simt->count[ABSGYP]+simt->count[AFMC]);
+        sim->gsratio2=(sim->gsratio2)/(sim->gsratio2+(float)(simt->count[POROSITY]+simt->count[EMPTYP]));
+        outprintf(sim->heatname,"%d %f %f %f %f %f %f\n",
+         sim->cyccnt,sim->time_cur,sim->alpha,sim->alpha_cur,sim->heat_new*sim->heat_cf,sim->gsratio2,((0.68*sim->alpha_cur)/(0.32*sim->alpha_cur+sim->w_to_c)));
+        outprintf(sim->chshrname,"%d %f %f %f\n",
+        sim->cyccnt,sim->time_cur,sim->alpha_cur,((float)(simt->count[EMPTYP]+simt->count[POROSITY]-sim->water_left)*sim->heat_cf/1000.));
+        sim->cyccnt+=1;
+        profstart(PROFPH);
 	pHpred();
-	printf("Final count for ncshplategrow is %ld \n",ncshplategrow);
-	printf("Final count for ncshplateinit is %ld \n",ncshplateinit);
+        profstop(PROFPH);
+	logmsg(LOGCYCLE,LOGINFO,"Final count for ncshplategrow is %ld \n",simt->ncshplategrow);
+	logmsg(LOGCYCLE,LOGINFO,"Final count for ncshplateinit is %ld \n",simt->ncshplateinit);
         /* Output final microstructure if desired */
-                outfile=fopen(fileo,"w");
+        profstart(PROFOUTPUT);
+        if(!sim->outoff){
+                imgsave(sim->imgname,sim->mic,SYSIZE,sim->imgout);
+        }
+        if((sim->movmode)&&(sim->movie.file!=NULL)){
+                movclose(&sim->movie);
+        }
+        profstop(PROFOUTPUT);
+        /* Print the time spent in each kernel (see prof.c) */
+        profreport();
+}
 
-                for(ix=0;ix<SYSIZE;ix++){
-                for(iy=0;iy<SYSIZE;iy++){
-                for(iz=0;iz<SYSIZE;iz++){
-                        fprintf(outfile,"%d\n",(int)mic[ix][iy][iz]);
-                }
-                }
-                }
-	fclose(outfile);
+#ifndef CEMHYDLIB
+/* Messages are all printed if the parameters are typed in, and */
+/* otherwise only warnings and errors, unless CEMHYD_LOG says (see log.c) */
+/* Calls cfginit, loginit, logmsg, ensrun, simstart, simcycle and */
+/* simend */
+int main(argc,argv)
+        int argc;
+        char *argv[];
+{
+        simuse(simnew());
+        cfginit(argc,argv);
+        if(loginit(getenv("CEMHYD_LOG"),((!sim->cfgkeyed)&&isatty(0))?LOGDEBUG:LOGWARN)!=0){
+                logmsg(LOGSETUP,LOGERROR,"CEMHYD_LOG %s should be a level (error, warn, info or debug) and subsystem=level pairs \n",getenv("CEMHYD_LOG"));
+                exit(1);
+        }
+        atexit(outclose);
+        /* An ensemble runs its members and exits (see ensemble.c) */
+        ensrun();
+        simstart((struct imgfile *)NULL,(struct imgfile *)NULL);
+        while(sim->icyc<=sim->ncyc){
+                simcycle();
+        }
+        simend();
+        return(0);
 }
+#endif
@@ -0,0 +1,459 @@
+/* Routines to run an ensemble of hydrations of one microstructure */
+/* Usage: disrealnew -c configfile [-e ensemblefile] [-n nseed] [-j njob] */
+/* Each line of the ensemble file (blank lines and anything following */
+/* # are ignored) gives a set of parameters as name=value pairs, */
+/* separated by blanks, that replace those of the configuration file, */
+/* such as E_act=38.0 beta=0.0004; with no ensemble file there is a */
+/* single set, the configuration file itself */
+/* Each set is run nseed times (default 1) with the seeds iseed, */
+/* iseed-1, iseed-2, ... where iseed is that of the set */
+/* The images are read only once, into memory that all members read */
+/* but none change; each member is then a simulation of its own (see */
+/* sim.c), run on a thread of this process, with its own lattices, */
+/* random numbers, output files and printed output, as for runs */
+/* through the library (see cemhydlib.c) */
+/* At most njob members (default the number of processors) run at */
+/* once; member r of set s writes its files, and its printed output */
+/* (disrealnew.out), to the directory fileroot.s.r */
+/* When all are done, the heat files of the members of each set are */
+/* gathered into fileroot.s.ens, giving for each cycle the mean time, */
+/* degree of hydration and heat, each with the half width of its 95% */
+/* confidence band over the seeds */
+/* Parameters read before the microstructure is assigned (the image */
+/* files and phase IDs) are shared by all members and cannot be set */
+/* in the ensemble file; as every value is checked before any member */
+/* starts, an error in a member (such as running out of memory) ends */
+/* the whole ensemble */
+
+#include "cemhyd.h"
+
+#define ENSMAXSET 256	/* most sets of parameters */
+#define ENSLINE 1024	/* longest line of ensemble file */
+
+/* a member of the ensemble */
+struct ensmem{
+        int set;	/* set of parameters */
+        int seed;
+        char dir[80];	/* directory of output */
+};
+
+char *enssets[ENSMAXSET];	/* sets of parameters, as name=value pairs */
+int nensset=0;
+struct ensmem *ensmems;
+int nensmem=0;
+int ensnext=0;		/* next member to start */
+pthread_mutex_t ensmutex=PTHREAD_MUTEX_INITIALIZER;	/* guards ensnext */
+struct sim *ensparent;	/* simulation that runs the ensemble */
+int *ensmic,*enspart;	/* pixel values of the images, read once */
+int ensnside;
+
+/* routine to read the sets of parameters in ensemble file name, */
+/* checking each value before any image is read */
+/* Called by cfginit */
+/* Calls cfgfind, cfgshared, cfgvalid and logmsg */
+void ensread(name)
+        char *name;
+{
+        FILE *ensfile;
+        char line[ENSLINE],pair[ENSLINE],source[ENSLINE+40],*hash,*pos,*eq;
+        struct cfgkey *key;
+        int nline,len;
+
+        ensfile=fopen(name,"r");
+        if(ensfile==NULL){
+                logmsg(LOGENSEMBLE,LOGERROR,"Unable to open ensemble file %s \n",name);
+                exit(1);
+        }
+        nline=0;
+        while(fgets(line,ENSLINE,ensfile)!=NULL){
+                nline+=1;
+                hash=strchr(line,'#');
+                if(hash!=NULL){*hash='\0';}
+                line[strcspn(line,"\r\n")]='\0';
+                pos=line+strspn(line," \t");
+                if(*pos=='\0'){continue;}
+                if(nensset>=ENSMAXSET){
+                        logmsg(LOGENSEMBLE,LOGERROR,"Too many sets of parameters in %s \n",name);
+                        exit(1);
+                }
+                /* Check each pair now, rather than in every member */
+                while(*pos!='\0'){
+                        len=strcspn(pos," \t");
+                        strncpy(pair,pos,len);
+                        pair[len]='\0';
+                        eq=strchr(pair,'=');
+                        if((eq==NULL)||(eq==pair)||(eq[1]=='\0')){
+                                logmsg(LOGENSEMBLE,LOGERROR,"Expected name=value on line %d of %s \n",nline,name);
+                                exit(1);
+                        }
+                        *eq='\0';
+                        key=cfgfind(pair);
+                        if(key==NULL){
+                                logmsg(LOGENSEMBLE,LOGERROR,"Unknown parameter %s on line %d of %s \n",pair,nline,name);
+                                exit(1);
+                        }
+                        if((strcmp(pair,"iseed")!=0)&&(cfgshared(key))){
+                                logmsg(LOGENSEMBLE,LOGERROR,"Parameter %s on line %d of %s is the same for all members \n",pair,nline,name);
+                                exit(1);
+                        }
+                        sprintf(source,"line %d of %s",nline,name);
+                        cfgvalid(key,eq+1,source);
+                        pos+=len;
+                        pos+=strspn(pos," \t");
+                }
+                pos=line+strspn(line," \t");
+                enssets[nensset]=(char *)malloc(strlen(pos)+1);
+                if(enssets[nensset]==NULL){
+                        logmsg(LOGENSEMBLE,LOGERROR,"Unable to allocate memory for ensemble \n");
+                        exit(1);
+                }
+                strcpy(enssets[nensset],pos);
+                nensset+=1;
+        }
+        fclose(ensfile);
+        if(nensset==0){
+                logmsg(LOGENSEMBLE,LOGERROR,"No sets of parameters in ensemble file %s \n",name);
+                exit(1);
+        }
+}
+
+/* routine to return the seed given in set of parameters set, or */
+/* iseed if it has none */
+/* Called by ensrun */
+/* Calls no other routines */
+int ensseed(set,iseed)
+        char *set;
+        int iseed;
+{
+        char *pos;
+
+        for(pos=set;(pos=strstr(pos,"iseed="))!=NULL;pos+=6){
+                if((pos==set)||(pos[-1]==' ')||(pos[-1]=='\t')){
+                        return(atoi(pos+6));
+                }
+        }
+        return(iseed);
+}
+
+/* routine to read image file name (what it holds) into memory, */
+/* returning its pixel values and its size in *nside */
+/* Called by ensrun */
+/* Calls imgopen, imgnext, imgclose and logmsg */
+int *ensimage(name,what,nside)
+        char *name,*what;
+        int *nside;
+{
+        struct imgfile img;
+        long int iv,nvox;
+        int *pix;
+
+        *nside=imgopen(name,&img);
+        if(*nside==0){
+                logmsg(LOGENSEMBLE,LOGERROR,"Unable to open %s file %s \n",what,name);
+                exit(1);
+        }
+        nvox=(long int)(*nside)*(*nside)*(*nside);
+        pix=(int *)malloc(nvox*sizeof(int));
+        if(pix==NULL){
+                logmsg(LOGENSEMBLE,LOGERROR,"Unable to allocate memory for ensemble \n");
+                exit(1);
+        }
+        for(iv=0;iv<nvox;iv++){
+                pix[iv]=imgnext(&img);
+        }
+        imgclose(&img);
+        return(pix);
+}
+
+/* routine to run member im of the ensemble, as a simulation of its */
+/* own on the calling thread, from the parameters of the simulation */
+/* that runs the ensemble and the images it read */
+/* Called by ensworker */
+/* Calls simnew, simuse, loginit, cfgmember, imgmemory, simstart, */
+/* simcycle, simend, outclose, simfree and logmsg */
+void ensmember(im)
+        int im;
+{
+        struct sim *s;
+        struct imgfile micimg,partimg;
+        char pair[ENSLINE],name[120],*pos,*eq;
+        int len,isub;
+
+        s=simnew();
+        simuse(s);
+        loginit((char *)NULL,LOGWARN);
+        for(isub=0;isub<NLOGSUB;isub++){
+                sim->loglevel[isub]=ensparent->loglevel[isub];
+        }
+        sprintf(name,"%s/disrealnew.out",ensmems[im].dir);
+        sim->logfile=fopen(name,"w");
+        if(sim->logfile==NULL){
+                simuse(ensparent);
+                logmsg(LOGENSEMBLE,LOGERROR,"Unable to write %s \n",name);
+                exit(1);
+        }
+        /* Parameters as read by the simulation that runs the ensemble, */
+        /* none of them used yet */
+        memcpy(sim->cfgentries,ensparent->cfgentries,sizeof(sim->cfgentries));
+        sim->ncfgentry=ensparent->ncfgentry;
+        sim->cfgkeyed=1;
+        logmsg(LOGENSEMBLE,LOGINFO,"Member %d of ensemble, seed %d \n",im,ensmems[im].seed);
+        if(nensset>0){
+                logmsg(LOGENSEMBLE,LOGINFO,"Parameters %s \n",enssets[ensmems[im].set]);
+                for(pos=enssets[ensmems[im].set];*pos!='\0';){
+                        len=strcspn(pos," \t");
+                        strncpy(pair,pos,len);
+                        pair[len]='\0';
+                        eq=strchr(pair,'=');
+                        *eq='\0';
+                        if(strcmp(pair,"iseed")!=0){
+                                cfgmember(pair,eq+1,"ensemble file");
+                        }
+                        pos+=len;
+                        pos+=strspn(pos," \t");
+                }
+        }
+        sprintf(name,"%d",ensmems[im].seed);
+        cfgmember("iseed",name,"ensemble");
+        if(snprintf(sim->fileroot,sizeof(sim->fileroot),"%s/%s",ensmems[im].dir,ensparent->fileroot)>=(int)sizeof(sim->fileroot)){
+                logmsg(LOGENSEMBLE,LOGERROR,"Root name %s too long for ensemble directories \n",ensparent->fileroot);
+                exit(1);
+        }
+
+        imgmemory((unsigned char *)ensmic,4,ensnside,&micimg);
+        imgmemory((unsigned char *)enspart,4,ensnside,&partimg);
+        simstart(&micimg,&partimg);
+        while(sim->icyc<=sim->ncyc){
+                simcycle();
+        }
+        simend();
+        outclose();
+        fclose(sim->logfile);
+        simfree(s);
+}
+
+/* routine run by each thread of the ensemble, to run members in turn */
+/* until none are left */
+/* Called by ensrun, through pthread_create */
+/* Calls ensmember, simuse, logmsg and logflush */
+void *ensworker(arg)
+        void *arg;
+{
+        int im;
+
+        for(;;){
+                pthread_mutex_lock(&ensmutex);
+                im=ensnext;
+                ensnext+=1;
+                pthread_mutex_unlock(&ensmutex);
+                if(im>=nensmem){break;}
+                ensmember(im);
+                /* Report to the output of the ensemble, one at a time */
+                pthread_mutex_lock(&ensmutex);
+                simuse(ensparent);
+                logmsg(LOGENSEMBLE,LOGINFO,"Member %d (set %d, seed %d) finished \n",im,ensmems[im].set,ensmems[im].seed);
+                logflush();
+                pthread_mutex_unlock(&ensmutex);
+        }
+        return(NULL);
+}
+
+/* routine to return the t value for a two sided 95% confidence band */
+/* with ndf degrees of freedom */
+/* Called by ensgather */
+/* Calls no other routines */
+double enst95(ndf)
+        int ndf;
+{
+        static double ttab[30]={12.706,4.303,3.182,2.776,2.571,2.447,2.365,
+                2.306,2.262,2.228,2.201,2.179,2.160,2.145,2.131,2.120,2.110,
+                2.101,2.093,2.086,2.080,2.074,2.069,2.064,2.060,2.056,2.052,
+                2.048,2.045,2.042};
+
+        if(ndf<1){return(0.0);}
+        if(ndf<=30){return(ttab[ndf-1]);}
+        return(1.96+2.4/(double)ndf);
+}
+
+/* routine to gather the heat files of the members of set iset, that */
+/* finished, into the file fileroot.iset.ens */
+/* Called by ensrun */
+/* Calls outcreate, outprintf and logmsg */
+void ensgather(iset)
+        int iset;
+{
+        DIR *dir;
+        struct dirent *ent;
+        FILE *heatfile;
+        char name[400],line[256];
+        double *sums,val[3],mean[3],half[3],var;
+        int im,cyc,maxcyc,ncols,iv,nmem,nused;
+        long int *nrow;
+
+        /* Sums over members of time, alpha and heat and their squares */
+        maxcyc=-1;
+        sums=NULL;
+        nrow=NULL;
+        nmem=nused=0;
+        for(im=0;im<nensmem;im++){
+                if(ensmems[im].set!=iset){continue;}
+                nmem+=1;
+                dir=opendir(ensmems[im].dir);
+                heatfile=NULL;
+                while((dir!=NULL)&&((ent=readdir(dir))!=NULL)){
+                        if(strstr(ent->d_name,".heat.")!=NULL){
+                                sprintf(name,"%s/%s",ensmems[im].dir,ent->d_name);
+                                heatfile=fopen(name,"r");
+                                break;
+                        }
+                }
+                if(dir!=NULL){closedir(dir);}
+                if(heatfile==NULL){
+                        logmsg(LOGENSEMBLE,LOGWARN,"No heat file for member %d in %s \n",im,ensmems[im].dir);
+                        continue;
+                }
+                nused+=1;
+                /* Skip the column headings */
+                fgets(line,256,heatfile);
+                while(fgets(line,256,heatfile)!=NULL){
+                        /* Columns are cycle, time, alpha_vol, alpha_mass and heat */
+                        ncols=sscanf(line,"%d %lf %*f %lf %lf",&cyc,&val[0],&val[1],&val[2]);
+                        if((ncols!=4)||(cyc<0)){continue;}
+                        if(cyc>maxcyc){
+                                sums=(double *)realloc(sums,(cyc+1)*6*sizeof(double));
+                                nrow=(long int *)realloc(nrow,(cyc+1)*sizeof(long int));
+                                if((sums==NULL)||(nrow==NULL)){
+                                        logmsg(LOGENSEMBLE,LOGERROR,"Unable to allocate memory for ensemble \n");
+                                        exit(1);
+                                }
+                                for(;maxcyc<cyc;maxcyc++){
+                                        nrow[maxcyc+1]=0;
+                                        for(iv=0;iv<6;iv++){sums[(maxcyc+1)*6+iv]=0.0;}
+                                }
+                        }
+                        nrow[cyc]+=1;
+                        for(iv=0;iv<3;iv++){
+                                sums[cyc*6+2*iv]+=val[iv];
+                                sums[cyc*6+2*iv+1]+=val[iv]*val[iv];
+                        }
+                }
+                fclose(heatfile);
+        }
+
+        sprintf(name,"%s.%d.ens",sim->fileroot,iset);
+        outcreate(name);
+        outprintf(name,"# %d of %d members of set %d",nused,nmem,iset);
+        if(nensset>0){outprintf(name,": %s",enssets[iset]);}
+        outprintf(name,"\n");
+        outprintf(name,"Cycle members time(h) time_ci95 alpha_mass alpha_ci95 heat4(kJ/kg_solid) heat_ci95\n");
+        for(cyc=0;cyc<=maxcyc;cyc++){
+                if(nrow[cyc]==0){continue;}
+                for(iv=0;iv<3;iv++){
+                        mean[iv]=sums[cyc*6+2*iv]/(double)nrow[cyc];
+                        half[iv]=0.0;
+                        if(nrow[cyc]>1){
+                                var=(sums[cyc*6+2*iv+1]-(double)nrow[cyc]*mean[iv]*mean[iv])/(double)(nrow[cyc]-1);
+                                if(var<0.0){var=0.0;}
+                                half[iv]=enst95((int)nrow[cyc]-1)*sqrt(var/(double)nrow[cyc]);
+                        }
+                }
+                outprintf(name,"%d %ld %f %f %f %f %f %f\n",cyc,nrow[cyc],mean[0],half[0],mean[1],half[1],mean[2],half[2]);
+        }
+        if(sums!=NULL){free(sums);}
+        if(nrow!=NULL){free(nrow);}
+        logmsg(LOGENSEMBLE,LOGINFO,"Gathered %d members of set %d into %s \n",nused,iset,name);
+}
+
+/* routine to run the ensemble, if one was asked for, returning */
+/* otherwise: the images are read, the members run on at most ensjobs */
+/* threads and their results gathered, after which the program exits */
+/* Called by main program */
+/* Calls cfggiven, ensimage, ensseed, ensworker, ensgather and logmsg */
+void ensrun()
+{
+        pthread_t *threads;
+        char *micfile;
+        int iset,ir,im,nsets,iseed,nthr,ithr,nside;
+
+        if((ensname==NULL)&&(ensseeds==0)){return;}
+        if(ensseeds<1){ensseeds=1;}
+        if(ensjobs<1){
+                ensjobs=(int)sysconf(_SC_NPROCESSORS_ONLN);
+                if(ensjobs<1){ensjobs=1;}
+        }
+        ensparent=sim;
+        /* Members are named from the microstructure, as is a single run */
+        micfile=cfggiven("micfile");
+        sim->fileroot[0]='\0';
+        strncat(sim->fileroot,micfile,strcspn(micfile,"."));
+        /* Leave room for the output file names */
+        if((2*strlen(sim->fileroot)+24)>=80){
+                logmsg(LOGENSEMBLE,LOGERROR,"Root name %s too long for ensemble directories \n",sim->fileroot);
+                exit(1);
+        }
+        ensmic=ensimage(micfile,"microstructure",&ensnside);
+        enspart=ensimage(cfggiven("partfile"),"particle ID",&nside);
+        if(nside!=ensnside){
+                logmsg(LOGENSEMBLE,LOGERROR,"Particle ID image size does not match microstructure \n");
+                exit(1);
+        }
+#ifdef FIXEDSIZE
+        if(ensnside!=FIXEDSIZE){
+                logmsg(LOGENSEMBLE,LOGERROR,"System size %d does not match compiled size %d \n",ensnside,FIXEDSIZE);
+                exit(1);
+        }
+#endif
+
+        iseed=atoi(cfggiven("iseed"));
+        nsets=(nensset>0)?nensset:1;
+        nensmem=nsets*ensseeds;
+        ensmems=(struct ensmem *)malloc(nensmem*sizeof(struct ensmem));
+        if(ensmems==NULL){
+                logmsg(LOGENSEMBLE,LOGERROR,"Unable to allocate memory for ensemble \n");
+                exit(1);
+        }
+        im=0;
+        for(iset=0;iset<nsets;iset++){
+                for(ir=0;ir<ensseeds;ir++){
+                        ensmems[im].set=iset;
+                        ensmems[im].seed=((nensset>0)?ensseed(enssets[iset],iseed):iseed)-ir;
+                        if(snprintf(ensmems[im].dir,sizeof(ensmems[im].dir),"%s.%d.%d",sim->fileroot,iset,ir)>=(int)sizeof(ensmems[im].dir)){
+                                logmsg(LOGENSEMBLE,LOGERROR,"Root name %s too long for ensemble directories \n",sim->fileroot);
+                                exit(1);
+                        }
+                        if((mkdir(ensmems[im].dir,0777)!=0)&&(errno!=EEXIST)){
+                                logmsg(LOGENSEMBLE,LOGERROR,"Unable to make directory %s \n",ensmems[im].dir);
+                                exit(1);
+                        }
+                        im+=1;
+                }
+        }
+        nthr=(ensjobs<nensmem)?ensjobs:nensmem;
+        logmsg(LOGENSEMBLE,LOGINFO,"Running ensemble of %d members (%d sets of %d seeds), %d at once \n",nensmem,nsets,ensseeds,nthr);
+        logflush();
+
+        threads=(pthread_t *)malloc(nthr*sizeof(pthread_t));
+        if(threads==NULL){
+                logmsg(LOGENSEMBLE,LOGERROR,"Unable to allocate memory for ensemble \n");
+                exit(1);
+        }
+        for(ithr=0;ithr<nthr;ithr++){
+                if(pthread_create(&threads[ithr],NULL,ensworker,NULL)!=0){
+                        logmsg(LOGENSEMBLE,LOGERROR,"Unable to start thread %d of ensemble \n",ithr);
+                        exit(1);
+                }
+        }
+        for(ithr=0;ithr<nthr;ithr++){
+                pthread_join(threads[ithr],NULL);
+        }
+        free(threads);
+        free(ensmic);
+        free(enspart);
+
+        for(iset=0;iset<nsets;iset++){
+                ensgather(iset);
+        }
+        logmsg(LOGENSEMBLE,LOGINFO,"Ensemble of %d members done \n",nensmem);
+        logflush();
+        exit(0);
+}
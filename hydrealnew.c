@@ -13,6 +13,8 @@
 /* they are derived from it, and any modified versions bear */
 /* some notice that they have been modified. */
 
+#include "cemhyd.h"
+
 #define AGRATE 0.25        /* Probability of gypsum absorption by CSH */
 
 /* routine to select a new neighboring location to (xloc, yloc, zloc) */ 
@@ -36,7 +38,7 @@ int moveone(xloc,yloc,zloc,act,sumold)
 
         /* Choose one of six directions (at random) for the new */
         /* location */
-        plok=6.*ran1(seed);
+        plok=6.*ran1(simt->seed);
         if((plok>5)||(plok<0)){plok=5;}
 
         switch (plok){
@@ -121,7 +123,7 @@ int edgecnt(xck,yck,zck,ph1,ph2,ph3)
                         else if(y2>=SYSIZE){y2=0;}
                         if(z2<0){z2=(SYSIZEM1);}
                         else if(z2>=SYSIZE){z2=0;}
-                        check=mic[x2][y2][z2];
+                        check=sim->mic[VOXEL(x2,y2,z2)];
                         if((check!=ph1)&&(check!=ph2)&&(check!=ph3)){
                                   edgeback+=1;
                         }
@@ -133,51 +135,103 @@ int edgecnt(xck,yck,zck,ph1,ph2,ph3)
        	return(edgeback);
 }
 
-/* routine to add extra CSH when diffusing CSH reacts */
-/* Called by movecsh */
-/* Calls edgecnt */
-void extcsh()
+/* routine to place phase ph at a random pore pixel in contact with */
+/* at least one pixel of the phases it grows on (or anywhere, after */
+/* 5000 tries), for the extra products of extcsh, extfh3, extettr, */
+/* ... once no neighboring pixel of the reaction is free */
+/* While species move on several threads, the placement is queued */
+/* and made once the domains of the current colour have moved */
+/* Called by extcsh, extfh3, extettr, extch, extgyps, extfreidel, */
+/* extstrat, extafm, extpozz, extc3ah6 and extflush */
+/* Calls extqueue, randpore, edgecnt, setphase, setcshage and ran1 */
+void extrand(ph)
+        int ph;
 {
-        int numnear,sump,xchr,ychr,zchr,fchr,i1,plok,check,msface;
+        int numnear,numsil,xchr,ychr,zchr,fchr,msface,ph1,ph2,ph3;
         long int tries;
 
+#ifdef PARALLEL
+        if(simt->curdom!=NULL){
+                extqueue(ph);
+                return;
+        }
+#endif
+        /* phases of which one must neighbor the new pixel */
+        switch(ph){
+                case CSH:	/* C2S, C3S, or CSH */
+                        ph1=CSH; ph2=C3S; ph3=C2S;
+                        break;
+                case FH3:	/* FH3 or diffusing FH3 */
+                        ph1=FH3; ph2=FH3; ph3=DIFFFH3;
+                        break;
+                case ETTR:	/* ettringite, or aluminate clinker */
+                        ph1=ETTR; ph2=C3A; ph3=C4AF;
+                        break;
+                case ETTRC4AF:
+                        ph1=ETTRC4AF; ph2=C3A; ph3=C4AF;
+                        break;
+                case CH:	/* CH or diffusing CH */
+                        ph1=CH; ph2=DIFFCH; ph3=CH;
+                        break;
+                case GYPSUMS:	/* Gypsum in some form */
+                        ph1=HEMIHYD; ph2=GYPSUMS; ph3=ANHYDRITE;
+                        break;
+                case FREIDEL:	/* FREIDEL or diffusing CACL2 */
+                        ph1=FREIDEL; ph2=FREIDEL; ph3=DIFFCACL2;
+                        break;
+                case STRAT:	/* STRAT, diffusing CAS2, or diffusing AS */
+                        ph1=STRAT; ph2=DIFFCAS2; ph3=DIFFAS;
+                        break;
+                case AFM:	/* Afm phase, C3A, or C4AF */
+                        ph1=AFM; ph2=C3A; ph3=C4AF;
+                        break;
+                case POZZCSH:	/* CSH or pozzolanic material */
+                        ph1=POZZ; ph2=CSH; ph3=POZZCSH;
+                        break;
+                default:	/* C3AH6 or C3A */
+                        ph1=C3AH6; ph2=C3A; ph3=C3AH6;
+                        break;
+        }
+
         fchr=0;
         tries=0;
-        /* locate CSH at random location */
-        /* in pore space in contact with at least another CSH or C3S or C2S */
         while(fchr==0){
                 tries+=1;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-
-                /* if location is porosity, locate the CSH there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,CSH,C3S,C2S);
-                        /* be sure that at least one neighboring pixel */
-                        /* is C2S, C3S, or diffusing CSH */
-                        if((numnear<26)||(tries>5000)){
-                                mic[xchr][ychr][zchr]=CSH;
-				count[CSH]+=1;
-				count[POROSITY]-=1;
-				cshage[xchr][ychr][zchr]=cyccnt;
-				if(cshgeom==1){
-					msface=(int)(3.*ran1(seed)+1.);
-					if(msface>3){msface=1;}
-					faces[xchr][ychr][zchr]=msface;
-					ncshplateinit+=1;
-				}
-                               	fchr=1;
+                /* if location is porosity, locate the phase there */
+                if(randpore(&xchr,&ychr,&zchr)){
+                        numnear=edgecnt(xchr,ychr,zchr,ph1,ph2,ph3);
+                        /* ettringite must not touch C3S or C2S */
+                        numsil=0;
+                        if((ph==ETTR)||(ph==ETTRC4AF)){
+                                numsil=26-edgecnt(xchr,ychr,zchr,C3S,C2S,C3S);
+                        }
+                        if(((numnear<26)&&(numsil<1))||(tries>5000)){
+                                setphase(xchr,ychr,zchr,ph);
+                                if(ph==CSH){
+                                        setcshage(xchr,ychr,zchr,sim->cyccnt);
+                                        if(sim->cshgeom==1){
+                                                msface=(int)(3.*ran1(simt->seed)+1.);
+                                                if(msface>3){msface=1;}
+                                                sim->faces[VOXEL(xchr,ychr,zchr)]=msface;
+                                                simt->ncshplateinit+=1;
+                                        }
+                                }
+                                fchr=1;
                         }
                 }
         }
 }
 
+/* routine to add extra CSH when diffusing CSH reacts */
+/* Called by movecsh */
+/* Calls extrand */
+void extcsh()
+{
+        /* locate CSH at random location */
+        /* in pore space in contact with at least another CSH or C3S or C2S */
+        extrand(CSH);
+}
+
 /* routine to move a diffusing CSH species */
 /* Inputs: current location (xcur,ycur,zcur) and flag indicating if final */
 /* step in diffusion process */
@@ -187,7 +241,7 @@ void extcsh()
 int movecsh(xcur,ycur,zcur,finalstep,cycorig)
         int xcur,ycur,zcur,finalstep,cycorig;
 {
-        int xnew,ynew,znew,plok,action,sumback,sumin,check;
+        int xnew,ynew,znew,action,sumin,check;
 	int msface,mstest,mstest2;
 	float prcsh,prcsh1,prcsh2,prtest;
 
@@ -197,8 +251,8 @@ int movecsh(xcur,ycur,zcur,finalstep,cycorig)
         ynew=ycur;
         znew=zcur;
         sumin=1;
-        sumback=moveone(&xnew,&ynew,&znew,&action,sumin);
-	if(cshgeom==1){
+        moveone(&xnew,&ynew,&znew,&action,sumin);
+	if(sim->cshgeom==1){
 	/* Determine eligible faces based on direction of move */
 		if(xnew!=xcur){
 			mstest=1;
@@ -214,35 +268,32 @@ int movecsh(xcur,ycur,zcur,finalstep,cycorig)
 		}
 	}
 
-        if(action==0){printf("Error in value of action \n");}
-        check=mic[xnew][ynew][znew];
+        if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action \n");}
+        check=sim->mic[VOXEL(xnew,ynew,znew)];
 
 
       /* if new location is solid CSH and plate growth is favorable, */
       /* then convert diffusing CSH species to solid CSH */
-       prcsh=ran1(seed);
-       if((check==CSH)&&((cshgeom==0)||(faces[xnew][ynew][znew]==0)||(faces[xnew][ynew][znew]==mstest)||(faces[xnew][ynew][znew]==mstest2))){
+       prcsh=ran1(simt->seed);
+       if((check==CSH)&&((sim->cshgeom==0)||(sim->faces[VOXEL(xnew,ynew,znew)]==0)||(sim->faces[VOXEL(xnew,ynew,znew)]==mstest)||(sim->faces[VOXEL(xnew,ynew,znew)]==mstest2))){
            /* decrement count of diffusing CSH species */
-              count[DIFFCSH]-=1;
            /* and increment count of solid CSH if needed */
-  		prtest=molarvcsh[cyccnt]/molarvcsh[cycorig];
-                prcsh1=ran1(seed);
+  		prtest=sim->molarvcsh[sim->cyccnt]/sim->molarvcsh[cycorig];
+                prcsh1=ran1(simt->seed);
 		if(prcsh1<=prtest){
-                   mic[xcur][ycur][zcur]=CSH;
-		   if(cshgeom==1){
-			   faces[xcur][ycur][zcur]=faces[xnew][ynew][znew];
-		           ncshplategrow+=1;
+                   setphase(xcur,ycur,zcur,CSH);
+		   if(sim->cshgeom==1){
+			   sim->faces[VOXEL(xcur,ycur,zcur)]=sim->faces[VOXEL(xnew,ynew,znew)];
+		           simt->ncshplategrow+=1;
 		   }
-         	   cshage[xcur][ycur][zcur]=cyccnt;
-                   count[CSH]+=1;
+         	   setcshage(xcur,ycur,zcur,sim->cyccnt);
 		}
       		else{
-			mic[xcur][ycur][zcur]=POROSITY;
-			count[POROSITY]+=1;
+			setphase(xcur,ycur,zcur,POROSITY);
 		}
       /* May need extra solid CSH if temperature goes down with time */
 		if(prtest>1.0){
-                        prcsh2=ran1(seed);
+                        prcsh2=ran1(simt->seed);
 			if(prcsh2<(prtest-1.0)){
 				extcsh();
 			}
@@ -256,33 +307,30 @@ int movecsh(xcur,ycur,zcur,finalstep,cycorig)
          ((check==CH)&&(prcsh<0.01))||
          (check==CACO3)||(check==INERT)){
            /* decrement count of diffusing CSH species */
-              count[DIFFCSH]-=1;
            /* and increment count of solid CSH if needed */
-  		prtest=molarvcsh[cyccnt]/molarvcsh[cycorig];
-                prcsh1=ran1(seed);
+  		prtest=sim->molarvcsh[sim->cyccnt]/sim->molarvcsh[cycorig];
+                prcsh1=ran1(simt->seed);
 		if(prcsh1<=prtest){
-                   mic[xcur][ycur][zcur]=CSH;
-         	   cshage[xcur][ycur][zcur]=cyccnt;
-		   if(cshgeom==1){
-		           msface=(int)(2.*ran1(seed)+1.);
+                   setphase(xcur,ycur,zcur,CSH);
+         	   setcshage(xcur,ycur,zcur,sim->cyccnt);
+		   if(sim->cshgeom==1){
+		           msface=(int)(2.*ran1(simt->seed)+1.);
 			   if(msface>2){msface=1;}
 			   if(msface==1){
-			      faces[xcur][ycur][zcur]=mstest;
+			      sim->faces[VOXEL(xcur,ycur,zcur)]=mstest;
 			   }
 			   else{
-			      faces[xcur][ycur][zcur]=mstest2;
+			      sim->faces[VOXEL(xcur,ycur,zcur)]=mstest2;
 			   }
-		           ncshplateinit+=1;
+		           simt->ncshplateinit+=1;
 		   }
-                   count[CSH]+=1;
 		}
       		else{
-			mic[xcur][ycur][zcur]=POROSITY;
-			count[POROSITY]+=1;
+			setphase(xcur,ycur,zcur,POROSITY);
 		}
       /* May need extra solid CSH if temperature goes down with time */
 		if(prtest>1.0){
-                        prcsh2=ran1(seed);
+                        prcsh2=ran1(simt->seed);
 			if(prcsh2<(prtest-1.0)){
 				extcsh();
 			}
@@ -293,8 +341,8 @@ int movecsh(xcur,ycur,zcur,finalstep,cycorig)
         if(action!=0){
         /* if diffusion step is possible, perform it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                       	mic[xnew][ynew][znew]=DIFFCSH;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                       	setphase(xnew,ynew,znew,DIFFCSH);
               	 }
                 else{
                         /* indicate that diffusing CSH species remained */
@@ -308,12 +356,11 @@ int movecsh(xcur,ycur,zcur,finalstep,cycorig)
 /* routine to add extra FH3 when gypsum, hemihydrate, anhydrite, CAS2, or */
 /* CaCl2 reacts with C4AF at location (xpres,ypres,zpres) */
 /* Called by movegyp, moveettr, movecas2, movehem, moveanh, and movecacl2 */
-/* Calls moveone and edgecnt */
+/* Calls moveone and extrand */
 void extfh3(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
-        int multf,numnear,sump,xchr,ychr,zchr,check,fchr,i1,plok,newact;
-       	long int tries;
+        int multf,sump,xchr,ychr,zchr,check,fchr,i1,newact;
 
 /* first try 6 neighboring locations until      */
 /*	a) successful				*/
@@ -329,15 +376,13 @@ void extfh3(xpres,ypres,zpres)
                 zchr=zpres;
                 newact=0;
                 multf=moveone(&xchr,&ychr,&zchr,&newact,sump);
-                if(newact==0){printf("Error in value of newact in extfh3 \n");}
-                check=mic[xchr][ychr][zchr];	 
+                if(newact==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of newact in extfh3 \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];	 
 
                	/* if neighbor is porosity   */
                 /* then locate the FH3 there */
                 if(check==POROSITY){
-                        mic[xchr][ychr][zchr]=FH3;
-			count[FH3]+=1;
-			count[POROSITY]-=1;
+                        setphase(xchr,ychr,zchr,FH3);
                        	fchr=1;
                 }
                	else{
@@ -347,29 +392,8 @@ void extfh3(xpres,ypres,zpres)
 
 /* if no neighbor available, locate FH3 at random location */
 /* in pore space in contact with at least one FH3 */
-        tries=0;
-        while(fchr==0){
-                tries+=1;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-                /* if location is porosity, locate the FH3 there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,FH3,FH3,DIFFFH3);
-                        /* be sure that at least one neighboring pixel */
-                        /* is FH3 or diffusing FH3 */
-                        if((numnear<26)||(tries>5000)){
-                                mic[xchr][ychr][zchr]=FH3;
-				count[FH3]+=1;
-				count[POROSITY]-=1;
-                               	fchr=1;
-                        }
-                }
+        if(fchr==0){
+                extrand(FH3);
         }
 }
 
@@ -379,15 +403,14 @@ void extfh3(xpres,ypres,zpres)
 /* etype=0 indicates primary ettringite */
 /* etype=1 indicates iron-rich stable ettringite */
 /* Returns flag indicating action taken */
-/* Calls moveone and edgecnt */
+/* Calls moveone, edgecnt and extrand */
 /* Called by movegyp, movehem, moveanh, and movec3a */
 int extettr(xpres,ypres,zpres,etype)
         int xpres,ypres,zpres,etype;
 {
-        int check,newact,multf,numnear,sump,xchr,ychr,zchr,fchr,i1,plok;
+        int check,newact,numnear,sump,xchr,ychr,zchr,fchr,i1;
 	int numalum,numsil;
         float pneigh,ptest;
-        long int tries;
 
 /* first try neighboring locations until        */
 /*	a) successful				*/
@@ -403,10 +426,10 @@ int extettr(xpres,ypres,zpres,etype)
                 ychr=ypres;
                 zchr=zpres;
                 newact=0;
-                multf=moveone(&xchr,&ychr,&zchr,&newact,sump);
-                if(newact==0){printf("Error in value of action \n");}
+                moveone(&xchr,&ychr,&zchr,&newact,sump);
+                if(newact==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action \n");}
 
-                check=mic[xchr][ychr][zchr];
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];
 
                 /* if neighbor is porosity, and conditions are favorable */
                 /* based on number of neighboring ettringite, C3A, or C4AF */
@@ -431,19 +454,16 @@ int extettr(xpres,ypres,zpres,etype)
 			if(numalum>=2){pneigh+=0.5;}
 			if(numalum>=3){pneigh+=0.25;}
 			if(numalum>=5){pneigh+=0.25;}
-                        ptest=ran1(seed);
+                        ptest=ran1(simt->seed);
                         if(numsil<1){
                         if(pneigh>=ptest){
 				if(etype==0){
-	                                mic[xchr][ychr][zchr]=ETTR;
-					count[ETTR]+=1;
+	                                setphase(xchr,ychr,zchr,ETTR);
 				}
 				else{
-	                                mic[xchr][ychr][zchr]=ETTRC4AF;
-					count[ETTRC4AF]+=1;
+	                                setphase(xchr,ychr,zchr,ETTRC4AF);
 				}
                                 fchr=1;
-				count[POROSITY]-=1;
                         }
                         }
                 }
@@ -452,43 +472,13 @@ int extettr(xpres,ypres,zpres,etype)
 /* if no neighbor available, locate ettringite at random location */
 /* in pore space in contact with at least another ettringite */
 /* or aluminate surface  */
-        tries=0;
-        while(fchr==0){
-                tries+=1;
+        if(fchr==0){
                 newact=7;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-
-                check=mic[xchr][ychr][zchr];
-                /* if location is porosity, locate the ettringite there */
-                if(check==POROSITY){
-                				numsil=edgecnt(xchr,ychr,zchr,C3S,C2S,C3S);
-                           numsil=26-numsil;
-			if(etype==0){
-	                        numnear=edgecnt(xchr,ychr,zchr,ETTR,C3A,C4AF);
-			}
-			else{
-	                        numnear=edgecnt(xchr,ychr,zchr,ETTRC4AF,C3A,C4AF);
-			}
-                        /* be sure that at least one neighboring pixel */
-                        /* is ettringite, or aluminate clinker */
-                        if((tries>5000)||((numnear<26)&&(numsil<1))){
-				if(etype==0){
-	                                mic[xchr][ychr][zchr]=ETTR;
-												count[ETTR]+=1;
-				}
-				else{
-	                                mic[xchr][ychr][zchr]=ETTRC4AF;
-												count[ETTRC4AF]+=1;
-				}
-											count[POROSITY]-=1;
-                               	fchr=1;
-                        }
+                if(etype==0){
+                        extrand(ETTR);
+                }
+                else{
+                        extrand(ETTRC4AF);
                 }
         }
         return(newact);
@@ -497,50 +487,21 @@ int extettr(xpres,ypres,zpres,etype)
 /* routine to add extra CH when gypsum, hemihydrate, anhydrite, CaCl2, or */
 /* diffusing CAS2  reacts with C4AF */
 /* Called by movegyp, movehem, moveanh, moveettr, movecas2, and movecacl2 */
-/* Calls edgecnt */
+/* Calls extrand */
 void extch()
 {
-        int numnear,sump,xchr,ychr,zchr,fchr,i1,plok,check;
-        long int tries;
-
-        fchr=0;
-        tries=0;
         /* locate CH at random location */
         /* in pore space in contact with at least another CH */
-        while(fchr==0){
-                tries+=1;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-
-                /* if location is porosity, locate the CH there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,CH,DIFFCH,CH);
-                        /* be sure that at least one neighboring pixel */
-                        /* is CH or diffusing CH */
-                        if((numnear<26)||(tries>5000)){
-                                mic[xchr][ychr][zchr]=CH;
-				count[CH]+=1;
-				count[POROSITY]-=1;
-                               	fchr=1;
-                        }
-                }
-        }
+        extrand(CH);
 }
 
 /* routine to add extra gypsum when hemihydrate or anhydrite hydrates */
 /* Called by movehem and moveanh */
-/* Calls moveone and edgecnt */
+/* Calls moveone and extrand */
 void extgyps(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
-        int multf,numnear,sump,xchr,ychr,zchr,check,fchr,i1,plok,newact;
-       	long int tries;
+        int multf,sump,xchr,ychr,zchr,check,fchr,i1,newact;
 
 /* first try 6 neighboring locations until      */
 /*	a) successful				*/
@@ -556,15 +517,13 @@ void extgyps(xpres,ypres,zpres)
                 zchr=zpres;
                 newact=0;
                 multf=moveone(&xchr,&ychr,&zchr,&newact,sump);
-                if(newact==0){printf("Error in value of newact in extfh3 \n");}
-                check=mic[xchr][ychr][zchr];	 
+                if(newact==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of newact in extfh3 \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];	 
 
                	/* if neighbor is porosity   */
                 /* then locate the GYPSUMS there */
                 if(check==POROSITY){
-                        mic[xchr][ychr][zchr]=GYPSUMS;
-			count[GYPSUMS]+=1;
-			count[POROSITY]-=1;
+                        setphase(xchr,ychr,zchr,GYPSUMS);
                        	fchr=1;
                 }
                	else{
@@ -574,29 +533,8 @@ void extgyps(xpres,ypres,zpres)
 
 /* if no neighbor available, locate GYPSUMS at random location */
 /* in pore space in contact with at least one GYPSUMS */
-        tries=0;
-        while(fchr==0){
-                tries+=1;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-                /* if location is porosity, locate the GYPSUMS there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,HEMIHYD,GYPSUMS,ANHYDRITE);
-                        /* be sure that at least one neighboring pixel */
-                        /* is Gypsum in some form */
-                        if((numnear<26)||(tries>5000)){
-                                mic[xchr][ychr][zchr]=GYPSUMS;
-				count[GYPSUMS]+=1;
-				count[POROSITY]-=1;
-                               	fchr=1;
-                        }
-                }
+        if(fchr==0){
+                extrand(GYPSUMS);
         }
 }
 
@@ -610,20 +548,18 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
         int xcur,ycur,zcur,finalstep;
 	float nucprgyp;
 {
-        int xnew,ynew,znew,plok,action,sumback,sumin,check;
-	int nexp,iexp,xexp,yexp,zexp,newact,sumold,sumgarb,ettrtype;
+        int xnew,ynew,znew,action,sumin,check;
+	int nexp,iexp,xexp,yexp,zexp,newact,ettrtype;
 	float pgen,pexp,pext,p2diff;
 
         action=0;
         /* first check for nucleation */
-        pgen=ran1(seed);
-	p2diff=ran1(seed);
+        pgen=ran1(simt->seed);
+	p2diff=ran1(simt->seed);
         if((nucprgyp>=pgen)||(finalstep==1)){
                 action=0;
-                mic[xcur][ycur][zcur]=GYPSUMS;
-                count[DIFFANH]-=1;
-		count[GYPSUMS]+=1;
-               	pexp=ran1(seed);
+                setphase(xcur,ycur,zcur,GYPSUMS);
+               	pexp=ran1(simt->seed);
 		if(pexp<0.4){
 			extgyps(xcur,ycur,zcur);
 		}
@@ -634,22 +570,20 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
        		 ynew=ycur;
        		 znew=zcur;
        		 sumin=1;
-       		 sumback=moveone(&xnew,&ynew,&znew,&action,sumin);
+       		 moveone(&xnew,&ynew,&znew,&action,sumin);
 	 
-       		 if(action==0){printf("Error in value of action \n");}
-       		 check=mic[xnew][ynew][znew];
+       		 if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action \n");}
+       		 check=sim->mic[VOXEL(xnew,ynew,znew)];
 
 /* if new location is solid GYPSUM(S) or diffusing GYPSUM, then convert */
 /* diffusing ANHYDRITE species to solid GYPSUM */
        	if((check==GYPSUM)||(check==GYPSUMS)||(check==DIFFGYP)){
-	                mic[xcur][ycur][zcur]=GYPSUMS;
+	                setphase(xcur,ycur,zcur,GYPSUMS);
         	        /* decrement count of diffusing ANHYDRITE species */
                		/* and increment count of solid GYPSUMS */
-	                count[DIFFANH]-=1;
-       		        count[GYPSUMS]+=1;
 	                action=0;
 			/* Add extra gypsum as necessary */
-               		pexp=ran1(seed);
+               		pexp=ran1(simt->seed);
 			if(pexp<0.4){
 				extgyps(xnew,ynew,znew);
 			}
@@ -659,28 +593,24 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
         else if(((check==C3A)&&(p2diff<SOLIDC3AGYP))||((check==DIFFC3A)&&(p2diff<C3AGYP))||((check==DIFFC4A)&&(p2diff<C3AGYP))){
         /* Convert diffusing gypsum to an ettringite pixel */
 		ettrtype=0;
-                mic[xcur][ycur][zcur]=ETTR;
+                setphase(xcur,ycur,zcur,ETTR);
 		if(check==DIFFC4A){
 			ettrtype=1;
-                	mic[xcur][ycur][zcur]=ETTRC4AF;
+                	setphase(xcur,ycur,zcur,ETTRC4AF);
 		}
                 action=0;
-                count[DIFFANH]-=1;
-		count[check]-=1;
 
                 /* determine if C3A should be converted to ettringite */
                 /* 1 unit of hemihydrate requires 0.569 units of C3A */
                 /* and should form 4.6935 units of ettringite */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=3;
                 if(pexp<=0.569){
 			if(ettrtype==0){
-       		                mic[xnew][ynew][znew]=ETTR;
-				count[ETTR]+=1;
+       		                setphase(xnew,ynew,znew,ETTR);
 			}
 			else{
-       		                mic[xnew][ynew][znew]=ETTRC4AF;
-				count[ETTRC4AF]+=1;
+       		                setphase(xnew,ynew,znew,ETTRC4AF);
 			}
                         nexp=2;
                 }
@@ -688,17 +618,14 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
                         /* maybe someday, use a new FIXEDC3A here */
                         /* so it won't dissolve later */
                         if(check==C3A){
-                                mic[xnew][ynew][znew]=C3A;
-				count[C3A]+=1;
+                                setphase(xnew,ynew,znew,C3A);
                         }
                         else{
 				if(ettrtype==0){
-	                                count[DIFFC3A]+=1;
-       		                        mic[xnew][ynew][znew]=DIFFC3A;
+       		                        setphase(xnew,ynew,znew,DIFFC3A);
 				}
 				else{
-	                                count[DIFFC4A]+=1;
-       		                        mic[xnew][ynew][znew]=DIFFC4A;
+       		                        setphase(xnew,ynew,znew,DIFFC4A);
 				}
                         }
                         nexp=3;
@@ -744,7 +671,7 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
                 }
 
                 /* probabilistic-based expansion for last ettringite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.6935){
                         newact=extettr(xexp,yexp,zexp,ettrtype);
                 }
@@ -753,26 +680,22 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
         /* if new location is C4AF execute conversion */
         /* to ettringite (including necessary volumetric expansion) */
         if((check==C4AF)&&(p2diff<SOLIDC4AFGYP)){
-                mic[xcur][ycur][zcur]=ETTRC4AF;
-		count[ETTRC4AF]+=1;
-                count[DIFFANH]-=1;
+                setphase(xcur,ycur,zcur,ETTRC4AF);
 
                 /* determine if C4AF should be converted to ettringite */
                 /* 1 unit of gypsum requires 0.8174 units of C4AF */
                 /* and should form 4.6935 units of ettringite */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=3;
                 if(pexp<=0.8174){
-                        mic[xnew][ynew][znew]=ETTRC4AF;
-			count[ETTRC4AF]+=1;
-			count[C4AF]-=1;
+                        setphase(xnew,ynew,znew,ETTRC4AF);
                         nexp=2;
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra CH */
                         if(pext<0.2584){
                                         extch();
                         }
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra FH3 */
                         if(pext<0.5453){
                                         extfh3(xnew,ynew,znew);
@@ -782,7 +705,7 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
                 else{
                         /* maybe someday, use a new FIXEDC4AF here */
                         /* so it won't dissolve later */
-                        mic[xnew][ynew][znew]=C4AF;
+                        setphase(xnew,ynew,znew,C4AF);
                         nexp=3;
                 }
 
@@ -826,7 +749,7 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
                 }
 
                 /* probabilistic-based expansion for last ettringite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.6935){
                         newact=extettr(xexp,yexp,zexp,1);
                 }
@@ -837,8 +760,8 @@ int moveanh(xcur,ycur,zcur,finalstep,nucprgyp)
         if(action!=0){
         /* if diffusion step is possible, perform it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                       	mic[xnew][ynew][znew]=DIFFANH;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                       	setphase(xnew,ynew,znew,DIFFANH);
                	}
                 else{
                         /* indicate that diffusing ANHYDRITE species remained */
@@ -859,21 +782,19 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
         int xcur,ycur,zcur,finalstep;
 	float nucprgyp;
 {
-        int xnew,ynew,znew,plok,action,sumback,sumin,check;
-	int nexp,iexp,xexp,yexp,zexp,newact,sumold,sumgarb,ettrtype;
+        int xnew,ynew,znew,action,sumin,check;
+	int nexp,iexp,xexp,yexp,zexp,newact,ettrtype;
 	float pgen,pexp,pext,p2diff;
 
         action=0;
         /* first check for nucleation */
-        pgen=ran1(seed);
-	p2diff=ran1(seed);
+        pgen=ran1(simt->seed);
+	p2diff=ran1(simt->seed);
         if((nucprgyp>=pgen)||(finalstep==1)){
                 action=0;
-                mic[xcur][ycur][zcur]=GYPSUMS;
-                count[DIFFHEM]-=1;
-		count[GYPSUMS]+=1;
+                setphase(xcur,ycur,zcur,GYPSUMS);
 		/* Add extra gypsum as necessary */
-               	pexp=ran1(seed);
+               	pexp=ran1(simt->seed);
 		if(pexp<0.4){
 			extgyps(xcur,ycur,zcur);
 		}
@@ -884,22 +805,20 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
        		 ynew=ycur;
        		 znew=zcur;
        		 sumin=1;
-       		 sumback=moveone(&xnew,&ynew,&znew,&action,sumin);
+       		 moveone(&xnew,&ynew,&znew,&action,sumin);
 
-       		 if(action==0){printf("Error in value of action \n");}
-       		 check=mic[xnew][ynew][znew];
+       		 if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action \n");}
+       		 check=sim->mic[VOXEL(xnew,ynew,znew)];
 
 /* if new location is solid GYPSUM(S) or diffusing GYPSUM, then convert */
 /* diffusing HEMIHYDRATE species to solid GYPSUM */
         	if((check==GYPSUM)||(check==GYPSUMS)||(check==DIFFGYP)){
-	                mic[xcur][ycur][zcur]=GYPSUMS;
+	                setphase(xcur,ycur,zcur,GYPSUMS);
        		        /* decrement count of diffusing HEMIHYDRATE species */
 	                /* and increment count of solid GYPSUMS */
-	                count[DIFFHEM]-=1;
-       		        count[GYPSUMS]+=1;
        		        action=0;
 			/* Add extra gypsum as necessary */
-                	pexp=ran1(seed);
+                	pexp=ran1(simt->seed);
 			if(pexp<0.4){
 				extgyps(xnew,ynew,znew);
 			}
@@ -909,28 +828,24 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
         else if(((check==C3A)&&(p2diff<SOLIDC3AGYP))||((check==DIFFC3A)&&(p2diff<C3AGYP))||((check==DIFFC4A)&&(p2diff<C3AGYP))){
         /* Convert diffusing gypsum to an ettringite pixel */
 		ettrtype=0;
-                mic[xcur][ycur][zcur]=ETTR;
+                setphase(xcur,ycur,zcur,ETTR);
 		if(check==DIFFC4A){
 			ettrtype=1;
-                	mic[xcur][ycur][zcur]=ETTRC4AF;
+                	setphase(xcur,ycur,zcur,ETTRC4AF);
 		}
                 action=0;
-                count[DIFFHEM]-=1;
-		count[check]-=1;
 
                 /* determine if C3A should be converted to ettringite */
                 /* 1 unit of hemihydrate requires 0.5583 units of C3A */
                 /* and should form 4.6053 units of ettringite */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=3;
                 if(pexp<=0.5583){
 			if(ettrtype==0){
-       		                mic[xnew][ynew][znew]=ETTR;
-				count[ETTR]+=1;
+       		                setphase(xnew,ynew,znew,ETTR);
 			}
 			else{
-       		                mic[xnew][ynew][znew]=ETTRC4AF;
-				count[ETTRC4AF]+=1;
+       		                setphase(xnew,ynew,znew,ETTRC4AF);
 			}
                         nexp=2;
                 }
@@ -938,17 +853,14 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
                         /* maybe someday, use a new FIXEDC3A here */
                         /* so it won't dissolve later */
                         if(check==C3A){
-                                mic[xnew][ynew][znew]=C3A;
-				count[C3A]+=1;
+                                setphase(xnew,ynew,znew,C3A);
                         }
                         else{
 				if(ettrtype==0){
-	                                count[DIFFC3A]+=1;
-       		                        mic[xnew][ynew][znew]=DIFFC3A;
+       		                        setphase(xnew,ynew,znew,DIFFC3A);
 				}
 				else{
-	                                count[DIFFC4A]+=1;
-       		                        mic[xnew][ynew][znew]=DIFFC4A;
+       		                        setphase(xnew,ynew,znew,DIFFC4A);
 				}
                         }
                         nexp=3;
@@ -994,7 +906,7 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
                 }
 
                 /* probabilistic-based expansion for last ettringite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.6053){
                         newact=extettr(xexp,yexp,zexp,ettrtype);
                 }
@@ -1003,26 +915,22 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
         /* if new location is C4AF execute conversion */
         /* to ettringite (including necessary volumetric expansion) */
         if((check==C4AF)&&(p2diff<SOLIDC4AFGYP)){
-                mic[xcur][ycur][zcur]=ETTRC4AF;
-		count[ETTRC4AF]+=1;
-                count[DIFFHEM]-=1;
+                setphase(xcur,ycur,zcur,ETTRC4AF);
 
                 /* determine if C4AF should be converted to ettringite */
                 /* 1 unit of gypsum requires 0.802 units of C4AF */
                 /* and should form 4.6053 units of ettringite */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=3;
                 if(pexp<=0.802){
-                        mic[xnew][ynew][znew]=ETTRC4AF;
-			count[ETTRC4AF]+=1;
-			count[C4AF]-=1;
+                        setphase(xnew,ynew,znew,ETTRC4AF);
                         nexp=2;
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra CH */
                         if(pext<0.2584){
                                         extch();
                         }
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra FH3 */
                         if(pext<0.5453){
                                         extfh3(xnew,ynew,znew);
@@ -1032,7 +940,7 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
                 else{
                         /* maybe someday, use a new FIXEDC4AF here */
                         /* so it won't dissolve later */
-                        mic[xnew][ynew][znew]=C4AF;
+                        setphase(xnew,ynew,znew,C4AF);
                         nexp=3;
                 }
 
@@ -1076,7 +984,7 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
                 }
 
                 /* probabilistic-based expansion for last ettringite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.6053){
                         newact=extettr(xexp,yexp,zexp,1);
                 }
@@ -1087,8 +995,8 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
         if(action!=0){
         /* if diffusion step is possible, perform it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                       	mic[xnew][ynew][znew]=DIFFHEM;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                       	setphase(xnew,ynew,znew,DIFFHEM);
                	}
                 else{
                         /* indicate that diffusing HEMIHYDRATE species */
@@ -1102,12 +1010,11 @@ int movehem(xcur,ycur,zcur,finalstep,nucprgyp)
 /* routine to add extra Freidel's salt when CaCl2 reacts with */
 /* C3A or C4AF at location (xpres,ypres,zpres) */
 /* Called by movecacl2 and movec3a */
-/* Calls moveone and edgecnt */
+/* Calls moveone and extrand */
 int extfreidel(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
-        int multf,numnear,sump,xchr,ychr,zchr,check,fchr,i1,plok,newact;
-       	long int tries;
+        int multf,sump,xchr,ychr,zchr,check,fchr,i1,newact;
 
 /* first try 6 neighboring locations until      */
 /*	a) successful				*/
@@ -1123,15 +1030,13 @@ int extfreidel(xpres,ypres,zpres)
                 zchr=zpres;
                 newact=0;
                 multf=moveone(&xchr,&ychr,&zchr,&newact,sump);
-                if(newact==0){printf("Error in value of newact in extfreidel \n");}
-                check=mic[xchr][ychr][zchr];	 
+                if(newact==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of newact in extfreidel \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];	 
 
                	/* if neighbor is porosity   */
                 /* then locate the freidel's salt there */
                 if(check==POROSITY){
-                        mic[xchr][ychr][zchr]=FREIDEL;
-			count[FREIDEL]+=1;
-			count[POROSITY]-=1;
+                        setphase(xchr,ychr,zchr,FREIDEL);
                        	fchr=1;
                 }
                	else{
@@ -1141,30 +1046,9 @@ int extfreidel(xpres,ypres,zpres)
 
 /* if no neighbor available, locate FREIDEL at random location */
 /* in pore space in contact with at least one FREIDEL */
-        tries=0;
-        while(fchr==0){
-                tries+=1;
-		newact=7;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-                /* if location is porosity, locate the FREIDEL there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,FREIDEL,FREIDEL,DIFFCACL2);
-                        /* be sure that at least one neighboring pixel */
-                        /* is FREIDEL or diffusing CACL2 */
-                        if((numnear<26)||(tries>5000)){
-                                mic[xchr][ychr][zchr]=FREIDEL;
-				count[FREIDEL]+=1;
-				count[POROSITY]-=1;
-                               	fchr=1;
-                        }
-                }
+        if(fchr==0){
+                newact=7;
+                extrand(FREIDEL);
         }
 	return(newact);
 }
@@ -1173,12 +1057,11 @@ int extfreidel(xpres,ypres,zpres)
 /* CH at location (xpres,ypres,zpres) */
 /* or when diffusing CAS2 reacts with aluminates */
 /* Called by moveas, movech, and movecas2 */
-/* Calls moveone and edgecnt */
+/* Calls moveone and extrand */
 int extstrat(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
-        int multf,numnear,sump,xchr,ychr,zchr,check,fchr,i1,plok,newact;
-       	long int tries;
+        int multf,sump,xchr,ychr,zchr,check,fchr,i1,newact;
 
 /* first try 6 neighboring locations until      */
 /*	a) successful				*/
@@ -1194,15 +1077,13 @@ int extstrat(xpres,ypres,zpres)
                 zchr=zpres;
                 newact=0;
                 multf=moveone(&xchr,&ychr,&zchr,&newact,sump);
-                if(newact==0){printf("Error in value of newact in extstrat \n");}
-                check=mic[xchr][ychr][zchr];	 
+                if(newact==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of newact in extstrat \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];	 
 
                	/* if neighbor is porosity   */
                 /* then locate the stratlingite there */
                 if(check==POROSITY){
-                        mic[xchr][ychr][zchr]=STRAT;
-			count[STRAT]+=1;
-			count[POROSITY]-=1;
+                        setphase(xchr,ychr,zchr,STRAT);
                        	fchr=1;
                 }
                	else{
@@ -1212,30 +1093,9 @@ int extstrat(xpres,ypres,zpres)
 
 /* if no neighbor available, locate STRAT at random location */
 /* in pore space in contact with at least one STRAT */
-        tries=0;
-        while(fchr==0){
-                tries+=1;
-		newact=7;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-                /* if location is porosity, locate the STRAT there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,STRAT,DIFFCAS2,DIFFAS);
-                        /* be sure that at least one neighboring pixel */
-                        /* is STRAT, diffusing CAS2, or diffusing AS */
-                        if((numnear<26)||(tries>5000)){
-                                mic[xchr][ychr][zchr]=STRAT;
-				count[STRAT]+=1;
-				count[POROSITY]-=1;
-                               	fchr=1;
-                        }
-                }
+        if(fchr==0){
+                newact=7;
+                extrand(STRAT);
         }
 	return(newact);
 }
@@ -1248,15 +1108,15 @@ int extstrat(xpres,ypres,zpres)
 int movegyp(xcur,ycur,zcur,finalstep)
         int xcur,ycur,zcur,finalstep;
 {
-        int check,xnew,ynew,znew,plok,action,nexp,iexp;
-       	int xexp,yexp,zexp,newact,sumold,sumgarb,ettrtype;
+        int check,xnew,ynew,znew,action,nexp,iexp;
+       	int xexp,yexp,zexp,newact,sumold,ettrtype;
        	float pexp,pext,p2diff;
 
        	sumold=1;
 
 /* First be sure that a diffusing gypsum species is located at xcur,ycur,zcur */
 /* if not, return to calling routine */
-        if(mic[xcur][ycur][zcur]!=DIFFGYP){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFGYP){
                 action=0;
                 return(action);
        	}
@@ -1266,18 +1126,16 @@ int movegyp(xcur,ycur,zcur,finalstep)
         ynew=ycur;
         znew=zcur;
         action=0;
-        sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-        if(action==0){printf("Error in value of action in movegyp \n");}
-        check=mic[xnew][ynew][znew];
-	p2diff=ran1(seed);
+        moveone(&xnew,&ynew,&znew,&action,sumold);
+        if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in movegyp \n");}
+        check=sim->mic[VOXEL(xnew,ynew,znew)];
+	p2diff=ran1(simt->seed);
         /* if new location is CSH, check for absorption of gypsum */
-        if((check==CSH)&&((float)count[ABSGYP]<(gypabsprob*(float)count[CSH]))){
-                pexp=ran1(seed);
+        if((check==CSH)&&((float)simt->count[ABSGYP]<(sim->gypabsprob*(float)simt->count[CSH]))){
+                pexp=ran1(simt->seed);
                 if(pexp<AGRATE){
                         /* update counts for absorbed and diffusing gypsum */
-                        count[ABSGYP]+=1;
-                        count[DIFFGYP]-=1;
-                        mic[xcur][ycur][zcur]=ABSGYP;
+                        setphase(xcur,ycur,zcur,ABSGYP);
                         action=0;
                 }
         }
@@ -1289,28 +1147,24 @@ int movegyp(xcur,ycur,zcur,finalstep)
         else if(((check==C3A)&&(p2diff<SOLIDC3AGYP))||((check==DIFFC3A)&&(p2diff<C3AGYP))||((check==DIFFC4A)&&(p2diff<C3AGYP))){
         /* Convert diffusing gypsum to an ettringite pixel */
 		ettrtype=0;
-                mic[xcur][ycur][zcur]=ETTR;
+                setphase(xcur,ycur,zcur,ETTR);
 		if(check==DIFFC4A){
 			ettrtype=1;
-                	mic[xcur][ycur][zcur]=ETTRC4AF;
+                	setphase(xcur,ycur,zcur,ETTRC4AF);
 		}
                 action=0;
-                count[DIFFGYP]-=1;
-		count[check]-=1;
 
                 /* determine if C3A should be converted to ettringite */
                 /* 1 unit of gypsum requires 0.40 units of C3A */
                 /* and should form 3.30 units of ettringite */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=2;
                 if(pexp<=0.40){
 			if(ettrtype==0){
-       		                mic[xnew][ynew][znew]=ETTR;
-				count[ETTR]+=1;
+       		                setphase(xnew,ynew,znew,ETTR);
 			}
 			else{
-       		                mic[xnew][ynew][znew]=ETTRC4AF;
-				count[ETTRC4AF]+=1;
+       		                setphase(xnew,ynew,znew,ETTRC4AF);
 			}
                         nexp=1;
                 }
@@ -1318,17 +1172,14 @@ int movegyp(xcur,ycur,zcur,finalstep)
                         /* maybe someday, use a new FIXEDC3A here */
                         /* so it won't dissolve later */
                         if(check==C3A){
-                                mic[xnew][ynew][znew]=C3A;
-				count[C3A]+=1;
+                                setphase(xnew,ynew,znew,C3A);
                         }
                         else{
 				if(ettrtype==0){
-	                                count[DIFFC3A]+=1;
-       		                        mic[xnew][ynew][znew]=DIFFC3A;
+       		                        setphase(xnew,ynew,znew,DIFFC3A);
 				}
 				else{
-	                                count[DIFFC4A]+=1;
-       		                        mic[xnew][ynew][znew]=DIFFC4A;
+       		                        setphase(xnew,ynew,znew,DIFFC4A);
 				}
                         }
                         nexp=2;
@@ -1374,7 +1225,7 @@ int movegyp(xcur,ycur,zcur,finalstep)
                 }
 
                 /* probabilistic-based expansion for last ettringite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.30){
                         newact=extettr(xexp,yexp,zexp,ettrtype);
                 }
@@ -1383,26 +1234,22 @@ int movegyp(xcur,ycur,zcur,finalstep)
         /* if new location is C4AF execute conversion */
         /* to ettringite (including necessary volumetric expansion) */
         if((check==C4AF)&&(p2diff<SOLIDC4AFGYP)){
-                mic[xcur][ycur][zcur]=ETTRC4AF;
-		count[ETTRC4AF]+=1;
-                count[DIFFGYP]-=1;
+                setphase(xcur,ycur,zcur,ETTRC4AF);
 
                 /* determine if C4AF should be converted to ettringite */
                 /* 1 unit of gypsum requires 0.575 units of C4AF */
                 /* and should form 3.30 units of ettringite */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=2;
                 if(pexp<=0.575){
-                        mic[xnew][ynew][znew]=ETTRC4AF;
-			count[ETTRC4AF]+=1;
-			count[C4AF]-=1;
+                        setphase(xnew,ynew,znew,ETTRC4AF);
                         nexp=1;
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra CH */
                         if(pext<0.2584){
                                         extch();
                         }
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra FH3 */
                         if(pext<0.5453){
                                         extfh3(xnew,ynew,znew);
@@ -1412,7 +1259,7 @@ int movegyp(xcur,ycur,zcur,finalstep)
                 else{
                         /* maybe someday, use a new FIXEDC4AF here */
                         /* so it won't dissolve later */
-                        mic[xnew][ynew][znew]=C4AF;
+                        setphase(xnew,ynew,znew,C4AF);
                         nexp=2;
                 }
 
@@ -1456,7 +1303,7 @@ int movegyp(xcur,ycur,zcur,finalstep)
                 }
 
                 /* probabilistic-based expansion for last ettringite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.30){
                         newact=extettr(xexp,yexp,zexp,1);
                 }
@@ -1467,16 +1314,14 @@ int movegyp(xcur,ycur,zcur,finalstep)
         /* primary solid gypsum */
         if((action!=0)&&(finalstep==1)){
                 action=0;
-                count[DIFFGYP]-=1;
-		count[GYPSUM]+=1;
-                mic[xcur][ycur][zcur]=GYPSUM;
+                setphase(xcur,ycur,zcur,GYPSUM);
         }
 
         if(action!=0){
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFGYP;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFGYP);
                 }
                 else{
                         /* indicate that diffusing gypsum remained at */
@@ -1495,8 +1340,8 @@ int movegyp(xcur,ycur,zcur,finalstep)
 int movecacl2(xcur,ycur,zcur,finalstep)
         int xcur,ycur,zcur,finalstep;
 {
-        int check,xnew,ynew,znew,plok,action,nexp,iexp;
-       	int xexp,yexp,zexp,newact,sumold,sumgarb,keep;
+        int check,xnew,ynew,znew,action,nexp,iexp;
+       	int xexp,yexp,zexp,newact,sumold,keep;
        	float pexp,pext;
 
        	sumold=1;
@@ -1504,7 +1349,7 @@ int movecacl2(xcur,ycur,zcur,finalstep)
 
 /* First be sure that a diffusing CaCl2 species is located at xcur,ycur,zcur */
 /* if not, return to calling routine */
-        if(mic[xcur][ycur][zcur]!=DIFFCACL2){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFCACL2){
                 action=0;
                 return(action);
        	}
@@ -1514,28 +1359,24 @@ int movecacl2(xcur,ycur,zcur,finalstep)
         ynew=ycur;
         znew=zcur;
         action=0;
-        sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-        if(action==0){printf("Error in value of action in movecacl2 \n");}
-        check=mic[xnew][ynew][znew];
+        moveone(&xnew,&ynew,&znew,&action,sumold);
+        if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in movecacl2 \n");}
+        check=sim->mic[VOXEL(xnew,ynew,znew)];
 
         /* if new location is C3A or diffusing C3A, execute conversion */
         /* to freidel's salt (including necessary volumetric expansion) */
         if((check==C3A)||(check==DIFFC3A)||(check==DIFFC4A)){
         /* Convert diffusing C3A or C3A to a freidel's salt pixel */
                 action=0;
-                mic[xnew][ynew][znew]=FREIDEL;
-		count[FREIDEL]+=1;
-                count[check]-=1;
+                setphase(xnew,ynew,znew,FREIDEL);
 
                 /* determine if diffusing CaCl2 should be converted to FREIDEL */
                 /* 0.5793 unit of CaCl2 requires 1 unit of C3A */
                 /* and should form 3.3295 units of FREIDEL */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=2;
                 if(pexp<=0.5793){
-                        mic[xcur][ycur][zcur]=FREIDEL;
-			count[FREIDEL]+=1;
-			count[DIFFCACL2]-=1;
+                        setphase(xcur,ycur,zcur,FREIDEL);
                         nexp=1;
                 }
                 else{
@@ -1582,7 +1423,7 @@ int movecacl2(xcur,ycur,zcur,finalstep)
                 }
 
                 /* probabilistic-based expansion for last FREIDEL pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.3295){
                         newact=extfreidel(xexp,yexp,zexp);
                 }
@@ -1591,28 +1432,24 @@ int movecacl2(xcur,ycur,zcur,finalstep)
         /* if new location is C4AF execute conversion */
         /* to freidel's salt (including necessary volumetric expansion) */
         else if(check==C4AF){
-                mic[xnew][ynew][znew]=FREIDEL;
-		count[FREIDEL]+=1;
-                count[C4AF]-=1;
+                setphase(xnew,ynew,znew,FREIDEL);
 
                 /* determine if CACL2 should be converted to FREIDEL */
                 /* 0.4033 unit of CaCl2 requires 1 unit of C4AF */
                 /* and should form 2.3176 units of FREIDEL */
 		/* Also 0.6412 units of CH and 1.3522 units of FH3 */
 		/* per unit of CACL2 */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=1;
                 if(pexp<=0.4033){
-                        mic[xcur][ycur][zcur]=FREIDEL;
-			count[FREIDEL]+=1;
-			count[DIFFCACL2]-=1;
+                        setphase(xcur,ycur,zcur,FREIDEL);
                         nexp=0;
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra CH */
                         if(pext<0.6412){
                                         extch();
                         }
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra FH3 */
                         if(pext<0.3522){
                                         extfh3(xnew,ynew,znew);
@@ -1664,7 +1501,7 @@ int movecacl2(xcur,ycur,zcur,finalstep)
                 }
 
                 /* probabilistic-based expansion for last FREIDEL pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.3176){
                         newact=extfreidel(xexp,yexp,zexp);
                 }
@@ -1675,16 +1512,14 @@ int movecacl2(xcur,ycur,zcur,finalstep)
         /* solid CaCl2 */
         if((action!=0)&&(finalstep==1)){
                 action=0;
-                count[DIFFCACL2]-=1;
-		count[CACL2]+=1;
-                mic[xcur][ycur][zcur]=CACL2;
+                setphase(xcur,ycur,zcur,CACL2);
         }
 
         if(action!=0){
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFCACL2;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFCACL2);
                 }
                 else{
                         /* indicate that diffusing CACL2 remained at */
@@ -1704,8 +1539,8 @@ int movecacl2(xcur,ycur,zcur,finalstep)
 int movecas2(xcur,ycur,zcur,finalstep)
         int xcur,ycur,zcur,finalstep;
 {
-        int check,xnew,ynew,znew,plok,action,nexp,iexp;
-       	int xexp,yexp,zexp,newact,sumold,sumgarb,keep;
+        int check,xnew,ynew,znew,action,nexp,iexp;
+       	int xexp,yexp,zexp,newact,sumold,keep;
        	float pexp,pext;
 
        	sumold=1;
@@ -1713,7 +1548,7 @@ int movecas2(xcur,ycur,zcur,finalstep)
 
 /* First be sure that a diffusing CAS2 species is located at xcur,ycur,zcur */
 /* if not, return to calling routine */
-        if(mic[xcur][ycur][zcur]!=DIFFCAS2){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFCAS2){
                 action=0;
                 return(action);
        	}
@@ -1723,28 +1558,24 @@ int movecas2(xcur,ycur,zcur,finalstep)
         ynew=ycur;
         znew=zcur;
         action=0;
-        sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-        if(action==0){printf("Error in value of action in movecas2 \n");}
-        check=mic[xnew][ynew][znew];
+        moveone(&xnew,&ynew,&znew,&action,sumold);
+        if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in movecas2 \n");}
+        check=sim->mic[VOXEL(xnew,ynew,znew)];
 
         /* if new location is C3A or diffusing C3A, execute conversion */
         /* to stratlingite (including necessary volumetric expansion) */
         if((check==C3A)||(check==DIFFC3A)||(check==DIFFC4A)){
         /* Convert diffusing CAS2 to a stratlingite pixel */
                 action=0;
-                mic[xcur][ycur][zcur]=STRAT;
-		count[STRAT]+=1;
-                count[DIFFCAS2]-=1;
+                setphase(xcur,ycur,zcur,STRAT);
 
                 /* determine if diffusing or solid C3A should be converted to STRAT*/
                 /* 1 unit of CAS2 requires 0.886 units of C3A */
                 /* and should form 4.286 units of STRAT */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=3;
                 if(pexp<=0.886){
-                        mic[xnew][ynew][znew]=STRAT;
-			count[STRAT]+=1;
-			count[check]-=1;
+                        setphase(xnew,ynew,znew,STRAT);
                         nexp=2;
                 }
 
@@ -1787,7 +1618,7 @@ int movecas2(xcur,ycur,zcur,finalstep)
                 }
 
                 /* probabilistic-based expansion for last STRAT pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.286){
                         newact=extstrat(xexp,yexp,zexp);
                 }
@@ -1796,29 +1627,25 @@ int movecas2(xcur,ycur,zcur,finalstep)
         /* if new location is C4AF execute conversion */
         /* to stratlingite (including necessary volumetric expansion) */
         else if(check==C4AF){
-                mic[xnew][ynew][znew]=STRAT;
-		count[STRAT]+=1;
-                count[C4AF]-=1;
+                setphase(xnew,ynew,znew,STRAT);
 
                 /* determine if CAS2 should be converted to STRAT */
                 /* 0.786 units of CAS2 requires 1 unit of C4AF */
                 /* and should form 3.37 units of STRAT */
 		/* Also 0.2586 units of CH and 0.5453 units of FH3 */
 		/* per unit of C4AF */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=2;
                 if(pexp<=0.786){
-                        mic[xcur][ycur][zcur]=STRAT;
-			count[STRAT]+=1;
-			count[DIFFCAS2]-=1;
+                        setphase(xcur,ycur,zcur,STRAT);
                         nexp=1;
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra CH */
                         /* 0.329= 0.2586/0.786 */
                         if(pext<0.329){
                                         extch();
                         }
-                        pext=ran1(seed);
+                        pext=ran1(simt->seed);
                         /* Addition of extra FH3 */
                         /* 0.6938= 0.5453/0.786 */
                         if(pext<0.6938){
@@ -1870,7 +1697,7 @@ int movecas2(xcur,ycur,zcur,finalstep)
                 }
 
                 /* probabilistic-based expansion for last STRAT pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.37){
                         newact=extstrat(xexp,yexp,zexp);
                 }
@@ -1881,16 +1708,14 @@ int movecas2(xcur,ycur,zcur,finalstep)
         /* solid CAS2 */
         if((action!=0)&&(finalstep==1)){
                 action=0;
-                count[DIFFCAS2]-=1;
-		count[CAS2]+=1;
-                mic[xcur][ycur][zcur]=CAS2;
+                setphase(xcur,ycur,zcur,CAS2);
         }
 
         if(action!=0){
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFCAS2;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFCAS2);
                 }
                 else{
                         /* indicate that diffusing CAS2 remained at */
@@ -1910,16 +1735,16 @@ int movecas2(xcur,ycur,zcur,finalstep)
 int moveas(xcur,ycur,zcur,finalstep)
         int xcur,ycur,zcur,finalstep;
 {
-        int check,xnew,ynew,znew,plok,action,nexp,iexp;
-       	int xexp,yexp,zexp,newact,sumold,sumgarb,keep;
-       	float pexp,pext;
+        int check,xnew,ynew,znew,action,nexp,iexp;
+       	int xexp,yexp,zexp,newact,sumold,keep;
+       	float pexp;
 
        	sumold=1;
 	keep=0;
 
 /* First be sure that a diffusing AS species is located at xcur,ycur,zcur */
 /* if not, return to calling routine */
-        if(mic[xcur][ycur][zcur]!=DIFFAS){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFAS){
                 action=0;
                 return(action);
        	}
@@ -1929,28 +1754,24 @@ int moveas(xcur,ycur,zcur,finalstep)
         ynew=ycur;
         znew=zcur;
         action=0;
-        sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-        if(action==0){printf("Error in value of action in moveas \n");}
-        check=mic[xnew][ynew][znew];
+        moveone(&xnew,&ynew,&znew,&action,sumold);
+        if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in moveas \n");}
+        check=sim->mic[VOXEL(xnew,ynew,znew)];
 
         /* if new location is CH or diffusing CH, execute conversion */
         /* to stratlingite (including necessary volumetric expansion) */
         if((check==CH)||(check==DIFFCH)){
         /* Convert diffusing CH or CH to a stratlingite pixel */
                 action=0;
-                mic[xnew][ynew][znew]=STRAT;
-		count[STRAT]+=1;
-                count[check]-=1;
+                setphase(xnew,ynew,znew,STRAT);
 
                 /* determine if diffusing AS should be converted to STRAT */
                 /* 0.7538 unit of AS requires 1 unit of CH */
                 /* and should form 3.26 units of STRAT */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 nexp=2;
                 if(pexp<=0.7538){
-                        mic[xcur][ycur][zcur]=STRAT;
-			count[STRAT]+=1;
-			count[DIFFAS]-=1;
+                        setphase(xcur,ycur,zcur,STRAT);
                         nexp=1;
                 }
                 else{
@@ -1997,7 +1818,7 @@ int moveas(xcur,ycur,zcur,finalstep)
                 }
 
                 /* probabilistic-based expansion for last stratlingite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.326){
                         newact=extstrat(xexp,yexp,zexp);
                 }
@@ -2007,16 +1828,14 @@ int moveas(xcur,ycur,zcur,finalstep)
         /* solid ASG */
         if((action!=0)&&(finalstep==1)){
                 action=0;
-                count[DIFFAS]-=1;
-		count[ASG]+=1;
-                mic[xcur][ycur][zcur]=ASG;
+                setphase(xcur,ycur,zcur,ASG);
         }
 
         if(action!=0){
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFAS;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFAS);
                 }
                 else{
                         /* indicate that diffusing AS remained at */
@@ -2036,16 +1855,16 @@ int moveas(xcur,ycur,zcur,finalstep)
 int movecaco3(xcur,ycur,zcur,finalstep)
         int xcur,ycur,zcur,finalstep;
 {
-        int check,xnew,ynew,znew,plok,action,nexp,iexp;
-       	int xexp,yexp,zexp,newact,sumold,sumgarb,keep;
-       	float pexp,pext;
+        int check,xnew,ynew,znew,action;
+       	int xexp,yexp,zexp,sumold,keep;
+       	float pexp;
 
        	sumold=1;
 	keep=0;
 
 /* First be sure that a diffusing CACO3 species is located at xcur,ycur,zcur */
 /* if not, return to calling routine */
-        if(mic[xcur][ycur][zcur]!=DIFFCACO3){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFCACO3){
                 action=0;
                 return(action);
        	}
@@ -2055,9 +1874,9 @@ int movecaco3(xcur,ycur,zcur,finalstep)
         ynew=ycur;
         znew=zcur;
         action=0;
-        sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-        if(action==0){printf("Error in value of action in moveas \n");}
-        check=mic[xnew][ynew][znew];
+        moveone(&xnew,&ynew,&znew,&action,sumold);
+        if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in moveas \n");}
+        check=sim->mic[VOXEL(xnew,ynew,znew)];
 
         /* if new location is AFM execute conversion */
         /* to carboaluminate and ettringite (including necessary */
@@ -2065,25 +1884,20 @@ int movecaco3(xcur,ycur,zcur,finalstep)
         if(check==AFM){
         /* Convert AFM to a carboaluminate or ettringite pixel */
                 action=0;
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.479192){
-                      mic[xnew][ynew][znew]=AFMC;
-		      count[AFMC]+=1;
+                      setphase(xnew,ynew,znew,AFMC);
                 }
                 else{
-                      mic[xnew][ynew][znew]=ETTR;
-		      count[ETTR]+=1;
+                      setphase(xnew,ynew,znew,ETTR);
                 }
-                count[check]-=1;
 
                 /* determine if diffusing CACO3 should be converted to AFMC */
                 /* 0.078658 unit of AS requires 1 unit of AFM */
                 /* and should form 0.55785 units of AFMC */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.078658){
-                        mic[xcur][ycur][zcur]=AFMC;
-			count[AFMC]+=1;
-			count[DIFFCACO3]-=1;
+                        setphase(xcur,ycur,zcur,AFMC);
                 }
                 else{
 			keep=1;
@@ -2096,9 +1910,9 @@ int movecaco3(xcur,ycur,zcur,finalstep)
                 zexp=znew;
 
                 /* probabilistic-based expansion for new ettringite pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.26194){
-                        newact=extettr(xexp,yexp,zexp,0);
+                        extettr(xexp,yexp,zexp,0);
                 }
         }
 	
@@ -2106,16 +1920,14 @@ int movecaco3(xcur,ycur,zcur,finalstep)
         /* solid CACO3 */
         if((action!=0)&&(finalstep==1)){
                 action=0;
-                count[DIFFCACO3]-=1;
-		count[CACO3]+=1;
-                mic[xcur][ycur][zcur]=CACO3;
+                setphase(xcur,ycur,zcur,CACO3);
         }
 
         if(action!=0){
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFCACO3;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFCACO3);
                 }
                 else{
                         /* indicate that diffusing CACO3 remained at */
@@ -2130,12 +1942,11 @@ int movecaco3(xcur,ycur,zcur,finalstep)
 /* routine to add extra AFm phase when diffusing ettringite reacts */
 /* with C3A (diffusing or solid) at location (xpres,ypres,zpres) */
 /* Called by moveettr and movec3a */
-/* Calls moveone and edgecnt */
+/* Calls moveone and extrand */
 void extafm(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
-        int check,sump,xchr,ychr,zchr,fchr,i1,plok,newact,numnear;
-       	long int tries;
+        int check,sump,xchr,ychr,zchr,fchr,i1,newact;
 
 /* first try 6 neighboring locations until      */
 /*	a) successful				*/
@@ -2151,44 +1962,20 @@ void extafm(xpres,ypres,zpres)
                 zchr=zpres;
                 newact=0;
                 sump*=moveone(&xchr,&ychr,&zchr,&newact,sump);
-                if(newact==0){printf("Error in value of newact in extafm \n");}
-                check=mic[xchr][ychr][zchr];
+                if(newact==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of newact in extafm \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];
 
                 /* if neighbor is porosity, locate the AFm phase there */
                 if(check==POROSITY){
-                        mic[xchr][ychr][zchr]=AFM;
-			count[AFM]+=1;
-			count[POROSITY]-=1;
+                        setphase(xchr,ychr,zchr,AFM);
                         fchr=1;
                 }
          }
 
          /* if no neighbor available, locate AFm phase at random location */
          /* in pore space */
-         tries=0;
-         while(fchr==0){
-                tries+=1;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-
-                /* if location is porosity, locate the extra AFm there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,AFM,C3A,C4AF);
-                        /* Be sure that at least one neighboring pixel is */
-                        /* Afm phase, C3A, or C4AF */
-                        if((tries>5000)||(numnear<26)){
-                                mic[xchr][ychr][zchr]=AFM;
-				count[AFM]+=1;
-				count[POROSITY]-=1;
-                                fchr=1;
-                        }
-                }
+        if(fchr==0){
+                extrand(AFM);
         }
 }
 
@@ -2199,13 +1986,13 @@ void extafm(xpres,ypres,zpres)
 int moveettr(xcur,ycur,zcur,finalstep)
         int xcur,ycur,zcur,finalstep;
 {
-        int check,xnew,ynew,znew,plok,action,nexp,iexp;
-        int xexp,yexp,zexp,newact,sumold,sumgarb;
+        int check,xnew,ynew,znew,action;
+        int sumold;
         float pexp,pafm,pgrow;
 
 /* First be sure a diffusing ettringite species is located at xcur,ycur,zcur */
 /* if not, return to calling routine */
-        if(mic[xcur][ycur][zcur]!=DIFFETTR){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFETTR){
                 action=0;
                 return(action);
         }
@@ -2216,43 +2003,37 @@ int moveettr(xcur,ycur,zcur,finalstep)
         znew=zcur;
         action=0;
         sumold=1;
-        sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-        if(action==0){printf("Error in value of action in moveettr \n");}
-        check=mic[xnew][ynew][znew];
+        moveone(&xnew,&ynew,&znew,&action,sumold);
+        if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in moveettr \n");}
+        check=sim->mic[VOXEL(xnew,ynew,znew)];
 
         /* if new location is C4AF, execute conversion */
         /* to AFM phase (including necessary volumetric expansion) */
         if(check==C4AF){
                 /* Convert diffusing ettringite to AFM phase */
-                mic[xcur][ycur][zcur]=AFM;
-		count[AFM]+=1;
-                count[DIFFETTR]-=1;
+                setphase(xcur,ycur,zcur,AFM);
 
                 /* determine if C4AF should be converted to Afm */
                 /* or FH3- 1 unit of ettringite requires 0.348 units */
                 /* of C4AF to form 1.278 units of Afm, */
                 /* 0.0901 units of CH and 0.1899 units of FH3 */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
 		
                 if(pexp<=0.278){
-                        mic[xnew][ynew][znew]=AFM;
-			count[AFM]+=1;
-			count[C4AF]-=1;
-                        pafm=ran1(seed);
+                        setphase(xnew,ynew,znew,AFM);
+                        pafm=ran1(simt->seed);
                         /* 0.3241= 0.0901/0.278 */
                         if(pafm<=0.3241){
                                 extch();
                         }
-                        pafm=ran1(seed);
+                        pafm=ran1(simt->seed);
                         /* 0.4313= ((.1899-(.348-.278))/.278)   */
                         if(pafm<=0.4313){
                                 extfh3(xnew,ynew,znew);
                         }
                 }
                 else if (pexp<=0.348){
-                        mic[xnew][ynew][znew]=FH3;
-			count[FH3]+=1;
-			count[C4AF]-=1;
+                        setphase(xnew,ynew,znew,FH3);
                 }
                 action=0;
         }
@@ -2262,37 +2043,31 @@ int moveettr(xcur,ycur,zcur,finalstep)
         else if((check==C3A)||(check==DIFFC3A)){
                 /* Convert diffusing ettringite to AFM phase */
                 action=0;
-                mic[xcur][ycur][zcur]=AFM;
-                count[DIFFETTR]-=1;
-		count[AFM]+=1;
-		count[check]-=1;	
+                setphase(xcur,ycur,zcur,AFM);
 
                 /* determine if C3A should be converted to AFm */
                 /* 1 unit of ettringite requires 0.2424 units of C3A */
                 /* and should form 1.278 units of AFm phase */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.2424){
-                        mic[xnew][ynew][znew]=AFM;
-			count[AFM]+=1;
+                        setphase(xnew,ynew,znew,AFM);
                         pafm=(-0.1);
                 }
                 else{
                         /* maybe someday, use a new FIXEDC3A here */
                         /* so it won't dissolve later */
                         if(check==C3A){
-                                mic[xnew][ynew][znew]=C3A;
-				count[C3A]+=1;
+                                setphase(xnew,ynew,znew,C3A);
                         }
                         else{
-                                count[DIFFC3A]+=1;
-                                mic[xnew][ynew][znew]=DIFFC3A;
+                                setphase(xnew,ynew,znew,DIFFC3A);
                         }
 /*                      pafm=(0.278-0.2424)/(1.0-0.2424);  */
 			pafm=0.04699;
                 }
 
                 /* probabilistic-based expansion for new AFm phase pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=pafm){
                         extafm(xcur,ycur,zcur);
                 }
@@ -2300,12 +2075,10 @@ int moveettr(xcur,ycur,zcur,finalstep)
 
         /* Check for conversion back to solid ettringite */
         else if(check==ETTR){
-                pgrow=ran1(seed);
+                pgrow=ran1(simt->seed);
                 if(pgrow<=ETTRGROW){
-                        mic[xcur] [ycur] [zcur]=ETTR;
-			count[ETTR]+=1;
+                        setphase(xcur,ycur,zcur,ETTR);
                         action=0;
-                        count[DIFFETTR]-=1;
                 }
         }
 
@@ -2313,16 +2086,14 @@ int moveettr(xcur,ycur,zcur,finalstep)
         /* solid ettringite */
         if((action!=0)&&(finalstep==1)){
                 action=0;
-                count[DIFFETTR]-=1;
-		count[ETTR]+=1;
-                mic[xcur][ycur][zcur]=ETTR;
+                setphase(xcur,ycur,zcur,ETTR);
         }
 
         if(action!=0){
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFETTR;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFETTR);
                 }
                 else{
                         /* indicate that diffusing ettringite remained at */
@@ -2336,12 +2107,11 @@ int moveettr(xcur,ycur,zcur,finalstep)
 /* routine to add extra pozzolanic CSH when CH reacts at */
 /* pozzolanic surface (e.g. silica fume) located at (xpres,ypres,zpres) */
 /* Called by movech */
-/* Calls moveone and edgecnt */
+/* Calls moveone and extrand */
 void extpozz(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
-        int check,sump,xchr,ychr,zchr,fchr,i1,plok,action,numnear;
-        long int tries;
+        int check,sump,xchr,ychr,zchr,fchr,i1,action;
 
 /* first try 6 neighboring locations until      */
 /*	a) successful				*/
@@ -2357,43 +2127,20 @@ void extpozz(xpres,ypres,zpres)
                 zchr=zpres;
                 action=0;
                 sump*=moveone(&xchr,&ychr,&zchr,&action,sump);
-                if(action==0){printf("Error in value of action in extpozz \n");}
-                check=mic[xchr][ychr][zchr];
+                if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in extpozz \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];
 
                 /* if neighbor is porosity, locate the pozzolanic CSH there */
                 if(check==POROSITY){
-                        mic[xchr][ychr][zchr]=POZZCSH;
-			count[POZZCSH]+=1;
-			count[POROSITY]-=1;
+                        setphase(xchr,ychr,zchr,POZZCSH);
                         fchr=1;
                 }
         }
 
         /* if no neighbor available, locate pozzolanic CSH at random location */
         /* in pore space */
-        tries=0;
-        while(fchr==0){
-                tries+=1;
-                /* generate a random location in the 3-D system */
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-           /* if location is porosity, locate the extra pozzolanic CSH there */
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,POZZ,CSH,POZZCSH);
-                        /* Be sure that one neighboring species is CSH or */
-                        /* pozzolanic material */
-                        if((tries>5000)||(numnear<26)){
-                                mic[xchr][ychr][zchr]=POZZCSH;
-				count[POZZCSH]+=1;
-				count[POROSITY]-=1;
-                                fchr=1;
-                        }
-                }
+        if(fchr==0){
+                extrand(POZZCSH);
         }
 }
 
@@ -2405,17 +2152,15 @@ int movefh3(xcur,ycur,zcur,finalstep,nucprob)
         int xcur,ycur,zcur,finalstep;
         float nucprob;
 {
-        int check,xnew,ynew,znew,plok,action,sumold,sumgarb;
+        int check,xnew,ynew,znew,action,sumold;
         float pgen;
 
         /* first check for nucleation */
-        pgen=ran1(seed);
+        pgen=ran1(simt->seed);
 
         if((nucprob>=pgen)||(finalstep==1)){
                 action=0;
-                mic[xcur][ycur][zcur]=FH3;
-		count[FH3]+=1;
-                count[DIFFFH3]-=1;
+                setphase(xcur,ycur,zcur,FH3);
         }
         else{
 		
@@ -2425,23 +2170,21 @@ int movefh3(xcur,ycur,zcur,finalstep,nucprob)
                 znew=zcur;
                 action=0;
                 sumold=1;
-                sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-                if(action==0){printf("Error in value of action in movefh3 \n");}
-                check=mic[xnew][ynew][znew];
+                moveone(&xnew,&ynew,&znew,&action,sumold);
+                if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in movefh3 \n");}
+                check=sim->mic[VOXEL(xnew,ynew,znew)];
 
                	/* check for growth of FH3 crystal */
                 if(check==FH3){
-                        mic[xcur][ycur][zcur]=FH3;
-			count[FH3]+=1;
-                        count[DIFFFH3]-=1;
+                        setphase(xcur,ycur,zcur,FH3);
                         action=0;
                 }
 
                 if(action!=0){
                         /* if diffusion is possible, execute it */
                         if(check==POROSITY){
-                                mic[xcur][ycur][zcur]=POROSITY;
-                                mic[xnew][ynew][znew]=DIFFFH3;
+                                setphase(xcur,ycur,zcur,POROSITY);
+                                setphase(xnew,ynew,znew,DIFFFH3);
                         }
                         else{
                                 /* indicate that diffusing FH3 species */
@@ -2461,16 +2204,14 @@ int movech(xcur,ycur,zcur,finalstep,nucprob)
         int xcur,ycur,zcur,finalstep;
         float nucprob;
 {
-        int check,xnew,ynew,znew,plok,action,sumgarb,sumold;
+        int check,xnew,ynew,znew,action,sumold;
         float pexp,pgen,pfix;
 
         /* first check for nucleation */
-        pgen=ran1(seed);
+        pgen=ran1(simt->seed);
         if((nucprob>=pgen)||(finalstep==1)){
                 action=0;
-                mic[xcur][ycur][zcur]=CH;
-                count[DIFFCH]-=1;
-		count[CH]+=1;
+                setphase(xcur,ycur,zcur,CH);
         }
         else{
 		
@@ -2480,45 +2221,37 @@ int movech(xcur,ycur,zcur,finalstep,nucprob)
                 znew=zcur;
                 action=0;
                 sumold=1;
-                sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-                if(action==0){printf("Error in value of action in movech \n");}
-                check=mic[xnew][ynew][znew];
+                moveone(&xnew,&ynew,&znew,&action,sumold);
+                if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in movech \n");}
+                check=sim->mic[VOXEL(xnew,ynew,znew)];
 
                 /* check for growth of CH crystal */
                 if((check==CH)&&(pgen<=CHGROW)){
-                        mic[xcur][ycur][zcur]=CH;
-                        count[DIFFCH]-=1;
-			count[CH]+=1;
+                        setphase(xcur,ycur,zcur,CH);
                         action=0;
                 }
               /* check for growth of CH crystal on aggregate or CaCO3 surface */
                 /* re suggestion of Sidney Diamond */
-                else if(((check==INERTAGG)||(check==CACO3)||(check==INERT))&&(pgen<=CHGROWAGG)&&(chflag==1)){
-                        mic[xcur][ycur][zcur]=CH;
-                        count[DIFFCH]-=1;
-			count[CH]+=1;
+                else if(((check==INERTAGG)||(check==CACO3)||(check==INERT))&&(pgen<=CHGROWAGG)&&(sim->chflag==1)){
+                        setphase(xcur,ycur,zcur,CH);
                         action=0;
                 }
 
                 /* check for pozzolanic reaction */
 		/* 36.41 units CH can react with 27 units of S */
-                else if((pgen<=ppozz)&&(check==POZZ)&&(npr<=(int)((float)nfill*1.35))){
+                else if((pgen<=sim->ppozz)&&(check==POZZ)&&(simt->npr<=(int)((float)sim->nfill*1.35))){
                         action=0;
-                        mic[xcur][ycur][zcur]=POZZCSH;
-			count[POZZCSH]+=1;
+                        setphase(xcur,ycur,zcur,POZZCSH);
                         /* update counter of number of diffusing CH */
                         /* which have reacted pozzolanically */
-                        npr+=1;
-                        count[DIFFCH]-=1;
+                        simt->npr+=1;
                         /* Convert pozzolan to pozzolanic CSH as needed */
-                        pfix=ran1(seed);
+                        pfix=ran1(simt->seed);
 			if(pfix<=(1./1.35)){
-				mic[xnew][ynew][znew]=POZZCSH;
-				count[POZZ]-=1;
-				count[POZZCSH]+=1;
+				setphase(xnew,ynew,znew,POZZCSH);
 			}
                         /* allow for extra pozzolanic CSH as needed */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
 			/* should form 101.81 units of pozzolanic CSH for */
 			/* each 36.41 units of CH and 27 units of S */
 			/* 1.05466=(101.81-36.41-27)/36.41 */
@@ -2529,23 +2262,19 @@ int movech(xcur,ycur,zcur,finalstep,nucprob)
                 }
 		else if(check==DIFFAS){
 			action=0;
-			mic[xcur][ycur][zcur]=STRAT;
-			count[STRAT]+=1;
+			setphase(xcur,ycur,zcur,STRAT);
 			/* update counter of number of diffusing CH */
 			/* which have reacted to form stratlingite */
-			nasr+=1;
-			count[DIFFCH]-=1;
+			simt->nasr+=1;
 			/* Convert DIFFAS to STRAT as needed */
-			pfix=ran1(seed);
+			pfix=ran1(simt->seed);
 			if(pfix<=0.7538){
-				mic[xnew][ynew][znew]=STRAT;
-				count[STRAT]+=1;
-				count[DIFFAS]-=1;
+				setphase(xnew,ynew,znew,STRAT);
 			}
 			/* allow for extra stratlingite as needed */
 			/* 1.5035=(215.63-66.2-49.9)/66.2 */
 			extstrat(xcur,ycur,zcur);
-			pexp=ran1(seed);
+			pexp=ran1(simt->seed);
 			if(pexp<=0.5035){
 				extstrat(xcur,ycur,zcur);
 			}
@@ -2554,8 +2283,8 @@ int movech(xcur,ycur,zcur,finalstep,nucprob)
 		if(action!=0){
                         /* if diffusion is possible, execute it */
                         if(check==POROSITY){
-                                mic[xcur][ycur][zcur]=POROSITY;
-                                mic[xnew][ynew][znew]=DIFFCH;
+                                setphase(xcur,ycur,zcur,POROSITY);
+                                setphase(xnew,ynew,znew,DIFFCH);
                         }
                         else{
                                 /* indicate that diffusing CH species */
@@ -2570,12 +2299,11 @@ int movech(xcur,ycur,zcur,finalstep,nucprob)
 /* routine to add extra C3AH6 when diffusing C3A nucleates or reacts at */
 /* C3AH6 surface at location (xpres,ypres,zpres) */
 /* Called by movec3a */
-/* Calls moveone and edgecnt */
+/* Calls moveone and extrand */
 void extc3ah6(xpres,ypres,zpres)
         int xpres,ypres,zpres;
 {
-        int check,sump,xchr,ychr,zchr,fchr,i1,plok,action,numnear;
-        long int tries;
+        int check,sump,xchr,ychr,zchr,fchr,i1,action;
 
 /* First try 6 neighboring locations until      */
 /* 	a) successful				*/
@@ -2591,41 +2319,19 @@ void extc3ah6(xpres,ypres,zpres)
                 zchr=zpres;
                 action=0;
                 sump*=moveone(&xchr,&ychr,&zchr,&action,sump);
-                if(action==0){printf("Error in action value in extc3ah6 \n");}
-                check=mic[xchr][ychr][zchr];
+                if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in action value in extc3ah6 \n");}
+                check=sim->mic[VOXEL(xchr,ychr,zchr)];
 
                 /* if neighbor is pore space, convert it to C3AH6 */
                 if(check==POROSITY){
-                        mic[xchr][ychr][zchr]=C3AH6;
-			count[C3AH6]+=1;
-			count[POROSITY]-=1;
+                        setphase(xchr,ychr,zchr,C3AH6);
                         fchr=1;
                 }
         }
 
         /* if unsuccessful, add C3AH6 at random location in pore space */
-        tries=0;
-        while(fchr==0){
-                tries+=1;
-                xchr=(int)((float)SYSIZE*ran1(seed));
-                ychr=(int)((float)SYSIZE*ran1(seed));
-                zchr=(int)((float)SYSIZE*ran1(seed));
-                if(xchr>=SYSIZE){xchr=0;}
-                if(ychr>=SYSIZE){ychr=0;}
-                if(zchr>=SYSIZE){zchr=0;}
-                check=mic[xchr][ychr][zchr];
-
-                if(check==POROSITY){
-                        numnear=edgecnt(xchr,ychr,zchr,C3AH6,C3A,C3AH6);
-                        /* Be sure that new C3AH6 is in contact with */
-                        /* at least one C3AH6 or C3A */
-                        if((tries>5000)||(numnear<26)){
-                                mic[xchr][ychr][zchr]=C3AH6;
-				count[C3AH6]+=1;
-				count[POROSITY]-=1;
-                                fchr=1;
-                        }
-                }
+        if(fchr==0){
+                extrand(C3AH6);
         }
 }
 
@@ -2637,29 +2343,27 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
         int xcur,ycur,zcur,finalstep;
         float nucprob;
 {
-        int check,xnew,ynew,znew,plok,action,sumgarb,sumold;
+        int check,xnew,ynew,znew,action,sumold;
         int xexp,yexp,zexp,nexp,iexp,newact;
         float pgen,pexp,pafm,pgrow,p2diff;
 
         /* First be sure that a diffusing C3A species is at (xcur,ycur,zcur) */
-        if(mic[xcur][ycur][zcur]!=DIFFC3A){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFC3A){
                 action=0;
                 return(action);
         }
 
         /* Check for nucleation into solid C3AH6 */
-        pgen=ran1(seed);
-	p2diff=ran1(seed);
+        pgen=ran1(simt->seed);
+	p2diff=ran1(simt->seed);
 
         if((nucprob>=pgen)||(finalstep==1)){
                 action=0;
-                mic[xcur][ycur][zcur]=C3AH6;
-		count[C3AH6]+=1;
+                setphase(xcur,ycur,zcur,C3AH6);
                 /* decrement count of diffusing C3A species */
-                count[DIFFC3A]-=1;
                 /* allow for probabilistic-based expansion of C3AH6 */
                 /* crystal to account for volume stoichiometry */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.69){
                         extc3ah6(xcur,ycur,zcur);
                 }
@@ -2671,23 +2375,21 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                 znew=zcur;
                 action=0;
                 sumold=1;
-                sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-                if(action==0){printf("Error in value of action in movec3a \n");}
-                check=mic[xnew][ynew][znew];
+                moveone(&xnew,&ynew,&znew,&action,sumold);
+                if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in movec3a \n");}
+                check=sim->mic[VOXEL(xnew,ynew,znew)];
 	
                 /* check for growth of C3AH6 crystal */
                 if(check==C3AH6){
-	                pgrow=ran1(seed);
+	                pgrow=ran1(simt->seed);
                         /* Try to slow down growth of C3AH6 crystals to */
                         /* promote ettringite and Afm formation */
                         if(pgrow<=C3AH6GROW){
-                                mic[xcur][ycur][zcur]=C3AH6;
-				count[C3AH6]+=1;
-                                count[DIFFC3A]-=1;
+                                setphase(xcur,ycur,zcur,C3AH6);
                                 action=0;
                          /* allow for probabilistic-based expansion of C3AH6 */
                          /* crystal to account for volume stoichiometry */
-                                pexp=ran1(seed);
+                                pexp=ran1(simt->seed);
                                 if(pexp<=0.69){
                                         extc3ah6(xcur,ycur,zcur);
                                 }
@@ -2698,19 +2400,15 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing gypsum */
                 else if((check==DIFFGYP)&&(p2diff<C3AGYP)){
                         /* convert diffusing gypsum to ettringite */
-                        mic[xnew][ynew][znew]=ETTR;
-			count[ETTR]+=1;
+                        setphase(xnew,ynew,znew,ETTR);
                         /* decrement counts of diffusing gypsum */
-                        count[DIFFGYP]-=1;
                         action=0;
 
 /* convert diffusing C3A to solid ettringite or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=2;
                         if(pexp<=0.40){
-                                mic[xcur][ycur][zcur]=ETTR;
-				count[ETTR]+=1;
-				count[DIFFC3A]-=1;
+                                setphase(xcur,ycur,zcur,ETTR);
                                 nexp=1;
                         }
                         else{
@@ -2759,7 +2457,7 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last ettringite pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.30){
                                 newact=extettr(xexp,yexp,zexp,0);
                         }
@@ -2768,19 +2466,15 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing hemihydrate */
                 else if((check==DIFFHEM)&&(p2diff<C3AGYP)){
                         /* convert diffusing hemihydrate to ettringite */
-                        mic[xnew][ynew][znew]=ETTR;
-			count[ETTR]+=1;
+                        setphase(xnew,ynew,znew,ETTR);
                         /* decrement counts of diffusing hemihydrate */
-                        count[DIFFHEM]-=1;
                         action=0;
 
 /* convert diffusing C3A to solid ettringite or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=3;
                         if(pexp<=0.5583){
-                                mic[xcur][ycur][zcur]=ETTR;
-				count[ETTR]+=1;
-				count[DIFFC3A]-=1;
+                                setphase(xcur,ycur,zcur,ETTR);
                                 nexp=2;
                         }
                         else{
@@ -2829,7 +2523,7 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last ettringite pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.6053){
                                 newact=extettr(xexp,yexp,zexp,0);
                         }
@@ -2838,19 +2532,15 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing anhydrite */
                 else if((check==DIFFANH)&&(p2diff<C3AGYP)){
                         /* convert diffusing anhydrite to ettringite */
-                        mic[xnew][ynew][znew]=ETTR;
-			count[ETTR]+=1;
+                        setphase(xnew,ynew,znew,ETTR);
                         /* decrement counts of diffusing anhydrite */
-                        count[DIFFANH]-=1;
                         action=0;
 
 /* convert diffusing C3A to solid ettringite or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=3;
                         if(pexp<=0.569){
-                                mic[xcur][ycur][zcur]=ETTR;
-				count[ETTR]+=1;
-				count[DIFFC3A]-=1;
+                                setphase(xcur,ycur,zcur,ETTR);
                                 nexp=2;
                         }
                         else{
@@ -2899,7 +2589,7 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last ettringite pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.6935){
                                 newact=extettr(xexp,yexp,zexp,0);
                         }
@@ -2908,19 +2598,15 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing CaCl2 */
                 else if(check==DIFFCACL2){
                         /* convert diffusing C3A to Freidel's salt */
-                        mic[xcur][ycur][zcur]=FREIDEL;
-			count[FREIDEL]+=1;
+                        setphase(xcur,ycur,zcur,FREIDEL);
                         /* decrement counts of diffusing C3A and CaCl2 */
-                        count[DIFFC3A]-=1;
                         action=0;
 
 /* convert diffusing CACL2 to solid FREIDEL or else leave as a diffusing CACL2 */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=2;
                         if(pexp<=0.5793){
-                                mic[xnew][ynew][znew]=FREIDEL;
-				count[FREIDEL]+=1;
-				count[DIFFCACL2]-=1;
+                                setphase(xnew,ynew,znew,FREIDEL);
                                 nexp=1;
                         }
                         else{
@@ -2967,7 +2653,7 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last FREIDEL pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.3295){
                                 newact=extfreidel(xexp,yexp,zexp);
                         }
@@ -2976,19 +2662,15 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing (not solid) CAS2 */
                 else if(check==DIFFCAS2){
                         /* convert diffusing CAS2 to stratlingite */
-                        mic[xnew][ynew][znew]=STRAT;
-			count[STRAT]+=1;
+                        setphase(xnew,ynew,znew,STRAT);
                         /* decrement counts of diffusing C3A and CAS2 */
-                        count[DIFFCAS2]-=1;
                         action=0;
 	
 /* convert diffusing C3A to solid STRAT or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=3;
                         if(pexp<=0.886){
-                                mic[xcur][ycur][zcur]=STRAT;
-				count[STRAT]+=1;
-				count[DIFFC3A]-=1;
+                                setphase(xcur,ycur,zcur,STRAT);
                                 nexp=2;
                         }
                         else{
@@ -3036,7 +2718,7 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last STRAT pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.286){
                                 newact=extstrat(xexp,yexp,zexp);
                         }
@@ -3045,21 +2727,17 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
 /* reaction at solid ettringite only possible if ettringite is soluble */
 /* and even then on a limited bases to avoid a great formation of AFm */
 /* when ettringite first becomes soluble */
-                pgrow=ran1(seed);
-   if((check==DIFFETTR)||((check==ETTR)&&(soluble[ETTR]==1)&&(pgrow<=C3AETTR))){
+                pgrow=ran1(simt->seed);
+   if((check==DIFFETTR)||((check==ETTR)&&(sim->soluble[ETTR]==1)&&(pgrow<=C3AETTR))){
                 /* convert diffusing or solid ettringite to AFm */
-                mic[xnew][ynew][znew]=AFM;
-		count[AFM]+=1;
+                setphase(xnew,ynew,znew,AFM);
                 /* decrement count of ettringite */
-		count[check]-=1;
                 action=0;
 	
                 /* convert diffusing C3A to AFm or leave as diffusing C3A */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.2424){
-                        mic[xcur][ycur][zcur]=AFM;
-			count[AFM]+=1;
-			count[DIFFC3A]-=1;
+                        setphase(xcur,ycur,zcur,AFM);
                         pafm=(-0.1);
                 }
                 else{
@@ -3068,7 +2746,7 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
                 }
 
                 /* probabilistic-based expansion for new AFm pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=pafm){
                         extafm(xnew,ynew,znew);
                 }
@@ -3077,8 +2755,8 @@ int movec3a(xcur,ycur,zcur,finalstep,nucprob)
 
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFC3A;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFC3A);
                 }
                 else{
                         /* indicate that diffusing C3A remained */
@@ -3098,29 +2776,27 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
         int xcur,ycur,zcur,finalstep;
         float nucprob;
 {
-        int check,xnew,ynew,znew,plok,action,sumgarb,sumold;
+        int check,xnew,ynew,znew,action,sumold;
         int xexp,yexp,zexp,nexp,iexp,newact;
         float pgen,pexp,pafm,pgrow,p2diff;
 
         /* First be sure that a diffusing C4A species is at (xcur,ycur,zcur) */
-        if(mic[xcur][ycur][zcur]!=DIFFC4A){
+        if(sim->mic[VOXEL(xcur,ycur,zcur)]!=DIFFC4A){
                 action=0;
                 return(action);
         }
 
         /* Check for nucleation into solid C3AH6 */
-        pgen=ran1(seed);
-	p2diff=ran1(seed);
+        pgen=ran1(simt->seed);
+	p2diff=ran1(simt->seed);
 
         if((nucprob>=pgen)||(finalstep==1)){
                 action=0;
-                mic[xcur][ycur][zcur]=C3AH6;
-		count[C3AH6]+=1;
+                setphase(xcur,ycur,zcur,C3AH6);
                 /* decrement count of diffusing C3A species */
-                count[DIFFC4A]-=1;
                 /* allow for probabilistic-based expansion of C3AH6 */
                 /* crystal to account for volume stoichiometry */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.69){
                         extc3ah6(xcur,ycur,zcur);
                 }
@@ -3132,23 +2808,21 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                 znew=zcur;
                 action=0;
                 sumold=1;
-                sumgarb=moveone(&xnew,&ynew,&znew,&action,sumold);
-                if(action==0){printf("Error in value of action in movec4a \n");}
-                check=mic[xnew][ynew][znew];
+                moveone(&xnew,&ynew,&znew,&action,sumold);
+                if(action==0){logmsg(LOGHYDRATE,LOGWARN,"Error in value of action in movec4a \n");}
+                check=sim->mic[VOXEL(xnew,ynew,znew)];
 	
                 /* check for growth of C3AH6 crystal */
                 if(check==C3AH6){
-	                pgrow=ran1(seed);
+	                pgrow=ran1(simt->seed);
                         /* Try to slow down growth of C3AH6 crystals to */
                         /* promote ettringite and Afm formation */
                         if(pgrow<=C3AH6GROW){
-                                mic[xcur][ycur][zcur]=C3AH6;
-				count[C3AH6]+=1;
-                                count[DIFFC4A]-=1;
+                                setphase(xcur,ycur,zcur,C3AH6);
                                 action=0;
                          /* allow for probabilistic-based expansion of C3AH6 */
                          /* crystal to account for volume stoichiometry */
-                                pexp=ran1(seed);
+                                pexp=ran1(simt->seed);
                                 if(pexp<=0.69){
                                         extc3ah6(xcur,ycur,zcur);
                                 }
@@ -3159,19 +2833,15 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing gypsum */
                 else if((check==DIFFGYP)&&(p2diff<C3AGYP)){
                         /* convert diffusing gypsum to ettringite */
-                        mic[xnew][ynew][znew]=ETTRC4AF;
-			count[ETTRC4AF]+=1;
+                        setphase(xnew,ynew,znew,ETTRC4AF);
                         /* decrement counts of diffusing gypsum */
-                        count[DIFFGYP]-=1;
                         action=0;
 
 /* convert diffusing C3A to solid ettringite or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=2;
                         if(pexp<=0.40){
-                                mic[xcur][ycur][zcur]=ETTRC4AF;
-				count[ETTRC4AF]+=1;
-				count[DIFFC4A]-=1;
+                                setphase(xcur,ycur,zcur,ETTRC4AF);
                                 nexp=1;
                         }
                         else{
@@ -3220,7 +2890,7 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last ettringite pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.30){
                                 newact=extettr(xexp,yexp,zexp,1);
                         }
@@ -3229,19 +2899,15 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing hemihydrate */
                 else if((check==DIFFHEM)&&(p2diff<C3AGYP)){
                         /* convert diffusing hemihydrate to ettringite */
-                        mic[xnew][ynew][znew]=ETTRC4AF;
-			count[ETTRC4AF]+=1;
+                        setphase(xnew,ynew,znew,ETTRC4AF);
                         /* decrement counts of diffusing hemihydrate */
-                        count[DIFFHEM]-=1;
                         action=0;
 
 /* convert diffusing C3A to solid ettringite or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=3;
                         if(pexp<=0.5583){
-                                mic[xcur][ycur][zcur]=ETTRC4AF;
-				count[ETTRC4AF]+=1;
-				count[DIFFC4A]-=1;
+                                setphase(xcur,ycur,zcur,ETTRC4AF);
                                 nexp=2;
                         }
                         else{
@@ -3290,7 +2956,7 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last ettringite pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.6053){
                                 newact=extettr(xexp,yexp,zexp,1);
                         }
@@ -3299,19 +2965,15 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing anhydrite */
                 else if((check==DIFFANH)&&(p2diff<C3AGYP)){
                         /* convert diffusing anhydrite to ettringite */
-                        mic[xnew][ynew][znew]=ETTRC4AF;
-			count[ETTRC4AF]+=1;
+                        setphase(xnew,ynew,znew,ETTRC4AF);
                         /* decrement counts of diffusing anhydrite */
-                        count[DIFFANH]-=1;
                         action=0;
 
 /* convert diffusing C3A to solid ettringite or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=3;
                         if(pexp<=0.569){
-                                mic[xcur][ycur][zcur]=ETTRC4AF;
-				count[ETTRC4AF]+=1;
-				count[DIFFC4A]-=1;
+                                setphase(xcur,ycur,zcur,ETTRC4AF);
                                 nexp=2;
                         }
                         else{
@@ -3360,7 +3022,7 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last ettringite pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.6935){
                                 newact=extettr(xexp,yexp,zexp,1);
                         }
@@ -3369,19 +3031,15 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing CaCl2 */
                 else if(check==DIFFCACL2){
                         /* convert diffusing C3A to Freidel's salt */
-                        mic[xcur][ycur][zcur]=FREIDEL;
-			count[FREIDEL]+=1;
+                        setphase(xcur,ycur,zcur,FREIDEL);
                         /* decrement counts of diffusing C3A and CaCl2 */
-                        count[DIFFC4A]-=1;
                         action=0;
 
 /* convert diffusing CACL2 to solid FREIDEL or else leave as a diffusing CACL2 */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=2;
                         if(pexp<=0.5793){
-                                mic[xnew][ynew][znew]=FREIDEL;
-				count[FREIDEL]+=1;
-				count[DIFFCACL2]-=1;
+                                setphase(xnew,ynew,znew,FREIDEL);
                                 nexp=1;
                         }
                         else{
@@ -3428,7 +3086,7 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last FREIDEL pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.3295){
                                 newact=extfreidel(xexp,yexp,zexp);
                         }
@@ -3437,19 +3095,15 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                 /* Only allow reaction with diffusing (not solid) CAS2 */
                 else if(check==DIFFCAS2){
                         /* convert diffusing CAS2 to stratlingite */
-                        mic[xnew][ynew][znew]=STRAT;
-			count[STRAT]+=1;
+                        setphase(xnew,ynew,znew,STRAT);
                         /* decrement counts of diffusing CAS2 */
-                        count[DIFFCAS2]-=1;
                         action=0;
 
 /* convert diffusing C3A to solid STRAT or else leave as a diffusing C3A */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         nexp=3;
                         if(pexp<=0.886){
-                                mic[xcur][ycur][zcur]=STRAT;
-				count[STRAT]+=1;
-				count[DIFFC4A]-=1;
+                                setphase(xcur,ycur,zcur,STRAT);
                                 nexp=2;
                         }
                         else{
@@ -3497,7 +3151,7 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                         }
 
                   /* probabilistic-based expansion for last STRAT pixel */
-                        pexp=ran1(seed);
+                        pexp=ran1(simt->seed);
                         if(pexp<=0.286){
                                 newact=extstrat(xexp,yexp,zexp);
                         }
@@ -3506,21 +3160,17 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
 /* reaction at solid ettringite only possible if ettringite is soluble */
 /* and even then on a limited bases to avoid a great formation of AFm */
 /* when ettringite first becomes soluble */
-                pgrow=ran1(seed);
-   if((check==DIFFETTR)||((check==ETTR)&&(soluble[ETTR]==1)&&(pgrow<=C3AETTR))){
+                pgrow=ran1(simt->seed);
+   if((check==DIFFETTR)||((check==ETTR)&&(sim->soluble[ETTR]==1)&&(pgrow<=C3AETTR))){
                 /* convert diffusing or solid ettringite to AFm */
-                mic[xnew][ynew][znew]=AFM;
-		count[AFM]+=1;
+                setphase(xnew,ynew,znew,AFM);
                 /* decrement count of ettringite */
-		count[check]-=1;
                 action=0;
 
                 /* convert diffusing C4A to AFm or leave as diffusing C4A */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=0.2424){
-                        mic[xcur][ycur][zcur]=AFM;
-			count[AFM]+=1;
-			count[DIFFC4A]-=1;
+                        setphase(xcur,ycur,zcur,AFM);
                         pafm=(-0.1);
                 }
                 else{
@@ -3529,7 +3179,7 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
                 }
 
                 /* probabilistic-based expansion for new AFm pixel */
-                pexp=ran1(seed);
+                pexp=ran1(simt->seed);
                 if(pexp<=pafm){
                         extafm(xnew,ynew,znew);
                 }
@@ -3538,8 +3188,8 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
 
                 /* if diffusion is possible, execute it */
                 if(check==POROSITY){
-                        mic[xcur][ycur][zcur]=POROSITY;
-                        mic[xnew][ynew][znew]=DIFFC4A;
+                        setphase(xcur,ycur,zcur,POROSITY);
+                        setphase(xnew,ynew,znew,DIFFC4A);
                 }
                 else{
                         /* indicate that diffusing C4A remained */
@@ -3551,187 +3201,243 @@ int movec4a(xcur,ycur,zcur,finalstep,nucprob)
         return(action);
 }
 
-/* routine to oversee hydration by updating position of all */
-/* remaining diffusing species */
-/* Calls movech, movec3a, movefh3, moveettr, movecsh, and movegyp */
-void hydrate(fincyc,stepmax,chpar1,chpar2,hgpar1,hgpar2,fhpar1,fhpar2,gypar1,gypar2)
-        int fincyc,stepmax;
-        float chpar1,chpar2,hgpar1,hgpar2,fhpar1,fhpar2,gypar1,gypar2;
-{
-        int xpl,ypl,zpl,phpl,agepl,xpnew,ypnew,zpnew;
+/* routine to move or react the diffusing species of phase phpl */
+/* located at (xpl,ypl,zpl) and formed in cycle agepl */
+/* Returns flag indicating action taken, as for the move routines */
+/* Called by hydrate and movedomain */
+/* Calls movech, movec3a, movefh3, moveettr, movecsh, movegyp and */
+/* profclock */
+int stepant(xpl,ypl,zpl,phpl,agepl,termflag,chprob,c3ah6prob,fh3prob,gypprob)
+        int xpl,ypl,zpl,phpl,agepl,termflag;
         float chprob,c3ah6prob,fh3prob,gypprob;
-        long int icnt,nleft,ntodo,ndale;
-        int istep,termflag,reactf;
-        float beterm;
-        struct ants *curant,*antgone;
-
-        ntodo=nmade;
-        nleft=nmade;
-        termflag=0;
-
-/* Perform diffusion until all reacted or max. # of diffusion steps reached */
-        for(istep=1;((istep<=stepmax)&&(nleft>0));istep++){
-                if((fincyc==1)&&(istep==stepmax)){termflag=1;} 
-
-                nleft=0;
-                ndale=0;
-
-                /* determine probabilities for CH and C3AH6 nucleation */
-                beterm=exp(-(double)(count[DIFFCH])/chpar2);
-                chprob=chpar1*(1.-beterm);
-                beterm=exp(-(double)(count[DIFFC3A])/hgpar2);
-                c3ah6prob=hgpar1*(1.-beterm);
-                beterm=exp(-(double)(count[DIFFFH3])/fhpar2);
-                fh3prob=fhpar1*(1.-beterm);
-                beterm=exp(-(double)(count[DIFFANH]+count[DIFFHEM])/gypar2);
-                gypprob=gypar1*(1.-beterm);
-
-                /* Process each diffusing species in turn */
-                curant=headant->nextant;
-                while(curant!=NULL){
-                        ndale+=1;
-                        xpl=curant->x;
-                        ypl=curant->y;
-                        zpl=curant->z;
-                        phpl=curant->id;
-			agepl=curant->cycbirth;
-
-       /* based on ID, call appropriate routine to process diffusing species */
-                        switch (phpl) {
-                                case DIFFCSH:
+{
+        int reactf,kind,timed;
+        double tstep;
+
+        reactf=0;
+        /* Only one step in PROFSAMPLE is timed, to keep the cost of */
+        /* reading the clock small */
+        timed=0;
+        tstep=0.0;
+        if(sim->profon){
+                simt->profnstep+=1;
+                if((simt->profnstep%PROFSAMPLE)==0){
+                        timed=1;
+                        tstep=profclock();
+                }
+        }
+/* based on ID, call appropriate routine to process diffusing species */
+        switch (phpl) {
+                case DIFFCSH:
 					/* printf("Calling movecsh \n");
 					fflush(stdout); */
-                                        reactf=movecsh(xpl,ypl,zpl,termflag,agepl);
-                                        break;
-                                case DIFFANH:
+                        reactf=movecsh(xpl,ypl,zpl,termflag,agepl);
+                        break;
+                case DIFFANH:
 					/* printf("Calling moveanh \n");
 					fflush(stdout); */
-                                        reactf=moveanh(xpl,ypl,zpl,termflag,gypprob);
-                                        break;
-                                case DIFFHEM:
+                        reactf=moveanh(xpl,ypl,zpl,termflag,gypprob);
+                        break;
+                case DIFFHEM:
 					/* printf("Calling movehem \n");
 					fflush(stdout); */
-                                        reactf=movehem(xpl,ypl,zpl,termflag,gypprob);
-                                        break;
-                                case DIFFCH:
+                        reactf=movehem(xpl,ypl,zpl,termflag,gypprob);
+                        break;
+                case DIFFCH:
 					/* printf("Calling movech \n");
 					fflush(stdout); */
-                                  reactf=movech(xpl,ypl,zpl,termflag,chprob);
-                                  break;
-                                case DIFFFH3:
+                  reactf=movech(xpl,ypl,zpl,termflag,chprob);
+                  break;
+                case DIFFFH3:
 					/* printf("Calling movefh3 \n");
 					fflush(stdout); */
-                                  reactf=movefh3(xpl,ypl,zpl,termflag,fh3prob);
-                                  break;
-                                case DIFFGYP:
+                  reactf=movefh3(xpl,ypl,zpl,termflag,fh3prob);
+                  break;
+                case DIFFGYP:
 					/* printf("Calling movegyp \n");
 					fflush(stdout); */
-                                        reactf=movegyp(xpl,ypl,zpl,termflag);
-                                       	break;
-                                case DIFFC3A:
+                        reactf=movegyp(xpl,ypl,zpl,termflag);
+                       	break;
+                case DIFFC3A:
 					/* printf("Calling movec3a \n");
 					fflush(stdout); */
-                                 reactf=movec3a(xpl,ypl,zpl,termflag,c3ah6prob);
-                                 break;
-                                case DIFFC4A:
+                 reactf=movec3a(xpl,ypl,zpl,termflag,c3ah6prob);
+                 break;
+                case DIFFC4A:
 					/* printf("Calling movec4a \n");
 					fflush(stdout); */
-                                 reactf=movec4a(xpl,ypl,zpl,termflag,c3ah6prob);
-                                 break;
-                                case DIFFETTR:
+                 reactf=movec4a(xpl,ypl,zpl,termflag,c3ah6prob);
+                 break;
+                case DIFFETTR:
 					/* printf("Calling moveettr \n");
 					fflush(stdout); */
-                                        reactf=moveettr(xpl,ypl,zpl,termflag);
-                                        break;
-                                case DIFFCACL2:
+                        reactf=moveettr(xpl,ypl,zpl,termflag);
+                        break;
+                case DIFFCACL2:
 					/* printf("Calling movecacl2 \n");
 					fflush(stdout); */
-                                        reactf=movecacl2(xpl,ypl,zpl,termflag);
-                                        break;
-                                case DIFFCAS2:
+                        reactf=movecacl2(xpl,ypl,zpl,termflag);
+                        break;
+                case DIFFCAS2:
 					/* printf("Calling movecas2 \n");
 					fflush(stdout); */
-                                        reactf=movecas2(xpl,ypl,zpl,termflag);
-                                        break;
-                                case DIFFAS:
+                        reactf=movecas2(xpl,ypl,zpl,termflag);
+                        break;
+                case DIFFAS:
 					/* printf("Calling moveas \n");
 					fflush(stdout); */
-                                        reactf=moveas(xpl,ypl,zpl,termflag);
-                                        break;
-                                case DIFFCACO3:
+                        reactf=moveas(xpl,ypl,zpl,termflag);
+                        break;
+                case DIFFCACO3:
 					/* printf("Calling movecaco3 \n");
 					fflush(stdout); */
-                                        reactf=movecaco3(xpl,ypl,zpl,termflag);
-                                        break;
-                                default:
-                                        printf("Error in ID of phase \n");
-                                        break;
-                        }
+                        reactf=movecaco3(xpl,ypl,zpl,termflag);
+                        break;
+                default:
+                        logmsg(LOGHYDRATE,LOGWARN,"Error in ID of phase \n");
+                        break;
+        }
+        /* Time, steps and reactions of this kind of species */
+        kind=phpl-DIFFCSH;
+        if((sim->profon)&&(kind>=0)&&(kind<NPROFSPEC)){
+                if(timed){simt->profspec[kind]+=PROFSAMPLE*(profclock()-tstep);}
+                simt->profmove[kind]+=1;
+                if(reactf==0){simt->profreact[kind]+=1;}
+        }
+        return(reactf);
+}
 
-                        /* if no reaction */
-                        if(reactf!=0){
-                                nleft+=1;
-                                xpnew=xpl;
-                                ypnew=ypl;
-                                zpnew=zpl;
+/* routine to return the packed location reached from locpl by a */
+/* diffusing species which did not react, with reactf as returned */
+/* by stepant */
+/* Called by hydrate and movedomain */
+/* Calls no other routines */
+unsigned int antstep(locpl,reactf)
+        unsigned int locpl;
+        int reactf;
+{
+        int xpnew,ypnew,zpnew;
 
-                                /* update location of diffusing species */
-                                switch (reactf) {
-                                        case 1:
-                                                xpnew-=1;
-                                                if(xpnew<0){xpnew=(SYSIZEM1);}
-                                                break;
-                                        case 2:
-                                                xpnew+=1;
-                                                if(xpnew>=SYSIZE){xpnew=0;}
-                                                break;
-                                        case 3:
-                                                ypnew-=1;
-                                                if(ypnew<0){ypnew=(SYSIZEM1);}
-                                                break;
-                                        case 4:
-                                                ypnew+=1;
-                                                if(ypnew>=SYSIZE){ypnew=0;}
-                                                break;
-                                        case 5:
-                                                zpnew-=1;
-                                                if(zpnew<0){zpnew=(SYSIZEM1);}
-                                                break;
-                                        case 6:
-                                                zpnew+=1;
-                                                if(zpnew>=SYSIZE){zpnew=0;}
-                                                break;
-                                        default:
-                                                break;
+        xpnew=ANTX(locpl);
+        ypnew=ANTY(locpl);
+        zpnew=ANTZ(locpl);
+
+        /* update location of diffusing species */
+        switch (reactf) {
+                case 1:
+                        xpnew-=1;
+                        if(xpnew<0){xpnew=(SYSIZEM1);}
+                        break;
+                case 2:
+                        xpnew+=1;
+                        if(xpnew>=SYSIZE){xpnew=0;}
+                        break;
+                case 3:
+                        ypnew-=1;
+                        if(ypnew<0){ypnew=(SYSIZEM1);}
+                        break;
+                case 4:
+                        ypnew+=1;
+                        if(ypnew>=SYSIZE){ypnew=0;}
+                        break;
+                case 5:
+                        zpnew-=1;
+                        if(zpnew<0){zpnew=(SYSIZEM1);}
+                        break;
+                case 6:
+                        zpnew+=1;
+                        if(zpnew>=SYSIZE){zpnew=0;}
+                        break;
+                default:
+                        break;
+        }
+        return(ANTLOC(xpnew,ypnew,zpnew));
+}
+
+/* routine to oversee hydration by updating position of all */
+/* remaining diffusing species */
+/* Calls ranready, ranahead, ranstream, stepant and antstep, or */
+/* pardiffuse in a parallel build */
+void hydrate(fincyc,stepmax,chpar1,chpar2,hgpar1,hgpar2,fhpar1,fhpar2,gypar1,gypar2)
+        int fincyc,stepmax;
+        float chpar1,chpar2,hgpar1,hgpar2,fhpar1,fhpar2,gypar1,gypar2;
+{
+        float chprob,c3ah6prob,fh3prob,gypprob;
+        long int nleft;
+        int istep,termflag;
+        float beterm;
+#ifndef PARALLEL
+        int xpl,ypl,zpl,phpl,agepl,reactf,nahead;
+        long int iant,jant;
+        long int aheadid[RANLANES];
+        unsigned int locpl,locnext;
+#endif
+
+        nleft=sim->nmade;
+        termflag=0;
+
+/* Perform diffusion until all reacted or max. # of diffusion steps reached */
+        for(istep=1;((istep<=stepmax)&&(nleft>0));istep++){
+                if((fincyc==1)&&(istep==stepmax)){termflag=1;} 
+
+                nleft=0;
+
+                /* determine probabilities for CH and C3AH6 nucleation */
+                /* scale factors are given for a 100^3 system */
+                beterm=exp(-(double)(simt->count[DIFFCH])/(chpar2*sim->sysvolfact));
+                chprob=chpar1*(1.-beterm);
+                beterm=exp(-(double)(simt->count[DIFFC3A])/(hgpar2*sim->sysvolfact));
+                c3ah6prob=hgpar1*(1.-beterm);
+                beterm=exp(-(double)(simt->count[DIFFFH3])/(fhpar2*sim->sysvolfact));
+                fh3prob=fhpar1*(1.-beterm);
+                beterm=exp(-(double)(simt->count[DIFFANH]+simt->count[DIFFHEM])/(gypar2*sim->sysvolfact));
+                gypprob=gypar1*(1.-beterm);
+
+#ifdef PARALLEL
+                nleft=pardiffuse(istep,termflag,chprob,c3ah6prob,fh3prob,gypprob);
+#else
+                /* Process each diffusing species in turn */
+                /* Survivors are compacted to the front of the pool in */
+                /* their original order, with nleft as the write index */
+                for(iant=0;iant<sim->nants;iant++){
+                        locpl=sim->antloc[iant];
+                        xpl=ANTX(locpl);
+                        ypl=ANTY(locpl);
+                        zpl=ANTZ(locpl);
+                        phpl=sim->antid[iant];
+			agepl=sim->antbirth[iant];
+
+                        /* Compute the first numbers of this and the */
+                        /* next few species' streams side by side */
+                        if(!ranready(RNGSTEP,istep,VOXEL(xpl,ypl,zpl))){
+                                nahead=0;
+                                for(jant=iant;(jant<sim->nants)&&(nahead<RANLANES);jant++){
+                                        locnext=sim->antloc[jant];
+                                        aheadid[nahead++]=VOXEL(ANTX(locnext),ANTY(locnext),ANTZ(locnext));
                                 }
+                                ranahead(RNGSTEP,istep,aheadid,nahead);
+                        }
+                        ranstream(RNGSTEP,istep,VOXEL(xpl,ypl,zpl));
+                        reactf=stepant(xpl,ypl,zpl,phpl,agepl,termflag,chprob,c3ah6prob,fh3prob,gypprob);
 
+                        /* if no reaction */
+                        if(reactf!=0){
                                 /* store new location of diffusing species */
-                                curant->x=xpnew;
-                                curant->y=ypnew;
-                                curant->z=zpnew;
-                                curant->id=phpl;
-                                curant=curant->nextant;
+                                sim->antloc[nleft]=antstep(locpl,reactf);
+                                sim->antid[nleft]=phpl;
+                                sim->antbirth[nleft]=agepl;
+                                nleft+=1;
                         } /* end of reactf!=0 loop */
-                        /* else remove ant from list */
+                        /* else drop species from pool */
                         else{
-                                if(ndale==1){
-                                        headant->nextant=curant->nextant;
-                                }
-                                else{
-                                     (curant->prevant)->nextant=curant->nextant;
-                                }
-                                if(curant->nextant!=NULL){
-                                     (curant->nextant)->prevant=curant->prevant;
-                                }
-                                else{
-                                        tailant=curant->prevant;
-                                }
-                                antgone=curant;
-                                curant=curant->nextant;
-                                free(antgone);
-                                ngoing-=1;
+                                sim->ngoing-=1;
                         }
-                } /* end of curant loop */
-                ntodo=nleft;
+                } /* end of iant loop */
+#endif
+                sim->nants=nleft;
         } /* end of istep loop */
+#ifdef PARALLEL
+        parmerge();
+#endif
+        ranstream(RNGCYCLE,3,0);
 }
@@ -0,0 +1,89 @@
+/************************************************************************/
+/*                                                                      */
+/*      Program imgconv.c to convert microstructure images between      */
+/*              the text form read and written by disrealnew and the    */
+/*              binary forms (see imgio.c)                              */
+/*      Usage: imgconv [-t|-b|-z] infile outfile                        */
+/*              Writes the image in infile to outfile as text (-t),     */
+/*              binary (-b) or compressed binary (-z); by default a     */
+/*              text image is written in binary, and a binary image     */
+/*              as text, one value per line                             */
+/*              Phase images are stored with one byte per pixel, and    */
+/*              images with values outside 0-255 (such as particle      */
+/*              IDs) with four bytes per pixel, uncompressed            */
+/*      Compile and link with the image routines of disrealnew, as      */
+/*              cc -O2 -o imgconv imgconv.c imgio.c imgzip.c -lm        */
+/*                                                                      */
+/************************************************************************/
+#include "cemhyd.h"
+
+int main(argc,argv)
+        int argc;
+        char *argv[];
+{
+        struct imgfile img;
+        FILE *outfile;
+        int nside,*val,bytes,form;
+        unsigned char *pix;
+        long int iv,npix;
+        char *inname,*outname;
+
+        form=(-1);
+        if((argc==4)&&(strcmp(argv[1],"-t")==0)){form=IMGTEXT;}
+        else if((argc==4)&&(strcmp(argv[1],"-b")==0)){form=IMGBINARY;}
+        else if((argc==4)&&(strcmp(argv[1],"-z")==0)){form=IMGCOMPRESSED;}
+        else if(argc!=3){
+                printf("Usage: imgconv [-t|-b|-z] infile outfile \n");
+                exit(1);
+        }
+        inname=argv[argc-2];
+        outname=argv[argc-1];
+        nside=imgopen(inname,&img);
+        if(nside==0){
+                printf("Unable to open image file %s \n",inname);
+                exit(1);
+        }
+        if(form<0){
+                form=(img.text==NULL)?IMGTEXT:IMGBINARY;
+        }
+        npix=(long int)nside*nside*nside;
+        val=(int *)malloc(npix*sizeof(int));
+        if(val==NULL){
+                printf("Unable to allocate memory for a %d^3 image \n",nside);
+                exit(1);
+        }
+        bytes=1;
+        for(iv=0;iv<npix;iv++){
+                val[iv]=imgnext(&img);
+                if((val[iv]<0)||(val[iv]>255)){bytes=4;}
+        }
+        imgclose(&img);
+
+        if(form==IMGTEXT){
+                outfile=fopen(outname,"w");
+                if(outfile==NULL){
+                        printf("Unable to write image file %s \n",outname);
+                        exit(1);
+                }
+                for(iv=0;iv<npix;iv++){
+                        fprintf(outfile,"%d\n",val[iv]);
+                }
+                fclose(outfile);
+                printf("Wrote %d^3 text image %s \n",nside,outname);
+        }
+        else if(bytes==1){
+                /* One byte per pixel, packed in place */
+                pix=(unsigned char *)val;
+                for(iv=0;iv<npix;iv++){
+                        pix[iv]=(unsigned char)val[iv];
+                }
+                imgwrite(outname,pix,1,nside,(form==IMGCOMPRESSED)?IMGZIP:IMGPLAIN);
+                printf("Wrote %d^3 %s image %s \n",nside,(form==IMGCOMPRESSED)?"compressed":"binary",outname);
+        }
+        else{
+                imgwrite(outname,val,4,nside,IMGPLAIN);
+                printf("Wrote %d^3 binary image %s with 4 bytes per pixel \n",nside,outname);
+        }
+        free(val);
+        return(0);
+}
@@ -0,0 +1,354 @@
+/* Routines to read and write microstructure images */
+/* A text image holds one pixel value per line, with z varying */
+/* fastest and x slowest, after an optional header (see imgsize) */
+/* A binary image holds a fixed header (struct imghead) followed by */
+/* the pixel values in the same order, one byte each for phase IDs or */
+/* four bytes each (in the byte order of the writing machine) for */
+/* larger values such as particle IDs */
+/* The pixel values of a phase image may instead be compressed (see */
+/* imgzip.c), to under a quarter of their size late in hydration and */
+/* about a twelfth for a starting image */
+/* Binary images are recognised by their first eight bytes, and are */
+/* mapped into memory rather than parsed (read whole if compiled with */
+/* -DNOMMAP) */
+/* Set the environment variable CEMHYD_IMAGE to binary or compressed */
+/* to write all microstructure images in that form, and */
+/* CEMHYD_SNAPSHOT to write the periodic .ima snapshots differently */
+/* from the final .img image */
+/* The program imgconv converts images between these forms */
+
+#include "cemhyd.h"
+
+/* routine to determine the system size from a microstructure image file */
+/* Images may begin with an optional header of the form */
+/*	Version: 3.0 */
+/*	X_Size: 100 */
+/*	Y_Size: 100 */
+/*	Z_Size: 100 */
+/*	Image_Resolution: 1.00 */
+/* Without a header, the size is taken as the cube root of the number */
+/* of pixel values in the file */
+/* On return the file is positioned at the first pixel value */
+/* Called by imgopen */
+/* Calls no other routines */
+int imgsize(infile)
+        FILE *infile;
+{
+        int xs,ys,zs,valin,nside;
+        long int nval,pos;
+        char key[80],val[80];
+
+        xs=ys=zs=0;
+        pos=ftell(infile);
+        /* Header entries are keywords terminated by a colon */
+        while((fscanf(infile,"%79s",key)==1)&&(key[strlen(key)-1]==':')){
+                if(fscanf(infile,"%79s",val)!=1){break;}
+                if(strcmp(key,"X_Size:")==0){xs=atoi(val);}
+                else if(strcmp(key,"Y_Size:")==0){ys=atoi(val);}
+                else if(strcmp(key,"Z_Size:")==0){zs=atoi(val);}
+                pos=ftell(infile);
+        }
+        fseek(infile,pos,SEEK_SET);
+        if((xs!=0)||(ys!=0)||(zs!=0)){
+                if((xs!=ys)||(xs!=zs)){
+                        printf("Only cubic systems are supported (image is %d x %d x %d) \n",xs,ys,zs);
+                        exit(1);
+                }
+                return(xs);
+        }
+
+        /* No header present, so count the pixel values */
+        nval=0;
+        while(fscanf(infile,"%d",&valin)==1){
+                nval+=1;
+        }
+        fseek(infile,pos,SEEK_SET);
+        nside=(int)(cbrt((double)nval)+0.5);
+        if(((long int)nside*nside*nside)!=nval){
+                printf("Number of pixels in image (%ld) is not a perfect cube \n",nval);
+                exit(1);
+        }
+        return(nside);
+}
+
+/* routine to return the form of image named by string form */
+/* Called by imginit */
+/* Calls no other routines */
+int imgform(form)
+        char *form;
+{
+        if(form!=NULL){
+                if(strcmp(form,"binary")==0){return(IMGBINARY);}
+                if(strcmp(form,"compressed")==0){return(IMGCOMPRESSED);}
+        }
+        return(IMGTEXT);
+}
+
+/* routine to select the forms of images written, as *out for the */
+/* final image and *snap for the periodic snapshots */
+/* Called by main program */
+/* Calls imgform */
+void imginit(out,snap)
+        int *out,*snap;
+{
+        char *envimg;
+
+        *out=(*snap)=imgform(getenv("CEMHYD_IMAGE"));
+        envimg=getenv("CEMHYD_SNAPSHOT");
+        if(envimg!=NULL){
+                *snap=imgform(envimg);
+        }
+}
+
+/* routine to return the FNV-1a hash of nbytes bytes at pix */
+/* Called by imgopen and imgwrite */
+/* Calls no other routines */
+unsigned int imgsum(pix,nbytes)
+        unsigned char *pix;
+        long int nbytes;
+{
+        unsigned int hash;
+        long int i;
+
+        hash=2166136261u;
+        for(i=0;i<nbytes;i++){
+                hash=(hash^pix[i])*16777619u;
+        }
+        return(hash);
+}
+
+/* routine to open image file name in either form for reading with */
+/* imgnext, returning the system size, or 0 if it cannot be opened */
+/* Called by main program and imgconv */
+/* Calls imgsize, unzipimage and imgsum */
+int imgopen(name,img)
+        char *name;
+        struct imgfile *img;
+{
+        FILE *infile;
+        char magic[8];
+        long int npix;
+#ifndef NOMMAP
+        int fd;
+        struct stat st;
+#endif
+
+        infile=fopen(name,"rb");
+        if(infile==NULL){return(0);}
+        img->next=0;
+        if((fread(magic,1,8,infile)!=8)||(memcmp(magic,IMGMAGIC,8)!=0)){
+                /* Text image */
+                rewind(infile);
+                img->text=infile;
+                img->base=img->pix=NULL;
+                return(imgsize(infile));
+        }
+        img->text=NULL;
+
+#ifndef NOMMAP
+        fclose(infile);
+        fd=open(name,O_RDONLY);
+        if((fd<0)||(fstat(fd,&st)!=0)){
+                printf("Unable to read binary image %s \n",name);
+                exit(1);
+        }
+        img->len=(long int)st.st_size;
+        img->base=(unsigned char *)mmap(NULL,(size_t)img->len,PROT_READ,MAP_PRIVATE,fd,0);
+        close(fd);
+        if(img->base==(unsigned char *)MAP_FAILED){
+                printf("Unable to map binary image %s \n",name);
+                exit(1);
+        }
+#else
+        fseek(infile,0,SEEK_END);
+        img->len=ftell(infile);
+        rewind(infile);
+        img->base=(unsigned char *)malloc(img->len);
+        if((img->base==NULL)||(fread(img->base,1,img->len,infile)!=(size_t)img->len)){
+                printf("Unable to read binary image %s \n",name);
+                exit(1);
+        }
+        fclose(infile);
+#endif
+
+        if(img->len<(long int)sizeof(struct imghead)){
+                printf("Binary image %s is truncated \n",name);
+                exit(1);
+        }
+        memcpy(&img->head,img->base,sizeof(struct imghead));
+        img->pix=img->base+sizeof(struct imghead);
+        if(img->head.version!=IMGVERSION){
+                printf("Binary image %s has unsupported version %d \n",name,img->head.version);
+                exit(1);
+        }
+        if((img->head.xsize!=img->head.ysize)||(img->head.xsize!=img->head.zsize)){
+                printf("Only cubic systems are supported (image is %d x %d x %d) \n",img->head.xsize,img->head.ysize,img->head.zsize);
+                exit(1);
+        }
+        npix=(long int)img->head.xsize*img->head.ysize*img->head.zsize;
+        if((img->head.coding!=IMGPLAIN)&&(img->head.coding!=IMGZIP)){
+                /* Including coding 1, the run coding of earlier versions */
+                printf("Binary image %s has unsupported coding %d \n",name,img->head.coding);
+                exit(1);
+        }
+        if(img->head.coding==IMGZIP){
+                if(img->head.bytes!=1){
+                        printf("Binary image %s is corrupt \n",name);
+                        exit(1);
+                }
+                img->pix=(unsigned char *)malloc(npix);
+                if(img->pix==NULL){
+                        printf("Unable to allocate memory for a %d^3 image \n",img->head.xsize);
+                        exit(1);
+                }
+                if(!unzipimage(img->base+sizeof(struct imghead),img->len-(long int)sizeof(struct imghead),img->head.xsize,img->pix)){
+                        printf("Binary image %s is corrupt \n",name);
+                        exit(1);
+                }
+        }
+        else if(((img->head.bytes!=1)&&(img->head.bytes!=4))||(img->len!=((long int)sizeof(struct imghead)+npix*img->head.bytes))){
+                printf("Binary image %s is not %d^3 pixels \n",name,img->head.xsize);
+                exit(1);
+        }
+        if(imgsum(img->pix,npix*img->head.bytes)!=img->head.checksum){
+                printf("Binary image %s fails its checksum \n",name);
+                exit(1);
+        }
+        return(img->head.xsize);
+}
+
+/* routine to return the next pixel value of an image opened by imgopen */
+/* Called by main program and imgconv */
+/* Calls no other routines */
+int imgnext(img)
+        struct imgfile *img;
+{
+        int valin;
+
+        if(img->text!=NULL){
+                fscanf(img->text,"%d",&valin);
+        }
+        else if(img->head.bytes==1){
+                valin=img->head.phasemap[img->pix[img->next]];
+        }
+        else{
+                memcpy(&valin,img->pix+4*img->next,4);
+        }
+        img->next+=1;
+        return(valin);
+}
+
+/* routine to set up the nside^3 pixel values of bytes bytes each at */
+/* pix, held in memory in the order of an image file, to be read with */
+/* imgnext as if from a binary image */
+/* Called by cemhydload */
+/* Calls no other routines */
+void imgmemory(pix,bytes,nside,img)
+        unsigned char *pix;
+        int bytes,nside;
+        struct imgfile *img;
+{
+        int i;
+
+        memset(img,0,sizeof(struct imgfile));
+        memcpy(img->head.magic,IMGMAGIC,8);
+        img->head.version=IMGVERSION;
+        img->head.xsize=img->head.ysize=img->head.zsize=nside;
+        img->head.bytes=bytes;
+        img->head.coding=IMGPLAIN;
+        for(i=0;i<256;i++){
+                img->head.phasemap[i]=(unsigned char)i;
+        }
+        img->text=NULL;
+        img->base=NULL;
+        img->pix=pix;
+}
+
+/* routine to close an image opened by imgopen or imgmemory */
+/* Called by main program and imgconv */
+/* Calls no other routines */
+void imgclose(img)
+        struct imgfile *img;
+{
+        if(img->text!=NULL){
+                fclose(img->text);
+        }
+        else if(img->base!=NULL){
+                if(img->head.coding==IMGZIP){free(img->pix);}
+#ifndef NOMMAP
+                munmap(img->base,(size_t)img->len);
+#else
+                free(img->base);
+#endif
+        }
+}
+
+/* routine to write nside^3 pixel values of bytes bytes each at pix */
+/* as binary image file name, compressed if coding is IMGZIP (for */
+/* one byte per pixel only) */
+/* Called by imgsave and imgconv */
+/* Calls imgsum and zipimage */
+void imgwrite(name,pix,bytes,nside,coding)
+        char *name;
+        void *pix;
+        int bytes,nside,coding;
+{
+        FILE *outfile;
+        struct imghead head;
+        unsigned char *data;
+        long int npix,nbytes;
+        int i;
+
+        memset(&head,0,sizeof(struct imghead));
+        memcpy(head.magic,IMGMAGIC,8);
+        head.version=IMGVERSION;
+        head.xsize=head.ysize=head.zsize=nside;
+        head.bytes=bytes;
+        head.coding=(bytes==1)?coding:IMGPLAIN;
+        npix=(long int)nside*nside*nside;
+        head.checksum=imgsum((unsigned char *)pix,npix*bytes);
+        for(i=0;i<256;i++){
+                head.phasemap[i]=i;
+        }
+        if(head.coding==IMGZIP){
+                data=zipimage((unsigned char *)pix,nside,&nbytes);
+        }
+        else{
+                data=(unsigned char *)pix;
+                nbytes=npix*bytes;
+        }
+        outfile=fopen(name,"wb");
+        if((outfile==NULL)||(fwrite(&head,sizeof(struct imghead),1,outfile)!=1)||(fwrite(data,1,nbytes,outfile)!=(size_t)nbytes)){
+                printf("Unable to write image file %s \n",name);
+                exit(1);
+        }
+        fclose(outfile);
+        if(head.coding==IMGZIP){free(data);}
+}
+
+/* routine to write the nside^3 phase IDs at pix as image file name, */
+/* in form IMGTEXT, IMGBINARY or IMGCOMPRESSED */
+/* Called by main program */
+/* Calls imgwrite */
+void imgsave(name,pix,nside,form)
+        char *name,*pix;
+        int nside,form;
+{
+        FILE *outfile;
+        long int iv,npix;
+
+        if(form!=IMGTEXT){
+                imgwrite(name,pix,1,nside,(form==IMGCOMPRESSED)?IMGZIP:IMGPLAIN);
+                return;
+        }
+        outfile=fopen(name,"w");
+        if(outfile==NULL){
+                printf("Unable to write image file %s \n",name);
+                exit(1);
+        }
+        npix=(long int)nside*nside*nside;
+        for(iv=0;iv<npix;iv++){
+                fprintf(outfile,"%d\n",(int)pix[iv]);
+        }
+        fclose(outfile);
+}
@@ -0,0 +1,345 @@
+/* Routines to compress and expand phase images of one byte per pixel */
+/* Each pixel is coded in turn, in the order of an image file, with an */
+/* adaptive binary range coder (as in LZMA), from the phases of its */
+/* three neighbours already coded, one pixel back along z, y and x: */
+/* the distinct phases among them are ranked by how many neighbours */
+/* have each, and the pixel is coded as a flag for each in turn, */
+/* whether it has that phase, modelled by the rank, the phase and the */
+/* votes for it and for the next; a pixel matching none of them has */
+/* its phase coded outright, modelled by the phase of the pixel before */
+/* it along z */
+/* Within a grain or the pore space all three agree, and a pixel */
+/* costs a small fraction of a bit */
+/* Nothing is stored besides the coded bits, since the models adapt */
+/* as the image is coded and expanded */
+
+#include "cemhyd.h"
+
+#define ZIPPROBBITS 11	/* precision of bit probabilities */
+#define ZIPMOVEBITS 5	/* rate of adaptation of bit probabilities */
+#define ZIPTOP (1u<<24)	/* range below which a byte is shifted out */
+#define ZIPPHASES 256	/* possible phases of a pixel */
+#define ZIPNEAR 3	/* neighbours voting for the phase of a pixel */
+
+/* state of the range coder and of the models of one image */
+struct zipcoder{
+        unsigned long long low;	/* low end of range (encoder) */
+        unsigned int range;
+        unsigned int code;	/* coded value within range (decoder) */
+        unsigned char cache;	/* byte held back for carries (encoder) */
+        long int ncache;	/* bytes held back (encoder) */
+        unsigned char *data;	/* coded bytes */
+        long int pos,len;	/* next byte, and bytes in data */
+        unsigned short *flag;	/* models of the flags of ranked phases */
+        unsigned short *phase;	/* ZIPPHASES trees of ZIPPHASES models */
+};
+
+/* routine to set up the models */
+/* Called by zipimage and unzipimage */
+/* Calls no other routines */
+void zipmodels(zc)
+        struct zipcoder *zc;
+{
+        long int i,nprob;
+
+        nprob=(long int)ZIPNEAR*ZIPPHASES*(ZIPNEAR+1)*(ZIPNEAR+1)+ZIPPHASES*ZIPPHASES;
+        zc->flag=(unsigned short *)malloc(nprob*sizeof(unsigned short));
+        if(zc->flag==NULL){
+                printf("Unable to allocate memory for image coding \n");
+                exit(1);
+        }
+        zc->phase=zc->flag+(long int)ZIPNEAR*ZIPPHASES*(ZIPNEAR+1)*(ZIPNEAR+1);
+        for(i=0;i<nprob;i++){
+                zc->flag[i]=(1<<ZIPPROBBITS)/2;
+        }
+}
+
+/* routine to rank the phases of the neighbours before pixel (x,y,z) */
+/* of the nside^3 phases at pix (the pixels one back along z, y and */
+/* x) by their votes, putting them in cand and their votes in vote, */
+/* most first, ties in that order, and return their number */
+/* Only pixels before it in the image are used, so that the expanded */
+/* image gives the same ranking */
+/* Called by zipimage and unzipimage */
+/* Calls no other routines */
+int zipcands(pix,nside,x,y,z,cand,vote)
+        unsigned char *pix;
+        int nside,x,y,z;
+        int cand[ZIPNEAR],vote[ZIPNEAR];
+{
+        unsigned char *at;
+        int near[ZIPNEAR];
+        int nnear,ncand,i,j,ph;
+
+        at=pix+((long int)x*nside+y)*nside+z;
+        nnear=0;
+        if(z>0){near[nnear++]=at[-1];}
+        if(y>0){near[nnear++]=at[-nside];}
+        if(x>0){near[nnear++]=at[-(long int)nside*nside];}
+        ncand=0;
+        for(i=0;i<nnear;i++){
+                for(j=0;(j<ncand)&&(cand[j]!=near[i]);j++);
+                if(j==ncand){
+                        cand[ncand]=near[i];
+                        vote[ncand]=0;
+                        ncand+=1;
+                }
+                vote[j]+=1;
+        }
+        /* Of three neighbours, only two agreeing after the first */
+        /* puts a later phase ahead */
+        if((ncand==2)&&(vote[1]>vote[0])){
+                ph=cand[0];
+                cand[0]=cand[1];
+                cand[1]=ph;
+                vote[0]=2;
+                vote[1]=1;
+        }
+        return(ncand);
+}
+
+/* routine to return the model of the flag for whether a pixel has */
+/* the phase ranked irank of the ncand in cand, with votes vote */
+/* Called by zipimage and unzipimage */
+/* Calls no other routines */
+unsigned short *zipflag(zc,irank,ncand,cand,vote)
+        struct zipcoder *zc;
+        int irank,ncand;
+        int cand[ZIPNEAR],vote[ZIPNEAR];
+{
+        int next;
+
+        next=((irank+1)<ncand)?vote[irank+1]:0;
+        return(&zc->flag[((irank*ZIPPHASES+cand[irank])*(ZIPNEAR+1)+vote[irank])*(ZIPNEAR+1)+next]);
+}
+
+/* routine to write out the top byte of low, holding back bytes of */
+/* 0xFF until it is known whether a carry will reach them */
+/* Called by zipbit and zipimage */
+/* Calls no other routines */
+void zipshift(zc)
+        struct zipcoder *zc;
+{
+        unsigned char carry;
+
+        if(((unsigned int)zc->low<0xFF000000u)||((zc->low>>32)!=0)){
+                carry=(unsigned char)(zc->low>>32);
+                do{
+                        if(zc->pos>=zc->len){
+                                zc->len*=2;
+                                zc->data=(unsigned char *)realloc(zc->data,zc->len);
+                                if(zc->data==NULL){
+                                        printf("Unable to allocate memory for image coding \n");
+                                        exit(1);
+                                }
+                        }
+                        zc->data[zc->pos]=zc->cache+carry;
+                        zc->pos+=1;
+                        zc->cache=0xFF;
+                        zc->ncache-=1;
+                } while(zc->ncache!=0);
+                zc->cache=(unsigned char)((unsigned int)zc->low>>24);
+        }
+        zc->ncache+=1;
+        zc->low=(zc->low&0x00FFFFFFu)<<8;
+}
+
+/* routine to code bit with probability model prob */
+/* Called by zipbits and zipimage */
+/* Calls zipshift */
+void zipbit(zc,prob,bit)
+        struct zipcoder *zc;
+        unsigned short *prob;
+        int bit;
+{
+        unsigned int bound;
+
+        bound=(zc->range>>ZIPPROBBITS)*(*prob);
+        if(bit==0){
+                zc->range=bound;
+                *prob+=((1<<ZIPPROBBITS)-(*prob))>>ZIPMOVEBITS;
+        }
+        else{
+                zc->low+=bound;
+                zc->range-=bound;
+                *prob-=(*prob)>>ZIPMOVEBITS;
+        }
+        if(zc->range<ZIPTOP){
+                zc->range<<=8;
+                zipshift(zc);
+        }
+}
+
+/* routine to code the nbits-bit value val, most significant bit */
+/* first, with the tree of models tree */
+/* Called by zipimage */
+/* Calls zipbit */
+void zipbits(zc,tree,nbits,val)
+        struct zipcoder *zc;
+        unsigned short *tree;
+        int nbits,val;
+{
+        int node,bit,i;
+
+        node=1;
+        for(i=nbits-1;i>=0;i--){
+                bit=(val>>i)&1;
+                zipbit(zc,&tree[node],bit);
+                node=(node<<1)|bit;
+        }
+}
+
+/* routine to decode a bit with probability model prob */
+/* Called by unzipbits and unzipimage */
+/* Calls no other routines */
+int unzipbit(zc,prob)
+        struct zipcoder *zc;
+        unsigned short *prob;
+{
+        unsigned int bound;
+        int bit;
+
+        bound=(zc->range>>ZIPPROBBITS)*(*prob);
+        if(zc->code<bound){
+                zc->range=bound;
+                *prob+=((1<<ZIPPROBBITS)-(*prob))>>ZIPMOVEBITS;
+                bit=0;
+        }
+        else{
+                zc->code-=bound;
+                zc->range-=bound;
+                *prob-=(*prob)>>ZIPMOVEBITS;
+                bit=1;
+        }
+        if(zc->range<ZIPTOP){
+                zc->range<<=8;
+                zc->code<<=8;
+                /* Reading past the end is detected by the caller */
+                if(zc->pos<zc->len){zc->code|=zc->data[zc->pos];}
+                zc->pos+=1;
+        }
+        return(bit);
+}
+
+/* routine to decode an nbits-bit value with the tree of models tree */
+/* Called by unzipimage */
+/* Calls unzipbit */
+int unzipbits(zc,tree,nbits)
+        struct zipcoder *zc;
+        unsigned short *tree;
+        int nbits;
+{
+        int node,i;
+
+        node=1;
+        for(i=0;i<nbits;i++){
+                node=(node<<1)|unzipbit(zc,&tree[node]);
+        }
+        return(node-(1<<nbits));
+}
+
+/* routine to compress the nside^3 phases at pix, returning the */
+/* compressed form in a new buffer and its length in *nbytes */
+/* Called by imgwrite and movwrite */
+/* Calls zipmodels, zipcands, zipflag, zipbit, zipbits and zipshift */
+unsigned char *zipimage(pix,nside,nbytes)
+        unsigned char *pix;
+        int nside;
+        long int *nbytes;
+{
+        struct zipcoder zc;
+        long int iv;
+        int cand[ZIPNEAR],vote[ZIPNEAR];
+        int x,y,z,ph,ncand,irank,hit,i;
+
+        zipmodels(&zc);
+        zc.low=0;
+        zc.range=0xFFFFFFFFu;
+        zc.cache=0;
+        zc.ncache=1;
+        zc.pos=0;
+        zc.len=(long int)nside*nside+1024;
+        zc.data=(unsigned char *)malloc(zc.len);
+        if(zc.data==NULL){
+                printf("Unable to allocate memory for image coding \n");
+                exit(1);
+        }
+
+        iv=0;
+        for(x=0;x<nside;x++){
+                for(y=0;y<nside;y++){
+                        for(z=0;z<nside;z++){
+                                ph=pix[iv];
+                                ncand=zipcands(pix,nside,x,y,z,cand,vote);
+                                hit=0;
+                                for(irank=0;(irank<ncand)&&(!hit);irank++){
+                                        hit=(ph==cand[irank]);
+                                        zipbit(&zc,zipflag(&zc,irank,ncand,cand,vote),hit);
+                                }
+                                if(!hit){
+                                        zipbits(&zc,&zc.phase[((z>0)?pix[iv-1]:0)*ZIPPHASES],8,ph);
+                                }
+                                iv+=1;
+                        }
+                }
+        }
+        for(i=0;i<5;i++){
+                zipshift(&zc);
+        }
+        free(zc.flag);
+        *nbytes=zc.pos;
+        return(zc.data);
+}
+
+/* routine to expand the nbytes of compressed form at data into the */
+/* nside^3 phases at pix, returning 0 if the data are not valid */
+/* Called by imgopen and movapply */
+/* Calls zipmodels, zipcands, zipflag, unzipbit and unzipbits */
+int unzipimage(data,nbytes,nside,pix)
+        unsigned char *data,*pix;
+        long int nbytes;
+        int nside;
+{
+        struct zipcoder zc;
+        long int iv;
+        int cand[ZIPNEAR],vote[ZIPNEAR];
+        int x,y,z,ncand,irank,hit,i;
+
+        if(nbytes<5){return(0);}
+        zipmodels(&zc);
+        zc.range=0xFFFFFFFFu;
+        zc.code=0;
+        zc.data=data;
+        zc.len=nbytes;
+        for(i=0;i<5;i++){
+                zc.code=(zc.code<<8)|data[i];
+        }
+        zc.pos=5;
+
+        iv=0;
+        for(x=0;x<nside;x++){
+                for(y=0;y<nside;y++){
+                        for(z=0;z<nside;z++){
+                                ncand=zipcands(pix,nside,x,y,z,cand,vote);
+                                hit=0;
+                                for(irank=0;(irank<ncand)&&(!hit);irank++){
+                                        hit=unzipbit(&zc,zipflag(&zc,irank,ncand,cand,vote));
+                                }
+                                if(hit){
+                                        pix[iv]=(unsigned char)cand[irank-1];
+                                }
+                                else{
+                                        pix[iv]=(unsigned char)unzipbits(&zc,&zc.phase[((z>0)?pix[iv-1]:0)*ZIPPHASES],8);
+                                }
+                                iv+=1;
+                        }
+                }
+                /* Reading past the end is only checked once a plane */
+                if(zc.pos>(zc.len+4)){
+                        free(zc.flag);
+                        return(0);
+                }
+        }
+        free(zc.flag);
+        return(1);
+}
@@ -0,0 +1,40 @@
+/* Routine to allocate the microstructure lattice at run time, once */
+/* the system size is known from the input image (see imgio.c) */
+/* Systems must be cubic, with at most MAXSYSIZE pixels per side */
+
+#include "cemhyd.h"
+
+/* routine to allocate all lattice arrays for a system of nside^3 pixels */
+/* and to set the system size parameters */
+/* Called by main program */
+/* Calls logmsg */
+void alloclattice(nside)
+        int nside;
+{
+        long int nvox;
+
+        if((nside<3)||(nside>MAXSYSIZE)){
+                logmsg(LOGSETUP,LOGERROR,"System size of %d is outside the allowed range (3-%d) \n",nside,MAXSYSIZE);
+                exit(1);
+        }
+#ifdef FIXEDSIZE
+        if(nside!=FIXEDSIZE){
+                logmsg(LOGSETUP,LOGERROR,"System size of %d does not match compiled size of %d \n",nside,FIXEDSIZE);
+                exit(1);
+        }
+#endif
+        sim->syssize=nside;
+        sim->syssizem1=nside-1;
+        sim->sysvolfact=(float)((double)nside*(double)nside*(double)nside/1000000.);
+
+        nvox=(long int)nside*nside*nside;
+        sim->mic=(char *)malloc(nvox*sizeof(char));
+        sim->micorig=(char *)malloc(nvox*sizeof(char));
+        sim->micpart=(int *)malloc(nvox*sizeof(int));
+        sim->cshage=(short int *)calloc(nvox,sizeof(short int));
+        sim->faces=(short int *)calloc(nvox,sizeof(short int));
+        if((sim->mic==NULL)||(sim->micorig==NULL)||(sim->micpart==NULL)||(sim->cshage==NULL)||(sim->faces==NULL)){
+                logmsg(LOGSETUP,LOGERROR,"Unable to allocate memory for a %d^3 system \n",nside);
+                exit(1);
+        }
+}
@@ -0,0 +1,224 @@
+/* Routines to write the messages of a run by level and subsystem */
+/* Each message has a level (LOGERROR, LOGWARN, LOGINFO or LOGDEBUG) */
+/* and belongs to a subsystem (LOGSETUP, LOGCYCLE, ...); it is printed */
+/* if its level is no higher than that of its subsystem, and is */
+/* otherwise kept in a ring of the last messages held back, which is */
+/* printed before the first error, so that a quiet run still shows */
+/* what led up to it (but not before an error in a parameter, which */
+/* the prompts held back would not explain) */
+/* The levels are set by the environment variable CEMHYD_LOG, a */
+/* level for every subsystem followed by levels for some of them, */
+/* for example */
+/*	CEMHYD_LOG=warn,cycle=info,ph=debug */
+/* with the levels error, warn, info and debug, and the subsystems */
+/* setup, cycle, dissolve, hydrate, ph, perc, output, ensemble and */
+/* prof */
+/* Without CEMHYD_LOG, a run whose parameters are typed in at a */
+/* terminal prints every message, as in earlier versions, and any */
+/* other run (input redirected, a configuration file or the library) */
+/* only warnings and errors; info gives the set up and a few lines a */
+/* cycle */
+/* The ring holds CEMHYD_LOGRING bytes (default 64 kB), or none if 0 */
+/* Messages go to the standard output, or to the file of the */
+/* simulation if it has one (as each member of an ensemble does) */
+
+#include "cemhyd.h"
+
+#define LOGLINE 1024	/* longest message kept in the ring */
+#define LOGRING (1L<<16)	/* default size of ring */
+#define LOGOUT ((sim->logfile!=NULL)?sim->logfile:stdout)	/* where printed */
+
+static char *loglevels[4]={"error","warn","info","debug"};
+static char *logsubs[NLOGSUB]={"setup","cycle","dissolve","hydrate","ph",
+        "perc","output","ensemble","prof"};
+
+/* routine to return the level named name, or -1 if there is none */
+/* Called by loginit */
+/* Calls no other routines */
+int loglevel(name)
+        char *name;
+{
+        int level;
+
+        for(level=LOGERROR;level<=LOGDEBUG;level++){
+                if(strcmp(name,loglevels[level])==0){return(level);}
+        }
+        return(-1);
+}
+
+/* routine to set the levels of the subsystems from spec (in the form */
+/* of CEMHYD_LOG), or to deflevel if spec is NULL, and allocate the */
+/* ring, returning 0, or -1 if spec is not understood */
+/* Called by main program, cemhydnew and cemhydlog */
+/* Calls loglevel */
+int loginit(spec,deflevel)
+        char *spec;
+        int deflevel;
+{
+        char copy[256],*item,*eq,*envring;
+        int isub,level;
+
+        for(isub=0;isub<NLOGSUB;isub++){
+                sim->loglevel[isub]=deflevel;
+        }
+        if(spec!=NULL){
+                if(strlen(spec)>=sizeof(copy)){return(-1);}
+                strcpy(copy,spec);
+                for(item=strtok(copy,", ");item!=NULL;item=strtok(NULL,", ")){
+                        eq=strchr(item,'=');
+                        if(eq==NULL){
+                                level=loglevel(item);
+                                if(level<0){return(-1);}
+                                for(isub=0;isub<NLOGSUB;isub++){
+                                        sim->loglevel[isub]=level;
+                                }
+                                continue;
+                        }
+                        *eq='\0';
+                        level=loglevel(eq+1);
+                        for(isub=0;isub<NLOGSUB;isub++){
+                                if(strcmp(item,logsubs[isub])==0){break;}
+                        }
+                        if((level<0)||(isub==NLOGSUB)){return(-1);}
+                        sim->loglevel[isub]=level;
+                }
+        }
+        if(sim->logring==NULL){
+                sim->logsize=LOGRING;
+                envring=getenv("CEMHYD_LOGRING");
+                if(envring!=NULL){
+                        sim->logsize=atol(envring);
+                        if(sim->logsize<0){sim->logsize=0;}
+                }
+                if(sim->logsize>0){
+                        sim->logring=(char *)malloc(sim->logsize);
+                        if(sim->logring==NULL){sim->logsize=0;}
+                }
+        }
+        return(0);
+}
+
+/* routine to add the len bytes of line to the ring, overwriting the */
+/* oldest if it is full */
+/* Called by logmsg */
+/* Calls no other routines */
+void logkeep(line,len)
+        char *line;
+        long int len;
+{
+        long int at,n;
+
+        if(len>sim->logsize){
+                line+=len-sim->logsize;
+                len=sim->logsize;
+        }
+        at=sim->loghead%sim->logsize;
+        n=sim->logsize-at;
+        if(n>len){n=len;}
+        memcpy(sim->logring+at,line,n);
+        memcpy(sim->logring,line+n,len-n);
+        sim->loghead+=len;
+}
+
+/* routine to print the messages held in the ring, oldest first, and */
+/* empty it */
+/* Called by logmsg */
+/* Calls no other routines */
+void logdump()
+{
+        long int first,at,n;
+
+        if(sim->loghead==0){return;}
+        fprintf(LOGOUT,"Last messages held back before the error: \n");
+        first=0;
+        if(sim->loghead>sim->logsize){
+                first=sim->loghead-sim->logsize;
+                /* Start at a whole line */
+                while((first<sim->loghead)&&(sim->logring[first%sim->logsize]!='\n')){
+                        first+=1;
+                }
+                first+=1;
+        }
+        at=first%sim->logsize;
+        n=sim->loghead-first;
+        if(n>(sim->logsize-at)){
+                fwrite(sim->logring+at,1,sim->logsize-at,LOGOUT);
+                n-=sim->logsize-at;
+                at=0;
+        }
+        if(n>0){fwrite(sim->logring+at,1,n,LOGOUT);}
+        if(sim->logring[(sim->loghead-1)%sim->logsize]!='\n'){fprintf(LOGOUT,"\n");}
+        fprintf(LOGOUT,"End of messages held back \n");
+        sim->loghead=0;
+}
+
+/* routine to empty the ring without printing it, before an error */
+/* that the messages held back would not help to explain */
+/* Called by cfgvalid, cfgvalue and namefile */
+/* Calls no other routines */
+void logdrop()
+{
+        if(sim!=NULL){sim->loghead=0;}
+}
+
+/* routine to write message format (as for printf) of level level in */
+/* subsystem sub, or keep it in the ring if its level is too high, */
+/* printing the ring first if it is an error */
+/* Messages from outside a simulation are always printed */
+/* Called by all routines */
+/* Calls logkeep and logdump */
+void logmsg(int sub,int level,char *format,...)
+{
+        char line[LOGLINE];
+        va_list args;
+        int len;
+
+        if(sim==NULL){
+                va_start(args,format);
+                vprintf(format,args);
+                va_end(args);
+                return;
+        }
+        if(level<=sim->loglevel[sub]){
+#ifdef PARALLEL
+                pthread_mutex_lock(&sim->logmutex);
+#endif
+                if((level==LOGERROR)&&(sim->logsize>0)){logdump();}
+                va_start(args,format);
+                vfprintf(LOGOUT,format,args);
+                va_end(args);
+                sim->logdirty=1;
+#ifdef PARALLEL
+                pthread_mutex_unlock(&sim->logmutex);
+#endif
+                return;
+        }
+        if(sim->logsize==0){return;}
+        va_start(args,format);
+        len=vsnprintf(line,LOGLINE,format,args);
+        va_end(args);
+        if(len>=LOGLINE){len=LOGLINE-1;}
+        if(len<=0){return;}
+#ifdef PARALLEL
+        pthread_mutex_lock(&sim->logmutex);
+#endif
+        logkeep(line,(long int)len);
+#ifdef PARALLEL
+        pthread_mutex_unlock(&sim->logmutex);
+#endif
+}
+
+/* routine to flush the output of messages, if anything has been */
+/* printed to it since it was last flushed */
+/* Called by all routines */
+/* Calls no other routines */
+void logflush()
+{
+        if(sim==NULL){
+                fflush(stdout);
+        }
+        else if(sim->logdirty){
+                fflush(LOGOUT);
+                sim->logdirty=0;
+        }
+}
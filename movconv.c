@@ -0,0 +1,118 @@
+/************************************************************************/
+/*                                                                      */
+/*      Program movconv.c to read hydration movies written as logs of   */
+/*              changes by disrealnew (see movie.c)                     */
+/*      Usage: movconv movie                                            */
+/*              Lists the planes followed and the frames of the movie   */
+/*      Usage: movconv movie cycle outfile                              */
+/*              Writes the pixels followed as of the last frame taken   */
+/*              at or before cycle to outfile as text, one value per    */
+/*              line, plane after plane (or as a text image for a       */
+/*              movie of the whole lattice)                             */
+/*      Usage: movconv -t movie outfile                                 */
+/*              Writes every frame in turn to outfile as text, in the   */
+/*              form of the text movies of earlier versions             */
+/*      Compile and link with the image and movie routines of           */
+/*              disrealnew, as                                          */
+/*              cc -O2 -o movconv movconv.c movie.c imgio.c imgzip.c \  */
+/*                      -lm                                             */
+/*                                                                      */
+/************************************************************************/
+#include "cemhyd.h"
+
+/* routine to write the pixels of the frame held by movie mv as text */
+/* to outfile */
+/* Called by main program */
+/* Calls no other routines */
+void movtext(mv,outfile)
+        struct movie *mv;
+        FILE *outfile;
+{
+        long int iv;
+
+        for(iv=0;iv<mv->npix;iv++){
+                fprintf(outfile,"%d\n",(int)mv->last[iv]);
+        }
+}
+
+int main(argc,argv)
+        int argc;
+        char *argv[];
+{
+        struct movie mv;
+        FILE *outfile;
+        int nframe,iframe,ip,cycle;
+        long int nbytes;
+        char *name;
+
+        if((argc==4)&&(strcmp(argv[1],"-t")==0)){name=argv[2];}
+        else if((argc==2)||(argc==4)){name=argv[1];}
+        else{
+                printf("Usage: movconv movie [cycle outfile] \n");
+                printf("       movconv -t movie outfile \n");
+                exit(1);
+        }
+        nframe=movopen(name,&mv);
+        if(nframe<0){
+                printf("Unable to open movie file %s \n",name);
+                exit(1);
+        }
+
+        if(argc==2){
+                printf("Movie of %d^3 system with keyframe every %d frames, following",mv.head.nside,mv.head.keyevery);
+                if(mv.head.axis[0]==MOVFULL){
+                        printf(" the whole lattice \n");
+                }
+                else{
+                        for(ip=0;ip<mv.head.nplane;ip++){
+                                printf(" %c=%d",'x'+mv.head.axis[ip],mv.head.pos[ip]);
+                        }
+                        printf(" \n");
+                }
+                printf("Frame Cycle Kind Bytes \n");
+                for(iframe=0;iframe<nframe;iframe++){
+                        nbytes=mv.offset[iframe+1]-mv.offset[iframe]-(long int)sizeof(struct movframe);
+                        printf("%d %d %s %ld \n",iframe,mv.cycle[iframe],(mv.kind[iframe]==MOVDELTA)?"delta":"key",nbytes);
+                }
+                movclose(&mv);
+                return(0);
+        }
+
+        if(strcmp(argv[1],"-t")!=0){
+                cycle=atoi(argv[2]);
+                iframe=movseek(&mv,cycle);
+                if(iframe<0){
+                        printf("Movie %s has no frame at or before cycle %d \n",name,cycle);
+                        exit(1);
+                }
+                if(mv.head.axis[0]==MOVFULL){
+                        imgsave(argv[3],(char *)mv.last,mv.head.nside,IMGTEXT);
+                }
+                else{
+                        outfile=fopen(argv[3],"w");
+                        if(outfile==NULL){
+                                printf("Unable to write file %s \n",argv[3]);
+                                exit(1);
+                        }
+                        movtext(&mv,outfile);
+                        fclose(outfile);
+                }
+                printf("Wrote frame %d (cycle %d) to %s \n",iframe,mv.cycle[iframe],argv[3]);
+                movclose(&mv);
+                return(0);
+        }
+
+        outfile=fopen(argv[3],"w");
+        if(outfile==NULL){
+                printf("Unable to write file %s \n",argv[3]);
+                exit(1);
+        }
+        for(iframe=0;iframe<nframe;iframe++){
+                movseek(&mv,mv.cycle[iframe]);
+                movtext(&mv,outfile);
+        }
+        fclose(outfile);
+        printf("Wrote %d frames to %s \n",nframe,argv[3]);
+        movclose(&mv);
+        return(0);
+}
@@ -0,0 +1,426 @@
+/* Routines to write and read hydration movies as a log of changes */
+/* A movie follows a set of planes of the lattice (or the whole */
+/* lattice) over the cycles of hydration: each frame is either a */
+/* keyframe holding every pixel followed, or a delta holding only the */
+/* pixels that changed since the previous frame, so that frames may */
+/* be taken every cycle at little cost in space */
+/* The file holds a fixed header (struct movhead) and then the */
+/* frames, each a struct movframe followed by its bytes; a keyframe */
+/* is written every keyevery frames (and whenever a delta would be */
+/* larger), so a frame is rebuilt from the keyframe before it and at */
+/* most keyevery-1 deltas */
+/* A delta is a sequence of (gap, phase) pairs, where the gap is the */
+/* number of unchanged pixels before the next changed one, written */
+/* 7 bits to the byte with the high bit set on all but the last */
+/* Keyframes of the whole lattice are compressed with zipimage */
+/* Set the environment variable CEMHYD_MOVIE to write the movie of */
+/* main in this form: full for the whole lattice, or a comma */
+/* separated list of planes such as x50,y0,z, each an axis and the */
+/* coordinate along it (the middle if omitted); without it, the plane */
+/* x=SYSIZE/2 is written as text, as in earlier versions */
+/* CEMHYD_MOVIEKEY sets the frames between keyframes (default 25) */
+/* The program movconv lists the frames of a movie and extracts the */
+/* pixels at any cycle */
+
+#include "cemhyd.h"
+
+/* routine to select the form of the movie of main, returning 1 (with */
+/* the planes to follow in *spec and the frames between keyframes in */
+/* *keyevery) if it is written by movwrite, or 0 if as text */
+/* Called by main program */
+/* Calls no other routines */
+int movinit(spec,keyevery)
+        char **spec;
+        int *keyevery;
+{
+        char *envkey;
+
+        *spec=getenv("CEMHYD_MOVIE");
+        *keyevery=MOVKEYEVERY;
+        if(*spec==NULL){return(0);}
+        envkey=getenv("CEMHYD_MOVIEKEY");
+        if(envkey!=NULL){
+                *keyevery=atoi(envkey);
+                if(*keyevery<1){*keyevery=1;}
+        }
+        return(1);
+}
+
+/* routine to allocate the buffers of movie mv for its header */
+/* Called by movcreate and movopen */
+/* Calls no other routines */
+void movalloc(mv)
+        struct movie *mv;
+{
+        long int nside;
+
+        nside=mv->head.nside;
+        if(mv->head.axis[0]==MOVFULL){
+                mv->npix=nside*nside*nside;
+        }
+        else{
+                mv->npix=(long int)mv->head.nplane*nside*nside;
+        }
+        mv->nbuf=mv->npix+1024;
+        mv->last=(unsigned char *)malloc(mv->npix);
+        mv->now=(unsigned char *)malloc(mv->npix);
+        mv->buf=(unsigned char *)malloc(mv->nbuf);
+        if((mv->last==NULL)||(mv->now==NULL)||(mv->buf==NULL)){
+                printf("Unable to allocate memory for movie \n");
+                exit(1);
+        }
+        mv->nframe=0;
+        mv->at=(-1);
+        mv->offset=NULL;
+        mv->cycle=mv->kind=NULL;
+}
+
+/* routine to create movie file name for a system of nside pixels a */
+/* side, following the planes given by spec (see above), with a */
+/* keyframe every keyevery frames */
+/* Called by main program */
+/* Calls movalloc */
+void movcreate(name,nside,spec,keyevery,mv)
+        char *name,*spec;
+        int nside,keyevery;
+        struct movie *mv;
+{
+        char *p;
+        int np;
+
+        memset(&mv->head,0,sizeof(struct movhead));
+        memcpy(mv->head.magic,MOVMAGIC,8);
+        mv->head.version=MOVVERSION;
+        mv->head.nside=nside;
+        mv->head.keyevery=keyevery;
+        np=0;
+        if(strcmp(spec,"full")==0){
+                mv->head.axis[0]=MOVFULL;
+                np=1;
+        }
+        else{
+                for(p=spec;*p!='\0';){
+                        if((np>=MOVMAXPLANE)||(*p<'x')||(*p>'z')){
+                                printf("Movie planes %s should be full or a list such as x50,y0,z \n",spec);
+                                exit(1);
+                        }
+                        mv->head.axis[np]=(*p)-'x';
+                        p+=1;
+                        mv->head.pos[np]=nside/2;
+                        if((*p>='0')&&(*p<='9')){
+                                mv->head.pos[np]=(int)strtol(p,&p,10);
+                        }
+                        if(mv->head.pos[np]>=nside){
+                                printf("Movie plane %c%d lies outside the system \n",'x'+mv->head.axis[np],mv->head.pos[np]);
+                                exit(1);
+                        }
+                        np+=1;
+                        if(*p==','){p+=1;}
+                }
+                if(np==0){
+                        printf("Movie planes %s should be full or a list such as x50,y0,z \n",spec);
+                        exit(1);
+                }
+        }
+        mv->head.nplane=np;
+        movalloc(mv);
+        mv->file=fopen(name,"wb");
+        if((mv->file==NULL)||(fwrite(&mv->head,sizeof(struct movhead),1,mv->file)!=1)){
+                printf("Unable to write movie file %s \n",name);
+                exit(1);
+        }
+}
+
+/* routine to copy the pixels of lattice lat followed by movie mv */
+/* into mv->now, planes in turn with the lower remaining axis slowest */
+/* Called by movwrite */
+/* Calls no other routines */
+void movgather(mv,lat)
+        struct movie *mv;
+        char *lat;
+{
+        long int nside,i,j,k;
+        int ip;
+        unsigned char *out;
+
+        nside=mv->head.nside;
+        if(mv->head.axis[0]==MOVFULL){
+                memcpy(mv->now,lat,mv->npix);
+                return;
+        }
+        out=mv->now;
+        for(ip=0;ip<mv->head.nplane;ip++){
+                k=mv->head.pos[ip];
+                for(i=0;i<nside;i++){
+                for(j=0;j<nside;j++){
+                        if(mv->head.axis[ip]==0){
+                                *out=lat[(k*nside+i)*nside+j];
+                        }
+                        else if(mv->head.axis[ip]==1){
+                                *out=lat[(i*nside+k)*nside+j];
+                        }
+                        else{
+                                *out=lat[(i*nside+j)*nside+k];
+                        }
+                        out+=1;
+                }
+                }
+        }
+}
+
+/* routine to append a frame of lattice lat at cycle cycle to movie mv */
+/* Called by main program */
+/* Calls movgather and zipimage */
+void movwrite(mv,lat,cycle)
+        struct movie *mv;
+        char *lat;
+        int cycle;
+{
+        struct movframe fr;
+        unsigned char *data,*swap;
+        long int iv,prev,gap;
+
+        movgather(mv,lat);
+        fr.cycle=cycle;
+        fr.kind=MOVKEY;
+        data=mv->now;
+        fr.nbytes=mv->npix;
+        if((mv->nframe%mv->head.keyevery)!=0){
+                /* Code the changes, giving up if they exceed a keyframe */
+                fr.nbytes=0;
+                prev=(-1);
+                for(iv=0;(iv<mv->npix)&&(fr.nbytes<mv->npix);iv++){
+                        if(mv->now[iv]!=mv->last[iv]){
+                                for(gap=iv-prev-1;gap>=128;gap>>=7){
+                                        mv->buf[fr.nbytes++]=(unsigned char)(128|(gap&127));
+                                }
+                                mv->buf[fr.nbytes++]=(unsigned char)gap;
+                                mv->buf[fr.nbytes++]=mv->now[iv];
+                                prev=iv;
+                        }
+                }
+                if(iv>=mv->npix){
+                        fr.kind=MOVDELTA;
+                        data=mv->buf;
+                }
+                else{
+                        fr.nbytes=mv->npix;
+                }
+        }
+        if((fr.kind==MOVKEY)&&(mv->head.axis[0]==MOVFULL)){
+                fr.kind=MOVKEYZIP;
+                iv=0;
+                data=zipimage(mv->now,mv->head.nside,&iv);
+                fr.nbytes=(int)iv;
+        }
+        if((fwrite(&fr,sizeof(struct movframe),1,mv->file)!=1)||(fwrite(data,1,fr.nbytes,mv->file)!=(size_t)fr.nbytes)){
+                printf("Unable to write movie frame at cycle %d \n",cycle);
+                exit(1);
+        }
+        fflush(mv->file);
+        if(fr.kind==MOVKEYZIP){free(data);}
+        swap=mv->last;
+        mv->last=mv->now;
+        mv->now=swap;
+        mv->nframe+=1;
+}
+
+/* routine to open movie file name for reading with movseek, */
+/* returning the number of frames, or -1 if it is not a movie */
+/* Called by movconv and movresume */
+/* Calls movalloc */
+int movopen(name,mv)
+        char *name;
+        struct movie *mv;
+{
+        struct movframe fr;
+        long int pos,len;
+        int nalloc;
+
+        mv->file=fopen(name,"rb");
+        if(mv->file==NULL){return(-1);}
+        if((fread(&mv->head,sizeof(struct movhead),1,mv->file)!=1)||(memcmp(mv->head.magic,MOVMAGIC,8)!=0)){
+                fclose(mv->file);
+                return(-1);
+        }
+        if((mv->head.version!=MOVVERSION)||(mv->head.nside<1)||(mv->head.nplane<1)||(mv->head.nplane>MOVMAXPLANE)||(mv->head.keyevery<1)){
+                printf("Movie %s has an unsupported header \n",name);
+                exit(1);
+        }
+        movalloc(mv);
+
+        /* Index the frames, stopping at the first incomplete one */
+        fseek(mv->file,0,SEEK_END);
+        len=ftell(mv->file);
+        fseek(mv->file,(long int)sizeof(struct movhead),SEEK_SET);
+        nalloc=0;
+        pos=sizeof(struct movhead);
+        while(fread(&fr,sizeof(struct movframe),1,mv->file)==1){
+                if((fr.nbytes<0)||((pos+(long int)sizeof(struct movframe)+fr.nbytes)>len)){
+                        break;
+                }
+                fseek(mv->file,fr.nbytes,SEEK_CUR);
+                if((mv->nframe+1)>=nalloc){
+                        nalloc=2*nalloc+64;
+                        mv->offset=(long int *)realloc(mv->offset,nalloc*sizeof(long int));
+                        mv->cycle=(int *)realloc(mv->cycle,nalloc*sizeof(int));
+                        mv->kind=(int *)realloc(mv->kind,nalloc*sizeof(int));
+                        if((mv->offset==NULL)||(mv->cycle==NULL)||(mv->kind==NULL)){
+                                printf("Unable to allocate memory for movie \n");
+                                exit(1);
+                        }
+                }
+                mv->offset[mv->nframe]=pos;
+                mv->cycle[mv->nframe]=fr.cycle;
+                mv->kind[mv->nframe]=fr.kind;
+                mv->nframe+=1;
+                pos=ftell(mv->file);
+                mv->offset[mv->nframe]=pos;
+        }
+        /* A partial last frame (from an interrupted run) is ignored */
+        if(len!=pos){
+                printf("Ignoring incomplete frame at end of movie %s \n",name);
+        }
+        return(mv->nframe);
+}
+
+/* routine to read frame iframe of movie mv and apply it to mv->last */
+/* Called by movseek */
+/* Calls unzipimage */
+void movapply(mv,iframe)
+        struct movie *mv;
+        int iframe;
+{
+        struct movframe fr;
+        long int iv,i,gap;
+        int shift,ok;
+
+        fseek(mv->file,mv->offset[iframe],SEEK_SET);
+        if(fread(&fr,sizeof(struct movframe),1,mv->file)!=1){
+                printf("Unable to read movie frame %d \n",iframe);
+                exit(1);
+        }
+        if(fr.nbytes>mv->nbuf){
+                mv->nbuf=fr.nbytes;
+                mv->buf=(unsigned char *)realloc(mv->buf,mv->nbuf);
+                if(mv->buf==NULL){
+                        printf("Unable to allocate memory for movie \n");
+                        exit(1);
+                }
+        }
+        if(fread(mv->buf,1,fr.nbytes,mv->file)!=(size_t)fr.nbytes){
+                printf("Unable to read movie frame %d \n",iframe);
+                exit(1);
+        }
+        ok=1;
+        if(fr.kind==MOVKEY){
+                ok=(fr.nbytes==mv->npix);
+                if(ok){memcpy(mv->last,mv->buf,mv->npix);}
+        }
+        else if(fr.kind==MOVKEYZIP){
+                ok=(mv->head.axis[0]==MOVFULL)&&unzipimage(mv->buf,(long int)fr.nbytes,mv->head.nside,mv->last);
+        }
+        else if(fr.kind==MOVDELTA){
+                iv=(-1);
+                for(i=0;(i<fr.nbytes)&&(ok);){
+                        gap=0;
+                        for(shift=0;(i<fr.nbytes)&&(mv->buf[i]&128);shift+=7){
+                                gap|=(long int)(mv->buf[i]&127)<<shift;
+                                i+=1;
+                        }
+                        if(i>=(fr.nbytes-1)){
+                                ok=0;
+                                break;
+                        }
+                        gap|=(long int)mv->buf[i]<<shift;
+                        iv+=gap+1;
+                        if(iv>=mv->npix){
+                                ok=0;
+                        }
+                        else{
+                                mv->last[iv]=mv->buf[i+1];
+                        }
+                        i+=2;
+                }
+        }
+        else{
+                ok=0;
+        }
+        if(!ok){
+                printf("Movie frame %d at cycle %d is corrupt \n",iframe,fr.cycle);
+                exit(1);
+        }
+        mv->at=iframe;
+}
+
+/* routine to rebuild in mv->last the pixels of the last frame of */
+/* movie mv taken at or before cycle, returning the index of the */
+/* frame, or -1 if there is none */
+/* Called by movconv and movresume */
+/* Calls movapply */
+int movseek(mv,cycle)
+        struct movie *mv;
+        int cycle;
+{
+        int target,first,i;
+
+        for(target=(-1);((target+1)<mv->nframe)&&(mv->cycle[target+1]<=cycle);target++);
+        if(target<0){return(-1);}
+        for(first=target;(first>0)&&(mv->kind[first]==MOVDELTA);first--);
+        if(mv->kind[first]==MOVDELTA){
+                printf("Movie has no keyframe before cycle %d \n",mv->cycle[first]);
+                exit(1);
+        }
+        if((mv->at>=first)&&(mv->at<=target)){
+                /* Carry on from the frame already rebuilt */
+                first=mv->at+1;
+        }
+        for(i=first;i<=target;i++){
+                movapply(mv,i);
+        }
+        return(target);
+}
+
+/* routine to reopen movie file name, as cut back to its length at a */
+/* checkpoint, to append frames to it as movie mv */
+/* Called by ckload */
+/* Calls movopen and movseek */
+void movresume(name,mv)
+        char *name;
+        struct movie *mv;
+{
+        if(movopen(name,mv)<1){
+                printf("Unable to resume movie %s \n",name);
+                exit(1);
+        }
+        /* Rebuild the last frame, from which the next delta is found */
+        movseek(mv,mv->cycle[mv->nframe-1]);
+        fclose(mv->file);
+        free(mv->offset);
+        free(mv->cycle);
+        free(mv->kind);
+        mv->offset=NULL;
+        mv->file=fopen(name,"ab");
+        if(mv->file==NULL){
+                printf("Unable to write movie file %s \n",name);
+                exit(1);
+        }
+}
+
+/* routine to close movie mv */
+/* Called by main program and movconv */
+/* Calls no other routines */
+void movclose(mv)
+        struct movie *mv;
+{
+        fclose(mv->file);
+        mv->file=NULL;
+        free(mv->last);
+        free(mv->now);
+        free(mv->buf);
+        if(mv->offset!=NULL){
+                free(mv->offset);
+                free(mv->cycle);
+                free(mv->kind);
+        }
+}
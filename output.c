@@ -0,0 +1,435 @@
+/* Routines to write the per-cycle output files (.heat, .chs, .pha, */
+/* .phv, .adi, .pps, .pts, .phr) and the microstructure snapshots */
+/* Each file is opened once, at its first use, and kept open (with */
+/* its buffer flushed once a cycle by outflush) until outclose, rather */
+/* than being opened and closed for every line */
+/* If compiled with -DPARALLEL and the environment variable */
+/* CEMHYD_OUTPUT is set to async, the writing is instead done by a */
+/* background thread: the simulation formats each line into a ring */
+/* buffer and goes on, and the thread takes the lines from the ring */
+/* and writes them, together with the snapshots handed to it by */
+/* outsnapshot, so that the cycles do not wait on the file system */
+/* The ring has a single writer (the main thread) and a single reader */
+/* (the output thread), each of which owns its own position in it, so */
+/* no lock is taken to pass a line; the main thread waits only if the */
+/* ring (CEMHYD_OUTBUF bytes, default 4 MB) is full, or if both */
+/* snapshot buffers are still being written */
+/* The files are closed (and the ring emptied) at exit, or when a */
+/* simulation run through the library is freed (see cemhydlib.c) */
+/* Each simulation (see cemhyd.h) has its own files, ring and thread, */
+/* and each member of an ensemble (see ensemble.c) starts its own */
+/* On a restart (see checkpoint.c), output is held back until the */
+/* files have been cut back to their lengths at the checkpoint */
+
+#include "cemhyd.h"
+
+#define OUTLINE 4096	/* longest line written at once */
+#define OUTRING (1L<<22)	/* default size of ring */
+
+#define OUTTEXT 0	/* bytes to append to a file */
+#define OUTCREATE 1	/* start a file afresh */
+#define OUTFLUSH 2	/* flush all files */
+#define OUTIMAGE 3	/* write a snapshot */
+#define OUTWRAP 4	/* rest of ring is unused */
+#define OUTSTOP 5	/* close all files and finish */
+
+/* header of each record in the ring, followed by len bytes */
+struct outrec{
+        int kind;	/* OUTTEXT, ... */
+        int ifile;	/* file, for OUTTEXT and OUTCREATE */
+        long int len;	/* bytes following the header */
+};
+
+/* snapshot handed to the output thread */
+struct outimg{
+        char name[256];
+        char *pix;
+        int nside,form,ibuf;
+};
+
+
+/* routine to return the file for output file ifile, opening it for */
+/* appending if it is not open */
+/* Called by outwrite */
+/* Calls logmsg */
+FILE *outopen(ifile)
+        int ifile;
+{
+        if(sim->outfp[ifile]==NULL){
+                sim->outfp[ifile]=fopen(sim->outname[ifile],"a");
+                if(sim->outfp[ifile]==NULL){
+                        logmsg(LOGOUTPUT,LOGERROR,"Unable to write output file %s \n",sim->outname[ifile]);
+                        exit(1);
+                }
+        }
+        return(sim->outfp[ifile]);
+}
+
+/* routine to carry out a record of kind kind for file ifile, with */
+/* data of len bytes */
+/* Called by outrecord and outworker */
+/* Calls outopen, imgsave and logmsg */
+void outwrite(kind,ifile,data,len)
+        int kind,ifile;
+        char *data;
+        long int len;
+{
+        int i;
+        struct outimg *img;
+
+        if(kind==OUTTEXT){
+                fwrite(data,1,len,outopen(ifile));
+        }
+        else if(kind==OUTCREATE){
+                if(sim->outfp[ifile]!=NULL){fclose(sim->outfp[ifile]);}
+                sim->outfp[ifile]=fopen(sim->outname[ifile],"w");
+                if(sim->outfp[ifile]==NULL){
+                        logmsg(LOGOUTPUT,LOGERROR,"Unable to write output file %s \n",sim->outname[ifile]);
+                        exit(1);
+                }
+        }
+        else if((kind==OUTFLUSH)||(kind==OUTSTOP)){
+                for(i=0;i<sim->noutfile;i++){
+                        if(sim->outfp[i]!=NULL){
+                                if(kind==OUTSTOP){
+                                        fclose(sim->outfp[i]);
+                                        sim->outfp[i]=NULL;
+                                }
+                                else{
+                                        fflush(sim->outfp[i]);
+                                }
+                        }
+                }
+        }
+        else if(kind==OUTIMAGE){
+                img=(struct outimg *)data;
+                imgsave(img->name,img->pix,img->nside,img->form);
+#ifdef PARALLEL
+                __atomic_store_n(&sim->outbusy[img->ibuf],0,__ATOMIC_RELEASE);
+#endif
+        }
+}
+
+#ifdef PARALLEL
+/* routine run by the output thread, carrying out the records put in */
+/* the ring until OUTSTOP */
+/* Called by outinit */
+/* Calls outwrite */
+void *outworker(arg)
+        void *arg;
+{
+        long int pos,head;
+        struct outrec *rec;
+        int kind;
+
+        sim=(struct sim *)arg;	/* simulation whose files are written */
+        for(;;){
+                head=__atomic_load_n(&sim->outhead,__ATOMIC_ACQUIRE);
+                if(head==sim->outtail){
+                        /* Sleep until the main thread puts a record */
+                        pthread_mutex_lock(&sim->outmutex);
+                        __atomic_store_n(&sim->outidle,1,__ATOMIC_SEQ_CST);
+                        while(__atomic_load_n(&sim->outhead,__ATOMIC_SEQ_CST)==sim->outtail){
+                                pthread_cond_wait(&sim->outwake,&sim->outmutex);
+                        }
+                        __atomic_store_n(&sim->outidle,0,__ATOMIC_SEQ_CST);
+                        pthread_mutex_unlock(&sim->outmutex);
+                        continue;
+                }
+                pos=sim->outtail%sim->outsize;
+                rec=(struct outrec *)&sim->outring[pos];
+                if(((sim->outsize-pos)<(long int)sizeof(struct outrec))||(rec->kind==OUTWRAP)){
+                        __atomic_store_n(&sim->outtail,sim->outtail+(sim->outsize-pos),__ATOMIC_RELEASE);
+                        continue;
+                }
+                kind=rec->kind;
+                outwrite(kind,rec->ifile,(char *)(rec+1),rec->len);
+                __atomic_store_n(&sim->outtail,sim->outtail+(long int)sizeof(struct outrec)+((rec->len+7)&(~7L)),__ATOMIC_RELEASE);
+                if(kind==OUTSTOP){
+                        return(NULL);
+                }
+        }
+}
+#endif
+
+/* routine to select how the output files are written */
+/* Called by main program */
+/* Calls outworker and logmsg */
+void outinit()
+{
+        char *envout;
+
+        envout=getenv("CEMHYD_OUTPUT");
+        if((envout!=NULL)&&(strcmp(envout,"async")==0)){
+#ifdef PARALLEL
+                sim->outsize=OUTRING;
+                envout=getenv("CEMHYD_OUTBUF");
+                if(envout!=NULL){
+                        sim->outsize=atol(envout)&(~7L);
+                        if(sim->outsize<(2*OUTLINE)){sim->outsize=2*OUTLINE;}
+                }
+                sim->outring=(unsigned char *)malloc(sim->outsize);
+                if(sim->outring==NULL){
+                        logmsg(LOGOUTPUT,LOGERROR,"Unable to allocate memory for output ring \n");
+                        exit(1);
+                }
+                if(pthread_create(&sim->outthread,NULL,outworker,(void *)sim)!=0){
+                        logmsg(LOGOUTPUT,LOGERROR,"Unable to start output thread \n");
+                        exit(1);
+                }
+                sim->outasync=1;
+                logmsg(LOGOUTPUT,LOGINFO,"Writing output files on a background thread \n");
+#else
+                logmsg(LOGOUTPUT,LOGWARN,"Output thread needs -DPARALLEL, so writing output files directly \n");
+#endif
+        }
+}
+
+/* routine to return the index of output file name, adding it if new */
+/* Called by outcreate and outprintf */
+/* Calls logmsg */
+int outfind(name)
+        char *name;
+{
+        int i;
+
+        for(i=0;i<sim->noutfile;i++){
+                if(strcmp(sim->outname[i],name)==0){return(i);}
+        }
+        if((sim->noutfile>=OUTMAXFILE)||(strlen(name)>=256)){
+                logmsg(LOGOUTPUT,LOGERROR,"Unable to add output file %s \n",name);
+                exit(1);
+        }
+        strcpy(sim->outname[sim->noutfile],name);
+        sim->outfp[sim->noutfile]=NULL;
+        sim->noutfile+=1;
+        return(sim->noutfile-1);
+}
+
+/* routine to carry out a record of kind kind for file ifile, with */
+/* data of len bytes, or to put it in the ring for the output thread */
+/* Called by outcreate, outprintf, outflush, outsnapshot and outclose */
+/* Calls outwrite */
+void outrecord(kind,ifile,data,len)
+        int kind,ifile;
+        char *data;
+        long int len;
+{
+#ifdef PARALLEL
+        long int need,pos,head;
+        struct outrec *rec;
+
+        if(sim->outasync){
+                head=sim->outhead;
+                pos=head%sim->outsize;
+                need=(long int)sizeof(struct outrec)+((len+7)&(~7L));
+                if((sim->outsize-pos)<need){
+                        /* Skip to the start of the ring */
+                        need+=sim->outsize-pos;
+                }
+                while((sim->outsize-(head-__atomic_load_n(&sim->outtail,__ATOMIC_ACQUIRE)))<need){
+                        usleep(100);
+                }
+                if((sim->outsize-pos)<((long int)sizeof(struct outrec)+((len+7)&(~7L)))){
+                        if((sim->outsize-pos)>=(long int)sizeof(struct outrec)){
+                                ((struct outrec *)&sim->outring[pos])->kind=OUTWRAP;
+                        }
+                        head+=sim->outsize-pos;
+                        pos=0;
+                }
+                rec=(struct outrec *)&sim->outring[pos];
+                rec->kind=kind;
+                rec->ifile=ifile;
+                rec->len=len;
+                if(len>0){memcpy(rec+1,data,len);}
+                __atomic_store_n(&sim->outhead,head+(long int)sizeof(struct outrec)+((len+7)&(~7L)),__ATOMIC_SEQ_CST);
+                if(__atomic_load_n(&sim->outidle,__ATOMIC_SEQ_CST)){
+                        pthread_mutex_lock(&sim->outmutex);
+                        pthread_cond_signal(&sim->outwake);
+                        pthread_mutex_unlock(&sim->outmutex);
+                }
+                return;
+        }
+#endif
+        outwrite(kind,ifile,data,len);
+}
+
+/* routine to start output file name afresh */
+/* Called by main program and dissolve */
+/* Calls outfind and outrecord */
+void outcreate(name)
+        char *name;
+{
+        if((sim->outheld)||(sim->outoff)){return;}
+        outrecord(OUTCREATE,outfind(name),NULL,0L);
+}
+
+/* routine to append to output file name, formatted as by printf */
+/* Called by main program, dissolve, pHpred, burn3d, burnset and */
+/* parthyd */
+/* Calls outfind and outrecord */
+void outprintf(char *name,char *format,...)
+{
+        char line[OUTLINE];
+        va_list args;
+        int len;
+
+        va_start(args,format);
+        len=vsnprintf(line,OUTLINE,format,args);
+        va_end(args);
+        if(len>=OUTLINE){len=OUTLINE-1;}
+        if((len>0)&&(!sim->outheld)&&(!sim->outoff)){
+                outrecord(OUTTEXT,outfind(name),line,(long int)len);
+        }
+}
+
+/* routine to flush the output files, once a cycle, so that they may */
+/* be followed as the run goes on */
+/* Called by main program */
+/* Calls outrecord */
+void outflush()
+{
+        outrecord(OUTFLUSH,0,NULL,0L);
+}
+
+/* routine to wait until everything put in the ring has been written */
+/* and the files flushed */
+/* Called by ckwrite */
+/* Calls outrecord */
+void outsync()
+{
+        outrecord(OUTFLUSH,0,NULL,0L);
+#ifdef PARALLEL
+        if(sim->outasync){
+                while(__atomic_load_n(&sim->outtail,__ATOMIC_ACQUIRE)!=sim->outhead){
+                        usleep(100);
+                }
+        }
+#endif
+}
+
+/* routine to return the length of file name, or -1 if there is none */
+/* Called by ckwrite */
+/* Calls no other routines */
+long int outlength(name)
+        char *name;
+{
+        FILE *infile;
+        long int len;
+
+        infile=fopen(name,"rb");
+        if(infile==NULL){return(-1);}
+        fseek(infile,0,SEEK_END);
+        len=ftell(infile);
+        fclose(infile);
+        return(len);
+}
+
+/* routine to discard all output to the files until outresume, while */
+/* a restarted run repeats the set up of the original run */
+/* Called by ckinit */
+/* Calls no other routines */
+void outhold()
+{
+        sim->outheld=1;
+}
+
+/* routine to cut output file name back to len bytes (or remove it if */
+/* len is -1) and write to it again, so that a restarted run carries */
+/* on from its checkpoint */
+/* Called by ckload */
+/* Calls logmsg */
+void outresume(name,len)
+        char *name;
+        long int len;
+{
+        sim->outheld=0;
+        if(len<0){
+                remove(name);
+        }
+        else if(truncate(name,(off_t)len)!=0){
+                logmsg(LOGOUTPUT,LOGERROR,"Unable to cut back output file %s to %ld bytes \n",name,len);
+                exit(1);
+        }
+}
+
+/* routine to return a buffer for the nside^3 pixel values of a */
+/* snapshot to be written by outsnapshot */
+/* Called by main program */
+/* Calls logmsg */
+char *outbuffer(nside)
+        int nside;
+{
+        int i,nbuf;
+
+        /* The output thread writes from one buffer while the next */
+        /* snapshot is put in the other */
+        nbuf=1;
+#ifdef PARALLEL
+        if(sim->outasync){nbuf=2;}
+#endif
+        if(sim->outbuf[0]==NULL){
+                for(i=0;i<nbuf;i++){
+                        sim->outbuf[i]=(char *)malloc((long int)nside*nside*nside*sizeof(char));
+                        if(sim->outbuf[i]==NULL){
+                                logmsg(LOGOUTPUT,LOGERROR,"Unable to allocate memory for image output \n");
+                                exit(1);
+                        }
+                }
+        }
+#ifdef PARALLEL
+        if(sim->outasync){
+                /* Wait for an earlier snapshot in this buffer to be written */
+                while(__atomic_load_n(&sim->outbusy[sim->outnext],__ATOMIC_ACQUIRE)){
+                        usleep(1000);
+                }
+                return(sim->outbuf[sim->outnext]);
+        }
+#endif
+        return(sim->outbuf[0]);
+}
+
+/* routine to write the nside^3 phase IDs at pix, from outbuffer, as */
+/* image file name in form form (see imgsave) */
+/* Called by main program */
+/* Calls imgsave and outrecord */
+void outsnapshot(name,pix,nside,form)
+        char *name,*pix;
+        int nside,form;
+{
+#ifdef PARALLEL
+        struct outimg img;
+
+        if(sim->outasync){
+                strncpy(img.name,name,255);
+                img.name[255]='\0';
+                img.pix=pix;
+                img.nside=nside;
+                img.form=form;
+                img.ibuf=sim->outnext;
+                sim->outbusy[sim->outnext]=1;
+                sim->outnext=1-sim->outnext;
+                outrecord(OUTIMAGE,0,(char *)&img,(long int)sizeof(struct outimg));
+                return;
+        }
+#endif
+        imgsave(name,pix,nside,form);
+}
+
+/* routine to write out all that remains and close the output files */
+/* Called at exit of the main program and by cemhydfree */
+/* Calls outrecord */
+void outclose()
+{
+#ifdef PARALLEL
+        if(sim->outasync){
+                /* Output thread may itself exit on an error */
+                if(pthread_equal(pthread_self(),sim->outthread)){return;}
+                outrecord(OUTSTOP,0,NULL,0L);
+                pthread_join(sim->outthread,NULL);
+                sim->outasync=0;
+                return;
+        }
+#endif
+        outwrite(OUTSTOP,0,NULL,0L);
+}
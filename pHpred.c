@@ -13,6 +13,8 @@
 /* they are derived from it, and any modified versions bear */
 /* some notice that they have been modified. */
 
+#include "cemhyd.h"
+
 /* Note that everything is being done on a one gram cement basis */
 #define VOLFACTOR 0.00001 /* dm per pixel Note- dm*dm*dm = Liters */
 #define MASSFACTOR 0.0001  /* cm per pixel - specific gravities in g/cm^3 */
@@ -177,58 +179,59 @@ void pHpred(){
 	/* Update CH activity product based on current system temperature */
 	/* Factors derived from fitting CH solubility vs. temperature */
 	/* data in Taylor book (p. 117) */
-	KspCH=KspCH25C*(1.534385-0.02057*temp_cur);
+	KspCH=KspCH25C*(1.534385-0.02057*sim->temp_cur);
 
-        if(conccaplus>1.0){conccaplus=0.0;}
+        if(sim->conccaplus>1.0){sim->conccaplus=0.0;}
 	/* Calculate volume of pore solution in the concrete in Liters */
-        volpore=(double)count[POROSITY]+0.38*(double)count[CSH]+0.20*(double)count[POZZCSH]+0.20*count[SLAGCSH];
+        volpore=(double)simt->count[POROSITY]+0.38*(double)simt->count[CSH]+0.20*(double)simt->count[POZZCSH]+0.20*simt->count[SLAGCSH];
 	/* Convert from pixels (cubic micrometers) to liters (cubic decimeters) */
         volpore*=VOLFACTOR;
         volpore*=VOLFACTOR;
         volpore*=VOLFACTOR;
 	/* Compute pore volume per gram of cement */
-        grams_cement=cemmasswgyp*MASSFACTOR*MASSFACTOR*MASSFACTOR;
+        grams_cement=sim->cemmasswgyp*MASSFACTOR*MASSFACTOR*MASSFACTOR;
 	/* Compute pore volume per gram of cement */
         volpore/=grams_cement;
 	/* Compute grams of pozzolan which have reacted */
-	pozzreact=((float)npr/1.35)*MASSFACTOR*MASSFACTOR*MASSFACTOR*specgrav[POZZ];
+	/* (referred to a 100^3 system) */
+	pozzreact=((float)simt->npr/1.35/sim->sysvolfact)*MASSFACTOR*MASSFACTOR*MASSFACTOR*sim->specgrav[POZZ];
 
 	/* Compute moles of released potassium and sodium per gram of cement*/
-        if(time_cur>1.0){
-       	    releasedk=(2.*(rspotassium+(totpotassium-rspotassium)*alpha_cur));
+        if(sim->time_cur>1.0){
+       	    releasedk=(2.*(sim->rspotassium+(sim->totpotassium-sim->rspotassium)*sim->alpha_cur));
 	    releasedk/=MMK2O;
-       	    releasedna=(2.*(rssodium+(totsodium-rssodium)*alpha_cur));
+       	    releasedna=(2.*(sim->rssodium+(sim->totsodium-sim->rssodium)*sim->alpha_cur));
 	    releasedna/=MMNa2O;
 	}
 	else{
 		/* Proportion the early time release over the first hour */
                 /* 90% immediately and the remaining 10% over the first hour */
                 /* based on limited data from Davide Zampini (MBT) */
-       	    releasedk=(2.*((0.9+0.1*time_cur)*(rspotassium)+(totpotassium-rspotassium)*alpha_cur));
+       	    releasedk=(2.*((0.9+0.1*sim->time_cur)*(sim->rspotassium)+(sim->totpotassium-sim->rspotassium)*sim->alpha_cur));
 	    releasedk/=MMK2O;
-       	    releasedna=(2.*((0.9+0.1*time_cur)*(rssodium)+(totsodium-rssodium)*alpha_cur));
+       	    releasedna=(2.*((0.9+0.1*sim->time_cur)*(sim->rssodium)+(sim->totsodium-sim->rssodium)*sim->alpha_cur));
 	    releasedna/=MMNa2O;
 	}
 
 	/* Compute concentrations of K+ and Na+ in pore solution currently */
         /* Remember to decrease K+ by KperSyn*moles of syngenite precipitated */
         /* Units must be in moles/gram for both */
-	conckplus=((releasedk-moles_syn_precip*KperSyn)/(volpore+BK*alpha_cur+BprimeK*pozzreact));
-	concnaplus=(releasedna)/(volpore+BNa*alpha_cur+BprimeNa*pozzreact);
+	conckplus=((releasedk-sim->moles_syn_precip*KperSyn)/(volpore+BK*sim->alpha_cur+BprimeK*pozzreact));
+	concnaplus=(releasedna)/(volpore+BNa*sim->alpha_cur+BprimeNa*pozzreact);
 
         do{  /* while Syngenite precipitating loop */
         /* Now compute the activities (estimated) of Ca++ and OH- */
         activityCa=activityOH=activitySO4=activityK=1.0;
         Inew=0.0;
-	if(((concnaplus+conckplus)>0.0)&&(soluble[ETTR]==0)){
+	if(((concnaplus+conckplus)>0.0)&&(sim->soluble[ETTR]==0)){
         /* Factor of 1000 to convert from M to mmol/L */
-        Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*conccaplus);
+        Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*sim->conccaplus);
         if(Istrength<1.0){Istrength=1.0;}
         while((abs(Istrength-Inew)/Istrength)>0.10){
-        	Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*conccaplus);
+        	Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*sim->conccaplus);
 	        if(Istrength<1.0){Istrength=1.0;}
-	        Anow=activeA0*295.*sqrt(295.)/((temp_cur+273.15)*sqrt(temp_cur+273.15));
-	        Bnow=activeB0*sqrt(295.)/(sqrt(temp_cur+273.15));
+	        Anow=activeA0*295.*sqrt(295.)/((sim->temp_cur+273.15)*sqrt(sim->temp_cur+273.15));
+	        Bnow=activeB0*sqrt(295.)/(sqrt(sim->temp_cur+273.15));
                 /* Equations from papers of Marchand et al. */
 	        activityCa=(-Anow*zCa*zCa*sqrt(Istrength))/(1.+aCa*Bnow*sqrt(Istrength));
 	        activityCa+=(0.2-0.0000417*Istrength)*Anow*zCa*zCa*Istrength/sqrt(1000.);
@@ -268,8 +271,8 @@ void pHpred(){
        		 sumbest=100; 
 			/* Find the best real root for electoneutrality */
        		 for(j=1;j<=4;j++){
-			printf("pH root %d is (%f,%f)\n",j,roots[j].r,roots[j].i);
-			fflush(stdout);
+			logmsg(LOGPH,LOGDEBUG,"pH root %d is (%f,%f)\n",j,roots[j].r,roots[j].i);
+			logflush();
 			if(((roots[j].i)==0.0)&&((roots[j].r)>0.0)){
 	
 				 conctest=sqrt(KspCH/(roots[j].r*activityCa*activityOH*activityOH));
@@ -278,23 +281,23 @@ void pHpred(){
 				if(fabs(sumtest)<sumbest){
 					sumbest=fabs(sumtest);
 					concohminus=conctest;
-       		                        conccaplus=roots[j].r;
-       		                        concsulfate=concsulfate1;
+       		                        sim->conccaplus=roots[j].r;
+       		                        sim->concsulfate=concsulfate1;
 				}
 			}
 		} 
        		 /* Update ionic strength */
-       		Inew=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*conccaplus);
+       		Inew=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*sim->conccaplus);
        	        }    /* end of while loop for Istrength-Inew */ 
 	}
 	else{ 
         /* Factor of 1000 to convert from M to mmol/L */
-        Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*conccaplus);
+        Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*sim->conccaplus);
         if(Istrength<1.0){Istrength=1.0;}
         while((abs(Istrength-Inew)/Istrength)>0.10){
-        	Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*conccaplus);
-	        Anow=activeA0*295.*sqrt(295.)/((temp_cur+273.15)*sqrt(temp_cur+273.15));
-	        Bnow=activeB0*sqrt(295.)/(sqrt(temp_cur+273.15));
+        	Istrength=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*sim->conccaplus);
+	        Anow=activeA0*295.*sqrt(295.)/((sim->temp_cur+273.15)*sqrt(sim->temp_cur+273.15));
+	        Bnow=activeB0*sqrt(295.)/(sqrt(sim->temp_cur+273.15));
                 /* Equations from papers of Marchand et al. */
 	        activityCa=(-Anow*zCa*zCa*sqrt(Istrength))/(1.+aCa*Bnow*sqrt(Istrength));
 	        activityCa+=(0.2-0.0000417*Istrength)*Anow*zCa*zCa*Istrength/sqrt(1000.);
@@ -307,35 +310,35 @@ void pHpred(){
 	        activityK=exp(activityK);
 	/* Calculate pH assuming simply that OH- balances sum of Na+ and K+ */
 	        concohminus=conckplus+concnaplus;
-                if((conccaplus)>(0.1*(concohminus))){
-                    concohminus+=(2.*conccaplus);
+                if((sim->conccaplus)>(0.1*(concohminus))){
+                    concohminus+=(2.*sim->conccaplus);
                 }
-		conccaplus=(KspCH/(activityCa*activityOH*activityOH*concohminus*concohminus));
-		concsulfate=0.0;
+		sim->conccaplus=(KspCH/(activityCa*activityOH*activityOH*concohminus*concohminus));
+		sim->concsulfate=0.0;
        		 /* Update ionic strength */
-       		Inew=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*conccaplus);
+       		Inew=1000.*(zK*zK*conckplus+zNa*zNa*concnaplus+zCa*zCa*sim->conccaplus);
        	        }    /* end of while loop for Istrength-Inew */ 
         } 
           /* Check for syngenite precipitation */
              syngen_change=0;
           if(syn_old!=2){
              test_precip=conckplus*conckplus*activityK*activityK;
-             test_precip*=conccaplus*activityCa;
-             test_precip*=concsulfate*concsulfate*activitySO4*activitySO4;
+             test_precip*=sim->conccaplus*activityCa;
+             test_precip*=sim->concsulfate*sim->concsulfate*activitySO4*activitySO4;
              if(test_precip>KspSyngenite){
-                printf("Syngenite precipitating at cycle %d\n",icyc);
+                logmsg(LOGPH,LOGINFO,"Syngenite precipitating at cycle %d\n",sim->icyc);
                 syngen_change=syn_old=1;
                 /* Units of moles_syn_precip are moles per gram of cement */
                 if(conckplus>0.002){
                    conckplus-=0.001;
-                   moles_syn_precip+=0.001*volpore/KperSyn;
+                   sim->moles_syn_precip+=0.001*volpore/KperSyn;
                 }
                 else if(conckplus>0.0002){
                    conckplus-=0.0001;
-                   moles_syn_precip+=0.0001*volpore/KperSyn;
+                   sim->moles_syn_precip+=0.0001*volpore/KperSyn;
                 }
                 else{
-                   moles_syn_precip+=conckplus*volpore/KperSyn;
+                   sim->moles_syn_precip+=conckplus*volpore/KperSyn;
       	           conckplus=0.0;
                 }
              }
@@ -344,16 +347,16 @@ void pHpred(){
              /* Have 0.001*KperSyn increase in conckplus each cycle */
              /* Only one dissolution per cycle --- purpose of syn_old */
              /* and no dissolution if some precipitation in that cycle */
-             if((syn_old==0)&&(moles_syn_precip>0.0)){
+             if((syn_old==0)&&(sim->moles_syn_precip>0.0)){
                syngen_change=syn_old=2;
 /*               conckplus+=(moles_syn_precip/10.0)/volpore; */
-               if((moles_syn_precip/volpore)>0.001){
+               if((sim->moles_syn_precip/volpore)>0.001){
 	               conckplus+=0.001*KperSyn; 
-       		       moles_syn_precip-=(0.001*volpore);
+       		       sim->moles_syn_precip-=(0.001*volpore);
                }
                else{
-                       conckplus+=(moles_syn_precip*KperSyn/volpore);
-                       moles_syn_precip=0.0;
+                       conckplus+=(sim->moles_syn_precip*KperSyn/volpore);
+                       sim->moles_syn_precip=0.0;
                }
              }
           }
@@ -361,25 +364,23 @@ void pHpred(){
 
 	if(concohminus<(0.0000001)){
 		concohminus=0.0000001;
-		conccaplus=(KspCH/(activityCa*activityOH*activityOH*concohminus*concohminus));
+		sim->conccaplus=(KspCH/(activityCa*activityOH*activityOH*concohminus*concohminus));
 	}
-        pH_cur=14.0+log10(concohminus*activityOH);
+        sim->pH_cur=14.0+log10(concohminus*activityOH);
         /* Calculation of solution conductivity (Snyder and Feng basis) */
         /* First convert ionic strength back to M units */
         Istrength/=1000.;
-        conductivity+=zCa*conccaplus*(lambdaCa_0/(1.+GCa*sqrt(Istrength)));
+        conductivity+=zCa*sim->conccaplus*(lambdaCa_0/(1.+GCa*sqrt(Istrength)));
         conductivity+=zOH*concohminus*(lambdaOH_0/(1.+GOH*sqrt(Istrength)));
         conductivity+=zNa*concnaplus*(lambdaNa_0/(1.+GNa*sqrt(Istrength)));
         conductivity+=zK*conckplus*(lambdaK_0/(1.+GK*sqrt(Istrength)));
-        conductivity+=zSO4*concsulfate*(lambdaSO4_0/(1.+GSO4*sqrt(Istrength)));
+        conductivity+=zSO4*sim->concsulfate*(lambdaSO4_0/(1.+GSO4*sqrt(Istrength)));
         conductivity*=cm2perL2m;
 
 	/* Output results to logging file */
-	pHfile=fopen(pHname,"a");
-        if((cyccnt-1)==0){
-        fprintf(pHfile,"Cycle time(h) alpha_mass pH sigma(S/m) [Na+] [K+] [Ca++] [SO4--] activityCa activityOH activitySO4 activityK molesSyngenite\n");
+        if((sim->cyccnt-1)==0){
+        outprintf(sim->pHname,"Cycle time(h) alpha_mass pH sigma(S/m) [Na+] [K+] [Ca++] [SO4--] activityCa activityOH activitySO4 activityK molesSyngenite\n");
         }
-        fprintf(pHfile,"%d %.4f %f %.4f %f %f %f %f %f %.4f %.4f %.4f %.4f %f\n",cyccnt-1,time_cur,alpha_cur,pH_cur,conductivity,concnaplus,conckplus,conccaplus,concsulfate,activityCa,activityOH,activitySO4,activityK,moles_syn_precip);
-        fclose(pHfile);
+        outprintf(sim->pHname,"%d %.4f %f %.4f %f %f %f %f %f %.4f %.4f %.4f %.4f %f\n",sim->cyccnt-1,sim->time_cur,sim->alpha_cur,sim->pH_cur,conductivity,concnaplus,conckplus,sim->conccaplus,sim->concsulfate,activityCa,activityOH,activitySO4,activityK,sim->moles_syn_precip);
 
 }
@@ -0,0 +1,541 @@
+/* Routines to move the diffusing species on several threads */
+/* The lattice is divided in x and y into sub-domains at least DOMMIN */
+/* pixels wide, coloured as a checkerboard, so that domains of one */
+/* colour are separated by more than twice the distance (DOMREACH) */
+/* over which one step of a species can read or change the */
+/* microstructure, counts, or frontier; all domains of one colour are */
+/* processed concurrently, the four colours in turn */
+/* The species are sorted by domain before each step, and gathered */
+/* back into the pool after it, by all threads at once */
+/* Each domain draws from its own ran1 stream, seeded from the main */
+/* stream, the cycle, the step, and the domain (or each species from */
+/* its own counter-based stream, see ranc.c), and changes to the */
+/* shared counts and the list of pore pixels are merged in a fixed */
+/* order, so results depend on the seed but not on the number of */
+/* threads */
+/* Reaction products placed at random anywhere in the lattice (see */
+/* extrand) are queued by each domain, and placed by the main thread */
+/* once the domains of a colour have moved, domain by domain in a */
+/* fixed order (in counter-based mode, each from its own stream) */
+/* The number of threads is taken from the environment variable */
+/* CEMHYD_THREADS, or else is the number of processors */
+
+#include "cemhyd.h"
+
+#define DOMREACH 8	/* farthest a species step reaches in x or y */
+#define DOMMIN (2*DOMREACH+1)	/* minimum width of a domain */
+/* domain holding the species at loc */
+#define ANTDOM(loc) (sim->domofx[ANTX(loc)]*sim->ndomy+sim->domofy[ANTY(loc)])
+
+#ifdef PARALLEL
+/* routine to return the number of domains along a side of n pixels, */
+/* which must be one or even for the colouring to be periodic */
+/* Called by initdomains */
+/* Calls no other routines */
+int domcount(n)
+        int n;
+{
+        int nd;
+
+        nd=n/DOMMIN;
+        if(nd<2){return(1);}
+        if((nd%2)!=0){nd-=1;}
+        return(nd);
+}
+
+/* routine to return the ran1 seed for domain idom in the current step */
+/* Called by movedomain */
+/* Calls no other routines */
+int domseed(idom)
+        int idom;
+{
+        unsigned int h;
+
+        h=(unsigned int)sim->jobseed;
+        h=h*2654435761u+(unsigned int)sim->cyccnt;
+        h^=(h>>16);
+        h=h*2246822519u+(unsigned int)sim->jobstep;
+        h^=(h>>13);
+        h=h*3266489917u+(unsigned int)idom;
+        h^=(h>>16);
+        return((int)(h%2147483646u)+1);
+}
+
+/* routine to move the diffusing species of domain idom on thread ithr */
+/* Called by poolworker */
+/* Calls domseed, ranready, ranahead, ranstream, stepant and antstep */
+void movedomain(idom,ithr)
+        int idom,ithr;
+{
+        struct domain *dom;
+        long int k,iant;
+        long int aheadid[RANLANES];
+        unsigned int locpl,locnext;
+        int i,reactf,nahead;
+
+        dom=&sim->doms[idom];
+        simt->curdom=dom;
+        /* A negative seed restarts ran1; in counter-based mode each */
+        /* species instead draws from its own stream */
+        simt->domidum=(-domseed(idom));
+        simt->seed=(&simt->domidum);
+        for(i=0;i<=EMPTYP;i++){
+                simt->count[i]=sim->phasecount[i];
+        }
+        simt->npr=sim->phasenpr;
+
+        dom->nout=dom->ngone=0;
+        for(k=dom->first;k<(dom->first+dom->nin);k++){
+                iant=sim->domant[k];
+                locpl=sim->antloc[iant];
+                /* Compute the first numbers of this and the next few */
+                /* species' streams side by side */
+                if(!ranready(RNGSTEP,sim->jobstep,VOXEL(ANTX(locpl),ANTY(locpl),ANTZ(locpl)))){
+                        for(nahead=0;(nahead<RANLANES)&&((k+nahead)<(dom->first+dom->nin));nahead++){
+                                locnext=sim->antloc[sim->domant[k+nahead]];
+                                aheadid[nahead]=VOXEL(ANTX(locnext),ANTY(locnext),ANTZ(locnext));
+                        }
+                        ranahead(RNGSTEP,sim->jobstep,aheadid,nahead);
+                }
+                ranstream(RNGSTEP,sim->jobstep,VOXEL(ANTX(locpl),ANTY(locpl),ANTZ(locpl)));
+                reactf=stepant(ANTX(locpl),ANTY(locpl),ANTZ(locpl),(int)sim->antid[iant],(int)sim->antbirth[iant],sim->jobterm,sim->jobch,sim->jobc3ah6,sim->jobfh3,sim->jobgyp);
+                if(reactf!=0){
+                        sim->outloc[dom->first+dom->nout]=antstep(locpl,reactf);
+                        sim->outid[dom->first+dom->nout]=sim->antid[iant];
+                        sim->outbirth[dom->first+dom->nout]=sim->antbirth[iant];
+                        dom->nout+=1;
+                }
+                else{
+                        dom->ngone+=1;
+                }
+        }
+
+        for(i=0;i<=EMPTYP;i++){
+                sim->thrcount[ithr][i]+=simt->count[i]-sim->phasecount[i];
+        }
+        sim->thrnpr[ithr]+=simt->npr-sim->phasenpr;
+        simt->curdom=NULL;
+}
+
+/* routine to count the species of each domain in the part of the */
+/* pool sorted by thread ithr */
+/* Called by poolworker */
+/* Calls no other routines */
+void antcount(ithr)
+        int ithr;
+{
+        long int iant,ifirst,ilast,*hist;
+        int idom;
+
+        hist=(&sim->thrhist[(long int)ithr*sim->ndoms]);
+        for(idom=0;idom<sim->ndoms;idom++){
+                hist[idom]=0;
+        }
+        ifirst=(sim->nants*ithr)/sim->nthreads;
+        ilast=(sim->nants*(ithr+1))/sim->nthreads;
+        for(iant=ifirst;iant<ilast;iant++){
+                hist[ANTDOM(sim->antloc[iant])]+=1;
+        }
+}
+
+/* routine to place the species in the part of the pool of thread */
+/* ithr in domant, after those of the same domain in earlier parts */
+/* Called by poolworker */
+/* Calls no other routines */
+void antsort(ithr)
+        int ithr;
+{
+        long int iant,ifirst,ilast,*hist;
+        int idom;
+
+        hist=(&sim->thrhist[(long int)ithr*sim->ndoms]);
+        ifirst=(sim->nants*ithr)/sim->nthreads;
+        ilast=(sim->nants*(ithr+1))/sim->nthreads;
+        for(iant=ifirst;iant<ilast;iant++){
+                idom=ANTDOM(sim->antloc[iant]);
+                sim->domant[hist[idom]]=iant;
+                hist[idom]+=1;
+        }
+}
+
+/* routine to copy the survivors of domain idom back into the pool */
+/* Called by poolworker */
+/* Calls no other routines */
+void antgather(idom)
+        int idom;
+{
+        struct domain *dom;
+        long int k;
+
+        dom=&sim->doms[idom];
+        for(k=0;k<dom->nout;k++){
+                sim->antloc[dom->back+k]=sim->outloc[dom->first+k];
+                sim->antid[dom->back+k]=sim->outid[dom->first+k];
+                sim->antbirth[dom->back+k]=sim->outbirth[dom->first+k];
+        }
+}
+
+/* routine to return the next domain for a worker thread in the */
+/* current job, or -1 if none is left */
+/* Called by poolworker */
+/* Calls no other routines */
+int nextdomain()
+{
+        int idom;
+
+        pthread_mutex_lock(&sim->poolmutex);
+        idom=(-1);
+        if(sim->pooljob==JOBGATHER){
+                if(sim->poolnext<sim->ndoms){
+                        idom=sim->poolnext;
+                }
+        }
+        else if(sim->poolnext<sim->ncolor[sim->poolcolor]){
+                idom=sim->domcolor[sim->poolcolor][sim->poolnext];
+        }
+        if(idom>=0){sim->poolnext+=1;}
+        pthread_mutex_unlock(&sim->poolmutex);
+        return(idom);
+}
+
+/* routine run by each worker thread, waiting for and carrying out */
+/* jobs posted by runjob */
+/* Called by initdomains */
+/* Calls nextdomain, movedomain, antcount, antsort, antgather, */
+/* percmerge and percwork */
+void *poolworker(arg)
+        void *arg;
+{
+        int ithr,mygen,job,idom,i;
+
+        /* Each worker has its own state within the simulation */
+        simt=(struct simthread *)arg;
+        sim=simt->owner;
+        ithr=simt->ithr;
+        mygen=0;
+        for(;;){
+                pthread_mutex_lock(&sim->poolmutex);
+                while(sim->poolgen==mygen){
+                        pthread_cond_wait(&sim->poolstart,&sim->poolmutex);
+                }
+                mygen=sim->poolgen;
+                job=sim->pooljob;
+                pthread_mutex_unlock(&sim->poolmutex);
+
+                if(job==JOBDOMAINS){
+                        while((idom=nextdomain())>=0){
+                                movedomain(idom,ithr);
+                        }
+                }
+                else if(job==JOBCOUNT){
+                        antcount(ithr);
+                }
+                else if(job==JOBSORT){
+                        antsort(ithr);
+                }
+                else if(job==JOBGATHER){
+                        while((idom=nextdomain())>=0){
+                                antgather(idom);
+                        }
+                }
+                else if(job==JOBMERGE){
+                        /* These are only changed, never read, while */
+                        /* species move, so each thread holds changes */
+                        pthread_mutex_lock(&sim->poolmutex);
+                        for(i=0;i<MAXCYC;i++){
+                                if(simt->ncshage[i]!=0){
+                                        sim->mainncshage[i]+=simt->ncshage[i];
+                                        simt->ncshage[i]=0;
+                                }
+                        }
+                        *sim->maingypready+=simt->gypready;
+                        *sim->mainnasr+=simt->nasr;
+                        *sim->mainplategrow+=simt->ncshplategrow;
+                        *sim->mainplateinit+=simt->ncshplateinit;
+                        simt->gypready=simt->nasr=simt->ncshplategrow=simt->ncshplateinit=0;
+                        percmerge();
+                        pthread_mutex_unlock(&sim->poolmutex);
+                }
+                else if(job==JOBLABEL){
+                        percwork();
+                }
+
+                pthread_mutex_lock(&sim->poolmutex);
+                sim->poolbusy-=1;
+                if(sim->poolbusy==0){
+                        pthread_cond_signal(&sim->pooldone);
+                }
+                pthread_mutex_unlock(&sim->poolmutex);
+                /* The simulation may be freed once the last thread */
+                /* has finished */
+                if(job==JOBQUIT){break;}
+        }
+        return(NULL);
+}
+
+/* routine to post a job to all worker threads and wait for them */
+/* Called by pardiffuse, parmerge, percupdate and enddomains */
+/* Calls no other routines */
+void runjob(job)
+        int job;
+{
+        pthread_mutex_lock(&sim->poolmutex);
+        sim->pooljob=job;
+        sim->poolnext=0;
+        sim->poolbusy=sim->nthreads;
+        sim->poolgen+=1;
+        pthread_cond_broadcast(&sim->poolstart);
+        while(sim->poolbusy>0){
+                pthread_cond_wait(&sim->pooldone,&sim->poolmutex);
+        }
+        pthread_mutex_unlock(&sim->poolmutex);
+}
+
+/* routine to divide the lattice into domains and start the worker */
+/* threads */
+/* Called by main program */
+/* Calls domcount, poolworker and logmsg */
+void initdomains()
+{
+        char *envthr;
+        int i,idx,idy,idom,icol;
+        pthread_t thr;
+
+        envthr=getenv("CEMHYD_THREADS");
+        if(envthr!=NULL){
+                sim->nthreads=atoi(envthr);
+        }
+        else{
+                sim->nthreads=(int)sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        if(sim->nthreads<1){sim->nthreads=1;}
+
+        sim->ndomx=domcount(SYSIZE);
+        sim->ndomy=domcount(SYSIZE);
+        sim->ndoms=sim->ndomx*sim->ndomy;
+        sim->domofx=(int *)malloc(SYSIZE*sizeof(int));
+        sim->domofy=(int *)malloc(SYSIZE*sizeof(int));
+        sim->doms=(struct domain *)malloc(sim->ndoms*sizeof(struct domain));
+        for(icol=0;icol<4;icol++){
+                sim->domcolor[icol]=(int *)malloc(sim->ndoms*sizeof(int));
+                sim->ncolor[icol]=0;
+        }
+        sim->thrcount=(long int (*)[EMPTYP+1])calloc(sim->nthreads,sizeof(*sim->thrcount));
+        sim->thrnpr=(long int *)calloc(sim->nthreads,sizeof(long int));
+        sim->thrhist=(long int *)calloc((long int)sim->nthreads*sim->ndoms,sizeof(long int));
+        sim->workers=(struct simthread *)calloc(sim->nthreads,sizeof(struct simthread));
+        if((sim->domofx==NULL)||(sim->domofy==NULL)||(sim->doms==NULL)||(sim->domcolor[3]==NULL)||(sim->thrcount==NULL)||(sim->thrnpr==NULL)||(sim->thrhist==NULL)||(sim->workers==NULL)){
+                logmsg(LOGHYDRATE,LOGERROR,"Unable to allocate memory for %d domains \n",sim->ndoms);
+                exit(1);
+        }
+        for(i=0;i<SYSIZE;i++){
+                sim->domofx[i]=(int)(((long int)i*sim->ndomx)/SYSIZE);
+                sim->domofy[i]=(int)(((long int)i*sim->ndomy)/SYSIZE);
+        }
+        for(idx=0;idx<sim->ndomx;idx++){
+        for(idy=0;idy<sim->ndomy;idy++){
+                idom=idx*sim->ndomy+idy;
+                sim->doms[idom].x0=(int)(((long int)idx*SYSIZE+sim->ndomx-1)/sim->ndomx);
+                sim->doms[idom].nx=(int)(((long int)(idx+1)*SYSIZE+sim->ndomx-1)/sim->ndomx)-sim->doms[idom].x0;
+                sim->doms[idom].y0=(int)(((long int)idy*SYSIZE+sim->ndomy-1)/sim->ndomy);
+                sim->doms[idom].ny=(int)(((long int)(idy+1)*SYSIZE+sim->ndomy-1)/sim->ndomy)-sim->doms[idom].y0;
+                sim->doms[idom].porelog=NULL;
+                sim->doms[idom].nporelog=sim->doms[idom].porelogcap=0;
+                sim->doms[idom].extq=NULL;
+                sim->doms[idom].nextq=sim->doms[idom].extqcap=0;
+                icol=(idx%2)*2+(idy%2);
+                sim->domcolor[icol][sim->ncolor[icol]]=idom;
+                sim->ncolor[icol]+=1;
+        }
+        }
+
+        /* Changes made by the workers are added to these */
+        sim->mainncshage=simt->ncshage;
+        sim->maingypready=(&simt->gypready);
+        sim->mainnasr=(&simt->nasr);
+        sim->mainplategrow=(&simt->ncshplategrow);
+        sim->mainplateinit=(&simt->ncshplateinit);
+
+        for(i=0;i<sim->nthreads;i++){
+                sim->workers[i].owner=sim;
+                sim->workers[i].ithr=i;
+                sim->workers[i].rngblocks=1;
+                if(pthread_create(&thr,NULL,poolworker,(void *)&sim->workers[i])!=0){
+                        logmsg(LOGHYDRATE,LOGERROR,"Unable to start diffusion thread %d \n",i);
+                        exit(1);
+                }
+                pthread_detach(thr);
+        }
+        logmsg(LOGHYDRATE,LOGINFO,"Moving diffusing species on %d threads over %d x %d domains \n",sim->nthreads,sim->ndomx,sim->ndomy);
+}
+
+/* routine to stop the worker threads and free the domains, once no */
+/* more cycles are to be run */
+/* Called by simfree */
+/* Calls runjob */
+void enddomains()
+{
+        int i,k;
+
+        runjob(JOBQUIT);
+        for(i=0;i<sim->nthreads;i++){
+                for(k=0;k<NPERCLAT;k++){
+                        free(sim->workers[i].percdirty[k]);
+                }
+        }
+        free(sim->workers);
+        sim->workers=NULL;
+        free(sim->domofx);
+        free(sim->domofy);
+        for(i=0;i<sim->ndoms;i++){
+                free(sim->doms[i].porelog);
+                free(sim->doms[i].extq);
+        }
+        free(sim->doms);
+        for(i=0;i<4;i++){
+                free(sim->domcolor[i]);
+        }
+        free(sim->thrcount);
+        free(sim->thrnpr);
+        free(sim->thrhist);
+        free(sim->domant);
+        free(sim->outloc);
+        free(sim->outbirth);
+        free(sim->outid);
+}
+
+/* routine to carry out one diffusion step for all diffusing species */
+/* Returns the number of species remaining in the pool, which are */
+/* ordered by domain and by their previous order within each domain */
+/* Called by hydrate */
+/* Calls runjob, poreflush, extflush and logmsg */
+long int pardiffuse(istep,termflag,chprob,c3ah6prob,fh3prob,gypprob)
+        int istep,termflag;
+        float chprob,c3ah6prob,fh3prob,gypprob;
+{
+        long int k,nhist,nleft;
+        int i,idom,icol,ithr;
+
+        if(sim->antcap>sim->outcap){
+                sim->domant=(long int *)realloc(sim->domant,sim->antcap*sizeof(long int));
+                sim->outloc=(unsigned int *)realloc(sim->outloc,sim->antcap*sizeof(unsigned int));
+                sim->outbirth=(short int *)realloc(sim->outbirth,sim->antcap*sizeof(short int));
+                sim->outid=(unsigned char *)realloc(sim->outid,sim->antcap*sizeof(unsigned char));
+                if((sim->domant==NULL)||(sim->outloc==NULL)||(sim->outbirth==NULL)||(sim->outid==NULL)){
+                        logmsg(LOGHYDRATE,LOGERROR,"Unable to allocate memory for %ld diffusing species \n",sim->antcap);
+                        exit(1);
+                }
+                sim->outcap=sim->antcap;
+        }
+
+        /* Sort the species by domain, keeping pool order within each; */
+        /* each thread counts the species of each domain in its part */
+        /* of the pool, and then places them after those of the same */
+        /* domain in earlier parts */
+        runjob(JOBCOUNT);
+        k=0;
+        for(idom=0;idom<sim->ndoms;idom++){
+                sim->doms[idom].first=k;
+                for(ithr=0;ithr<sim->nthreads;ithr++){
+                        nhist=sim->thrhist[(long int)ithr*sim->ndoms+idom];
+                        sim->thrhist[(long int)ithr*sim->ndoms+idom]=k;
+                        k+=nhist;
+                }
+                sim->doms[idom].nin=k-sim->doms[idom].first;
+        }
+        runjob(JOBSORT);
+
+        sim->jobstep=istep;
+        sim->jobterm=termflag;
+        sim->jobseed=(*simt->seed);
+        sim->jobch=chprob;
+        sim->jobc3ah6=c3ah6prob;
+        sim->jobfh3=fh3prob;
+        sim->jobgyp=gypprob;
+        sim->jobplaced=0;
+        for(icol=0;icol<4;icol++){
+                if(sim->ncolor[icol]==0){continue;}
+                for(i=0;i<=EMPTYP;i++){
+                        sim->phasecount[i]=simt->count[i];
+                }
+                sim->phasenpr=simt->npr;
+                sim->poolcolor=icol;
+                runjob(JOBDOMAINS);
+                for(ithr=0;ithr<sim->nthreads;ithr++){
+                        for(i=0;i<=EMPTYP;i++){
+                                simt->count[i]+=sim->thrcount[ithr][i];
+                                sim->thrcount[ithr][i]=0;
+                        }
+                        simt->npr+=sim->thrnpr[ithr];
+                        sim->thrnpr[ithr]=0;
+                }
+                /* Bring the list of pore pixels up to date before */
+                /* placing the queued products */
+                for(k=0;k<sim->ncolor[icol];k++){
+                        poreflush(&sim->doms[sim->domcolor[icol][k]]);
+                }
+                for(k=0;k<sim->ncolor[icol];k++){
+                        extflush(&sim->doms[sim->domcolor[icol][k]]);
+                }
+        }
+
+        /* Gather the survivors back into the pool in domain order */
+        nleft=0;
+        for(idom=0;idom<sim->ndoms;idom++){
+                sim->doms[idom].back=nleft;
+                nleft+=sim->doms[idom].nout;
+                sim->ngoing-=sim->doms[idom].ngone;
+        }
+        runjob(JOBGATHER);
+        return(nleft);
+}
+
+/* routine to queue a product of phase ph, from a reaction in the */
+/* current domain, to be placed at random once the domains of its */
+/* colour have moved */
+/* Called by extrand */
+/* Calls logmsg */
+void extqueue(ph)
+        int ph;
+{
+        struct domain *dom;
+
+        dom=simt->curdom;
+        if(dom->nextq>=dom->extqcap){
+                dom->extqcap=2*dom->extqcap+64;
+                dom->extq=(int *)realloc(dom->extq,dom->extqcap*sizeof(int));
+                if(dom->extq==NULL){
+                        logmsg(LOGHYDRATE,LOGERROR,"Unable to allocate memory for queued products \n");
+                        exit(1);
+                }
+        }
+        dom->extq[dom->nextq]=ph;
+        dom->nextq+=1;
+}
+
+/* routine to place the products queued by domain dom, in the order */
+/* they were queued */
+/* Called by pardiffuse */
+/* Calls ranstream and extrand */
+void extflush(dom)
+        struct domain *dom;
+{
+        long int k;
+
+        for(k=0;k<dom->nextq;k++){
+                ranstream(RNGPLACE,sim->jobstep,sim->jobplaced);
+                sim->jobplaced+=1;
+                extrand(dom->extq[k]);
+        }
+        dom->nextq=0;
+}
+
+/* routine to add the changes to C-S-H ages, soluble gypsum and other */
+/* totals made by the worker threads to those of the main thread */
+/* Called by hydrate */
+/* Calls runjob */
+void parmerge()
+{
+        runjob(JOBMERGE);
+}
+#endif
@@ -13,21 +13,24 @@
 /* they are derived from it, and any modified versions bear */
 /* some notice that they have been modified. */
 
+#include "cemhyd.h"
+
 /* Routine to assess relative particle hydration */
 void parthyd(){
-	int norig[50000],nleft[50000];
+	int *norig,*nleft;
 	int ix,iy,iz;
 	char valmic,valmicorig;
 	int valpart,partmax;
         float alpart;
-	FILE *phydfile;
 
-        /* Initialize the particle count arrays */
-	for(ix=0;ix<50000;ix++){
-		nleft[ix]=norig[ix]=0;
+        /* Allocate and initialize the particle count arrays */
+	norig=(int *)calloc(sim->maxpartid+1,sizeof(int));
+	nleft=(int *)calloc(sim->maxpartid+1,sizeof(int));
+	if((norig==NULL)||(nleft==NULL)){
+		logmsg(LOGPERC,LOGERROR,"Unable to allocate particle count arrays in parthyd \n");
+		exit(1);
 	}
-	phydfile=fopen(phrname,"a");
-	fprintf(phydfile,"%d %f\n",cyccnt,alpha_cur);
+	outprintf(sim->phrname,"%d %f\n",sim->cyccnt,sim->alpha_cur);
 
 	partmax=0;
         /* Scan the microstructure pixel by pixel and update counts */
@@ -35,14 +38,14 @@ void parthyd(){
 	for(iy=0;iy<SYSIZE;iy++){
 	for(iz=0;iz<SYSIZE;iz++){
 
-		if(micpart[ix][iy][iz]!=0){
-			valpart=micpart[ix][iy][iz];
+		if(sim->micpart[VOXEL(ix,iy,iz)]!=0){
+			valpart=sim->micpart[VOXEL(ix,iy,iz)];
 			if(valpart>partmax){partmax=valpart;}
-			valmic=mic[ix][iy][iz];
+			valmic=sim->mic[VOXEL(ix,iy,iz)];
 			if((valmic==C3S)||(valmic==C2S)||(valmic==C3A)||(valmic==C4AF)){
 				nleft[valpart]+=1;
 			}
-			valmicorig=micorig[ix][iy][iz];
+			valmicorig=sim->micorig[VOXEL(ix,iy,iz)];
 			if((valmicorig==C3S)||(valmicorig==C2S)||(valmicorig==C3A)||(valmicorig==C4AF)){
 				norig[valpart]+=1;
 			}
@@ -50,6 +53,7 @@ void parthyd(){
 	}
 	}
 	}
+        PROFSCAN((long int)SYSIZE*SYSIZE*SYSIZE);
  
         /* Output results to end of particle hydration file */
 	for(ix=100;ix<=partmax;ix++){
@@ -57,7 +61,8 @@ void parthyd(){
                 if(norig[ix]!=0){
 			alpart=1.-(float)nleft[ix]/(float)norig[ix];
 		}
-		fprintf(phydfile,"%d %d %d %.3f\n",ix,norig[ix],nleft[ix],alpart);
+		outprintf(sim->phrname,"%d %d %d %.3f\n",ix,norig[ix],nleft[ix],alpart);
 	}
-	fclose(phydfile);
+	free(norig);
+	free(nleft);
 }
@@ -0,0 +1,591 @@
+/* Routines to find the clusters of connected pixels in the */
+/* microstructure, and the percolation of those clusters in each of */
+/* the three directions, by union-find (Hoshen-Kopelman) labelling */
+/* Used by burn3d for a single phase (PERCPORE) and by burnset for */
+/* the solids making up the set network (PERCSET) */
+/* Which pixels belong to clusters, and which neighbors are joined, */
+/* is given by the class of each phase in the type of each lattice: */
+/*	PERCOUT pixels belong to no cluster */
+/*	PERCLINK pixels are joined to every neighboring cluster pixel */
+/*	PERCPART pixels are joined to neighboring PERCLINK pixels, and */
+/*	to neighboring PERCPART pixels of the same initial particle */
+/* The lattice is divided into blocks of PERCBLK pixels a side, each */
+/* labelled separately, and the clusters of neighboring blocks joined */
+/* across the faces between them; the labels of a block, and the */
+/* joins across its faces, are kept from one check to the next and */
+/* found again only if setphase has changed the class of one of its */
+/* pixels, so that a check costs little more than the blocks changed */
+/* For each burn direction, the joins across the faces of the lattice */
+/* normal to that direction are left out, so that, as in the burning */
+/* algorithm used before, connectivity is nonperiodic along the burn */
+/* direction and periodic in the other two */
+/* A cluster percolates in a direction if it contains the pixels at */
+/* both ends of some line of pixels along that direction */
+/* Compile with -DCHECKCOUNTS to verify each check against a check */
+/* with every block labelled again */
+
+#include "cemhyd.h"
+
+/* Pixels iv and iw, both in clusters of a lattice of class type, */
+/* are joined */
+#define PERCJOIN(type,iv,iw) ((type[(unsigned char)sim->mic[iv]]==PERCLINK)|| \
+        (type[(unsigned char)sim->mic[iw]]==PERCLINK)|| \
+        ((sim->micpart[iv]!=0)&&(sim->micpart[iv]==sim->micpart[iw])))
+
+/* Block containing pixel (x,y,z) */
+#define PERCBLOCK(x,y,z) ((((long int)((x)/PERCBLK))*sim->percnb+((y)/PERCBLK))*sim->percnb+((z)/PERCBLK))
+
+/* routine to return the root of element i of union-find forest par, */
+/* halving the path to it on the way */
+/* Called by percjoin and perccount */
+/* Calls no other routines */
+int percfind(par,i)
+        int *par;
+        int i;
+{
+        while(par[i]!=i){
+                par[i]=par[par[i]];
+                i=par[i];
+        }
+        return(i);
+}
+
+/* routine to join the trees of elements i and j of union-find forest */
+/* par, keeping the smaller index as the root */
+/* Called by percblock and perccount */
+/* Calls percfind */
+void percjoin(par,i,j)
+        int *par;
+        int i,j;
+{
+        i=percfind(par,i);
+        j=percfind(par,j);
+        if(i<j){par[j]=i;}
+        else if(j<i){par[i]=j;}
+}
+
+/* routine to return the index of the pixel at position t along */
+/* direction idir (0 for x, 1 for y, 2 for z), and at positions j and */
+/* k along the two directions following it cyclically */
+/* Called by percface and perccount */
+/* Calls no other routines */
+long int percvox(idir,t,j,k)
+        int idir,t,j,k;
+{
+        if(idir==0){return(VOXEL(t,j,k));}
+        if(idir==1){return(VOXEL(k,t,j));}
+        return(VOXEL(j,k,t));
+}
+
+/* routine to mark the block of pixel (xp,yp,zp) as changed in each */
+/* lattice for which the class of the pixel changes from that of */
+/* phase phold to that of phase phnew */
+/* Called by setphase, when percclass shows some class changes */
+/* Calls logmsg */
+void percmark(xp,yp,zp,phold,phnew)
+        int xp,yp,zp,phold,phnew;
+{
+        int k;
+        struct perclat *lat;
+
+        for(k=0;k<NPERCLAT;k++){
+                lat=&sim->perclats[k];
+                if((lat->lab==NULL)||(lat->type[phold]==lat->type[phnew])){
+                        continue;
+                }
+                if(simt->percdirty[k]==NULL){
+                        simt->percdirty[k]=(char *)calloc(sim->percnblk,sizeof(char));
+                        if(simt->percdirty[k]==NULL){
+                                logmsg(LOGPERC,LOGERROR,"Unable to allocate changed blocks in percmark \n");
+                                exit(1);
+                        }
+                }
+                simt->percdirty[k][PERCBLOCK(xp,yp,zp)]=1;
+        }
+}
+
+#ifdef PARALLEL
+/* routine run by each worker thread to label blocks of poollat */
+/* from percjob until none remain */
+/* Called by poolworker */
+/* Calls percblock */
+void percwork()
+{
+        long int ijob;
+
+        for(;;){
+                pthread_mutex_lock(&sim->poolmutex);
+                ijob=(-1);
+                if(sim->poolnext<sim->npercjob){
+                        ijob=sim->poolnext;
+                        sim->poolnext+=1;
+                }
+                pthread_mutex_unlock(&sim->poolmutex);
+                if(ijob<0){break;}
+                percblock(sim->poollat,sim->percjob[ijob]);
+        }
+}
+
+/* routine to add the blocks marked changed by a worker thread to */
+/* those marked by the main thread */
+/* Called by poolworker, with the pool mutex held */
+/* Calls no other routines */
+void percmerge()
+{
+        int k;
+        long int ib;
+
+        for(k=0;k<NPERCLAT;k++){
+                if((sim->perclats[k].lab==NULL)||(simt->percdirty[k]==NULL)||(simt->percdirty[k]==sim->perclats[k].dirty)){
+                        continue;
+                }
+                for(ib=0;ib<sim->percnblk;ib++){
+                        if(simt->percdirty[k][ib]){
+                                sim->perclats[k].dirty[ib]=1;
+                                simt->percdirty[k][ib]=0;
+                        }
+                }
+        }
+}
+#endif
+
+/* routine to set percclass, the classes of each phase in all */
+/* lattices in use, used by setphase to skip changes of phase which */
+/* change no class */
+/* Called by percupdate and percfree */
+/* Calls no other routines */
+void percsetclass()
+{
+        int i,k;
+
+        for(i=0;i<256;i++){
+                sim->percclass[i]=0;
+                for(k=0;k<NPERCLAT;k++){
+                        if(sim->perclats[k].lab!=NULL){
+                                sim->percclass[i]|=(sim->perclats[k].type[i]<<(2*k));
+                        }
+                }
+        }
+}
+
+/* routine to free the clusters of lattice k once no more checks of */
+/* it are needed, so that changes of phase are no longer tracked */
+/* A later check labels the whole lattice again */
+/* Called by main program */
+/* Calls percsetclass */
+void percfree(k)
+        int k;
+{
+        struct perclat *lat;
+        long int ib;
+
+        lat=&sim->perclats[k];
+        if(lat->lab==NULL){return;}
+        for(ib=0;ib<sim->percnblk;ib++){
+                if(lat->locsize[ib]!=NULL){free(lat->locsize[ib]);}
+                if(lat->pair[3*ib]!=NULL){free(lat->pair[3*ib]);}
+                if(lat->pair[3*ib+1]!=NULL){free(lat->pair[3*ib+1]);}
+                if(lat->pair[3*ib+2]!=NULL){free(lat->pair[3*ib+2]);}
+        }
+        free(lat->lab);
+        free(lat->dirty);
+        free(lat->nloc);
+        free(lat->locsize);
+        free(lat->npair);
+        free(lat->pair);
+        lat->lab=NULL;
+        simt->percdirty[k]=NULL;
+        percsetclass();
+}
+
+/* routine to return the first pixel of block ib along each direction */
+/* in x0[0..2] and the pixel after the last in x1[0..2] */
+/* Called by percblock and percface */
+/* Calls no other routines */
+void percextent(ib,x0,x1)
+        long int ib;
+        int *x0,*x1;
+{
+        int i,bc[3];
+
+        bc[0]=(int)(ib/((long int)sim->percnb*sim->percnb));
+        bc[1]=(int)((ib/sim->percnb)%sim->percnb);
+        bc[2]=(int)(ib%sim->percnb);
+        for(i=0;i<3;i++){
+                x0[i]=bc[i]*PERCBLK;
+                x1[i]=x0[i]+PERCBLK;
+                if(x1[i]>SYSIZE){x1[i]=SYSIZE;}
+        }
+}
+
+/* routine to label the clusters of block ib of lattice lat, numbering */
+/* them from 0 in order of their first pixel */
+/* Blocks do not share any labels, so that several may be labelled */
+/* concurrently */
+/* Called by percupdate and percwork */
+/* Calls percextent, percjoin and logmsg */
+void percblock(lat,ib)
+        struct perclat *lat;
+        long int ib;
+{
+        long int iv,iw;
+        int ix,iy,iz,x0[3],x1[3],nclus,*lab,*size;
+        char *type;
+
+        lab=lat->lab;
+        type=lat->type;
+        percextent(ib,x0,x1);
+        for(ix=x0[0];ix<x1[0];ix++){
+        for(iy=x0[1];iy<x1[1];iy++){
+                iv=VOXEL(ix,iy,x0[2]);
+                for(iz=x0[2];iz<x1[2];iz++){
+                        if(type[(unsigned char)sim->mic[iv]]==PERCOUT){
+                                lab[iv]=(-1);
+                        }
+                        else{
+                                /* Continue the run of the pixel before */
+                                /* along z, or else start a new tree */
+                                iw=iv-1;
+                                if((iz>x0[2])&&(lab[iw]>=0)&&PERCJOIN(type,iv,iw)){
+                                        lab[iv]=lab[iw];
+                                }
+                                else{
+                                        lab[iv]=(int)iv;
+                                }
+                                iw=iv-SYSIZE;
+                                if((iy>x0[1])&&(lab[iw]>=0)&&PERCJOIN(type,iv,iw)){
+                                        percjoin(lab,(int)iv,(int)iw);
+                                }
+                                iw=iv-(long int)SYSIZE*SYSIZE;
+                                if((ix>x0[0])&&(lab[iw]>=0)&&PERCJOIN(type,iv,iw)){
+                                        percjoin(lab,(int)iv,(int)iw);
+                                }
+                        }
+                        iv+=1;
+                }
+        }
+        }
+
+        /* Number the clusters and count their pixels; every pixel */
+        /* has a larger index than its parent, so its parent is */
+        /* numbered first */
+        /* A block has at most one cluster in every two pixels */
+        if(lat->locsize[ib]==NULL){
+                lat->locsize[ib]=(int *)malloc(((x1[0]-x0[0])*(x1[1]-x0[1])*(x1[2]-x0[2])/2+1)*sizeof(int));
+                if(lat->locsize[ib]==NULL){
+                        logmsg(LOGPERC,LOGERROR,"Unable to allocate cluster sizes in percblock \n");
+                        exit(1);
+                }
+        }
+        size=lat->locsize[ib];
+        nclus=0;
+        for(ix=x0[0];ix<x1[0];ix++){
+        for(iy=x0[1];iy<x1[1];iy++){
+                iv=VOXEL(ix,iy,x0[2]);
+                for(iz=x0[2];iz<x1[2];iz++){
+                        if(lab[iv]==iv){
+                                lab[iv]=nclus;
+                                size[nclus]=1;
+                                nclus+=1;
+                        }
+                        else if(lab[iv]>=0){
+                                lab[iv]=lab[lab[iv]];
+                                size[lab[iv]]+=1;
+                        }
+                        iv+=1;
+                }
+        }
+        }
+        lat->nloc[ib]=nclus;
+}
+
+/* routine to compare two pairs of clusters, for sorting */
+/* Called by qsort from percface */
+/* Calls no other routines */
+int perccmp(a,b)
+        const void *a,*b;
+{
+        const int *pa,*pb;
+
+        pa=(const int *)a;
+        pb=(const int *)b;
+        if(pa[0]!=pb[0]){return((pa[0]<pb[0])?(-1):1);}
+        if(pa[1]!=pb[1]){return((pa[1]<pb[1])?(-1):1);}
+        return(0);
+}
+
+/* routine to find the distinct pairs of clusters of lattice lat */
+/* joined across the face of block ib at its lowest pixels along */
+/* direction idir, first of block ib and then of the block below it */
+/* (periodically) */
+/* Called by percupdate */
+/* Calls percextent, percvox, perccmp and logmsg */
+void percface(lat,ib,idir)
+        struct perclat *lat;
+        long int ib;
+        int idir;
+{
+        long int iv,iw;
+        int x0[3],x1[3],j,k,n,m,tlow,jd,kd,*p;
+
+        percextent(ib,x0,x1);
+        jd=(idir+1)%3;
+        kd=(idir+2)%3;
+        tlow=x0[idir]-1;
+        if(tlow<0){tlow=SYSIZE-1;}
+        p=sim->percpairs;
+        n=0;
+        for(j=x0[jd];j<x1[jd];j++){
+        for(k=x0[kd];k<x1[kd];k++){
+                iv=percvox(idir,x0[idir],j,k);
+                iw=percvox(idir,tlow,j,k);
+                if((lat->lab[iv]<0)||(lat->lab[iw]<0)||(!PERCJOIN(lat->type,iv,iw))){
+                        continue;
+                }
+                if((n>0)&&(p[2*n-2]==lat->lab[iv])&&(p[2*n-1]==lat->lab[iw])){
+                        continue;
+                }
+                p[2*n]=lat->lab[iv];
+                p[2*n+1]=lat->lab[iw];
+                n+=1;
+        }
+        }
+        /* Keep each pair once */
+        qsort(p,n,2*sizeof(int),perccmp);
+        m=0;
+        for(j=0;j<n;j++){
+                if((m>0)&&(p[2*m-2]==p[2*j])&&(p[2*m-1]==p[2*j+1])){continue;}
+                p[2*m]=p[2*j];
+                p[2*m+1]=p[2*j+1];
+                m+=1;
+        }
+        lat->pair[3*ib+idir]=(int *)realloc(lat->pair[3*ib+idir],(2*m+1)*sizeof(int));
+        if(lat->pair[3*ib+idir]==NULL){
+                logmsg(LOGPERC,LOGERROR,"Unable to allocate cluster pairs in percface \n");
+                exit(1);
+        }
+        for(j=0;j<2*m;j++){
+                lat->pair[3*ib+idir][j]=p[j];
+        }
+        lat->npair[3*ib+idir]=m;
+}
+
+/* routine to return the block below block ib along direction idir, */
+/* periodically */
+/* Called by percupdate and perccount */
+/* Calls no other routines */
+long int percbelow(ib,idir)
+        long int ib;
+        int idir;
+{
+        long int stride;
+        int bc;
+
+        stride=1;
+        if(idir==0){stride=(long int)sim->percnb*sim->percnb;}
+        else if(idir==1){stride=sim->percnb;}
+        bc=(int)((ib/stride)%sim->percnb);
+        if(bc==0){return(ib+(sim->percnb-1)*stride);}
+        return(ib-stride);
+}
+
+/* routine to label again the blocks of lattice lat changed since the */
+/* last check, and find again the joins across their faces */
+/* In a parallel build the blocks are labelled on the worker threads */
+/* Called by perccheck */
+/* Calls percsetclass, percblock, runjob, percbelow, percface and */
+/* logmsg */
+void percupdate(lat)
+        struct perclat *lat;
+{
+        long int ib,nvox;
+        int idir;
+#ifndef PARALLEL
+        long int ijob;
+#endif
+
+        if(lat->lab==NULL){
+                nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+                sim->percnb=(SYSIZE+PERCBLK-1)/PERCBLK;
+                sim->percnblk=(long int)sim->percnb*sim->percnb*sim->percnb;
+                lat->lab=(int *)malloc(nvox*sizeof(int));
+                lat->dirty=(char *)malloc(sim->percnblk*sizeof(char));
+                lat->nloc=(int *)calloc(sim->percnblk,sizeof(int));
+                lat->locsize=(int **)calloc(sim->percnblk,sizeof(int *));
+                lat->npair=(int *)calloc(3*sim->percnblk,sizeof(int));
+                lat->pair=(int **)calloc(3*sim->percnblk,sizeof(int *));
+                sim->percjob=(long int *)realloc(sim->percjob,sim->percnblk*sizeof(long int));
+                if((lat->lab==NULL)||(lat->dirty==NULL)||(lat->nloc==NULL)||(lat->locsize==NULL)||(lat->npair==NULL)||(lat->pair==NULL)||(sim->percjob==NULL)){
+                        logmsg(LOGPERC,LOGERROR,"Unable to allocate memory for cluster labels in percupdate \n");
+                        exit(1);
+                }
+                for(ib=0;ib<sim->percnblk;ib++){
+                        lat->dirty[ib]=1;
+                }
+                simt->percdirty[lat-sim->perclats]=lat->dirty;
+                percsetclass();
+        }
+
+        sim->npercjob=0;
+        for(ib=0;ib<sim->percnblk;ib++){
+                if(lat->dirty[ib]){
+                        sim->percjob[sim->npercjob]=ib;
+                        sim->npercjob+=1;
+                }
+        }
+        PROFSCAN(sim->npercjob*PERCBLK*PERCBLK*PERCBLK);
+#ifdef PARALLEL
+        sim->poollat=lat;
+        runjob(JOBLABEL);
+#else
+        for(ijob=0;ijob<sim->npercjob;ijob++){
+                percblock(lat,sim->percjob[ijob]);
+        }
+#endif
+        for(ib=0;ib<sim->percnblk;ib++){
+                for(idir=0;idir<3;idir++){
+                        if((lat->dirty[ib])||(lat->dirty[percbelow(ib,idir)])){
+                                percface(lat,ib,idir);
+                        }
+                }
+        }
+        for(ib=0;ib<sim->percnblk;ib++){
+                lat->dirty[ib]=0;
+        }
+}
+
+/* routine to join the clusters of all blocks of lattice lat and */
+/* assess their percolation in each direction, returned in res[0..2] */
+/* for x, y and z */
+/* Returns the number of pixels belonging to clusters */
+/* Called by perccheck */
+/* Calls percbelow, percjoin, percvox, percfind and logmsg */
+long int perccount(lat,res)
+        struct perclat *lat;
+        struct percres *res;
+{
+        long int ib,ibelow,iv,iw,ncpix,*rsize,*base;
+        int idir,iface,j,k,n,c,r,nclus,*cpar,*csize,*p;
+        char *ctop,*cthrough;
+
+        /* Clusters of the lattice are numbered block by block */
+        base=(long int *)malloc(sim->percnblk*sizeof(long int));
+        if(base==NULL){
+                logmsg(LOGPERC,LOGERROR,"Unable to allocate memory for %ld blocks in perccount \n",sim->percnblk);
+                exit(1);
+        }
+        nclus=0;
+        for(ib=0;ib<sim->percnblk;ib++){
+                base[ib]=nclus;
+                nclus+=lat->nloc[ib];
+        }
+        csize=(int *)malloc((nclus+1)*sizeof(int));
+        rsize=(long int *)malloc((nclus+1)*sizeof(long int));
+        cpar=(int *)malloc((nclus+1)*sizeof(int));
+        ctop=(char *)malloc((nclus+1)*sizeof(char));
+        cthrough=(char *)malloc((nclus+1)*sizeof(char));
+        if((csize==NULL)||(rsize==NULL)||(cpar==NULL)||(ctop==NULL)||(cthrough==NULL)){
+                logmsg(LOGPERC,LOGERROR,"Unable to allocate memory for %d clusters in perccount \n",nclus);
+                exit(1);
+        }
+        ncpix=0;
+        for(ib=0;ib<sim->percnblk;ib++){
+                for(c=0;c<lat->nloc[ib];c++){
+                        csize[base[ib]+c]=lat->locsize[ib][c];
+                        ncpix+=lat->locsize[ib][c];
+                }
+        }
+
+        for(idir=0;idir<3;idir++){
+                for(c=0;c<nclus;c++){
+                        cpar[c]=c;
+                        rsize[c]=0;
+                        ctop[c]=cthrough[c]=0;
+                }
+                /* Join clusters across block faces, except the faces */
+                /* of the lattice normal to the burn direction */
+                for(ib=0;ib<sim->percnblk;ib++){
+                for(iface=0;iface<3;iface++){
+                        ibelow=percbelow(ib,iface);
+                        if((iface==idir)&&(ibelow>=ib)){continue;}
+                        p=lat->pair[3*ib+iface];
+                        for(n=0;n<lat->npair[3*ib+iface];n++){
+                                percjoin(cpar,(int)(base[ib]+p[2*n]),(int)(base[ibelow]+p[2*n+1]));
+                        }
+                }
+                }
+                /* Mark clusters touching the first face, and those */
+                /* containing both ends of a line along the direction */
+                for(j=0;j<SYSIZE;j++){
+                for(k=0;k<SYSIZE;k++){
+                        iv=percvox(idir,0,j,k);
+                        iw=percvox(idir,SYSIZE-1,j,k);
+                        if(lat->lab[iv]<0){continue;}
+                        r=percfind(cpar,(int)(base[PERCBLOCK(iv/((long int)SYSIZE*SYSIZE),(iv/SYSIZE)%SYSIZE,iv%SYSIZE)]+lat->lab[iv]));
+                        ctop[r]=1;
+                        if((lat->lab[iw]>=0)&&(percfind(cpar,(int)(base[PERCBLOCK(iw/((long int)SYSIZE*SYSIZE),(iw/SYSIZE)%SYSIZE,iw%SYSIZE)]+lat->lab[iw]))==r)){
+                                cthrough[r]=1;
+                        }
+                }
+                }
+
+                res[idir].ntop=res[idir].nthrough=0;
+                res[idir].nclus=res[idir].maxclus=0;
+                for(c=0;c<nclus;c++){
+                        r=percfind(cpar,c);
+                        rsize[r]+=csize[c];
+                        if(ctop[r]){res[idir].ntop+=csize[c];}
+                        if(cthrough[r]){res[idir].nthrough+=csize[c];}
+                }
+                for(c=0;c<nclus;c++){
+                        if(cpar[c]!=c){continue;}
+                        res[idir].nclus+=1;
+                        if(rsize[c]>res[idir].maxclus){res[idir].maxclus=rsize[c];}
+                }
+        }
+
+        free(base);
+        free(csize);
+        free(rsize);
+        free(cpar);
+        free(ctop);
+        free(cthrough);
+        return(ncpix);
+}
+
+/* routine to assess the percolation of the clusters of lattice k in */
+/* each direction, returned in res[0..2] for x, y and z, labelling */
+/* only the blocks changed since the last check */
+/* The class of each phase in perclats[k].type must be set before */
+/* the first check, and not changed after */
+/* Returns the number of pixels belonging to clusters */
+/* Called by burn3d and burnset */
+/* Calls percupdate, perccount and logmsg */
+long int perccheck(k,res)
+        int k;
+        struct percres *res;
+{
+        long int ncpix;
+#ifdef CHECKCOUNTS
+        long int ib,nfull;
+        int idir;
+        struct percres full[3];
+#endif
+
+        percupdate(&sim->perclats[k]);
+        ncpix=perccount(&sim->perclats[k],res);
+#ifdef CHECKCOUNTS
+        for(ib=0;ib<sim->percnblk;ib++){
+                sim->perclats[k].dirty[ib]=1;
+        }
+        percupdate(&sim->perclats[k]);
+        nfull=perccount(&sim->perclats[k],full);
+        for(idir=0;idir<3;idir++){
+                if((nfull!=ncpix)||(full[idir].ntop!=res[idir].ntop)||(full[idir].nthrough!=res[idir].nthrough)||(full[idir].nclus!=res[idir].nclus)||(full[idir].maxclus!=res[idir].maxclus)){
+                        logmsg(LOGPERC,LOGERROR,"Clusters of lattice %d in direction %d are inconsistent with microstructure at cycle %d \n",k,idir,sim->cyccnt);
+                        exit(1);
+                }
+        }
+#endif
+        return(ncpix);
+}
@@ -0,0 +1,134 @@
+/* Routines through which every change of pixel phase is made, so that */
+/* the phase counts, the soluble gypsum count, and the ages of solid */
+/* C-S-H are always up to date without rescanning the microstructure */
+/* Counts are by phase, ignoring any surface mark (OFFSET) */
+/* Compile with -DCHECKCOUNTS to verify them against a full recount */
+/* at the start of every cycle */
+
+#include "cemhyd.h"
+
+/* routine to tally the phase counts for the current microstructure */
+/* and to locate the pixels in contact with pore space */
+/* Called by main program and ckload */
+/* Calls surfphase and initsurf */
+void initphases()
+{
+        int i,ph;
+        long int iv,nvox;
+
+        for(i=0;i<=EMPTYP;i++){
+                simt->count[i]=0;
+        }
+        for(i=0;i<MAXCYC;i++){
+                simt->ncshage[i]=0;
+        }
+        nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+        for(iv=0;iv<nvox;iv++){
+                ph=surfphase(iv);
+                simt->count[ph]+=1;
+                if(ph==CSH){simt->ncshage[sim->cshage[iv]]+=1;}
+        }
+        simt->gypready=simt->count[GYPSUM]+simt->count[GYPSUMS];
+        initsurf();
+}
+
+/* routine to change the phase of pixel (xp,yp,zp) to phnew, */
+/* keeping the phase counts and the frontier up to date */
+/* Called by loccsh, makeinert, extslagcsh, dissolve, addrand, */
+/* resaturate and the hydration routines */
+/* Calls surfphase, flipsurf, percmark and poremark */
+void setphase(xp,yp,zp,phnew)
+        int xp,yp,zp,phnew;
+{
+        long int iv;
+        int phold;
+
+        iv=VOXEL(xp,yp,zp);
+        phold=surfphase(iv);
+        sim->mic[iv]=phnew;
+        simt->count[phold]-=1;
+        simt->count[phnew]+=1;
+        /* gypready used to determine if any soluble gypsum remains */
+        if((phold==GYPSUM)||(phold==GYPSUMS)){simt->gypready-=1;}
+        if((phnew==GYPSUM)||(phnew==GYPSUMS)){simt->gypready+=1;}
+        if(phold==CSH){simt->ncshage[sim->cshage[iv]]-=1;}
+        if(phnew==CSH){simt->ncshage[sim->cshage[iv]]+=1;}
+        if(OPENPH(phold)!=OPENPH(phnew)){
+                flipsurf(xp,yp,zp,OPENPH(phnew));
+        }
+        if(sim->percclass[phold]!=sim->percclass[phnew]){
+                percmark(xp,yp,zp,phold,phnew);
+        }
+        if((sim->poreok)&&(PORELISTED(phold)!=PORELISTED(phnew))){
+                poremark(iv,PORELISTED(phnew));
+        }
+}
+
+/* routine to set the cycle of formation of pixel (xp,yp,zp) to cyc */
+/* Called by extcsh and movecsh */
+/* Calls surfphase */
+void setcshage(xp,yp,zp,cyc)
+        int xp,yp,zp,cyc;
+{
+        long int iv;
+
+        iv=VOXEL(xp,yp,zp);
+        if(surfphase(iv)==CSH){
+                simt->ncshage[sim->cshage[iv]]-=1;
+                simt->ncshage[cyc]+=1;
+        }
+        sim->cshage[iv]=cyc;
+}
+
+#ifdef CHECKCOUNTS
+/* routine to verify the phase counts, soluble gypsum count, and */
+/* C-S-H ages, and the list of pore pixels, against a full scan of */
+/* the microstructure */
+/* Called by dissolve and ckload */
+/* Calls surfphase, porecheck and logmsg */
+void checkcounts()
+{
+        int i,ph,bad;
+        long int iv,nvox,nph[EMPTYP+1],ngyp,*nage;
+
+        nage=(long int *)calloc(MAXCYC,sizeof(long int));
+        if(nage==NULL){
+                logmsg(LOGCYCLE,LOGERROR,"Unable to allocate memory for count check \n");
+                exit(1);
+        }
+        for(i=0;i<=EMPTYP;i++){
+                nph[i]=0;
+        }
+        nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+        for(iv=0;iv<nvox;iv++){
+                ph=surfphase(iv);
+                nph[ph]+=1;
+                if(ph==CSH){nage[sim->cshage[iv]]+=1;}
+        }
+        ngyp=nph[GYPSUM]+nph[GYPSUMS];
+
+        bad=0;
+        for(i=0;i<=EMPTYP;i++){
+                if(nph[i]!=simt->count[i]){
+                        logmsg(LOGCYCLE,LOGERROR,"Count of phase %d is %ld but should be %ld \n",i,simt->count[i],nph[i]);
+                        bad=1;
+                }
+        }
+        if(ngyp!=simt->gypready){
+                logmsg(LOGCYCLE,LOGERROR,"Count of soluble gypsum is %ld but should be %ld \n",simt->gypready,ngyp);
+                bad=1;
+        }
+        for(i=0;i<MAXCYC;i++){
+                if(nage[i]!=simt->ncshage[i]){
+                        logmsg(LOGCYCLE,LOGERROR,"Count of C-S-H formed in cycle %d is %ld but should be %ld \n",i,simt->ncshage[i],nage[i]);
+                        bad=1;
+                }
+        }
+        free(nage);
+        if(bad){
+                logmsg(LOGCYCLE,LOGERROR,"Phase counts are inconsistent with microstructure at cycle %d \n",sim->cyccnt);
+                exit(1);
+        }
+        porecheck();
+}
+#endif
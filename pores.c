@@ -0,0 +1,274 @@
+/* Routines to pick pore pixels at random for the placement of */
+/* diffusing species and other phases */
+/* By default a pixel is drawn from the whole lattice and rejected */
+/* unless it is porosity, as in earlier versions, so that runs repeat */
+/* historical outputs; if the environment variable CEMHYD_PLACE is set */
+/* to indexed, a pixel is instead picked from a list of all pore */
+/* pixels and diffusing species, and rejected if it is a diffusing */
+/* species, so that the cost of a placement does not grow as the */
+/* porosity is used up */
+/* The list is built in lattice order at the first pick and then kept */
+/* up to date by setphase, at a cost independent of its length; a */
+/* diffusing species only trades places with porosity as it moves, */
+/* so only reactions, dissolution and placements change the list */
+/* While species move on several threads, the changes made in each */
+/* domain are noted and made to the list in domain order once the */
+/* domains of its colour have moved, so that the list and the picks */
+/* are the same whatever the number of threads */
+
+#include "cemhyd.h"
+
+#define BOXTRIES 8	/* draws in a box before its pore pixels are listed */
+
+/* routine to select how pore pixels are picked */
+/* Called by main program */
+/* Calls logmsg */
+void placeinit()
+{
+        char *envplace;
+
+        envplace=getenv("CEMHYD_PLACE");
+        if((envplace!=NULL)&&(strcmp(envplace,"indexed")==0)){
+                sim->placemode=PLACEINDEX;
+                logmsg(LOGHYDRATE,LOGINFO,"Picking pore pixels for placement from an index \n");
+        }
+}
+
+/* routine to allocate the list of pore pixels */
+/* Called by porebuild and ckload */
+/* Calls logmsg */
+void porealloc()
+{
+        long int nvox;
+
+        nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+        if(sim->poresite==NULL){
+                sim->poresite=(int *)malloc(nvox*sizeof(int));
+                sim->poreat=(int *)malloc(nvox*sizeof(int));
+                if((sim->poresite==NULL)||(sim->poreat==NULL)){
+                        logmsg(LOGHYDRATE,LOGERROR,"Unable to allocate memory for pore index \n");
+                        exit(1);
+                }
+        }
+}
+
+/* routine to list all pore pixels and diffusing species of the */
+/* current microstructure in lattice order */
+/* Called by randpore */
+/* Calls porealloc */
+void porebuild()
+{
+        long int iv,nvox;
+
+        porealloc();
+        nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+        sim->nporesite=0;
+        for(iv=0;iv<nvox;iv++){
+                if(PORELISTED(sim->mic[iv])){
+                        sim->poreat[iv]=sim->nporesite;
+                        sim->poresite[sim->nporesite]=iv;
+                        sim->nporesite+=1;
+                }
+        }
+        sim->poreok=1;
+}
+
+/* routine to add pixel iv to (nowpore=1) or remove it from */
+/* (nowpore=0) the list of pore pixels; a removed pixel is replaced */
+/* by the last in the list */
+/* Called by setphase and poreflush */
+/* Calls logmsg */
+void poremark(iv,nowpore)
+        long int iv;
+        int nowpore;
+{
+        long int ipos;
+        int ilast;
+#ifdef PARALLEL
+        struct domain *dom;
+
+        /* A worker only notes the change, in its own domain */
+        if(simt->curdom!=NULL){
+                dom=simt->curdom;
+                if(dom->nporelog>=dom->porelogcap){
+                        dom->porelogcap=2*dom->porelogcap+1024;
+                        dom->porelog=(long int *)realloc(dom->porelog,dom->porelogcap*sizeof(long int));
+                        if(dom->porelog==NULL){
+                                logmsg(LOGHYDRATE,LOGERROR,"Unable to allocate memory for pore changes \n");
+                                exit(1);
+                        }
+                }
+                dom->porelog[dom->nporelog]=2*iv+nowpore;
+                dom->nporelog+=1;
+                return;
+        }
+#endif
+
+        if(nowpore){
+                sim->poreat[iv]=sim->nporesite;
+                sim->poresite[sim->nporesite]=iv;
+                sim->nporesite+=1;
+        }
+        else{
+                ipos=sim->poreat[iv];
+                sim->nporesite-=1;
+                ilast=sim->poresite[sim->nporesite];
+                sim->poresite[ipos]=ilast;
+                sim->poreat[ilast]=ipos;
+        }
+}
+
+/* routine to add the changes noted in domain dom to the list of pore */
+/* pixels, in the order they were made */
+/* Called by pardiffuse */
+/* Calls poremark */
+void poreflush(dom)
+        struct domain *dom;
+{
+        long int k;
+
+        for(k=0;k<dom->nporelog;k++){
+                poremark(dom->porelog[k]/2,(int)(dom->porelog[k]%2));
+        }
+        dom->nporelog=0;
+}
+
+#ifdef CHECKCOUNTS
+/* routine to verify the list of pore pixels, if it is in use, */
+/* against the microstructure and phase counts */
+/* Called by checkcounts */
+/* Calls logmsg */
+void porecheck()
+{
+        long int ipos,nlisted;
+        int ph;
+
+        if(sim->poreok==0){return;}
+        nlisted=0;
+        for(ph=0;ph<=EMPTYP;ph++){
+                if(PORELISTED(ph)){nlisted+=simt->count[ph];}
+        }
+        if(sim->nporesite!=nlisted){
+                logmsg(LOGCYCLE,LOGERROR,"Pore index holds %ld pixels but should hold %ld \n",sim->nporesite,nlisted);
+                exit(1);
+        }
+        for(ipos=0;ipos<sim->nporesite;ipos++){
+                if((!PORELISTED(sim->mic[sim->poresite[ipos]]))||(sim->poreat[sim->poresite[ipos]]!=ipos)){
+                        logmsg(LOGCYCLE,LOGERROR,"Pore index is inconsistent with microstructure at cycle %d \n",sim->cyccnt);
+                        exit(1);
+                }
+        }
+}
+#endif
+
+/* routine to pick a pixel at random for placement at a pore pixel, */
+/* returning its location in (xp,yp,zp) and 1 if it is porosity, or */
+/* 0 if it is not and another must be picked */
+/* Called by extslagcsh, dissolve, addrand and extrand */
+/* Calls porebuild, ran1 and logmsg */
+int randpore(xp,yp,zp)
+        int *xp,*yp,*zp;
+{
+        long int ipos,iv;
+
+        if(sim->placemode!=PLACEINDEX){
+                *xp=(int)((float)SYSIZE*ran1(simt->seed));
+                *yp=(int)((float)SYSIZE*ran1(simt->seed));
+                *zp=(int)((float)SYSIZE*ran1(simt->seed));
+                if(*xp>=SYSIZE){*xp=0;}
+                if(*yp>=SYSIZE){*yp=0;}
+                if(*zp>=SYSIZE){*zp=0;}
+                return(sim->mic[VOXEL(*xp,*yp,*zp)]==POROSITY);
+        }
+        if(sim->poreok==0){porebuild();}
+        if(simt->count[POROSITY]==0){
+                logmsg(LOGHYDRATE,LOGERROR,"No pore pixels remain for placement at cycle %d \n",sim->cyccnt);
+                exit(1);
+        }
+        ipos=(long int)((double)sim->nporesite*ran1(simt->seed));
+        if(ipos>=sim->nporesite){ipos=sim->nporesite-1;}
+        iv=sim->poresite[ipos];
+        *xp=iv/((long int)SYSIZE*SYSIZE);
+        *yp=(iv/SYSIZE)%SYSIZE;
+        *zp=iv%SYSIZE;
+        return(sim->mic[iv]==POROSITY);
+}
+
+/* routine to return the coordinate offset by off from c, using */
+/* periodic boundaries */
+/* Called by boxpore and boxscan */
+/* Calls no other routines */
+int boxwrap(c,off)
+        int c,off;
+{
+        c=(c+off)%SYSIZE;
+        if(c<0){c+=SYSIZE;}
+        return(c);
+}
+
+/* routine to count the pore pixels in the cube of half width extent */
+/* about (xc,yc,zc), stopping at the one numbered ipick (if not -1) */
+/* and returning its location in (xp,yp,zp) */
+/* Called by boxpore */
+/* Calls boxwrap */
+int boxscan(xc,yc,zc,extent,ipick,xp,yp,zp)
+        int xc,yc,zc,extent,ipick;
+        int *xp,*yp,*zp;
+{
+        int ix,iy,iz,nfound;
+
+        nfound=0;
+        for(ix=(-extent);ix<=extent;ix++){
+        for(iy=(-extent);iy<=extent;iy++){
+        for(iz=(-extent);iz<=extent;iz++){
+                if(sim->mic[VOXEL(boxwrap(xc,ix),boxwrap(yc,iy),boxwrap(zc,iz))]==POROSITY){
+                        if(nfound==ipick){
+                                *xp=boxwrap(xc,ix);
+                                *yp=boxwrap(yc,iy);
+                                *zp=boxwrap(zc,iz);
+                                return(nfound);
+                        }
+                        nfound+=1;
+                }
+        }
+        }
+        }
+        return(nfound);
+}
+
+/* routine to pick a pore pixel at random in the cube of half width */
+/* extent about (xc,yc,zc), returning its location in (xp,yp,zp) and */
+/* 1, or 0 if the cube holds no porosity */
+/* A few pixels of the cube are drawn first; if none is porosity, the */
+/* pore pixels of the cube are listed and one picked, so that the */
+/* pick is as likely for every pore pixel but its cost is bounded */
+/* Called by loccsh */
+/* Calls ran1, boxwrap and boxscan */
+int boxpore(xc,yc,zc,extent,xp,yp,zp)
+        int xc,yc,zc,extent;
+        int *xp,*yp,*zp;
+{
+        int itry,width,xoff,yoff,zoff,nfound,ipick;
+
+        width=2*extent+1;
+        for(itry=0;itry<BOXTRIES;itry++){
+                xoff=(-extent)+(int)((float)width*ran1(simt->seed));
+                yoff=(-extent)+(int)((float)width*ran1(simt->seed));
+                zoff=(-extent)+(int)((float)width*ran1(simt->seed));
+                if(xoff>extent){xoff=extent;}
+                if(yoff>extent){yoff=extent;}
+                if(zoff>extent){zoff=extent;}
+                if(sim->mic[VOXEL(boxwrap(xc,xoff),boxwrap(yc,yoff),boxwrap(zc,zoff))]==POROSITY){
+                        *xp=boxwrap(xc,xoff);
+                        *yp=boxwrap(yc,yoff);
+                        *zp=boxwrap(zc,zoff);
+                        return(1);
+                }
+        }
+        nfound=boxscan(xc,yc,zc,extent,-1,xp,yp,zp);
+        if(nfound==0){return(0);}
+        ipick=(int)((float)nfound*ran1(simt->seed));
+        if(ipick>=nfound){ipick=nfound-1;}
+        boxscan(xc,yc,zc,extent,ipick,xp,yp,zp);
+        return(1);
+}
@@ -0,0 +1,220 @@
+/* Routines to profile the run time of the kernels of each cycle */
+/* If the environment variable CEMHYD_PROFILE is set, the wall-clock */
+/* seconds spent in each kernel (passone, pass two of dissolve, */
+/* makeinert, hydrate, pHpred, burn3d, burnset, parthyd, the writing */
+/* of output and of checkpoints) and the pixels it scanned are */
+/* written, one line a cycle, to the .prf file, together with the */
+/* species dissolved, the steps taken and reactions fired by each */
+/* kind of diffusing species, and the seconds spent moving it */
+/* The totals over the run are printed once it ends (see log.c) */
+/* The time of the kernels run at the end of a cycle after its line */
+/* is written (the checkpoint, and the caller of the library) is */
+/* given in the line of the next cycle */
+/* The time of each kind of species is estimated from one step in */
+/* PROFSAMPLE, each timed step standing for PROFSAMPLE steps of its */
+/* kind; in a parallel build it is summed over the threads moving */
+/* the species, so may exceed that of hydrate */
+/* When not profiling, each kernel and each species step only tests */
+/* a flag */
+
+#include "cemhyd.h"
+
+/* Names of the kernels and of the kinds of diffusing species, from */
+/* DIFFCSH on, used in the header of the profile and the summary */
+static char *profkernel[NPROF]={"passone","passtwo","makeinert","hydrate",
+        "pHpred","burn3d","burnset","parthyd","output","checkpoint"};
+static char *profspecies[NPROFSPEC]={"CSH","CH","GYP","C3A","C4A","FH3",
+        "ETTR","CACO3","AS","ANH","HEM","CAS2","CACL2"};
+
+/* routine to return the wall-clock time in seconds from an */
+/* arbitrary origin */
+/* Called by profinit, profstart, profstop, profcycle and stepant */
+/* Calls no other routines */
+double profclock()
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC,&ts);
+        return((double)ts.tv_sec+1.0e-9*(double)ts.tv_nsec);
+}
+
+/* routine to start profiling if CEMHYD_PROFILE is set, and create the */
+/* profile file with its column headings */
+/* Called by simstart */
+/* Calls ckfile, outcreate, outprintf, profclock and logmsg */
+void profinit()
+{
+        int k;
+
+        if(snprintf(sim->profname,sizeof(sim->profname),"%s.prf.%d.%d.%1d%1d%1d",sim->fileroot,sim->ncyc,(int)sim->temp_0,sim->csh2flag,sim->adiaflag,sim->sealed)>=(int)sizeof(sim->profname)){
+                logmsg(LOGPROF,LOGERROR,"Root name %s too long for profile file \n",sim->fileroot);
+                exit(1);
+        }
+        /* Always listed, so that a checkpoint can be restarted with */
+        /* profiling on or off (older checkpoints have no profile, see */
+        /* ckload) */
+        ckfile(sim->profname);
+        sim->profon=(getenv("CEMHYD_PROFILE")!=NULL);
+        if(!sim->profon){return;}
+        /* The summary is asked for, so printed even in a quiet run */
+        if(sim->loglevel[LOGPROF]<LOGINFO){sim->loglevel[LOGPROF]=LOGINFO;}
+        outcreate(sim->profname);
+        outprintf(sim->profname,"Cycle wall(s)");
+        for(k=0;k<NPROF;k++){
+                outprintf(sim->profname," %s(s) %s(pix)",profkernel[k],profkernel[k]);
+        }
+        outprintf(sim->profname," dissolved moved reacted");
+        for(k=0;k<NPROFSPEC;k++){
+                outprintf(sim->profname," %s(s) %s_moved %s_reacted",profspecies[k],profspecies[k],profspecies[k]);
+        }
+        outprintf(sim->profname,"\n");
+        sim->profkern=(-1);
+        sim->profbegin=sim->proflast=profclock();
+}
+
+/* routine to start timing kernel kernel; kernels are not nested */
+/* Called by dissolve, simcycle and simend */
+/* Calls profclock and logmsg */
+void profstart(kernel)
+        int kernel;
+{
+        if(!sim->profon){return;}
+        if(sim->profkern>=0){
+                logmsg(LOGPROF,LOGERROR,"Kernel %s started while timing %s \n",profkernel[kernel],profkernel[sim->profkern]);
+                exit(1);
+        }
+        sim->profkern=kernel;
+        sim->profnvox=0;
+        sim->profat=profclock();
+}
+
+/* routine to stop timing kernel kernel, which must be the one */
+/* started, adding its time and the pixels it scanned (see PROFSCAN) */
+/* to those of the cycle and run */
+/* Called by dissolve, simcycle and simend */
+/* Calls profclock and logmsg */
+void profstop(kernel)
+        int kernel;
+{
+        double dt;
+
+        if(!sim->profon){return;}
+        if(sim->profkern!=kernel){
+                logmsg(LOGPROF,LOGERROR,"Kernel %s stopped while timing %s \n",profkernel[kernel],(sim->profkern>=0)?profkernel[sim->profkern]:"none");
+                exit(1);
+        }
+        sim->profkern=(-1);
+        dt=profclock()-sim->profat;
+        sim->profsec[kernel]+=dt;
+        sim->proftotsec[kernel]+=dt;
+        sim->profpix[kernel]+=sim->profnvox;
+        sim->proftotpix[kernel]+=sim->profnvox;
+}
+
+/* routine to add the time, steps and reactions of each kind of */
+/* species taken by every thread to those of the run, and return them */
+/* in spec, moved and react, clearing those of the threads */
+/* Called by profcycle and profreport */
+/* Calls no other routines */
+void profgather(spec,moved,react)
+        double spec[NPROFSPEC];
+        long int moved[NPROFSPEC],react[NPROFSPEC];
+{
+        struct simthread *thr;
+        int i,k,nthr;
+
+        for(k=0;k<NPROFSPEC;k++){
+                spec[k]=0.0;
+                moved[k]=react[k]=0;
+        }
+        nthr=1;
+#ifdef PARALLEL
+        if(sim->workers!=NULL){nthr+=sim->nthreads;}
+#endif
+        for(i=0;i<nthr;i++){
+                thr=(&sim->mainthr);
+#ifdef PARALLEL
+                if(i>0){thr=(&sim->workers[i-1]);}
+#endif
+                for(k=0;k<NPROFSPEC;k++){
+                        spec[k]+=thr->profspec[k];
+                        moved[k]+=thr->profmove[k];
+                        react[k]+=thr->profreact[k];
+                        thr->profspec[k]=0.0;
+                        thr->profmove[k]=thr->profreact[k]=0;
+                }
+        }
+        for(k=0;k<NPROFSPEC;k++){
+                sim->proftotspec[k]+=spec[k];
+                sim->proftotmove[k]+=moved[k];
+                sim->proftotreact[k]+=react[k];
+        }
+}
+
+/* routine to write the line of the profile for the current cycle */
+/* and clear the counts of the cycle */
+/* Called by simcycle */
+/* Calls profclock, profgather and outprintf */
+void profcycle()
+{
+        double now,spec[NPROFSPEC];
+        long int moved[NPROFSPEC],react[NPROFSPEC],nmoved,nreact;
+        int k;
+
+        if(!sim->profon){return;}
+        now=profclock();
+        profgather(spec,moved,react);
+        nmoved=nreact=0;
+        for(k=0;k<NPROFSPEC;k++){
+                nmoved+=moved[k];
+                nreact+=react[k];
+        }
+        sim->proftotmade+=sim->nmade;
+        sim->profncyc+=1;
+        outprintf(sim->profname,"%d %.6f",sim->icyc,now-sim->proflast);
+        for(k=0;k<NPROF;k++){
+                outprintf(sim->profname," %.6f %ld",sim->profsec[k],sim->profpix[k]);
+                sim->profsec[k]=0.0;
+                sim->profpix[k]=0;
+        }
+        outprintf(sim->profname," %ld %ld %ld",sim->nmade,nmoved,nreact);
+        for(k=0;k<NPROFSPEC;k++){
+                outprintf(sim->profname," %.6f %ld %ld",spec[k],moved[k],react[k]);
+        }
+        outprintf(sim->profname,"\n");
+        sim->proflast=now;
+}
+
+/* routine to print the time spent in each kernel and on each kind */
+/* of diffusing species over the run */
+/* Called by simend */
+/* Calls profclock, profgather, logmsg and logflush */
+void profreport()
+{
+        double wall,ksum,spec[NPROFSPEC];
+        long int moved[NPROFSPEC],react[NPROFSPEC];
+        int k;
+
+        if(!sim->profon){return;}
+        wall=profclock()-sim->profbegin;
+        profgather(spec,moved,react);
+        if(wall<=0.0){wall=1.0e-9;}
+        logmsg(LOGPROF,LOGINFO,"Profile of %d cycles over %.3f s \n",sim->profncyc,wall);
+        logmsg(LOGPROF,LOGINFO,"%-12s %12s %7s %16s\n","kernel","seconds","share","pixels");
+        ksum=0.0;
+        for(k=0;k<NPROF;k++){
+                logmsg(LOGPROF,LOGINFO,"%-12s %12.3f %6.1f%% %16ld\n",profkernel[k],sim->proftotsec[k],
+                 100.0*sim->proftotsec[k]/wall,sim->proftotpix[k]);
+                ksum+=sim->proftotsec[k];
+        }
+        logmsg(LOGPROF,LOGINFO,"%-12s %12.3f %6.1f%%\n","other",wall-ksum,100.0*(wall-ksum)/wall);
+        logmsg(LOGPROF,LOGINFO,"%ld species dissolved \n",sim->proftotmade);
+        logmsg(LOGPROF,LOGINFO,"%-12s %12s %16s %16s %10s\n","species","seconds","moved","reacted","ns/step");
+        for(k=0;k<NPROFSPEC;k++){
+                if(sim->proftotmove[k]>0){
+                        logmsg(LOGPROF,LOGINFO,"%-12s %12.3f %16ld %16ld %10.1f\n",profspecies[k],sim->proftotspec[k],
+                         sim->proftotmove[k],sim->proftotreact[k],1.0e9*sim->proftotspec[k]/(double)sim->proftotmove[k]);
+                }
+        }
+        logflush();
+}
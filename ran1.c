@@ -1,39 +1,45 @@
+#include "cemhyd.h"
+#undef ran1		/* the generator itself, not the buffered macro */
+
 #define IA 16807
 #define IM 2147483647
 #define IQ 127773
 #define IR 2836
-#define NTAB 32
+#define NTAB RANTAB
 #define EPS (1.2E-07)
 #define MAX(a,b) (a>b)?a:b
 #define MIN(a,b) (a<b)?a:b
 
+/* Shuffle table of ran1 (ran1iv and ran1iy) is kept in the state of */
+/* each thread (see cemhyd.h) so that it can be saved and restored */
+/* with the rest of the state (see checkpoint.c) */
+
 double ran1(idum)
 int *idum;
 {
         int j,k;
-	static int iv[NTAB],iy=0;
 	void nrerror();
         static double NDIV = 1.0/(1.0+(IM-1.0)/NTAB);
         static double RNMX = (1.0-EPS);
         static double AM = (1.0/IM);
 
-	if ((*idum <= 0) || (iy == 0)) {
+	if ((*idum <= 0) || (simt->ran1iy == 0)) {
 		*idum = MAX(-*idum,*idum);
                 for(j=NTAB+7;j>=0;j--) {
 			k = *idum/IQ;
 			*idum = IA*(*idum-k*IQ)-IR*k;
 			if(*idum < 0) *idum += IM;
-			if(j < NTAB) iv[j] = *idum;
+			if(j < NTAB) simt->ran1iv[j] = *idum;
 		}
-		iy = iv[0];
+		simt->ran1iy = simt->ran1iv[0];
 	}
 	k = *idum/IQ;
 	*idum = IA*(*idum-k*IQ)-IR*k;
 	if(*idum<0) *idum += IM;
-	j = iy*NDIV;
-	iy = iv[j];
-	iv[j] = *idum;
-	return MIN(AM*iy,RNMX);
+	j = simt->ran1iy*NDIV;
+	simt->ran1iy = simt->ran1iv[j];
+	simt->ran1iv[j] = *idum;
+	return MIN(AM*simt->ran1iy,RNMX);
 }
 #undef IA 
 #undef IM 
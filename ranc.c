@@ -0,0 +1,277 @@
+/* Routines for counter-based random number generation, and for */
+/* drawing random numbers ahead of use in batches */
+/* Each counter-based random number is computed directly from a key, */
+/* made from the input seed, and a counter made from the cycle, the */
+/* kind of update (tag and sub), an identifier such as a pixel index, */
+/* and the number of draws already made for it, using the Philox4x32-10 */
+/* generator of Salmon et al. (SC11); no state is carried from one */
+/* update to the next, so an update draws the same numbers whatever */
+/* order the updates are done in, and on whatever thread */
+/* Set the environment variable CEMHYD_RNG to counter to use these */
+/* in place of the (default) legacy ran1 sequence */
+/* The ran1 macro of cemhyd.h takes numbers in order from a buffer */
+/* refilled by ranrefill */
+/* Most updates need only one block of four numbers, so the first */
+/* blocks of the next few updates (pixels queued for dissolution, */
+/* diffusing species) are computed together, a lane for each, by */
+/* ranahead; only an update needing more falls back to its own */
+/* blocks, computed singly and then RANLANES at a time */
+
+#include "cemhyd.h"
+#undef ran1		/* ranrefill calls the generator itself */
+
+/* routine to compute the next block of the current stream, as four */
+/* random numbers in (0,1) in out, and advance the counter */
+/* Called by philox */
+/* Calls no other routines */
+void philox1(out)
+        double *out;
+{
+        unsigned int c0,c1,c2,c3,k0,k1,hi0,lo0,hi1,lo1;
+        unsigned long long prod;
+        int iround;
+
+        c0=simt->rngctr[0];
+        c1=simt->rngctr[1];
+        c2=simt->rngctr[2];
+        c3=simt->rngctr[3];
+        k0=sim->rngkey[0];
+        k1=sim->rngkey[1];
+        for(iround=0;iround<10;iround++){
+                if(iround>0){
+                        k0+=0x9E3779B9u;
+                        k1+=0xBB67AE85u;
+                }
+                prod=(unsigned long long)0xD2511F53u*c0;
+                hi0=(unsigned int)(prod>>32);
+                lo0=(unsigned int)prod;
+                prod=(unsigned long long)0xCD9E8D57u*c2;
+                hi1=(unsigned int)(prod>>32);
+                lo1=(unsigned int)prod;
+                c0=hi1^c1^k0;
+                c1=lo1;
+                c2=hi0^c3^k1;
+                c3=lo0;
+        }
+        out[0]=((double)c0+0.5)/4294967296.0;
+        out[1]=((double)c1+0.5)/4294967296.0;
+        out[2]=((double)c2+0.5)/4294967296.0;
+        out[3]=((double)c3+0.5)/4294967296.0;
+        simt->rngctr[0]+=1;
+}
+
+/* routine to compute, side by side in RANLANES separate lanes so */
+/* that the rounds can be vectorized by the compiler, one block for */
+/* each lane's counter (c0,c1,c2,c3), as four random numbers in (0,1) */
+/* a lane in out */
+/* Called by philox and ranahead */
+/* Calls no other routines */
+void philoxlanes(c0,c1,c2,c3,out)
+        unsigned int c0[RANLANES],c1[RANLANES],c2[RANLANES],c3[RANLANES];
+        double *out;
+{
+        unsigned int n0[RANLANES],n1[RANLANES],n2[RANLANES],n3[RANLANES];
+        unsigned int k0,k1;
+        unsigned long long prod0,prod1;
+        int ilane,iround;
+
+        k0=sim->rngkey[0];
+        k1=sim->rngkey[1];
+        for(iround=0;iround<10;iround++){
+                if(iround>0){
+                        k0+=0x9E3779B9u;
+                        k1+=0xBB67AE85u;
+                }
+                /* The round is written to n0..n3 and copied back, */
+                /* rather than updating c0..c3 in place, so that the */
+                /* compiler vectorizes it */
+                for(ilane=0;ilane<RANLANES;ilane++){
+                        prod0=(unsigned long long)c0[ilane]*0xD2511F53u;
+                        prod1=(unsigned long long)c2[ilane]*0xCD9E8D57u;
+                        n0[ilane]=((unsigned int)(prod1>>32))^c1[ilane]^k0;
+                        n2[ilane]=((unsigned int)(prod0>>32))^c3[ilane]^k1;
+                        n1[ilane]=(unsigned int)prod1;
+                        n3[ilane]=(unsigned int)prod0;
+                }
+                for(ilane=0;ilane<RANLANES;ilane++){
+                        c0[ilane]=n0[ilane];
+                        c1[ilane]=n1[ilane];
+                        c2[ilane]=n2[ilane];
+                        c3[ilane]=n3[ilane];
+                }
+        }
+        /* As in philox1, but converted through a signed int, which */
+        /* vectorizes, giving exactly the same numbers */
+        for(ilane=0;ilane<RANLANES;ilane++){
+                out[4*ilane]=((double)(int)(c0[ilane]^0x80000000u)+2147483648.5)/4294967296.0;
+                out[4*ilane+1]=((double)(int)(c1[ilane]^0x80000000u)+2147483648.5)/4294967296.0;
+                out[4*ilane+2]=((double)(int)(c2[ilane]^0x80000000u)+2147483648.5)/4294967296.0;
+                out[4*ilane+3]=((double)(int)(c3[ilane]^0x80000000u)+2147483648.5)/4294967296.0;
+        }
+}
+
+/* routine to compute the next nblk blocks of the current stream, as */
+/* random numbers in (0,1) in out, and advance the counter */
+/* Fewer than RANLANES blocks are computed one at a time; otherwise */
+/* nblk must be a multiple of RANLANES, and the blocks are computed */
+/* RANLANES at a time by philoxlanes */
+/* Called by ranrefill */
+/* Calls philox1 and philoxlanes */
+void philox(nblk,out)
+        int nblk;
+        double *out;
+{
+        unsigned int c0[RANLANES],c1[RANLANES],c2[RANLANES],c3[RANLANES];
+        int iblk,ilane;
+
+        if(nblk<RANLANES){
+                for(iblk=0;iblk<nblk;iblk++){
+                        philox1(&out[4*iblk]);
+                }
+                return;
+        }
+        for(iblk=0;iblk<nblk;iblk+=RANLANES){
+                for(ilane=0;ilane<RANLANES;ilane++){
+                        c0[ilane]=simt->rngctr[0]+(unsigned int)(iblk+ilane);
+                        c1[ilane]=simt->rngctr[1];
+                        c2[ilane]=simt->rngctr[2];
+                        c3[ilane]=simt->rngctr[3];
+                }
+                philoxlanes(c0,c1,c2,c3,&out[4*iblk]);
+        }
+        simt->rngctr[0]+=(unsigned int)nblk;
+}
+
+/* routine to compute ahead, side by side, the first block of the */
+/* streams of the n (at most RANLANES) updates ids of kind tag and */
+/* sub in the current cycle, to be taken by ranstream when each is */
+/* started; most updates (a dissolving pixel, a diffusion step) use */
+/* no more than this block, so that nearly all their numbers are */
+/* computed in lanes rather than one block at a time */
+/* The numbers are those the streams would draw in any case, so a */
+/* guess at the updates to come that proves wrong costs only time */
+/* Called by dissolve, hydrate and movedomain */
+/* Calls philoxlanes */
+void ranahead(tag,sub,ids,n)
+        int tag,sub,n;
+        long int ids[RANLANES];
+{
+        unsigned int c0[RANLANES],c1[RANLANES],c2[RANLANES],c3[RANLANES];
+        int ilane;
+
+        if((sim->rngmode!=RNGCOUNTER)||(n<1)){return;}
+        if(n>RANLANES){n=RANLANES;}
+        for(ilane=0;ilane<RANLANES;ilane++){
+                c0[ilane]=0;
+                c1[ilane]=(unsigned int)ids[(ilane<n)?ilane:(n-1)];
+                c2[ilane]=RNGTAGWORD(tag,sub);
+                c3[ilane]=(unsigned int)sim->cyccnt;
+        }
+        philoxlanes(c0,c1,c2,c3,simt->aheadbuf);
+        for(ilane=0;ilane<n;ilane++){
+                simt->aheadid[ilane]=ids[ilane];
+        }
+        simt->nahead=n;
+        simt->aheadnext=0;
+        simt->aheadtag=RNGTAGWORD(tag,sub);
+        simt->aheadcyc=(unsigned int)sim->cyccnt;
+}
+
+/* routine to return the lane of ranahead holding the first block of */
+/* the stream of update id of kind tag and sub, or -1 if none does */
+/* Called by ranstream, and by dissolve, hydrate and movedomain */
+/* through ranready */
+/* Calls no other routines */
+int ranfind(tag,sub,id)
+        int tag,sub;
+        long int id;
+{
+        int ilane;
+
+        if((simt->nahead==0)||(simt->aheadtag!=RNGTAGWORD(tag,sub))||(simt->aheadcyc!=(unsigned int)sim->cyccnt)){
+                return(-1);
+        }
+        /* Updates are usually started in the order computed */
+        ilane=simt->aheadnext;
+        if((ilane<simt->nahead)&&(simt->aheadid[ilane]==id)){
+                return(ilane);
+        }
+        for(ilane=0;ilane<simt->nahead;ilane++){
+                if(simt->aheadid[ilane]==id){
+                        return(ilane);
+                }
+        }
+        return(-1);
+}
+
+/* routine to select the random number generator and set the key */
+/* from the input seed */
+/* Called by main program */
+/* Calls logmsg */
+void raninit(iseed)
+        int iseed;
+{
+        char *envrng;
+
+        envrng=getenv("CEMHYD_RNG");
+        if((envrng!=NULL)&&(strcmp(envrng,"counter")==0)){
+                sim->rngmode=RNGCOUNTER;
+                logmsg(LOGSETUP,LOGINFO,"Using counter-based random numbers \n");
+        }
+        sim->rngkey[0]=(unsigned int)iseed;
+        sim->rngkey[1]=0x5EED5EEDu;
+        simt->ranpos=simt->ranlen=0;
+        simt->nahead=0;
+}
+
+/* routine to start the stream of random numbers for update id of */
+/* kind tag and sub in the current cycle, taking its first block from */
+/* ranahead if computed there; the legacy ran1 sequence is unaffected */
+/* Called by dissolve, hydrate, movedomain, extflush and main */
+/* program */
+/* Calls ranfind */
+void ranstream(tag,sub,id)
+        int tag,sub;
+        long int id;
+{
+        int ilane;
+
+        if(sim->rngmode!=RNGCOUNTER){return;}
+        simt->rngctr[0]=0;
+        simt->rngctr[1]=(unsigned int)id;
+        simt->rngctr[2]=RNGTAGWORD(tag,sub);
+        simt->rngctr[3]=(unsigned int)sim->cyccnt;
+        /* Most updates need only a few numbers, so start with one */
+        /* block and double the batch for those needing more */
+        simt->rngblocks=1;
+        simt->ranpos=simt->ranlen=0;
+        ilane=ranfind(tag,sub,id);
+        if(ilane>=0){
+                /* As if the first block had been drawn by ranrefill */
+                memcpy(simt->ranbuf,&simt->aheadbuf[4*ilane],4*sizeof(double));
+                simt->ranlen=4;
+                simt->rngctr[0]=1;
+                simt->rngblocks=2;
+                simt->aheadnext=ilane+1;
+        }
+}
+
+/* routine to refill the buffer of random numbers once it is used up, */
+/* and return the first of them */
+/* The legacy ran1 sequence is not drawn ahead, since each number */
+/* depends on the last through the shuffle table; it is returned */
+/* directly, leaving the buffer empty */
+/* Called through the ran1 macro */
+/* Calls philox and ran1 */
+double ranrefill(idum)
+        int *idum;
+{
+        if(sim->rngmode!=RNGCOUNTER){
+                return(ran1(idum));
+        }
+        philox(simt->rngblocks,simt->ranbuf);
+        simt->ranlen=4*simt->rngblocks;
+        if((8*simt->rngblocks)<=RANBATCH){simt->rngblocks*=2;}
+        simt->ranpos=1;
+        return(simt->ranbuf[0]);
+}
@@ -0,0 +1,138 @@
+/* Routines to make, select and free simulation contexts */
+/* A context (struct sim, see cemhyd.h) holds every variable of one */
+/* simulation, so that independent simulations can be kept in one */
+/* process; all the routines of the program work on the context */
+/* selected by simuse, reached through the pointer sim, and on the */
+/* state of the calling thread within it, reached through simt */
+/* Both pointers are THREADLOCAL, so each thread may work on its own */
+/* simulation at the same time, in a serial build as well as a */
+/* parallel one; within a thread, simulations may be interleaved, with */
+/* simuse called before any routine is called for another one */
+
+#include "cemhyd.h"
+
+THREADLOCAL struct sim *sim=NULL;	/* current simulation */
+THREADLOCAL struct simthread *simt=NULL;	/* and state of this thread */
+
+/* routine to return a new simulation, with every variable at its */
+/* initial value */
+/* Called by main program and cemhydnew */
+/* Calls logmsg */
+struct sim *simnew()
+{
+        struct sim *s;
+        int k;
+
+        s=(struct sim *)calloc(1,sizeof(struct sim));
+        if(s==NULL){
+                logmsg(LOGSETUP,LOGERROR,"Unable to allocate memory for simulation \n");
+                exit(1);
+        }
+        /* All other variables start at zero */
+        s->syssize=100;
+        s->syssizem1=99;
+        s->sysvolfact=1.0;
+        s->totfract=1.0;
+        s->tfractw04=0.438596;
+        s->fractwithfill=1.0;
+        s->tfractw05=0.384615;
+        s->pfractw05=0.615385;
+        s->T_ambient=25.;
+        s->saturation=1.0;
+        s->cs_acc=1.0;
+        s->ca_acc=1.0;
+        s->dismin_c3a=DISMIN_C3A_0;
+        s->dismin_c4af=DISMIN_C4AF_0;
+        s->onepixelbias=1.0;
+        s->rngmode=RNGLEGACY;
+        s->imgout=s->imgsnap=IMGTEXT;
+        s->movkey=MOVKEYEVERY;
+        s->visitcur=(-1);
+        s->nthreads=1;
+        s->placemode=PLACEDRAW;
+        for(k=0;k<NLOGSUB;k++){
+                s->loglevel[k]=LOGDEBUG;
+        }
+#ifdef PARALLEL
+        pthread_mutex_init(&s->logmutex,NULL);
+        pthread_mutex_init(&s->outmutex,NULL);
+        pthread_cond_init(&s->outwake,NULL);
+        pthread_mutex_init(&s->poolmutex,NULL);
+        pthread_cond_init(&s->poolstart,NULL);
+        pthread_cond_init(&s->pooldone,NULL);
+#endif
+        s->mainthr.owner=s;
+        s->mainthr.ithr=(-1);
+        s->mainthr.rngblocks=1;
+        return(s);
+}
+
+/* routine to make s the simulation of the calling thread */
+/* Called by main program, simfree and the routines of cemhydlib.c */
+/* Calls no other routines */
+void simuse(s)
+        struct sim *s;
+{
+        sim=s;
+        simt=(&s->mainthr);
+}
+
+/* routine to free simulation s and the arrays it holds, once its */
+/* output has been closed (see outclose), stopping its worker threads */
+/* Called by cemhydfree */
+/* Calls enddomains, movclose and percfree */
+void simfree(s)
+        struct sim *s;
+{
+        struct sim *old;
+        int k;
+
+        old=sim;
+        simuse(s);
+#ifdef PARALLEL
+        if(sim->workers!=NULL){
+                enddomains();
+        }
+#endif
+        if(sim->movie.file!=NULL){
+                movclose(&sim->movie);
+        }
+        if(sim->thfile!=NULL){
+                fclose(sim->thfile);
+        }
+        free(sim->mic);
+        free(sim->micorig);
+        free(sim->micpart);
+        free(sim->cshage);
+        free(sim->faces);
+        free(sim->antloc);
+        free(sim->antbirth);
+        free(sim->antid);
+        free(sim->nopen);
+        free(sim->nnear);
+        free(sim->surfbits);
+        free(sim->nearbits);
+        free(sim->visitbits);
+        for(k=0;k<BOXPLANES;k++){
+                free(sim->boxplane[k]);
+        }
+        free(sim->boxslab);
+        free(sim->poresite);
+        free(sim->poreat);
+        for(k=0;k<NPERCLAT;k++){
+                percfree(k);
+        }
+        free(sim->percjob);
+        free(sim->outbuf[0]);
+        free(sim->outbuf[1]);
+        free(sim->logring);
+#ifdef PARALLEL
+        free(sim->outring);
+#endif
+        free(s);
+        sim=NULL;
+        simt=NULL;
+        if((old!=NULL)&&(old!=s)){
+                simuse(old);
+        }
+}
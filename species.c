@@ -0,0 +1,48 @@
+/* Routines to maintain the pool of diffusing species */
+/* Species are held as parallel arrays in order of creation, so that */
+/* hydrate can walk them sequentially and compact out reacted species */
+/* without any per-species allocation */
+
+/* Locations are packed by ANTLOC (see cemhyd.h) */
+
+#include "cemhyd.h"
+
+#define ANTCHUNK 65536	/* initial capacity of the species pool */
+
+/* routine to make room in the pool for at least nneed species */
+/* Called by addant and ckload */
+/* Calls logmsg */
+void antgrow(nneed)
+        long int nneed;
+{
+        long int newcap;
+
+        if(nneed<=sim->antcap){return;}
+        newcap=(sim->antcap==0)?ANTCHUNK:sim->antcap;
+        while(newcap<nneed){
+                newcap*=2;
+        }
+        sim->antloc=(unsigned int *)realloc(sim->antloc,newcap*sizeof(unsigned int));
+        sim->antbirth=(short int *)realloc(sim->antbirth,newcap*sizeof(short int));
+        sim->antid=(unsigned char *)realloc(sim->antid,newcap*sizeof(unsigned char));
+        if((sim->antloc==NULL)||(sim->antbirth==NULL)||(sim->antid==NULL)){
+                logmsg(LOGHYDRATE,LOGERROR,"Unable to allocate memory for %ld diffusing species \n",newcap);
+                exit(1);
+        }
+        sim->antcap=newcap;
+}
+
+/* routine to add a diffusing species to the end of the pool */
+/* Called by loccsh and dissolve */
+/* Calls antgrow */
+void addant(xa,ya,za,ida)
+        int xa,ya,za,ida;
+{
+        if(sim->nants>=sim->antcap){
+                antgrow(sim->nants+1);
+        }
+        sim->antloc[sim->nants]=ANTLOC(xa,ya,za);
+        sim->antbirth[sim->nants]=sim->cyccnt;
+        sim->antid[sim->nants]=ida;
+        sim->nants+=1;
+}
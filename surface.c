@@ -0,0 +1,215 @@
+/* Routines to maintain the frontier of solid pixels in contact with */
+/* pore space, so that passone and pass two of dissolve need only */
+/* visit pixels which may dissolve or react */
+/* As in countbox, a pixel is open if it is porosity, a diffusing */
+/* species, or empty porosity, and solid otherwise; surface-eligible */
+/* pixels (ID greater than OFFSET) are classed by their original phase */
+/* All phase changes made after initsurf must go through setphase */
+/* (see phases.c) */
+
+#include "cemhyd.h"
+
+/* Table of SURFLOW (see cemhyd.h) */
+int surfdebruijn[32]={0,1,28,2,29,14,24,3,30,22,20,15,25,17,4,8,
+        31,27,13,23,21,19,16,7,26,12,18,6,11,5,10,9};
+
+/* routine to return the phase of pixel iv, ignoring any surface mark */
+/* Called by initsurf, flipsurf, setphase and setcshage */
+/* Calls no other routines */
+int surfphase(iv)
+        long int iv;
+{
+        int ph;
+
+        ph=sim->mic[iv];
+        if(ph>=OFFSET){ph-=OFFSET;}
+        return(ph);
+}
+
+/* routine to update the frontier when pixel (xp,yp,zp) changes */
+/* between open (nowopen=1) and solid (nowopen=0) */
+/* During pass two, C-S-H and slag pixels gaining an open neighbor */
+/* are queued for a visit if they have not yet been passed */
+/* Called by initsurf and setphase */
+/* Calls surfphase */
+void flipsurf(xp,yp,zp,nowopen)
+        int xp,yp,zp,nowopen;
+{
+        long int iv,iw,xw[5],yw[5];
+        int i,j,k,zw[5],inbox;
+
+        /* Wrapped coordinates of the 5x5x5 box about the pixel */
+        for(i=0;i<5;i++){
+                xw[i]=xp+i-2;
+                if(xw[i]<0){xw[i]+=SYSIZE;}
+                else if(xw[i]>=SYSIZE){xw[i]-=SYSIZE;}
+                yw[i]=yp+i-2;
+                if(yw[i]<0){yw[i]+=SYSIZE;}
+                else if(yw[i]>=SYSIZE){yw[i]-=SYSIZE;}
+                zw[i]=zp+i-2;
+                if(zw[i]<0){zw[i]+=SYSIZE;}
+                else if(zw[i]>=SYSIZE){zw[i]-=SYSIZE;}
+        }
+        iv=VOXEL(xp,yp,zp);
+        for(i=0;i<5;i++){
+        for(j=0;j<5;j++){
+        for(k=0;k<5;k++){
+                iw=(xw[i]*SYSIZE+yw[j])*SYSIZE+zw[k];
+                if(iw==iv){continue;}
+                inbox=((i>=1)&&(i<=3)&&(j>=1)&&(j<=3)&&(k>=1)&&(k<=3));
+                if(nowopen){
+                        sim->nnear[iw]+=1;
+                        if(inbox){sim->nopen[iw]+=1;}
+                        if(((sim->nnear[iw]==1)||(inbox))&&(!OPENPH(surfphase(iw)))){
+                                sim->nearbits[SURFWORD(iw)]|=SURFBIT(iw);
+                                if(inbox){
+                                        sim->surfbits[SURFWORD(iw)]|=SURFBIT(iw);
+                                        if((iw>sim->visitcur)&&(((sim->visitslag)&&(sim->mic[iw]==SLAG))||((sim->visitcsh)&&(sim->mic[iw]==CSH)))){
+                                                sim->visitbits[SURFWORD(iw)]|=SURFBIT(iw);
+                                        }
+                                }
+                        }
+                }
+                else{
+                        sim->nnear[iw]-=1;
+                        if(sim->nnear[iw]==0){
+                                sim->nearbits[SURFWORD(iw)]&=(~SURFBIT(iw));
+                        }
+                        if(inbox){
+                                sim->nopen[iw]-=1;
+                                if(sim->nopen[iw]==0){
+                                        sim->surfbits[SURFWORD(iw)]&=(~SURFBIT(iw));
+                                }
+                        }
+                }
+        }
+        }
+        }
+        if(nowopen){
+                sim->surfbits[SURFWORD(iv)]&=(~SURFBIT(iv));
+                sim->nearbits[SURFWORD(iv)]&=(~SURFBIT(iv));
+        }
+        else{
+                if(sim->nopen[iv]>0){sim->surfbits[SURFWORD(iv)]|=SURFBIT(iv);}
+                if(sim->nnear[iv]>0){sim->nearbits[SURFWORD(iv)]|=SURFBIT(iv);}
+        }
+}
+
+/* routine to allocate (if need be) and build the frontier for the */
+/* current microstructure */
+/* Called by initphases */
+/* Calls surfphase, flipsurf and logmsg */
+void initsurf()
+{
+        long int nvox;
+        int ix,iy,iz;
+
+        nvox=(long int)SYSIZE*SYSIZE*SYSIZE;
+        if(sim->nopen==NULL){
+                sim->nsurfwords=SURFWORD(nvox-1)+1;
+                sim->nopen=(unsigned char *)calloc(nvox,sizeof(unsigned char));
+                sim->nnear=(unsigned char *)calloc(nvox,sizeof(unsigned char));
+                sim->surfbits=(unsigned int *)calloc(sim->nsurfwords,sizeof(unsigned int));
+                sim->nearbits=(unsigned int *)calloc(sim->nsurfwords,sizeof(unsigned int));
+                sim->visitbits=(unsigned int *)calloc(sim->nsurfwords,sizeof(unsigned int));
+                if((sim->nopen==NULL)||(sim->nnear==NULL)||(sim->surfbits==NULL)||(sim->nearbits==NULL)||(sim->visitbits==NULL)){
+                        logmsg(LOGDISSOLVE,LOGERROR,"Unable to allocate memory for surface frontier \n");
+                        exit(1);
+                }
+        }
+        else{
+                /* Built again after a restart (see checkpoint.c) */
+                memset(sim->nopen,0,nvox*sizeof(unsigned char));
+                memset(sim->nnear,0,nvox*sizeof(unsigned char));
+                memset(sim->surfbits,0,sim->nsurfwords*sizeof(unsigned int));
+                memset(sim->nearbits,0,sim->nsurfwords*sizeof(unsigned int));
+                memset(sim->visitbits,0,sim->nsurfwords*sizeof(unsigned int));
+        }
+
+        /* Starting from an all-solid frontier, open each open pixel */
+        for(ix=0;ix<SYSIZE;ix++){
+        for(iy=0;iy<SYSIZE;iy++){
+        for(iz=0;iz<SYSIZE;iz++){
+                if(OPENPH(surfphase(VOXEL(ix,iy,iz)))){
+                        flipsurf(ix,iy,iz,1);
+                }
+        }
+        }
+        }
+}
+
+/* routine to queue for pass two the C-S-H and slag pixels which may */
+/* satisfy countbox(3,...)>=1 when visited, i.e. those with an open */
+/* or surface-eligible pixel in their 3x3x3 box; since every */
+/* surface-eligible pixel touches porosity, all such pixels lie */
+/* within the 5x5x5 box of an open pixel */
+/* Surface-eligible pixels themselves are queued by passone */
+/* Called by dissolve */
+/* Calls no other routines */
+void addvisit()
+{
+        long int iw,iv;
+        int ph;
+        unsigned int bits;
+
+        if((sim->visitcsh==0)&&(sim->visitslag==0)){return;}
+        for(iw=0;iw<sim->nsurfwords;iw++){
+                for(bits=sim->nearbits[iw];bits!=0;bits&=(bits-1)){
+                        iv=(iw<<5)+SURFLOW(bits);
+                        ph=sim->mic[iv];
+                        if(((sim->visitslag)&&(ph==SLAG))||((sim->visitcsh)&&(ph==CSH))){
+                                sim->visitbits[iw]|=SURFBIT(iv);
+                        }
+                }
+        }
+}
+
+/* routine to return the next pixel to visit in pass two of dissolve, */
+/* in lattice order, or -1 when none remain */
+/* Pixels may be queued ahead of visitcur while the pass is under way */
+/* Called by dissolve */
+/* Calls no other routines */
+long int nextvisit()
+{
+        long int iw;
+        unsigned int bits;
+
+        iw=(sim->visitcur<0)?0:SURFWORD(sim->visitcur);
+        for(;iw<sim->nsurfwords;iw++){
+                bits=sim->visitbits[iw];
+                if(bits!=0){
+                        sim->visitbits[iw]&=(bits-1);
+                        sim->visitcur=(iw<<5)+SURFLOW(bits);
+                        PROFSCAN(1);
+                        return(sim->visitcur);
+                }
+        }
+        sim->visitcur=(-1);
+        return(-1);
+}
+
+/* routine to put first and then the pixels queued after it for pass */
+/* two, in the order nextvisit will return them, in ids (at most n in */
+/* all), leaving the queue as it is, and return their number */
+/* Called by dissolve */
+/* Calls no other routines */
+int peekvisit(first,ids,n)
+        long int first;
+        long int *ids;
+        int n;
+{
+        long int iw;
+        unsigned int bits;
+        int nids;
+
+        nids=0;
+        ids[nids++]=first;
+        for(iw=SURFWORD(first);(iw<sim->nsurfwords)&&(nids<n);iw++){
+                bits=sim->visitbits[iw];
+                while((bits!=0)&&(nids<n)){
+                        ids[nids++]=(iw<<5)+SURFLOW(bits);
+                        bits&=(bits-1);
+                }
+        }
+        return(nids);
+}